@@ -42,6 +42,7 @@
 
 #include <3d_viewer.h>
 #include <3d_canvas.h>
+#include <3d_gl_buffer.h>
 #include <info3d_visu.h>
 #include <trackball.h>
 
@@ -120,34 +121,34 @@ void TransfertToGLlist( std::vector< S3D_VERTEX >& aVertices, double aBiuTo3DUni
         nx /= r;
         ny /= r;
         nz /= r;
-        glNormal3f( nx, ny, nz );
+        glbNormal3f( nx, ny, nz );
     }
 
     /* glBegin/glEnd */
     switch( aVertices.size() )
     {
     case 3:
-        glBegin( GL_TRIANGLES );
+        glbBegin( GL_TRIANGLES );
         break;
 
     case 4:
-        glBegin( GL_QUADS );
+        glbBegin( GL_QUADS );
         break;
 
     default:
-        glBegin( GL_POLYGON );
+        glbBegin( GL_POLYGON );
         break;
     }
 
     /* draw polygon/triangle/quad */
     for( ii = 0; ii < aVertices.size(); ii++ )
     {
-        glVertex3d( aVertices[ii].x * aBiuTo3DUnits,
-                    aVertices[ii].y * aBiuTo3DUnits,
-                    aVertices[ii].z * aBiuTo3DUnits );
+        glbVertex3f( aVertices[ii].x * aBiuTo3DUnits,
+                     aVertices[ii].y * aBiuTo3DUnits,
+                     aVertices[ii].z * aBiuTo3DUnits );
     }
 
-    glEnd();
+    glbEnd();
 }
 
 S3DPOINT_VALUE_CTRL::S3DPOINT_VALUE_CTRL( wxWindow* aParent, wxBoxSizer* aBoxSizer )
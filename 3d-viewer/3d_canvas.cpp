@@ -45,6 +45,8 @@
 
 #include <3d_viewer.h>
 #include <3d_canvas.h>
+#include <3d_model_cache.h>
+#include <3d_model_buffer.h>
 #include <info3d_visu.h>
 #include <trackball.h>
 #include <3d_viewer_id.h>
@@ -74,6 +76,7 @@ BEGIN_EVENT_TABLE( EDA_3D_CANVAS, wxGLCanvas )
     // other events
     EVT_ERASE_BACKGROUND( EDA_3D_CANVAS::OnEraseBackground )
     EVT_MENU_RANGE( ID_POPUP_3D_VIEW_START, ID_POPUP_3D_VIEW_END, EDA_3D_CANVAS::OnPopUpMenu )
+    EVT_TIMER( wxID_ANY, EDA_3D_CANVAS::OnModelLoadTimer )
 END_EVENT_TABLE()
 
 // Define an invalid value for some unsigned int indexes
@@ -86,6 +89,9 @@ EDA_3D_CANVAS::EDA_3D_CANVAS( EDA_3D_FRAME* parent, int* attribList ) :
     m_init   = false;
     m_reportWarnings = true;
     m_shadow_init = false;
+    m_loadedModelCount = 0;
+    m_footprintShapesRead = false;
+    m_modelLoadTimer.SetOwner( this );
     // set an invalide value to not yet initialized indexes managing
     // textures created to enhance 3D rendering
     m_text_pcb = m_text_silk = INVALID_INDEX;
@@ -113,15 +119,12 @@ EDA_3D_CANVAS::EDA_3D_CANVAS( EDA_3D_FRAME* parent, int* attribList ) :
 
 EDA_3D_CANVAS::~EDA_3D_CANVAS()
 {
+    m_modelLoadTimer.Stop();
     ClearLists();
     m_init = false;
     delete m_glRC;
 
-    // Free the list of parsers list
-    for( unsigned int i = 0; i < m_model_parsers_list.size(); i++ )
-        if( m_model_parsers_list[i] )
-            delete m_model_parsers_list[i];
-
+    // The 3D models are kept by S3D_MODEL_CACHE, for the next 3D viewer
 }
 
 
@@ -133,6 +136,10 @@ void EDA_3D_CANVAS::ClearLists( int aGlList )
             glDeleteLists( m_glLists[aGlList], 1 );
 
         m_glLists[aGlList] = 0;
+        m_glBuffers[aGlList].Clear();
+
+        if( aGlList == GL_ID_3DSHAPES_SOLID_FRONT )
+            m_footprintShapesRead = false;
 
         return;
     }
@@ -143,8 +150,23 @@ void EDA_3D_CANVAS::ClearLists( int aGlList )
             glDeleteLists( m_glLists[ii], 1 );
 
         m_glLists[ii] = 0;
+        m_glBuffers[ii].Clear();
     }
 
+    // The render options of the 3D models may have changed
+    for( MODEL_BUFFER_MAP::iterator it = m_modelBuffers.begin();
+         it != m_modelBuffers.end(); ++it )
+        delete it->second;
+
+    m_modelBuffers.clear();
+    m_footprintShapesRead = false;
+
+    clearFakeShadows();
+}
+
+
+void EDA_3D_CANVAS::clearFakeShadows()
+{
     // When m_text_fake_shadow_??? is set to INVALID_INDEX, textures are no yet
     // created.
     if( m_text_fake_shadow_front != INVALID_INDEX )
@@ -160,6 +182,31 @@ void EDA_3D_CANVAS::ClearLists( int aGlList )
 }
 
 
+void EDA_3D_CANVAS::OnModelLoadTimer( wxTimerEvent& event )
+{
+    S3D_MODEL_CACHE& cache = S3D_MODEL_CACHE::Instance();
+
+    // Read before the count, so the models loaded last are not missed
+    bool loading = cache.IsLoading();
+
+    if( cache.LoadedCount() != m_loadedModelCount )
+    {
+        // Draw the footprints with the models loaded so far
+        ClearLists( GL_ID_3DSHAPES_SOLID_FRONT );
+
+        // The shadows take time to render: they are updated only when all the
+        // models are loaded
+        if( !loading )
+            clearFakeShadows();
+
+        Refresh( false );
+    }
+
+    if( !loading )
+        m_modelLoadTimer.Stop();
+}
+
+
 void EDA_3D_CANVAS::OnChar( wxKeyEvent& event )
 {
     SetView3D( event.GetKeyCode() );
@@ -571,6 +618,7 @@ void EDA_3D_CANVAS::InitGL()
     {
         m_init = true;
 
+        S3D_GL_BUFFER::InitGL();
 
         m_text_pcb = load_and_generate_texture( (tsImage *)&text_pcb  );
         m_text_silk = load_and_generate_texture( (tsImage *)&text_silk );
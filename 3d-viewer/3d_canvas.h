@@ -31,6 +31,8 @@
 #define _3D_CANVAS_H_
 
 #include <wx/glcanvas.h>
+#include <wx/timer.h>
+#include <boost/unordered_map.hpp>
 
 #ifdef __WXMAC__
 #  ifdef __DARWIN__
@@ -43,6 +45,7 @@
 #endif
 
 #include <3d_struct.h>
+#include <3d_gl_buffer.h>
 #include <modelparsers.h>
 #include <class_module.h>
 #include <CBBox.h>
@@ -54,26 +57,28 @@ class REPORTER;
 
 class VIA;
 class D_PAD;
+class S3D_MODEL_BUFFER;
 
-// We are using GL lists to store layers and other items
+// We are using GL lists and vertex buffers to store layers and other items
 // to draw or not
-// GL_LIST_ID are the GL lists indexes in m_glLists
+// GL_LIST_ID are the GL lists indexes in m_glLists, and the vertex buffers
+// indexes in m_glBuffers for the board and its layers
 enum GL_LIST_ID
 {
     GL_ID_BEGIN = 0,
     GL_ID_AXIS = GL_ID_BEGIN,   // list id for 3D axis
     GL_ID_GRID,                 // list id for 3D grid
-    GL_ID_BOARD,                // List id for copper layers
-    GL_ID_TECH_LAYERS,          // List id for non copper layers (masks...)
-    GL_ID_AUX_LAYERS,           // List id for user layers (draw, eco, comment)
-    GL_ID_3DSHAPES_SOLID_FRONT, // List id for 3D shapes, non transparent entities
-    GL_ID_3DSHAPES_TRANSP_FRONT,// List id for 3D shapes, transparent entities
-    GL_ID_3DSHAPES_SOLID_BACK,  // List id for 3D shapes, non transparent entities
-    GL_ID_3DSHAPES_TRANSP_BACK, // List id for 3D shapes, transparent entities
+    GL_ID_BOARD,                // Buffer id for copper layers
+    GL_ID_TECH_LAYERS,          // Buffer id for non copper layers (masks...)
+    GL_ID_AUX_LAYERS,           // Buffer id for user layers (draw, eco, comment)
+    GL_ID_3DSHAPES_SOLID_FRONT, // Id to read again the 3D shapes
+    GL_ID_3DSHAPES_TRANSP_FRONT,// Unused (3D shapes are drawn from S3D_MODEL_BUFFERs)
+    GL_ID_3DSHAPES_SOLID_BACK,  // Unused
+    GL_ID_3DSHAPES_TRANSP_BACK, // Unused
     GL_ID_SHADOW_FRONT,
     GL_ID_SHADOW_BACK,
     GL_ID_SHADOW_BOARD,
-    GL_ID_BODY,                 // Body only list
+    GL_ID_BODY,                 // Body only buffer
     GL_ID_END
 };
 
@@ -84,6 +89,7 @@ private:
     bool            m_reportWarnings;       ///< true to report all warnings when building the 3D scene
                                             ///< false to report errors only
     GLuint          m_glLists[GL_ID_END];   ///< GL lists
+    S3D_GL_BUFFER   m_glBuffers[GL_ID_END]; ///< vertex buffers of the board and its layers
     wxGLContext*    m_glRC;
     wxRealPoint     m_draw3dOffset;         ///< offset to draw the 3D mesh.
     double          m_ZBottom;              ///< position of the back layer
@@ -104,9 +110,22 @@ private:
 
     S3D_VERTEX      m_lightPos;
 
-    /// Stores the list of parsers for each new file name (dont repeat files already loaded)
-    std::vector<S3D_MODEL_PARSER *> m_model_parsers_list;
-    std::vector<wxString> m_model_filename_list;
+    /// Polls the 3D model cache while models are loaded in background
+    wxTimer         m_modelLoadTimer;
+    int             m_loadedModelCount;     ///< LoadedCount() of the cache when the 3D shapes
+                                            ///< were read
+    bool            m_footprintShapesRead;  ///< true once the footprints got their 3D shapes
+
+    typedef boost::unordered_map<S3D_MODEL_PARSER*, S3D_MODEL_BUFFER*> MODEL_BUFFER_MAP;
+
+    /// Vertex buffers of the 3D models, shared by the footprints using the same model
+    MODEL_BUFFER_MAP m_modelBuffers;
+
+    /**
+     * Function clearFakeShadows
+     * deletes the shadow textures, which will be created again at the next redraw.
+     */
+    void clearFakeShadows();
 
     void create_and_render_shadow_buffer( GLuint *aDst_gl_texture,
             GLuint aTexture_size, bool aDraw_body, int aBlurPasses );
@@ -123,9 +142,10 @@ public:
 
     /**
      * Function ClearLists
-     * Clear the display list.
+     * Clear the display list or the vertex buffer.
      * @param aGlList = the list to clear.
      * if 0 (default) all lists are cleared
+     * GL_ID_3DSHAPES_SOLID_FRONT makes the 3D shapes read again from the model cache
      */
     void   ClearLists( int aGlList = 0 );
 
@@ -141,6 +161,12 @@ public:
     void   OnRightClick( wxMouseEvent& event );
     void   OnPopUpMenu( wxCommandEvent& event );
 
+    /**
+     * Function OnModelLoadTimer
+     * rebuilds the 3D shapes when more models were loaded by the 3D model cache.
+     */
+    void   OnModelLoadTimer( wxTimerEvent& event );
+
     /**
      * Function TakeScreenshot
      *
@@ -240,23 +266,25 @@ private:
     /**
      * Function buildBoard3DView
      * Called by CreateDrawGL_List()
-     * Populates the OpenGL GL_ID_BOARD draw list with board items only on copper layers.
-     * 3D footprint shapes, tech layers and aux layers are not on this list
+     * Populates the GL_ID_BOARD vertex buffer with board items only on copper layers,
+     * in one group per layer (holes are in the UNDEFINED_LAYER group).
+     * 3D footprint shapes, tech layers and aux layers are not in this buffer
      * Fills aErrorMessages with error messages created by some calculation function
      * display activity state
-     * @param aBoardList =
-     * @param aBodyOnlyList =
+     * @param aBoard = the buffer receiving the copper layers
+     * @param aBodyOnly = the buffer receiving the board body
      * @param aErrorMessages = a REPORTER to add error and warning messages
      * created by the build process (can be NULL)
      * @param aActivity = a REPORTER to display activity state
      */
-    void   buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
+    void   buildBoard3DView( S3D_GL_BUFFER& aBoard, S3D_GL_BUFFER& aBodyOnly,
                              REPORTER* aErrorMessages, REPORTER* aActivity );
 
     /**
      * Function buildTechLayers3DView
      * Called by CreateDrawGL_List()
-     * Populates the OpenGL GL_ID_TECH_LAYERS draw list with items on tech layers
+     * Populates the GL_ID_TECH_LAYERS vertex buffer with items on tech layers, in one
+     * group per layer. All the layers are stored: the hidden ones are not drawn.
      * @param aErrorMessages = a REPORTER to add error and warning messages
      * created by the build process (can be NULL)
      * @param aActivity = a REPORTER to display activity state
@@ -272,23 +300,36 @@ private:
     /**
      * Function buildFootprintShape3DList
      * Called by CreateDrawGL_List()
-     * Fills the OpenGL GL_ID_3DSHAPES_SOLID and GL_ID_3DSHAPES_TRANSP
-     * draw lists with 3D footprint shapes
-     * @param aOpaqueList is the gl list for non transparent items
-     * @param aTransparentList is the gl list for non transparent items,
+     * Gives the footprints their 3D shapes read by the 3D model cache, and starts
+     * reading the missing ones in background.
+     * The shapes are drawn by renderFootprintShapes()
      * @param aErrorMessages = a REPORTER to add error and warning messages
      * created by the build process (can be NULL)
      * @param aActivity = a REPORTER to display activity state
-     * which need to be drawn after all other items
      */
-    void   buildFootprintShape3DList( GLuint aOpaqueList,
-                                      GLuint aTransparentList,
-                                      REPORTER* aErrorMessages, REPORTER* aActivity );
+    void   buildFootprintShape3DList( REPORTER* aErrorMessages, REPORTER* aActivity );
+
+    /**
+     * Function renderFootprintShapes
+     * draws the 3D shapes of all the footprints
+     * @param  aIsRenderingJustNonTransparentObjects = true to draw only opaque objects
+     * @param  aIsRenderingJustTransparentObjects = true to draw only transparent objects
+     */
+    void   renderFootprintShapes( bool aIsRenderingJustNonTransparentObjects,
+                                  bool aIsRenderingJustTransparentObjects );
+
+    /**
+     * Function getModelBuffer
+     * @return the vertex buffer of the meshes read by aParser, built at the first call
+     * (the OpenGL context must be current), or NULL if aParser is NULL
+     */
+    S3D_MODEL_BUFFER* getModelBuffer( S3D_MODEL_PARSER* aParser );
+
     /**
      * Function buildBoard3DAuxLayers
      * Called by CreateDrawGL_List()
-     * Fills the OpenGL GL_ID_AUX_LAYERS draw list
-     * with items on aux layers only
+     * Fills the GL_ID_AUX_LAYERS vertex buffer with items on aux layers only, in one
+     * group per layer. All the layers are stored: the hidden ones are not drawn.
      * @param aErrorMessages = a REPORTER to add error and warning messages
      * created by the build process (can be NULL)
      * @param aActivity = a REPORTER to display activity state
@@ -296,6 +337,12 @@ private:
      */
     void   buildBoard3DAuxLayers( REPORTER* aErrorMessages, REPORTER* aActivity );
 
+    /**
+     * Function drawLayers
+     * draws the groups of a vertex buffer which are layers enabled by is3DLayerEnabled()
+     */
+    void   drawLayers( const S3D_GL_BUFFER& aBuffer );
+
     void   draw3DGrid( double aGriSizeMM );
     void   draw3DAxis();
 
@@ -328,7 +375,7 @@ private:
 
     /**
      * function render3DComponentShape
-     * insert mesh in gl list
+     * draws the 3D shapes of a footprint
      * @param module
      * @param  aIsRenderingJustNonTransparentObjects = true to load non transparent objects
      * @param  aIsRenderingJustTransparentObjects = true to load non transparent objects
@@ -53,6 +53,8 @@
 
 #include <3d_viewer.h>
 #include <3d_canvas.h>
+#include <3d_model_cache.h>
+#include <3d_model_buffer.h>
 #include <info3d_visu.h>
 #include <trackball.h>
 #include <3d_draw_basic_functions.h>
@@ -114,11 +116,11 @@ void EDA_3D_CANVAS::create_and_render_shadow_buffer( GLuint *aDst_gl_texture,
 
     // Render body and shapes
 
-    if( aDraw_body && m_glLists[GL_ID_BODY] )
-        glCallList( m_glLists[GL_ID_BODY] );
+    if( aDraw_body )
+        m_glBuffers[GL_ID_BODY].Draw();
 
-    if( m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] )
-        glCallList( m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] );
+    if( m_footprintShapesRead )
+        renderFootprintShapes( true, false );
 
     // Create and Initialize the float depth buffer
 
@@ -410,7 +412,7 @@ void EDA_3D_CANVAS::Redraw()
     glRotatef( GetPrm3DVisu().m_Rot[2], 0.0, 0.0, 1.0 );
 
 
-    if( ! m_glLists[GL_ID_BOARD] || ! m_glLists[GL_ID_TECH_LAYERS] )
+    if( ! m_glBuffers[GL_ID_BOARD].IsUploaded() || ! m_glBuffers[GL_ID_TECH_LAYERS].IsUploaded() )
         CreateDrawGL_List( &errorReporter, &activityReporter );
 
     if( isEnabled( FL_AXIS ) && m_glLists[GL_ID_AXIS] )
@@ -423,7 +425,7 @@ void EDA_3D_CANVAS::Redraw()
 
     if( isEnabled( FL_MODULE ) )
     {
-        if( ! m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] )
+        if( ! m_footprintShapesRead )
             CreateDrawGL_List( &errorReporter, &activityReporter );
     }
 
@@ -449,12 +451,7 @@ void EDA_3D_CANVAS::Redraw()
     glMateriali ( GL_FRONT_AND_BACK, GL_SHININESS, shininess_value );
 
     if( isEnabled( FL_SHOW_BOARD_BODY ) )
-    {
-        if( m_glLists[GL_ID_BODY] )
-        {
-            glCallList( m_glLists[GL_ID_BODY] );
-        }
-    }
+        m_glBuffers[GL_ID_BODY].Draw();
 
 
     // Board
@@ -467,10 +464,7 @@ void EDA_3D_CANVAS::Redraw()
                         GetPrm3DVisu().m_CopperColor.m_Blue  * 0.20f, 1.0f );
     glMaterialfv( GL_FRONT_AND_BACK, GL_SPECULAR, &specular.x );
 
-    if( m_glLists[GL_ID_BOARD] )
-    {
-        glCallList( m_glLists[GL_ID_BOARD] );
-    }
+    drawLayers( m_glBuffers[GL_ID_BOARD] );
 
 
     // Tech layers
@@ -481,17 +475,14 @@ void EDA_3D_CANVAS::Redraw()
     glm::vec4 specularTech( 0.0f, 0.0f, 0.0f, 1.0f );
     glMaterialfv( GL_FRONT_AND_BACK, GL_SPECULAR, &specularTech.x );
 
-    if( m_glLists[GL_ID_TECH_LAYERS] )
-    {
-        glCallList( m_glLists[GL_ID_TECH_LAYERS] );
-    }
+    drawLayers( m_glBuffers[GL_ID_TECH_LAYERS] );
 
-    if( isEnabled( FL_COMMENTS ) || isEnabled( FL_COMMENTS )  )
+    if( isEnabled( FL_COMMENTS ) || isEnabled( FL_ECO ) )
     {
-        if( ! m_glLists[GL_ID_AUX_LAYERS] )
+        if( ! m_glBuffers[GL_ID_AUX_LAYERS].IsUploaded() )
             CreateDrawGL_List( &errorReporter, &activityReporter );
 
-        glCallList( m_glLists[GL_ID_AUX_LAYERS] );
+        drawLayers( m_glBuffers[GL_ID_AUX_LAYERS] );
     }
 
     //glLightModeli( GL_LIGHT_MODEL_TWO_SIDE, TRUE );
@@ -541,10 +532,10 @@ void EDA_3D_CANVAS::Redraw()
 
     if( isEnabled( FL_MODULE ) )
     {
-        if( ! m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] )
+        if( ! m_footprintShapesRead )
             CreateDrawGL_List( &errorReporter, &activityReporter );
 
-        glCallList( m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] );
+        renderFootprintShapes( true, false );
     }
 
     glEnable( GL_BLEND );
@@ -581,16 +572,15 @@ void EDA_3D_CANVAS::Redraw()
         }
     }
 
-    // This list must be drawn last, because it contains the
-    // transparent gl objects, which should be drawn after all
-    // non transparent objects
-    if(  isEnabled( FL_MODULE ) && m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT] )
+    // The transparent parts of the 3D shapes must be drawn last,
+    // after all non transparent objects
+    if( isEnabled( FL_MODULE ) && m_footprintShapesRead && isEnabled( FL_RENDER_MATERIAL ) )
     {
         glEnable( GL_COLOR_MATERIAL );
         SetOpenGlDefaultMaterial();
         glEnable( GL_BLEND );
         glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-        glCallList( m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT] );
+        renderFootprintShapes( false, true );
     }
 
     // Debug bounding boxes
@@ -689,7 +679,7 @@ void EDA_3D_CANVAS::buildShadowList( GLuint aFrontList, GLuint aBacklist, GLuint
 }
 
 
-void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
+void EDA_3D_CANVAS::buildBoard3DView( S3D_GL_BUFFER& aBoard, S3D_GL_BUFFER& aBodyOnly,
                                       REPORTER* aErrorMessages, REPORTER* aActivity  )
 {
     BOARD* pcb = GetBoard();
@@ -752,7 +742,8 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
     LAYER_ID        cu_seq[MAX_CU_LAYERS];          // preferred sequence, could have called CuStack()
                                                     // but I assume that's backwards
 
-    glNewList( aBoardList, GL_COMPILE );
+    aBoard.Clear();
+    SetGLBuffer( &aBoard );
 
     for( unsigned i=0; i < DIM( cu_seq ); ++i )
         cu_seq[i] = ToLAYER_ID( B_Cu - i );
@@ -772,6 +763,8 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
         if( aActivity )
             aActivity->Report( wxString::Format( _( "Build layer %s" ), LSET::Name( layer ) ) );
 
+        aBoard.SetGroup( layer );
+
         bufferPolys.RemoveAllContours();
         bufferZonesPolys.RemoveAllContours();
         currLayerHoles.RemoveAllContours();
@@ -980,6 +973,9 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
     // - or if the copper thickness is shown
     if( !isEnabled( FL_SHOW_BOARD_BODY ) || isEnabled( FL_USE_COPPER_THICKNESS ) )
     {
+        // The holes do not belong to a layer, and are always drawn
+        aBoard.SetGroup( UNDEFINED_LAYER );
+
         // Draw vias holes (vertical cylinders)
         for( const TRACK* track = pcb->m_Track;  track;  track = track->Next() )
         {
@@ -999,10 +995,11 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
         }
     }
 
-    glEndList();
+    aBoard.Upload();
 
     // Build the body board:
-    glNewList( aBodyOnlyList, GL_COMPILE );
+    aBodyOnly.Clear();
+    SetGLBuffer( &aBodyOnly );
 
     if( isRealisticMode() )
     {
@@ -1052,7 +1049,8 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
                                             1.0f );
     }
 
-    glEndList();
+    aBodyOnly.Upload();
+    SetGLBuffer( NULL );
 }
 
 
@@ -1140,15 +1138,15 @@ void EDA_3D_CANVAS::buildTechLayers3DView( REPORTER* aErrorMessages, REPORTER* a
     {
         LAYER_ID layer = *seq;
 
-        if( !is3DLayerEnabled( layer ) )
-            continue;
-
+        // All the layers are built: the disabled ones are skipped when drawing
         if( layer == Edge_Cuts && isEnabled( FL_SHOW_BOARD_BODY )  )
             continue;
 
         if( aActivity )
             aActivity->Report( wxString::Format( _( "Build layer %s" ), LSET::Name( layer ) ) );
 
+        m_glBuffers[GL_ID_TECH_LAYERS].SetGroup( layer );
+
 
         bufferPolys.RemoveAllContours();
 
@@ -1316,12 +1314,12 @@ void EDA_3D_CANVAS::buildBoard3DAuxLayers( REPORTER* aErrorMessages, REPORTER* a
     {
         LAYER_ID layer = *aux;
 
-        if( !is3DLayerEnabled( layer ) )
-            continue;
-
+        // All the layers are built: the disabled ones are skipped when drawing
         if( aActivity )
             aActivity->Report( wxString::Format( _( "Build layer %s" ), LSET::Name( layer ) ) );
 
+        m_glBuffers[GL_ID_AUX_LAYERS].SetGroup( layer );
+
         bufferPolys.RemoveAllContours();
 
         for( BOARD_ITEM* item = pcb->m_Drawings; item; item = item->Next() )
@@ -1414,66 +1412,51 @@ void EDA_3D_CANVAS::CreateDrawGL_List( REPORTER* aErrorMessages, REPORTER* aActi
 
     // Create Board full gl lists:
 
-    if( ! m_glLists[GL_ID_BOARD] )
+    if( ! m_glBuffers[GL_ID_BOARD].IsUploaded() )
     {
         DBG( unsigned strtime = GetRunningMicroSecs() );
 
-        m_glLists[GL_ID_BOARD] = glGenLists( 1 );
-        m_glLists[GL_ID_BODY] = glGenLists( 1 );
-        buildBoard3DView(m_glLists[GL_ID_BOARD], m_glLists[GL_ID_BODY], aErrorMessages, aActivity );
+        buildBoard3DView( m_glBuffers[GL_ID_BOARD], m_glBuffers[GL_ID_BODY],
+                          aErrorMessages, aActivity );
         CheckGLError( __FILE__, __LINE__ );
 
         DBG( printf( "  buildBoard3DView total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
     }
 
-    if( ! m_glLists[GL_ID_TECH_LAYERS] )
+    if( ! m_glBuffers[GL_ID_TECH_LAYERS].IsUploaded() )
     {
         DBG( unsigned strtime = GetRunningMicroSecs() );
 
-        m_glLists[GL_ID_TECH_LAYERS] = glGenLists( 1 );
-        glNewList( m_glLists[GL_ID_TECH_LAYERS], GL_COMPILE );
+        m_glBuffers[GL_ID_TECH_LAYERS].Clear();
+        SetGLBuffer( &m_glBuffers[GL_ID_TECH_LAYERS] );
         // when calling BuildTechLayers3DView,
         // do not show warnings, which are the same as buildBoard3DView
         buildTechLayers3DView( aErrorMessages, aActivity );
-        glEndList();
+        m_glBuffers[GL_ID_TECH_LAYERS].Upload();
+        SetGLBuffer( NULL );
         CheckGLError( __FILE__, __LINE__ );
 
         DBG( printf( "  buildTechLayers3DView total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
     }
 
-    if( ! m_glLists[GL_ID_AUX_LAYERS] )
+    if( ! m_glBuffers[GL_ID_AUX_LAYERS].IsUploaded() )
     {
         DBG( unsigned strtime = GetRunningMicroSecs() );
 
-        m_glLists[GL_ID_AUX_LAYERS] = glGenLists( 1 );
-        glNewList( m_glLists[GL_ID_AUX_LAYERS], GL_COMPILE );
+        m_glBuffers[GL_ID_AUX_LAYERS].Clear();
+        SetGLBuffer( &m_glBuffers[GL_ID_AUX_LAYERS] );
         buildBoard3DAuxLayers( aErrorMessages, aActivity );
-        glEndList();
+        m_glBuffers[GL_ID_AUX_LAYERS].Upload();
+        SetGLBuffer( NULL );
         CheckGLError( __FILE__, __LINE__ );
 
         DBG( printf( "  buildBoard3DAuxLayers total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
     }
 
-    // draw modules 3D shapes
-    if( ! m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] && isEnabled( FL_MODULE ) )
+    // read modules 3D shapes
+    if( ! m_footprintShapesRead && isEnabled( FL_MODULE ) )
     {
-        m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] = glGenLists( 1 );
-
-        // GL_ID_3DSHAPES_TRANSP_FRONT is an auxiliary list for 3D shapes;
-        // Ensure it is cleared before rebuilding it
-        if( m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT] )
-            glDeleteLists( m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT], 1 );
-
-        bool useMaterial = g_Parm_3D_Visu.GetFlag( FL_RENDER_MATERIAL );
-
-        if( useMaterial )
-            m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT] = glGenLists( 1 );
-        else
-            m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT] = 0;
-
-        buildFootprintShape3DList( m_glLists[GL_ID_3DSHAPES_SOLID_FRONT],
-                                   m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT],
-                                   aErrorMessages, aActivity );
+        buildFootprintShape3DList( aErrorMessages, aActivity );
 
         CheckGLError( __FILE__, __LINE__ );
     }
@@ -1579,9 +1562,10 @@ void EDA_3D_CANVAS::calcBBox()
 }
 
 
-void EDA_3D_CANVAS::buildFootprintShape3DList( GLuint aOpaqueList,
-                                               GLuint aTransparentList,
-                                               REPORTER* aErrorMessages,
+/// Delay, in ms, between two checks for new 3D models loaded in background
+#define MODEL_LOAD_POLL_PERIOD 250
+
+void EDA_3D_CANVAS::buildFootprintShape3DList( REPORTER* aErrorMessages,
                                                REPORTER* aActivity )
 {
     DBG( unsigned strtime = GetRunningMicroSecs() );
@@ -1589,57 +1573,63 @@ void EDA_3D_CANVAS::buildFootprintShape3DList( GLuint aOpaqueList,
     if( aActivity )
         aActivity->Report( _( "Load 3D Shapes" ) );
 
-    // clean the parser list if it have any already loaded files
-    m_model_parsers_list.clear();
-    m_model_filename_list.clear();
+    S3D_MODEL_CACHE& cache = S3D_MODEL_CACHE::Instance();
+
+    // Models loaded after this point will be drawn by the next rebuild of the list
+    m_loadedModelCount = cache.LoadedCount();
 
     BOARD* pcb = GetBoard();
 
     for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
         read3DComponentShape( module );
 
+    // Read the missing models in background, and draw them when they are available
+    cache.StartLoading();
+
+    if( cache.IsLoading() && !m_modelLoadTimer.IsRunning() )
+        m_modelLoadTimer.Start( MODEL_LOAD_POLL_PERIOD );
+
     DBG( printf( "  read3DComponentShape total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
 
-    DBG( strtime = GetRunningMicroSecs() );
+    // The models are stored in vertex buffers by the first rendering
+    m_footprintShapesRead = true;
+}
 
-    bool useMaterial = g_Parm_3D_Visu.GetFlag( FL_RENDER_MATERIAL );
 
-    if( useMaterial )
-    {
-        // aOpaqueList is the gl list for non transparent items
-        // aTransparentList is the gl list for non transparent items,
-        // which need to be drawn after all other items
+void EDA_3D_CANVAS::renderFootprintShapes( bool aIsRenderingJustNonTransparentObjects,
+                                           bool aIsRenderingJustTransparentObjects )
+{
+    for( MODULE* module = GetBoard()->m_Modules; module; module = module->Next() )
+        render3DComponentShape( module, aIsRenderingJustNonTransparentObjects,
+                                aIsRenderingJustTransparentObjects );
+}
 
-        glNewList( aOpaqueList, GL_COMPILE );
-        bool loadOpaqueObjects = true;
 
-        for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
-            render3DComponentShape( module,  loadOpaqueObjects,
-                                             !loadOpaqueObjects );
+S3D_MODEL_BUFFER* EDA_3D_CANVAS::getModelBuffer( S3D_MODEL_PARSER* aParser )
+{
+    if( !aParser )
+        return NULL;
 
-        glEndList();
+    MODEL_BUFFER_MAP::iterator it = m_modelBuffers.find( aParser );
 
+    if( it != m_modelBuffers.end() )
+        return it->second;
 
-        glNewList( aTransparentList, GL_COMPILE );
-        bool loadTransparentObjects = true;
+    S3D_MODEL_BUFFER* model = new S3D_MODEL_BUFFER( aParser );
+    m_modelBuffers[aParser] = model;
 
-        for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
-            render3DComponentShape( module, !loadTransparentObjects,
-                                            loadTransparentObjects );
+    return model;
+}
 
-        glEndList();
-    }
-    else
-    {
-        // Just create one list
-        glNewList( aOpaqueList, GL_COMPILE );
 
-        for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
-            render3DComponentShape( module, false, false );
-        glEndList();
-    }
+void EDA_3D_CANVAS::drawLayers( const S3D_GL_BUFFER& aBuffer )
+{
+    std::vector<bool> visible( LAYER_ID_COUNT );
 
-    DBG( printf( "  render3DComponentShape total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
+    for( int layer = 0; layer < LAYER_ID_COUNT; layer++ )
+        visible[layer] = is3DLayerEnabled( ToLAYER_ID( layer ) );
+
+    aBuffer.Draw( visible );
 }
 
 
@@ -1647,49 +1637,14 @@ bool EDA_3D_CANVAS::read3DComponentShape( MODULE* module )
 {
     if( module )
     {
+        S3D_MODEL_CACHE& cache = S3D_MODEL_CACHE::Instance();
         S3D_MASTER* shape3D = module->Models();
 
         for( ; shape3D; shape3D = shape3D->Next() )
         {
+            // The shapes not yet loaded are drawn empty until they are
             if( shape3D->Is3DType( S3D_MASTER::FILE3D_VRML ) )
-            {
-                bool found = false;
-
-                unsigned int i;
-                wxString shape_filename = shape3D->GetShape3DFullFilename();
-
-                // Search for already loaded files
-                for( i = 0; i < m_model_filename_list.size(); i++ )
-                {
-                    if( shape_filename.Cmp(m_model_filename_list[i]) == 0 )
-                    {
-                        found = true;
-                        break;
-                    }
-                }
-
-                if( found == false )
-                {
-                    // Create a new parser
-                    S3D_MODEL_PARSER *newParser = S3D_MODEL_PARSER::Create( shape3D, shape3D->GetShape3DExtension() );
-
-                    if( newParser )
-                    {
-                        // Read file
-                        if( shape3D->ReadData( newParser ) == 0 )
-                        {
-                            // Store this couple filename / parsed file
-                            m_model_filename_list.push_back( shape_filename );
-                            m_model_parsers_list.push_back( newParser );
-                        }
-                    }
-                }
-                else
-                {
-                    // Reusing file
-                    shape3D->m_parser = m_model_parsers_list[i];
-                }
-            }
+                shape3D->SetParser( cache.GetParser( shape3D ) );
         }
     }
 
@@ -1726,10 +1681,13 @@ void EDA_3D_CANVAS::render3DComponentShape( MODULE* module,
     {
         if( shape3D->Is3DType( S3D_MASTER::FILE3D_VRML ) )
         {
+            S3D_MODEL_BUFFER* model = getModelBuffer( shape3D->m_parser );
+
             glPushMatrix();
 
-            shape3D->Render( aIsRenderingJustNonTransparentObjects,
-                             aIsRenderingJustTransparentObjects );
+            if( model )
+                shape3D->Render( *model, aIsRenderingJustNonTransparentObjects,
+                                 aIsRenderingJustTransparentObjects );
 
             if( isEnabled( FL_RENDER_SHOW_MODEL_BBOX ) )
             {
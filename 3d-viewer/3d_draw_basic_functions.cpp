@@ -33,6 +33,7 @@
 #include <3d_viewer.h>
 #include <info3d_visu.h>
 #include <3d_draw_basic_functions.h>
+#include <3d_gl_buffer.h>
 #include <modelparsers.h>
 
 // Number of segments to approximate a circle by segments
@@ -121,20 +122,19 @@ void SetGLColor( EDA_COLOR_T color, double alpha )
     float red     = colordata.m_Red / 255.0;
     float blue    = colordata.m_Blue / 255.0;
     float green   = colordata.m_Green / 255.0;
-    glColor4f( red, green, blue, (float)alpha );
+    glbColor4f( red, green, blue, (float)alpha );
 }
 
 
 void SetGLColor( S3D_COLOR& aColor, float aTransparency )
 {
-    glColor4f( aColor.m_Red, aColor.m_Green, aColor.m_Blue, aTransparency );
+    glbColor4f( aColor.m_Red, aColor.m_Green, aColor.m_Blue, aTransparency );
 }
 
 
 void SetGLTexture( GLuint text_id, float scale )
 {
-    glEnable( GL_TEXTURE_2D );
-    glBindTexture( GL_TEXTURE_2D, text_id );
+    glbTexture( text_id );
     s_textureScale = scale;     // for Tess callback functions
 }
 
@@ -173,7 +173,7 @@ void Draw3D_SolidHorizontalPolyPolygons( const CPOLYGONS_LIST& aPolysList,
     //gluTessProperty( tess, GLU_TESS_BOUNDARY_ONLY, GL_TRUE );
     //gluTessProperty( tess, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_ODD );
 
-    glNormal3f( 0.0, 0.0, aNormal_Z_Orientation );
+    glbNormal3f( 0.0, 0.0, aNormal_Z_Orientation );
 
     // Draw solid areas contained in this list
     CPOLYGONS_LIST polylist = aPolysList;    // temporary copy for gluTessVertex
@@ -218,7 +218,7 @@ void Draw3D_SolidHorizontalPolyPolygons( const CPOLYGONS_LIST& aPolysList,
         s_currentZpos = zpos;     // for Tess callback functions
         v_data[2] = zpos;
 
-        glNormal3f( 0.0, 0.0, -aNormal_Z_Orientation );
+        glbNormal3f( 0.0, 0.0, -aNormal_Z_Orientation );
     }
 
     if( startContour == 0 )
@@ -408,13 +408,13 @@ void Draw3D_ArcSegment( const wxPoint&  aCenterPos, const wxPoint& aStartPoint,
 
 void CALLBACK tessBeginCB( GLenum which )
 {
-    glBegin( which );
+    glbBegin( which );
 }
 
 
 void CALLBACK tessEndCB()
 {
-    glEnd();
+    glbEnd();
 }
 
 
@@ -425,11 +425,11 @@ void CALLBACK tessCPolyPt2Vertex( const GLvoid* data )
 
     if( s_useTextures )
     {
-        glTexCoord2f( ptr->x * s_biuTo3Dunits * s_textureScale,
+        glbTexCoord2f( ptr->x * s_biuTo3Dunits * s_textureScale,
                       -ptr->y * s_biuTo3Dunits * s_textureScale);
     }
 
-    glVertex3d( ptr->x * s_biuTo3Dunits, -ptr->y * s_biuTo3Dunits, s_currentZpos );
+    glbVertex3f( ptr->x * s_biuTo3Dunits, -ptr->y * s_biuTo3Dunits, s_currentZpos );
 }
 
 
@@ -107,7 +107,7 @@ bool EDA_3D_CANVAS::isEnabled( DISPLAY3D_FLG aItem ) const
 // in realistic mode.
 void EDA_3D_CANVAS::setGLCopperColor()
 {
-    glDisable( GL_TEXTURE_2D );
+    glbTexture( 0 );
     SetGLColor( GetPrm3DVisu().m_CopperColor, 1.0 );
 }
 
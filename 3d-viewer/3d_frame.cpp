@@ -627,35 +627,33 @@ void EDA_3D_FRAME::Process_Special_Functions( wxCommandEvent& event )
         NewDisplay( GL_ID_BOARD );
         return;
 
+    // The layers are all stored in the vertex buffers: showing or hiding them
+    // just needs a redraw
     case ID_MENU3D_ADHESIVE_ONOFF:
         GetPrm3DVisu().SetFlag( FL_ADHESIVE, isChecked );
-        NewDisplay( GL_ID_TECH_LAYERS );
-        return;
+        break;
 
     case ID_MENU3D_SILKSCREEN_ONOFF:
         GetPrm3DVisu().SetFlag( FL_SILKSCREEN, isChecked );
-        NewDisplay( GL_ID_TECH_LAYERS );
-        return;
+        break;
 
     case ID_MENU3D_SOLDER_MASK_ONOFF:
         GetPrm3DVisu().SetFlag( FL_SOLDERMASK, isChecked );
-        NewDisplay( GL_ID_TECH_LAYERS );
-        return;
+        break;
 
     case ID_MENU3D_SOLDER_PASTE_ONOFF:
+        // The 3D shapes are moved, and their shadows too
         GetPrm3DVisu().SetFlag( FL_SOLDERPASTE, isChecked );
         NewDisplay();
         return;
 
     case ID_MENU3D_COMMENTS_ONOFF:
         GetPrm3DVisu().SetFlag( FL_COMMENTS, isChecked );
-        NewDisplay( GL_ID_AUX_LAYERS );
-        return;
+        break;
 
     case ID_MENU3D_ECO_ONOFF:
         GetPrm3DVisu().SetFlag( FL_ECO, isChecked );
-        NewDisplay( GL_ID_AUX_LAYERS );
-        return;
+        break;
 
     default:
         wxLogMessage( wxT( "EDA_3D_FRAME::Process_Special_Functions() error: unknown command" ) );
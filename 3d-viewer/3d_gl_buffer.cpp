@@ -0,0 +1,421 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_gl_buffer.cpp
+ */
+
+#include <GL/glew.h>        // must be included before gl.h
+
+#include <cstddef>
+
+#include "3d_gl_buffer.h"
+
+
+// true if vertex buffer objects can be used, once InitGL() was called
+static bool s_useVBO = false;
+
+// the buffer receiving the primitives of the drawing functions, if any
+static S3D_GL_BUFFER* s_currentBuffer = NULL;
+
+
+void SetGLBuffer( S3D_GL_BUFFER* aBuffer )
+{
+    s_currentBuffer = aBuffer;
+}
+
+
+S3D_GL_BUFFER* GetGLBuffer()
+{
+    return s_currentBuffer;
+}
+
+
+// Converts a color component to a byte
+static inline GLubyte colorByte( float aValue )
+{
+    if( aValue <= 0.0f )
+        return 0;
+
+    if( aValue >= 1.0f )
+        return 255;
+
+    return (GLubyte) ( aValue * 255.0f + 0.5f );
+}
+
+
+S3D_GL_BUFFER::S3D_GL_BUFFER()
+{
+    m_vertexBuffer = 0;
+    m_indexBuffer = 0;
+    m_uploaded = false;
+
+    Clear();
+}
+
+
+S3D_GL_BUFFER::~S3D_GL_BUFFER()
+{
+    Clear();
+}
+
+
+void S3D_GL_BUFFER::InitGL()
+{
+    static bool initialized = false;
+
+    if( initialized )
+        return;
+
+    initialized = true;
+
+    if( glewInit() == GLEW_OK )
+        s_useVBO = GLEW_VERSION_1_5;
+}
+
+
+void S3D_GL_BUFFER::Clear()
+{
+    if( m_vertexBuffer )
+        glDeleteBuffers( 1, &m_vertexBuffer );
+
+    if( m_indexBuffer )
+        glDeleteBuffers( 1, &m_indexBuffer );
+
+    m_vertexBuffer = 0;
+    m_indexBuffer = 0;
+    m_uploaded = false;
+
+    // swap() frees the memory, clear() would keep it
+    std::vector<VERTEX>().swap( m_vertices );
+    std::vector<GLuint>().swap( m_indexes );
+    m_ranges.clear();
+
+    static const VERTEX defaultVertex = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f },
+                                          { 0.0f, 0.0f }, { 255, 255, 255, 255 } };
+    m_current = defaultVertex;
+    m_group = 0;
+    m_texture = KEEP_TEXTURE;
+    m_range = -1;
+    m_mode = GL_POINTS;
+    m_begin = 0;
+}
+
+
+void S3D_GL_BUFFER::SetGroup( int aGroup )
+{
+    if( aGroup != m_group )
+    {
+        m_group = aGroup;
+        m_range = -1;
+    }
+}
+
+
+void S3D_GL_BUFFER::SetTexture( GLuint aTexture )
+{
+    if( aTexture != m_texture )
+    {
+        m_texture = aTexture;
+        m_range = -1;
+    }
+}
+
+
+void S3D_GL_BUFFER::Color( float aRed, float aGreen, float aBlue, float aAlpha )
+{
+    m_current.color[0] = colorByte( aRed );
+    m_current.color[1] = colorByte( aGreen );
+    m_current.color[2] = colorByte( aBlue );
+    m_current.color[3] = colorByte( aAlpha );
+}
+
+
+void S3D_GL_BUFFER::Normal( float aX, float aY, float aZ )
+{
+    m_current.normal[0] = aX;
+    m_current.normal[1] = aY;
+    m_current.normal[2] = aZ;
+}
+
+
+void S3D_GL_BUFFER::TexCoord( float aU, float aV )
+{
+    m_current.texCoord[0] = aU;
+    m_current.texCoord[1] = aV;
+}
+
+
+void S3D_GL_BUFFER::Begin( GLenum aMode )
+{
+    m_mode = aMode;
+    m_begin = m_vertices.size();
+}
+
+
+void S3D_GL_BUFFER::Vertex( float aX, float aY, float aZ )
+{
+    m_current.position[0] = aX;
+    m_current.position[1] = aY;
+    m_current.position[2] = aZ;
+
+    m_vertices.push_back( m_current );
+}
+
+
+void S3D_GL_BUFFER::addTriangle( GLuint aA, GLuint aB, GLuint aC )
+{
+    if( m_range < 0 )
+    {
+        for( unsigned ii = 0; ii < m_ranges.size(); ii++ )
+        {
+            if( m_ranges[ii].group == m_group && m_ranges[ii].texture == m_texture )
+            {
+                m_range = ii;
+                break;
+            }
+        }
+
+        if( m_range < 0 )
+        {
+            m_range = m_ranges.size();
+            m_ranges.push_back( RANGE() );
+            m_ranges.back().group = m_group;
+            m_ranges.back().texture = m_texture;
+            m_ranges.back().first = 0;
+            m_ranges.back().count = 0;
+        }
+    }
+
+    std::vector<GLuint>& indexes = m_ranges[m_range].indexes;
+
+    indexes.push_back( aA );
+    indexes.push_back( aB );
+    indexes.push_back( aC );
+}
+
+
+void S3D_GL_BUFFER::End()
+{
+    unsigned first = m_begin;
+    unsigned count = m_vertices.size() - m_begin;
+
+    switch( m_mode )
+    {
+    case GL_TRIANGLES:
+        for( unsigned ii = 2; ii < count; ii += 3 )
+            addTriangle( first + ii - 2, first + ii - 1, first + ii );
+        break;
+
+    case GL_TRIANGLE_STRIP:
+        // Every other triangle is reversed to keep the orientation of the strip
+        for( unsigned ii = 2; ii < count; ii++ )
+        {
+            if( ii % 2 )
+                addTriangle( first + ii - 1, first + ii - 2, first + ii );
+            else
+                addTriangle( first + ii - 2, first + ii - 1, first + ii );
+        }
+        break;
+
+    case GL_TRIANGLE_FAN:
+    case GL_POLYGON:        // the polygons of the 3D viewer are convex
+        for( unsigned ii = 2; ii < count; ii++ )
+            addTriangle( first, first + ii - 1, first + ii );
+        break;
+
+    case GL_QUADS:
+        for( unsigned ii = 3; ii < count; ii += 4 )
+        {
+            addTriangle( first + ii - 3, first + ii - 2, first + ii - 1 );
+            addTriangle( first + ii - 3, first + ii - 1, first + ii );
+        }
+        break;
+
+    default:
+        // Lines and points are not stored
+        m_vertices.resize( m_begin );
+        break;
+    }
+
+    m_mode = GL_POINTS;
+}
+
+
+void S3D_GL_BUFFER::Upload()
+{
+    // Store the ranges one after the other in the index buffer
+    unsigned count = 0;
+
+    for( unsigned ii = 0; ii < m_ranges.size(); ii++ )
+        count += m_ranges[ii].indexes.size();
+
+    m_indexes.reserve( count );
+
+    for( unsigned ii = 0; ii < m_ranges.size(); ii++ )
+    {
+        RANGE& range = m_ranges[ii];
+
+        range.first = m_indexes.size();
+        range.count = range.indexes.size();
+        m_indexes.insert( m_indexes.end(), range.indexes.begin(), range.indexes.end() );
+        std::vector<GLuint>().swap( range.indexes );
+    }
+
+    m_uploaded = true;
+    m_range = -1;
+
+    if( !s_useVBO || m_indexes.empty() )
+        return;
+
+    glGenBuffers( 1, &m_vertexBuffer );
+    glBindBuffer( GL_ARRAY_BUFFER, m_vertexBuffer );
+    glBufferData( GL_ARRAY_BUFFER, m_vertices.size() * sizeof( VERTEX ),
+                  &m_vertices[0], GL_STATIC_DRAW );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+    glGenBuffers( 1, &m_indexBuffer );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, m_indexes.size() * sizeof( GLuint ),
+                  &m_indexes[0], GL_STATIC_DRAW );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+
+    // The data is now stored by the graphic card
+    std::vector<VERTEX>().swap( m_vertices );
+    std::vector<GLuint>().swap( m_indexes );
+}
+
+
+bool S3D_GL_BUFFER::Bind() const
+{
+    if( !m_uploaded || m_ranges.empty() )
+        return false;
+
+    // With vertex buffer objects, the pointers are offsets in the buffers
+    size_t base = 0;
+
+    if( m_vertexBuffer )
+    {
+        glBindBuffer( GL_ARRAY_BUFFER, m_vertexBuffer );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer );
+    }
+    else
+    {
+        base = (size_t) &m_vertices[0];
+    }
+
+    glEnableClientState( GL_VERTEX_ARRAY );
+    glEnableClientState( GL_NORMAL_ARRAY );
+    glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+    glEnableClientState( GL_COLOR_ARRAY );
+
+    glVertexPointer( 3, GL_FLOAT, sizeof( VERTEX ),
+                     (const GLvoid*) ( base + offsetof( VERTEX, position ) ) );
+    glNormalPointer( GL_FLOAT, sizeof( VERTEX ),
+                     (const GLvoid*) ( base + offsetof( VERTEX, normal ) ) );
+    glTexCoordPointer( 2, GL_FLOAT, sizeof( VERTEX ),
+                       (const GLvoid*) ( base + offsetof( VERTEX, texCoord ) ) );
+    glColorPointer( 4, GL_UNSIGNED_BYTE, sizeof( VERTEX ),
+                    (const GLvoid*) ( base + offsetof( VERTEX, color ) ) );
+
+    return true;
+}
+
+
+void S3D_GL_BUFFER::Unbind() const
+{
+    glDisableClientState( GL_VERTEX_ARRAY );
+    glDisableClientState( GL_NORMAL_ARRAY );
+    glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+    glDisableClientState( GL_COLOR_ARRAY );
+
+    if( m_vertexBuffer )
+    {
+        glBindBuffer( GL_ARRAY_BUFFER, 0 );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    }
+}
+
+
+void S3D_GL_BUFFER::drawRange( const RANGE& aRange ) const
+{
+    if( aRange.texture == 0 )
+    {
+        glDisable( GL_TEXTURE_2D );
+    }
+    else if( aRange.texture != KEEP_TEXTURE )
+    {
+        glEnable( GL_TEXTURE_2D );
+        glBindTexture( GL_TEXTURE_2D, aRange.texture );
+    }
+
+    const GLvoid* indexes;
+
+    if( m_indexBuffer )
+        indexes = (const GLvoid*) ( aRange.first * sizeof( GLuint ) );
+    else
+        indexes = &m_indexes[aRange.first];
+
+    glDrawElements( GL_TRIANGLES, aRange.count, GL_UNSIGNED_INT, indexes );
+}
+
+
+void S3D_GL_BUFFER::DrawGroup( int aGroup ) const
+{
+    for( unsigned ii = 0; ii < m_ranges.size(); ii++ )
+    {
+        if( m_ranges[ii].group == aGroup )
+            drawRange( m_ranges[ii] );
+    }
+}
+
+
+void S3D_GL_BUFFER::Draw() const
+{
+    if( !Bind() )
+        return;
+
+    for( unsigned ii = 0; ii < m_ranges.size(); ii++ )
+        drawRange( m_ranges[ii] );
+
+    Unbind();
+}
+
+
+void S3D_GL_BUFFER::Draw( const std::vector<bool>& aVisible ) const
+{
+    if( !Bind() )
+        return;
+
+    for( unsigned ii = 0; ii < m_ranges.size(); ii++ )
+    {
+        int group = m_ranges[ii].group;
+
+        if( group >= 0 && group < (int) aVisible.size() && !aVisible[group] )
+            continue;
+
+        drawRange( m_ranges[ii] );
+    }
+
+    Unbind();
+}
@@ -0,0 +1,261 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_gl_buffer.h
+ */
+
+#ifndef _3D_GL_BUFFER_H_
+#define _3D_GL_BUFFER_H_
+
+#include <vector>
+
+#ifdef __WXMAC__
+#  ifdef __DARWIN__
+#    include <OpenGL/gl.h>
+#  else
+#    include <gl.h>
+#  endif
+#else
+#  include <GL/gl.h>
+#endif
+
+/**
+ * Class S3D_GL_BUFFER
+ * stores triangles in a vertex buffer and an index buffer, uploaded once to the graphic
+ * card, to be drawn with a few draw calls instead of the immediate mode calls of a display
+ * list.
+ *
+ * The buffer is filled with calls similar to the OpenGL immediate mode ones (Begin(),
+ * Normal(), Color(), Vertex()...), then Upload() is called. The triangles are sorted in
+ * groups (e.g. one per board layer), which can be drawn separately.
+ *
+ * Vertex buffer objects are used if the OpenGL driver supports them, client side vertex
+ * arrays otherwise. As display lists, the buffers belong to the OpenGL context which was
+ * current when they were uploaded: it must be current when they are drawn or cleared.
+ */
+class S3D_GL_BUFFER
+{
+public:
+    ///> Texture value of the primitives which do not change the current texture
+    static const GLuint KEEP_TEXTURE = (GLuint) -1;
+
+    S3D_GL_BUFFER();
+    ~S3D_GL_BUFFER();
+
+    /**
+     * Function InitGL
+     * initializes the OpenGL extensions used by the buffers. Must be called once the
+     * OpenGL context is current, before uploading buffers.
+     */
+    static void InitGL();
+
+    /**
+     * Function SetGroup
+     * sets the group of the primitives added after this call (0 by default).
+     */
+    void SetGroup( int aGroup );
+
+    /**
+     * Function SetTexture
+     * sets the texture of the primitives added after this call: a texture id, 0 to
+     * disable the textures, or KEEP_TEXTURE (the default) to use the current texture
+     * when the buffer is drawn.
+     */
+    void SetTexture( GLuint aTexture );
+
+    void Color( float aRed, float aGreen, float aBlue, float aAlpha );
+    void Normal( float aX, float aY, float aZ );
+    void TexCoord( float aU, float aV );
+
+    /**
+     * Function Begin
+     * starts a primitive. The supported modes are GL_TRIANGLES, GL_TRIANGLE_STRIP,
+     * GL_TRIANGLE_FAN, GL_QUADS and GL_POLYGON. The other ones are ignored.
+     */
+    void Begin( GLenum aMode );
+    void Vertex( float aX, float aY, float aZ );
+    void End();
+
+    /**
+     * Function Upload
+     * sends the primitives added so far to the graphic card. The buffer can not be
+     * modified afterwards, until it is cleared.
+     */
+    void Upload();
+
+    ///> Returns true once Upload() was called
+    bool IsUploaded() const
+    {
+        return m_uploaded;
+    }
+
+    ///> Frees the buffers. The OpenGL context must be current.
+    void Clear();
+
+    /**
+     * Function Bind
+     * prepares the drawing of the groups with DrawGroup(). Unbind() must be called when
+     * done.
+     * @return bool - false if there is nothing to draw
+     */
+    bool Bind() const;
+    void Unbind() const;
+
+    ///> Draws the triangles of aGroup. The buffer must be bound.
+    void DrawGroup( int aGroup ) const;
+
+    ///> Draws all the triangles
+    void Draw() const;
+
+    /**
+     * Function Draw
+     * draws the groups in the order they were created, except the ones for which
+     * aVisible is false. Groups which are not in aVisible (negative or too big) are drawn.
+     */
+    void Draw( const std::vector<bool>& aVisible ) const;
+
+private:
+    /// The interleaved data of a vertex
+    struct VERTEX
+    {
+        GLfloat position[3];
+        GLfloat normal[3];
+        GLfloat texCoord[2];
+        GLubyte color[4];
+    };
+
+    /// Triangles with the same group and texture, stored consecutively in the index buffer
+    struct RANGE
+    {
+        int                 group;
+        GLuint              texture;
+        unsigned            first;      ///< first index, once uploaded
+        unsigned            count;      ///< number of indexes, once uploaded
+        std::vector<GLuint> indexes;    ///< indexes, until uploaded
+    };
+
+    void drawRange( const RANGE& aRange ) const;
+
+    ///> Adds the triangles of the current primitive to the current range
+    void addTriangle( GLuint aA, GLuint aB, GLuint aC );
+
+    std::vector<VERTEX> m_vertices;
+    std::vector<GLuint> m_indexes;  ///< all the indexes, once uploaded without VBO
+    std::vector<RANGE>  m_ranges;
+
+    VERTEX              m_current;  ///< attributes of the next vertex
+    int                 m_group;
+    GLuint              m_texture;
+    int                 m_range;    ///< index of the range receiving triangles, or -1
+
+    GLenum              m_mode;     ///< mode of the current primitive
+    unsigned            m_begin;    ///< index of the first vertex of the current primitive
+
+    bool                m_uploaded;
+    GLuint              m_vertexBuffer; ///< 0 if vertex buffer objects are not used
+    GLuint              m_indexBuffer;
+};
+
+
+/**
+ * Function SetGLBuffer
+ * makes the drawing functions of the 3D viewer (Draw3D_xxx(), SetGLColor(), SetGLTexture()
+ * and the glbXxx() functions below) record the geometry in aBuffer, or draw it with OpenGL
+ * immediate mode calls if aBuffer is NULL.
+ */
+void SetGLBuffer( S3D_GL_BUFFER* aBuffer );
+
+///> Returns the buffer given to SetGLBuffer()
+S3D_GL_BUFFER* GetGLBuffer();
+
+
+/* Immediate mode calls, recorded in the buffer given to SetGLBuffer() if any.
+ */
+inline void glbBegin( GLenum aMode )
+{
+    if( GetGLBuffer() )
+        GetGLBuffer()->Begin( aMode );
+    else
+        glBegin( aMode );
+}
+
+inline void glbEnd()
+{
+    if( GetGLBuffer() )
+        GetGLBuffer()->End();
+    else
+        glEnd();
+}
+
+inline void glbVertex3f( GLfloat aX, GLfloat aY, GLfloat aZ )
+{
+    if( GetGLBuffer() )
+        GetGLBuffer()->Vertex( aX, aY, aZ );
+    else
+        glVertex3f( aX, aY, aZ );
+}
+
+inline void glbNormal3f( GLfloat aX, GLfloat aY, GLfloat aZ )
+{
+    if( GetGLBuffer() )
+        GetGLBuffer()->Normal( aX, aY, aZ );
+    else
+        glNormal3f( aX, aY, aZ );
+}
+
+inline void glbTexCoord2f( GLfloat aU, GLfloat aV )
+{
+    if( GetGLBuffer() )
+        GetGLBuffer()->TexCoord( aU, aV );
+    else
+        glTexCoord2f( aU, aV );
+}
+
+inline void glbColor4f( GLfloat aRed, GLfloat aGreen, GLfloat aBlue, GLfloat aAlpha )
+{
+    if( GetGLBuffer() )
+        GetGLBuffer()->Color( aRed, aGreen, aBlue, aAlpha );
+    else
+        glColor4f( aRed, aGreen, aBlue, aAlpha );
+}
+
+///> Binds aTexture and enables the textures, or disables them if aTexture is 0
+inline void glbTexture( GLuint aTexture )
+{
+    if( GetGLBuffer() )
+    {
+        GetGLBuffer()->SetTexture( aTexture );
+    }
+    else if( aTexture )
+    {
+        glEnable( GL_TEXTURE_2D );
+        glBindTexture( GL_TEXTURE_2D, aTexture );
+    }
+    else
+    {
+        glDisable( GL_TEXTURE_2D );
+    }
+}
+
+#endif  // _3D_GL_BUFFER_H_
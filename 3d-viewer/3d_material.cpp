@@ -72,35 +72,50 @@ void SetOpenGlDefaultMaterial()
 }
 
 
-bool S3D_MATERIAL::SetOpenGLMaterial( unsigned int aMaterialIndex, bool aUseMaterial )
+float S3D_MATERIAL::GetTransparency( unsigned int aMaterialIndex ) const
 {
-    if( aUseMaterial )
+    if( m_Transparency.size() > aMaterialIndex )
+        return m_Transparency[aMaterialIndex];
+
+    if( m_Transparency.size() > 0 )
+        return m_Transparency[0];
+
+    return 0.0f;
+}
+
+
+bool S3D_MATERIAL::GetOpenGLColor( unsigned int aMaterialIndex, bool aUseMaterial,
+                                   glm::vec4& aColor ) const
+{
+    if( m_DiffuseColor.size() > aMaterialIndex )
     {
-        float transparency_value = 0.0f;
+        glm::vec3 color = m_DiffuseColor[aMaterialIndex];
+        float alpha = aUseMaterial ? 1.0f - GetTransparency( aMaterialIndex ) : 1.0f;
 
-        if( m_Transparency.size() > aMaterialIndex )
-        {
-            transparency_value = m_Transparency[aMaterialIndex];
-        }
-        else
-        {
-            if( m_Transparency.size() > 0 )
-                transparency_value = m_Transparency[0];
-        }
+        aColor = glm::vec4( color.x, color.y, color.z, alpha );
+        return true;
+    }
 
-        if( m_DiffuseColor.size() > aMaterialIndex )
-        {
-            glm::vec3 color = m_DiffuseColor[aMaterialIndex];
+    if( aUseMaterial && m_DiffuseColor.size() == 0 )
+    {
+        aColor = glm::vec4( 0.8f, 0.8f, 0.8f, 1.0f );
+        return true;
+    }
 
-            glColor4f( color.x, color.y, color.z, 1.0f - transparency_value );
-        }
-        else
-        {
-            if( m_DiffuseColor.size() == 0 )
-            {
-                glColor4f( 0.8f, 0.8f, 0.8f, 1.0f );
-            }
-        }
+    return false;
+}
+
+
+bool S3D_MATERIAL::SetOpenGLMaterial( unsigned int aMaterialIndex, bool aUseMaterial )
+{
+    glm::vec4 color;
+
+    if( GetOpenGLColor( aMaterialIndex, aUseMaterial, color ) )
+        glColor4f( color.x, color.y, color.z, color.w );
+
+    if( aUseMaterial )
+    {
+        float transparency_value = GetTransparency( aMaterialIndex );
 
         if( m_Shininess.size() > 0 )
         {
@@ -142,14 +157,6 @@ bool S3D_MATERIAL::SetOpenGLMaterial( unsigned int aMaterialIndex, bool aUseMate
 
         return (transparency_value != 0.0f);
     }
-    else
-    {
-        if( m_DiffuseColor.size() > aMaterialIndex )
-        {
-            glm::vec3 color = m_DiffuseColor[aMaterialIndex];
-            glColor4f( color.x, color.y, color.z, 1.0 );
-        }
-    }
 
     return false;
 }
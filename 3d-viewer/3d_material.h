@@ -65,6 +65,24 @@ public:
      */
     bool SetOpenGLMaterial(unsigned int aMaterialIndex, bool aUseMaterial);
 
+    /**
+     * Function GetOpenGLColor
+     * gives the color set by SetOpenGLMaterial(), e.g. to store it in a vertex buffer.
+     * @param aMaterialIndex = the index in list of available materials
+     * @param aUseMaterial = the same as for SetOpenGLMaterial()
+     * @param aColor = the current color, replaced by the color of the material
+     * @return true if aColor was replaced, false if the current color is kept
+     */
+    bool GetOpenGLColor( unsigned int aMaterialIndex, bool aUseMaterial,
+                         glm::vec4& aColor ) const;
+
+    /**
+     * Function GetTransparency
+     * @return the transparency of the material aMaterialIndex, as used by
+     * SetOpenGLMaterial()
+     */
+    float GetTransparency( unsigned int aMaterialIndex ) const;
+
 #if defined(DEBUG)
     void Show( int nestLevel, std::ostream& os ) const { ShowDummy( os ); } // override
 #endif
@@ -0,0 +1,729 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_cache.cpp
+ *
+ * Layout of a cache file (all the values are 32 bit words, in the byte order of the
+ * computer which wrote the file):
+ *  - the header: MAGIC, VERSION, BYTE_ORDER_MARK, the modification time and the size of
+ *    the model file (2 words each), the render flags and the full name of the model file;
+ *  - the material table: the count of materials, then for each of them its name, its
+ *    colors, shininess and transparency arrays, and its "color per vertex" flag;
+ *  - the count of top level meshes, then the meshes, each one followed by its children.
+ * Strings are stored as their UTF-8 length followed by the bytes, padded to a word. Arrays
+ * of arrays (e.g. the coordinate indexes of the faces) are stored as the count of arrays,
+ * the size of each of them, then their concatenated items.
+ */
+
+#include <fctsys.h>
+#include <common.h>
+
+#include <cstring>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+
+#include "3d_struct.h"
+#include "3d_mesh_cache.h"
+#include "info3d_visu.h"
+
+
+static const char       MAGIC[8] = { 'K', 'I', 'C', 'A', 'D', '3', 'D', 'M' };
+static const uint32_t   VERSION = 1;
+static const uint32_t   BYTE_ORDER_MARK = 0x01020304;
+
+/// The flags the normals or the materials computed while reading a model depend on
+enum RENDER_FLAGS
+{
+    RF_USE_MODEL_NORMALS    = 1 << 0,
+    RF_MODEL_EMISSIVE       = 1 << 1,
+    RF_MODEL_SPECULAR       = 1 << 2,
+    RF_MODEL_AMBIENT        = 1 << 3,
+    RF_MODEL_TRANSPARENCY   = 1 << 4,
+    RF_MODEL_SHININESS      = 1 << 5
+};
+
+/// Maximum depth of the mesh tree, to reject corrupted files
+static const int MAX_DEPTH = 256;
+
+
+static uint32_t renderFlags( const S3D_MASTER* aMaster )
+{
+    uint32_t flags = 0;
+
+    if( g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
+        flags |= RF_USE_MODEL_NORMALS;
+
+    if( aMaster->m_use_modelfile_emissiveColor )
+        flags |= RF_MODEL_EMISSIVE;
+
+    if( aMaster->m_use_modelfile_specularColor )
+        flags |= RF_MODEL_SPECULAR;
+
+    if( aMaster->m_use_modelfile_ambientIntensity )
+        flags |= RF_MODEL_AMBIENT;
+
+    if( aMaster->m_use_modelfile_transparency )
+        flags |= RF_MODEL_TRANSPARENCY;
+
+    if( aMaster->m_use_modelfile_shininess )
+        flags |= RF_MODEL_SHININESS;
+
+    return flags;
+}
+
+
+/**
+ * Function statModelFile
+ * reads the modification time and the size of a model file.
+ * @return bool - false if the file can not be read
+ */
+static bool statModelFile( const wxString& aModelFile, int64_t* aModified, int64_t* aSize )
+{
+    wxString filename = aModelFile;
+
+#ifdef __WINDOWS__
+    filename.Replace( wxT( "/" ), wxT( "\\" ) );
+#else
+    filename.Replace( wxT( "\\" ), wxT( "/" ) );
+#endif
+
+    wxStructStat st;
+
+    if( wxStat( filename, &st ) != 0 )
+        return false;
+
+    *aModified = st.st_mtime;
+    *aSize = st.st_size;
+    return true;
+}
+
+
+/**
+ * Class CACHE_WRITER
+ * builds the contents of a cache file in memory.
+ */
+class CACHE_WRITER
+{
+public:
+    void Word( uint32_t aValue )
+    {
+        Bytes( &aValue, sizeof( aValue ) );
+    }
+
+    void Int64( int64_t aValue )
+    {
+        Bytes( &aValue, sizeof( aValue ) );
+    }
+
+    void Float( float aValue )
+    {
+        Bytes( &aValue, sizeof( aValue ) );
+    }
+
+    void String( const wxString& aString )
+    {
+        const std::string utf8 = (const char*) aString.utf8_str();
+
+        Word( utf8.size() );
+        Bytes( utf8.data(), utf8.size() );
+        pad();
+    }
+
+    template <typename T>
+    void Array( const std::vector<T>& aArray )
+    {
+        Word( aArray.size() );
+
+        if( !aArray.empty() )
+            Bytes( &aArray[0], aArray.size() * sizeof( T ) );
+    }
+
+    template <typename T>
+    void Arrays( const std::vector< std::vector<T> >& aArrays )
+    {
+        Word( aArrays.size() );
+
+        for( unsigned i = 0; i < aArrays.size(); i++ )
+            Word( aArrays[i].size() );
+
+        for( unsigned i = 0; i < aArrays.size(); i++ )
+        {
+            if( !aArrays[i].empty() )
+                Bytes( &aArrays[i][0], aArrays[i].size() * sizeof( T ) );
+        }
+    }
+
+    void Bytes( const void* aData, size_t aSize )
+    {
+        const char* data = (const char*) aData;
+
+        m_data.insert( m_data.end(), data, data + aSize );
+    }
+
+    const std::vector<char>& Data() const
+    {
+        return m_data;
+    }
+
+private:
+    void pad()
+    {
+        m_data.resize( ( m_data.size() + 3 ) & ~3 );
+    }
+
+    std::vector<char> m_data;
+};
+
+
+/**
+ * Class CACHE_READER
+ * reads the contents of a cache file, checking that no read goes past its end. Once a
+ * read failed, the reader is not valid anymore and all the next reads fail.
+ */
+class CACHE_READER
+{
+public:
+    CACHE_READER( const std::vector<char>& aData ) :
+        m_pos( aData.empty() ? NULL : &aData[0] ),
+        m_end( m_pos + aData.size() ),
+        m_valid( true )
+    {
+    }
+
+    bool IsValid() const
+    {
+        return m_valid;
+    }
+
+    bool AtEnd() const
+    {
+        return m_pos == m_end;
+    }
+
+    bool Bytes( void* aData, size_t aSize )
+    {
+        if( !m_valid || (size_t) ( m_end - m_pos ) < aSize )
+            return m_valid = false;
+
+        memcpy( aData, m_pos, aSize );
+        m_pos += aSize;
+        return true;
+    }
+
+    uint32_t Word()
+    {
+        uint32_t value = 0;
+
+        Bytes( &value, sizeof( value ) );
+        return value;
+    }
+
+    int64_t Int64()
+    {
+        int64_t value = 0;
+
+        Bytes( &value, sizeof( value ) );
+        return value;
+    }
+
+    float Float()
+    {
+        float value = 0;
+
+        Bytes( &value, sizeof( value ) );
+        return value;
+    }
+
+    bool String( wxString& aString )
+    {
+        uint32_t len = Word();
+        uint64_t padded = ( (uint64_t) len + 3 ) & ~3;
+
+        if( !m_valid || (size_t) ( m_end - m_pos ) < padded )
+            return m_valid = false;
+
+        aString = wxString::FromUTF8( m_pos, len );
+        m_pos += padded;
+        return true;
+    }
+
+    template <typename T>
+    bool Array( std::vector<T>& aArray )
+    {
+        uint32_t count = Word();
+
+        if( !Fits( count, sizeof( T ) ) )
+            return false;
+
+        aArray.resize( count );
+
+        return count == 0 || Bytes( &aArray[0], count * sizeof( T ) );
+    }
+
+    template <typename T>
+    bool Arrays( std::vector< std::vector<T> >& aArrays )
+    {
+        uint32_t count = Word();
+
+        if( !Fits( count, sizeof( uint32_t ) ) )
+            return false;
+
+        aArrays.resize( count );
+
+        std::vector<uint32_t> sizes( count );
+        uint64_t total = 0;
+
+        if( count && !Bytes( &sizes[0], count * sizeof( uint32_t ) ) )
+            return false;
+
+        for( unsigned i = 0; i < count; i++ )
+            total += sizes[i];
+
+        if( !Fits( total, sizeof( T ) ) )
+            return false;
+
+        for( unsigned i = 0; i < count; i++ )
+        {
+            aArrays[i].resize( sizes[i] );
+
+            if( sizes[i] )
+                Bytes( &aArrays[i][0], sizes[i] * sizeof( T ) );
+        }
+
+        return m_valid;
+    }
+
+    ///> Returns true if aCount items of aSize bytes can be read
+    bool Fits( uint64_t aCount, size_t aSize )
+    {
+        if( !m_valid || aCount > (uint64_t) ( m_end - m_pos ) / aSize )
+            return m_valid = false;
+
+        return true;
+    }
+
+private:
+    const char* m_pos;
+    const char* m_end;
+    bool        m_valid;
+};
+
+
+typedef boost::unordered_map<const S3D_MATERIAL*, uint32_t> MATERIAL_INDEXES;
+
+static const uint32_t NO_MATERIAL = 0xFFFFFFFF;
+
+
+static void indexMaterials( const S3D_MESH_PTRS& aMeshes, MATERIAL_INDEXES& aIndexes,
+                            std::vector<const S3D_MATERIAL*>& aMaterials )
+{
+    for( unsigned i = 0; i < aMeshes.size(); i++ )
+    {
+        const S3D_MATERIAL* material = aMeshes[i]->m_Materials;
+
+        if( material && aIndexes.find( material ) == aIndexes.end() )
+        {
+            aIndexes[material] = aMaterials.size();
+            aMaterials.push_back( material );
+        }
+
+        indexMaterials( aMeshes[i]->childs, aIndexes, aMaterials );
+    }
+}
+
+
+static void writeMaterial( CACHE_WRITER& aWriter, const S3D_MATERIAL* aMaterial )
+{
+    aWriter.String( aMaterial->m_Name );
+    aWriter.Array( aMaterial->m_AmbientColor );
+    aWriter.Array( aMaterial->m_DiffuseColor );
+    aWriter.Array( aMaterial->m_EmissiveColor );
+    aWriter.Array( aMaterial->m_SpecularColor );
+    aWriter.Array( aMaterial->m_Shininess );
+    aWriter.Array( aMaterial->m_Transparency );
+    aWriter.Word( aMaterial->m_ColorPerVertex );
+}
+
+
+static bool readMaterial( CACHE_READER& aReader, S3D_MATERIAL* aMaterial )
+{
+    aReader.String( aMaterial->m_Name );
+    aReader.Array( aMaterial->m_AmbientColor );
+    aReader.Array( aMaterial->m_DiffuseColor );
+    aReader.Array( aMaterial->m_EmissiveColor );
+    aReader.Array( aMaterial->m_SpecularColor );
+    aReader.Array( aMaterial->m_Shininess );
+    aReader.Array( aMaterial->m_Transparency );
+    aMaterial->m_ColorPerVertex = aReader.Word() != 0;
+
+    return aReader.IsValid();
+}
+
+
+/// Writes or reads the members of a mesh (including the computed normals), in the same order
+struct S3D_MESH_SERIALIZER
+{
+    static void Write( CACHE_WRITER& aWriter, const S3D_MESH& aMesh,
+                       const MATERIAL_INDEXES& aIndexes )
+    {
+        if( aMesh.m_Materials )
+            aWriter.Word( aIndexes.find( aMesh.m_Materials )->second );
+        else
+            aWriter.Word( NO_MATERIAL );
+
+        for( int i = 0; i < 3; i++ )
+            aWriter.Float( aMesh.m_translation[i] );
+
+        for( int i = 0; i < 4; i++ )
+            aWriter.Float( aMesh.m_rotation[i] );
+
+        for( int i = 0; i < 3; i++ )
+            aWriter.Float( aMesh.m_scale[i] );
+
+        aWriter.Array( aMesh.m_Point );
+        aWriter.Arrays( aMesh.m_CoordIndex );
+        aWriter.Arrays( aMesh.m_NormalIndex );
+        aWriter.Array( aMesh.m_PerFaceColor );
+        aWriter.Array( aMesh.m_PerFaceNormalsNormalized );
+        aWriter.Array( aMesh.m_PerVertexNormalsNormalized );
+        aWriter.Array( aMesh.m_MaterialIndexPerFace );
+        aWriter.Arrays( aMesh.m_MaterialIndexPerVertex );
+
+        aWriter.Array( aMesh.m_PerFaceNormalsRaw_X_PerFaceSquaredArea );
+        aWriter.Arrays( aMesh.m_PerFaceVertexNormals );
+        aWriter.Array( aMesh.m_PointNormalized );
+        aWriter.Arrays( aMesh.m_InvalidCoordIndexes );
+
+        aWriter.Word( ( aMesh.isPerFaceNormalsComputed ? 1 : 0 ) |
+                      ( aMesh.isPointNormalizedComputed ? 2 : 0 ) |
+                      ( aMesh.isPerPointNormalsComputed ? 4 : 0 ) |
+                      ( aMesh.isPerVertexNormalsVerified ? 8 : 0 ) );
+
+        aWriter.Word( aMesh.childs.size() );
+
+        for( unsigned i = 0; i < aMesh.childs.size(); i++ )
+            Write( aWriter, *aMesh.childs[i], aIndexes );
+    }
+
+    static bool Read( CACHE_READER& aReader, S3D_MESH& aMesh,
+                      const std::vector<S3D_MATERIAL*>& aMaterials, int aDepth )
+    {
+        uint32_t material = aReader.Word();
+
+        if( material == NO_MATERIAL )
+            aMesh.m_Materials = NULL;
+        else if( material < aMaterials.size() )
+            aMesh.m_Materials = aMaterials[material];
+        else
+            return false;
+
+        for( int i = 0; i < 3; i++ )
+            aMesh.m_translation[i] = aReader.Float();
+
+        for( int i = 0; i < 4; i++ )
+            aMesh.m_rotation[i] = aReader.Float();
+
+        for( int i = 0; i < 3; i++ )
+            aMesh.m_scale[i] = aReader.Float();
+
+        aReader.Array( aMesh.m_Point );
+        aReader.Arrays( aMesh.m_CoordIndex );
+        aReader.Arrays( aMesh.m_NormalIndex );
+        aReader.Array( aMesh.m_PerFaceColor );
+        aReader.Array( aMesh.m_PerFaceNormalsNormalized );
+        aReader.Array( aMesh.m_PerVertexNormalsNormalized );
+        aReader.Array( aMesh.m_MaterialIndexPerFace );
+        aReader.Arrays( aMesh.m_MaterialIndexPerVertex );
+
+        aReader.Array( aMesh.m_PerFaceNormalsRaw_X_PerFaceSquaredArea );
+        aReader.Arrays( aMesh.m_PerFaceVertexNormals );
+        aReader.Array( aMesh.m_PointNormalized );
+        aReader.Arrays( aMesh.m_InvalidCoordIndexes );
+
+        uint32_t computed = aReader.Word();
+
+        aMesh.isPerFaceNormalsComputed   = computed & 1;
+        aMesh.isPointNormalizedComputed  = computed & 2;
+        aMesh.isPerPointNormalsComputed  = computed & 4;
+        aMesh.isPerVertexNormalsVerified = computed & 8;
+
+        if( !aReader.IsValid() || !validIndexes( aMesh ) )
+            return false;
+
+        return ReadChildren( aReader, aMesh.childs, aMaterials, aDepth + 1 );
+    }
+
+    static bool ReadChildren( CACHE_READER& aReader, S3D_MESH_PTRS& aMeshes,
+                              const std::vector<S3D_MATERIAL*>& aMaterials, int aDepth )
+    {
+        uint32_t count = aReader.Word();
+
+        // each mesh takes more than one word
+        if( aDepth > MAX_DEPTH || !aReader.Fits( count, sizeof( uint32_t ) ) )
+            return false;
+
+        for( uint32_t i = 0; i < count; i++ )
+        {
+            S3D_MESH_PTR mesh( new S3D_MESH() );
+
+            if( !Read( aReader, *mesh, aMaterials, aDepth ) )
+                return false;
+
+            aMeshes.push_back( mesh );
+        }
+
+        return true;
+    }
+
+    /**
+     * Function validIndexes
+     * checks the indexes used to render a mesh, so a corrupted cache file can not make the
+     * renderer read out of the arrays.
+     */
+    static bool validIndexes( const S3D_MESH& aMesh )
+    {
+        const size_t points = aMesh.m_Point.size();
+        const size_t normals = aMesh.m_PerVertexNormalsNormalized.size();
+
+        for( unsigned i = 0; i < aMesh.m_CoordIndex.size(); i++ )
+        {
+            for( unsigned j = 0; j < aMesh.m_CoordIndex[i].size(); j++ )
+            {
+                if( (unsigned) aMesh.m_CoordIndex[i][j] >= points )
+                    return false;
+            }
+        }
+
+        for( unsigned i = 0; i < aMesh.m_NormalIndex.size(); i++ )
+        {
+            for( unsigned j = 0; j < aMesh.m_NormalIndex[i].size(); j++ )
+            {
+                if( normals && (unsigned) aMesh.m_NormalIndex[i][j] >= normals )
+                    return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+
+S3D_MESH_CACHE::S3D_MESH_CACHE()
+{
+    wxFileName dir;
+
+#if defined( __WINDOWS__ ) || defined( __WXMAC__ )
+    // Windows: "C:\Documents and Settings\username\Local Settings\Application Data\kicad"
+    // Mac: ~/Library/Application Support/kicad
+    dir.AssignDir( wxStandardPaths::Get().GetUserLocalDataDir() );
+#else
+    wxString envstr;
+
+    if( wxGetEnv( wxT( "XDG_CACHE_HOME" ), &envstr ) && !envstr.IsEmpty() )
+    {
+        dir.AssignDir( envstr );
+    }
+    else
+    {
+        dir.AssignDir( wxGetHomeDir() );
+        dir.AppendDir( wxT( ".cache" ) );
+    }
+
+    dir.AppendDir( wxT( "kicad" ) );
+#endif
+
+    dir.AppendDir( wxT( "3d_mesh_cache" ) );
+
+    if( dir.DirExists() || dir.Mkdir( wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL ) )
+        m_directory = dir.GetPath();
+}
+
+
+bool S3D_MESH_CACHE::Load( const wxString& aModelFile, S3D_MASTER* aMaster,
+                           S3D_MESH_PTRS& aMeshes ) const
+{
+    int64_t modified, size;
+
+    if( m_directory.IsEmpty() || !statModelFile( aModelFile, &modified, &size ) )
+        return false;
+
+    std::vector<char> data;
+
+    {
+        wxLogNull   noLog;      // a missing cache file is not an error
+        wxFFile     file( cacheFileName( aModelFile ), wxT( "rb" ) );
+
+        if( !file.IsOpened() )
+            return false;
+
+        wxFileOffset length = file.Length();
+
+        if( length <= 0 )
+            return false;
+
+        data.resize( length );
+
+        if( file.Read( &data[0], length ) != (size_t) length )
+            return false;
+    }
+
+    CACHE_READER reader( data );
+    char         magic[sizeof( MAGIC )];
+
+    if( !reader.Bytes( magic, sizeof( magic ) ) || memcmp( magic, MAGIC, sizeof( MAGIC ) ) )
+        return false;
+
+    if( reader.Word() != VERSION || reader.Word() != BYTE_ORDER_MARK )
+        return false;
+
+    if( reader.Int64() != modified || reader.Int64() != size )
+        return false;
+
+    if( reader.Word() != renderFlags( aMaster ) )
+        return false;
+
+    wxString filename;
+
+    // Two model files can have the same hash
+    if( !reader.String( filename ) || filename != aModelFile )
+        return false;
+
+    // Materials are given to the master only when the whole file was read
+    uint32_t                   count = reader.Word();
+    std::vector<S3D_MATERIAL*> materials;
+    S3D_MESH_PTRS              meshes;
+    bool                       ok = reader.Fits( count, sizeof( uint32_t ) );
+
+    if( ok )
+        materials.resize( count, NULL );
+
+
+    for( unsigned i = 0; ok && i < materials.size(); i++ )
+    {
+        materials[i] = new S3D_MATERIAL( aMaster, wxEmptyString );
+        ok = readMaterial( reader, materials[i] );
+    }
+
+    ok = ok && S3D_MESH_SERIALIZER::ReadChildren( reader, meshes, materials, 0 ) && reader.AtEnd();
+
+    if( !ok )
+    {
+        for( unsigned i = 0; i < materials.size(); i++ )
+            delete materials[i];
+
+        return false;
+    }
+
+    // S3D_MASTER::Insert() prepends: keep the order of the table in the list
+    for( int i = materials.size() - 1; i >= 0; i-- )
+        aMaster->Insert( materials[i] );
+
+    aMeshes.insert( aMeshes.end(), meshes.begin(), meshes.end() );
+    return true;
+}
+
+
+bool S3D_MESH_CACHE::Save( const wxString& aModelFile, const S3D_MASTER* aMaster,
+                           const S3D_MESH_PTRS& aMeshes ) const
+{
+    int64_t modified, size;
+
+    if( m_directory.IsEmpty() || aMeshes.empty() ||
+        !statModelFile( aModelFile, &modified, &size ) )
+        return false;
+
+    MATERIAL_INDEXES                    indexes;
+    std::vector<const S3D_MATERIAL*>    materials;
+
+    indexMaterials( aMeshes, indexes, materials );
+
+    CACHE_WRITER writer;
+
+    writer.Bytes( MAGIC, sizeof( MAGIC ) );
+
+    writer.Word( VERSION );
+    writer.Word( BYTE_ORDER_MARK );
+    writer.Int64( modified );
+    writer.Int64( size );
+
+    writer.Word( renderFlags( aMaster ) );
+    writer.String( aModelFile );
+
+    writer.Word( materials.size() );
+
+    for( unsigned i = 0; i < materials.size(); i++ )
+        writeMaterial( writer, materials[i] );
+
+    writer.Word( aMeshes.size() );
+
+    for( unsigned i = 0; i < aMeshes.size(); i++ )
+        S3D_MESH_SERIALIZER::Write( writer, *aMeshes[i], indexes );
+
+    // Write a temporary file, renamed when complete: the cache file is either missing or
+    // complete, even if several instances of KiCad write it at the same time.
+    const wxString  filename = cacheFileName( aModelFile );
+    wxFFile         file;
+    wxString        tmpName = wxFileName::CreateTempFileName( filename, &file );
+
+    if( tmpName.IsEmpty() )
+        return false;
+
+    const std::vector<char>& data = writer.Data();
+    bool ok = file.Write( &data[0], data.size() ) == data.size();
+
+    ok = file.Close() && ok;
+
+    if( !ok || !wxRenameFile( tmpName, filename, true ) )
+    {
+        wxRemoveFile( tmpName );
+        return false;
+    }
+
+    return true;
+}
+
+
+wxString S3D_MESH_CACHE::cacheFileName( const wxString& aModelFile ) const
+{
+    // 64 bit FNV-1a hash of the file name
+    const std::string utf8 = (const char*) aModelFile.utf8_str();
+    uint64_t hash = 14695981039346656037ULL;
+
+    for( const char* c = utf8.c_str(); *c; c++ )
+    {
+        hash ^= (unsigned char) *c;
+        hash *= 1099511628211ULL;
+    }
+
+    wxFileName fn( m_directory, wxString::Format( wxT( "%08x%08x.mesh" ),
+                                                  (unsigned) ( hash >> 32 ),
+                                                  (unsigned) hash ) );
+
+    return fn.GetFullPath();
+}
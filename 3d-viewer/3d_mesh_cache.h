@@ -0,0 +1,89 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_cache.h
+ */
+
+#ifndef _3D_MESH_CACHE_H_
+#define _3D_MESH_CACHE_H_
+
+#include <wx/string.h>
+
+#include "3d_mesh_model.h"
+
+class S3D_MASTER;
+
+/**
+ * Class S3D_MESH_CACHE
+ * stores on disk the meshes read from the 3D model files, with their materials and
+ * their normals, so the model files do not have to be parsed again by the next sessions.
+ *
+ * There is one cache file per model file, named after a hash of its full file name. It
+ * is used only if the modification time and the size of the model file, and the
+ * render options the normals depend on, are the ones the cache file was written for.
+ * The file is a header followed by arrays of 32 bit values, in the byte order of the
+ * computer, which are read at once.
+ *
+ * Load() and Save() can be called from several threads at the same time.
+ */
+class S3D_MESH_CACHE
+{
+public:
+    /**
+     * Constructor
+     * uses the "3d_mesh_cache" directory of the user cache directory, which is created if
+     * needed. Must be called from the main thread.
+     */
+    S3D_MESH_CACHE();
+
+    /**
+     * Function Load
+     * reads the meshes of a model file from the cache.
+     * @param aModelFile = the full file name of the model file
+     * @param aMaster = the master receiving the materials of the meshes
+     * @param aMeshes = receives the meshes
+     * @return bool - true if the meshes were read
+     */
+    bool Load( const wxString& aModelFile, S3D_MASTER* aMaster, S3D_MESH_PTRS& aMeshes ) const;
+
+    /**
+     * Function Save
+     * stores the meshes of a model file in the cache. Their normals should be computed
+     * (see S3D_MESH::CalcNormals()).
+     * @param aModelFile = the full file name of the model file
+     * @param aMaster = the master the meshes were read for
+     * @param aMeshes = the meshes read from aModelFile
+     * @return bool - true if the cache file was written
+     */
+    bool Save( const wxString& aModelFile, const S3D_MASTER* aMaster,
+               const S3D_MESH_PTRS& aMeshes ) const;
+
+private:
+    ///> Returns the name of the cache file of aModelFile
+    wxString cacheFileName( const wxString& aModelFile ) const;
+
+    wxString    m_directory;    ///< the cache directory, empty if it can not be used
+};
+
+#endif  // _3D_MESH_CACHE_H_
@@ -133,517 +133,20 @@ void S3D_MESH::calcBBox( )
 }
 
 
-void S3D_MESH::openGL_RenderAllChilds(  bool aIsRenderingJustNonTransparentObjects,
-                                        bool aIsRenderingJustTransparentObjects )
+void S3D_MESH::CalcNormals()
 {
-    glEnable( GL_COLOR_MATERIAL ) ;
-    SetOpenGlDefaultMaterial();
-
-    glPushMatrix();
-    glTranslatef( m_translation.x, m_translation.y, m_translation.z );
-    glRotatef( m_rotation[3], m_rotation[0], m_rotation[1], m_rotation[2] );
-    glScalef( m_scale.x, m_scale.y, m_scale.z );
-
-    // Render your self
-    openGL_Render( aIsRenderingJustNonTransparentObjects,
-                   aIsRenderingJustTransparentObjects );
-
-    // Render childs recursively
-    for( unsigned int idx = 0; idx < childs.size(); idx++ )
-    {
-        childs[idx]->openGL_RenderAllChilds( aIsRenderingJustNonTransparentObjects,
-                                             aIsRenderingJustTransparentObjects );
-    }
-
-    SetOpenGlDefaultMaterial();
-
-    glPopMatrix();
-}
-
-
-void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
-                              bool aIsRenderingJustTransparentObjects )
-{
-    if( (aIsRenderingJustNonTransparentObjects == true) &&
-        (aIsRenderingJustTransparentObjects == true) )
-    {
-        return;
-    }
-
-    //DBG( printf( "openGL_Render" ) );
-    bool useMaterial = g_Parm_3D_Visu.GetFlag( FL_RENDER_MATERIAL );
-    bool smoothShapes = g_Parm_3D_Visu.IsRealisticMode()
-                        && g_Parm_3D_Visu.GetFlag( FL_RENDER_SMOOTH_NORMALS );
-
-    if( m_CoordIndex.size() == 0 )
-    {
-        return;
-    }
-/*
-    // DEBUG INFO
-    printf("aIsRenderingJustNonTransparentObjects %d aIsRenderingJustTransparentObjects %d\n", aIsRenderingJustNonTransparentObjects, aIsRenderingJustTransparentObjects);
-
-    printf("m_CoordIndex.size() %lu\n", m_CoordIndex.size() );
-    printf("m_MaterialIndexPerFace.size() %lu\n", m_MaterialIndexPerFace.size() );
-    printf("m_MaterialIndexPerVertex.size() %lu\n", m_MaterialIndexPerVertex.size() );
-    printf("m_PerVertexNormalsNormalized.size() %lu\n", m_PerVertexNormalsNormalized.size() );
-    printf("m_PerFaceVertexNormals.size() %lu\n", m_PerFaceVertexNormals.size() );
-    printf("m_PerFaceNormalsNormalized.size() %lu\n", m_PerFaceNormalsNormalized.size() );
-
-    printf("smoothShapes %d\n", smoothShapes );
-
-    if( m_Materials )
-    {
-        printf(" m_Name %s\n", static_cast<const char*>(m_Materials->m_Name.c_str()) );
-        printf(" m_ColorPerVertex %d\n", m_Materials->m_ColorPerVertex );
-        printf(" m_Transparency.size() %lu\n", m_Materials->m_Transparency.size() );
-        printf(" m_DiffuseColor.size() %lu\n", m_Materials->m_DiffuseColor.size() );
-        printf(" m_Shininess.size() %lu\n", m_Materials->m_Shininess.size() );
-        printf(" m_EmissiveColor.size() %lu\n", m_Materials->m_EmissiveColor.size() );
-        printf(" m_SpecularColor.size() %lu\n", m_Materials->m_SpecularColor.size() );
-        printf(" m_AmbientColor.size() %lu\n", m_Materials->m_AmbientColor.size() );
-    }
-    printf("m_Materials %p\n", ( void * )m_Materials );
-*/
-
-    float lastTransparency_value = 0.0f;
-
-    if( m_Materials )
-    {
-        bool isTransparent = m_Materials->SetOpenGLMaterial( 0, useMaterial );
-
-        if( isTransparent && aIsRenderingJustNonTransparentObjects )
-            return;
-
-        if( !isTransparent && aIsRenderingJustTransparentObjects )
-            return;
-
-        // Skip total transparent models
-        if( useMaterial )
-            if( m_Materials->m_Transparency.size() > 0 )
-            {
-                lastTransparency_value = m_Materials->m_Transparency[0];
-
-                if( lastTransparency_value >= 1.0f )
-                    return;
-            }
-    }
-
-    glPushMatrix();
-    glTranslatef( m_translation.x, m_translation.y, m_translation.z );
-    glRotatef( m_rotation[3], m_rotation[0], m_rotation[1], m_rotation[2] );
-    glScalef( m_scale.x, m_scale.y, m_scale.z );
-
     calcPointNormalized();
     calcPerFaceNormals();
 
-    if( smoothShapes )
-    {
-        if( (m_PerVertexNormalsNormalized.size() > 0) &&
-            g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
-            perVertexNormalsVerify_and_Repair();
-        else
-            calcPerPointNormals();
-
-    }
-/*
-#if defined(DEBUG)
-    // Debug Normals
-    glColor4f( 1.0, 0.0, 1.0, 0.7 );
-    for( unsigned int idx = 0; idx < m_CoordIndex.size(); idx++ )
-    {
-        if( m_PerFaceNormalsNormalized.size() > 0 )
-        {
-            S3D_VERTEX normal = m_PerFaceNormalsNormalized[idx];
-            //glNormal3fv( &normal.x );
-
-            glm::vec3 point = m_Point[m_CoordIndex[idx][0]];
-            for( unsigned int ii = 1; ii < m_CoordIndex[idx].size(); ii++ )
-            {
-                point += m_Point[m_CoordIndex[idx][ii]];
-            }
-
-            point /= m_CoordIndex[idx].size();
-
-            glBegin( GL_LINES );
-            glVertex3fv( &point.x );
-            point += normal * 0.01f;
-            glVertex3fv( &point.x );
-            glEnd();
-        }
-    }
-
-    // Restore material
-    if( m_Materials )
-        m_Materials->SetOpenGLMaterial( 0, useMaterial );
-#endif
-*/
-
-/*
-#if defined(DEBUG)
-    if( smoothShapes )
-    {
-        // Debug Per Vertex Normals
-        glColor4f( 0.0, 1.0, 1.0, 0.7 );
-        for( unsigned int idx = 0; idx < m_CoordIndex.size(); idx++ )
-        {
-            if( (m_PerVertexNormalsNormalized.size() > 0) &&
-                g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
-            {
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                {
-                    glm::vec3 normal = m_PerVertexNormalsNormalized[m_NormalIndex[idx][ii]];
-                    //glNormal3fv( &normal.x );
-
-                    glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                    glBegin( GL_LINES );
-                    glVertex3fv( &point.x );
-                    point += normal * 1.00f;
-                    glVertex3fv( &point.x );
-                    glEnd();
-                }
-            }
-            else
-            {
-                std::vector< glm::vec3 > normals_list;
-                normals_list = m_PerFaceVertexNormals[idx];
-
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                {
-                    glm::vec3 normal = normals_list[ii];
-                    printf("normal(%f, %f, %f), ", normal.x, normal.y, normal.z );
-
-                    //glNormal3fv( &normal.x );
-
-                    glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                    glBegin( GL_LINES );
-                    glVertex3fv( &point.x );
-                    point += normal * 1.00f;
-                    glVertex3fv( &point.x );
-                    glEnd();
-                }
-                printf("\n");
-            }
-        }
-
-        // Restore material
-        if( m_Materials )
-            m_Materials->SetOpenGLMaterial( 0, useMaterial );
-    }
-#endif
-*/
-
-    for( unsigned int idx = 0; idx < m_CoordIndex.size(); idx++ )
-    {
-        if( m_Materials )
-        {
-            // http://accad.osu.edu/~pgerstma/class/vnv/resources/info/AnnotatedVrmlRef/ch3-323.htm
-            // "If colorPerVertex is FALSE, colours are applied to each face, as follows:"
-            if( ( m_Materials->m_ColorPerVertex == false ) &&
-                ( m_Materials->m_DiffuseColor.size() > 1 ) )
-            {
-                bool isTransparent;
-
-                // "If the colorIndex field is not empty, then one colour is
-                //  used for each face of the IndexedFaceSet. There must be
-                //  at least as many indices in the colorIndex field as
-                //  there are faces in the IndexedFaceSet."
-                if ( m_MaterialIndexPerFace.size() == m_CoordIndex.size() )
-                {
-                    isTransparent = m_Materials->SetOpenGLMaterial( m_MaterialIndexPerFace[idx], useMaterial );
-
-                    // Skip total transparent faces
-                    if( useMaterial )
-                        if( (int)m_Materials->m_Transparency.size() > m_MaterialIndexPerFace[idx] )
-                        {
-                            if( m_Materials->m_Transparency[m_MaterialIndexPerFace[idx]] >= 1.0f )
-                                continue;
-                        }
-                }
-                else
-                {
-                    // "If the colorIndex field is empty, then the colours in the
-                    //  Color node are applied to each face of the IndexedFaceSet
-                    //  in order. There must be at least as many colours in the
-                    //  Color node as there are faces."
-                    isTransparent = m_Materials->SetOpenGLMaterial( idx, useMaterial );
-
-                    // Skip total transparent faces
-                    if( useMaterial )
-                        if( m_Materials->m_Transparency.size() > idx )
-                        {
-                            if( m_Materials->m_Transparency[idx] >= 1.0f )
-                                continue;
-                        }
-                }
-
-                if( isTransparent && aIsRenderingJustNonTransparentObjects )
-                    continue;
-
-                if( !isTransparent && aIsRenderingJustTransparentObjects )
-                    continue;
-            }
-        }
-
-        switch( m_CoordIndex[idx].size() )
-        {
-        case 3:
-            glBegin( GL_TRIANGLES );
-            break;
-        case 4:
-            glBegin( GL_QUADS );
-            break;
-        default:
-            glBegin( GL_POLYGON );
-            break;
-        }
-
-
-        if( smoothShapes )
-        {
-            if( m_Materials )
-            {
-                // for VRML2:
-                // http://accad.osu.edu/~pgerstma/class/vnv/resources/info/AnnotatedVrmlRef/ch3-323.htm
-                // "If colorPerVertex is TRUE, colours are applied to each vertex, as follows:
-                if( ( m_Materials->m_ColorPerVertex == true ) &&
-                    ( m_Materials->m_DiffuseColor.size() > 1 ) )
-                {
-                    // "If the colorIndex field is not empty, then colours
-                    // are applied to each vertex of the IndexedFaceSet in
-                    // exactly the same manner that the coordIndex field is
-                    // used to choose coordinates for each vertex from the
-                    // Coordinate node. The colorIndex field must contain at
-                    // least as many indices as the coordIndex field, and
-                    // must contain end-of-face markers (-1) in exactly the
-                    // same places as the coordIndex field. If the greatest
-                    // index in the colorIndex field is N, then there must
-                    // be N+1 colours in the Color node."
-                    if ( m_MaterialIndexPerVertex.size() != 0 )
-                    {
-                        if( (m_PerVertexNormalsNormalized.size() > 0) &&
-                            g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
-                        {
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                            {
-                                S3D_VERTEX color = m_Materials->m_DiffuseColor[m_MaterialIndexPerVertex[idx][ii]];
-                                glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
-
-                                glm::vec3 normal = m_PerVertexNormalsNormalized[m_NormalIndex[idx][ii]];
-                                glNormal3fv( &normal.x );
-
-                                glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                                glVertex3fv( &point.x );
-                            }
-                        }
-                        else
-                        {
-                            std::vector< glm::vec3 > normals_list;
-                            normals_list = m_PerFaceVertexNormals[idx];
-
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                            {
-                                S3D_VERTEX color = m_Materials->m_DiffuseColor[m_MaterialIndexPerVertex[idx][ii]];
-                                glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
-
-                                glm::vec3 normal = normals_list[ii];
-                                glNormal3fv( &normal.x );
-
-                                glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                                glVertex3fv( &point.x );
-                            }
-                        }
-                    }
-                    else
-                    {
-                        // "If the colorIndex field is empty, then the
-                        // coordIndex field is used to choose colours from
-                        // the Color node. If the greatest index in the
-                        // coordIndex field is N, then there must be N+1
-                        // colours in the Color node."
-
-
-                        if( (m_PerVertexNormalsNormalized.size() > 0) &&
-                            g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
-                        {
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                            {
-                                S3D_VERTEX color = m_Materials->m_DiffuseColor[m_CoordIndex[idx][ii]];
-                                glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
-
-                                glm::vec3 normal = m_PerVertexNormalsNormalized[m_NormalIndex[idx][ii]];
-                                glNormal3fv( &normal.x );
-
-                                glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                                glVertex3fv( &point.x );
-                            }
-                        }
-                        else
-                        {
-                            std::vector< glm::vec3 > normals_list;
-                            normals_list = m_PerFaceVertexNormals[idx];
-
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                            {
-                                S3D_VERTEX color = m_Materials->m_DiffuseColor[m_CoordIndex[idx][ii]];
-                                glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
-
-                                glm::vec3 normal = normals_list[ii];
-                                glNormal3fv( &normal.x );
-
-                                glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                                glVertex3fv( &point.x );
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    if( (m_PerVertexNormalsNormalized.size() > 0) &&
-                        g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
-                    {
-                        for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                        {
-                            glm::vec3 normal = m_PerVertexNormalsNormalized[m_NormalIndex[idx][ii]];
-                            glNormal3fv( &normal.x );
-
-                            glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                            glVertex3fv( &point.x );
-                        }
-                    }
-                    else
-                    {
-                        std::vector< glm::vec3 > normals_list;
-                        normals_list = m_PerFaceVertexNormals[idx];
-
-                        for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                        {
-                            glm::vec3 normal = normals_list[ii];
-                            glNormal3fv( &normal.x );
-
-                            glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                            glVertex3fv( &point.x );
-                        }
-                    }
-                }
-            }
-            else
-            {
-                if( (m_PerVertexNormalsNormalized.size() > 0) &&
-                    g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
-                {
-                    for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                    {
-                        glm::vec3 normal = m_PerVertexNormalsNormalized[m_NormalIndex[idx][ii]];
-                        glNormal3fv( &normal.x );
-
-                        glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                        glVertex3fv( &point.x );
-                    }
-                }
-                else
-                {
-                    std::vector< glm::vec3 > normals_list;
-                    normals_list = m_PerFaceVertexNormals[idx];
-
-                    for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                    {
-                        glm::vec3 normal = normals_list[ii];
-                        glNormal3fv( &normal.x );
-
-                        glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                        glVertex3fv( &point.x );
-                    }
-                }
-            }
-        }
-        else
-        {
-            // Flat
-            if( m_PerFaceNormalsNormalized.size() > 0 )
-            {
-                S3D_VERTEX normal = m_PerFaceNormalsNormalized[idx];
-                glNormal3fv( &normal.x );
-
-                if( m_Materials )
-                {
-                    // for VRML2:
-                    // http://accad.osu.edu/~pgerstma/class/vnv/resources/info/AnnotatedVrmlRef/ch3-323.htm
-                    // "If colorPerVertex is TRUE, colours are applied to each vertex, as follows:
-                    if( ( m_Materials->m_ColorPerVertex == true ) &&
-                        ( m_Materials->m_DiffuseColor.size() > 1 ) )
-                    {
-                        // "If the colorIndex field is not empty, then colours
-                        // are applied to each vertex of the IndexedFaceSet in
-                        // exactly the same manner that the coordIndex field is
-                        // used to choose coordinates for each vertex from the
-                        // Coordinate node. The colorIndex field must contain at
-                        // least as many indices as the coordIndex field, and
-                        // must contain end-of-face markers (-1) in exactly the
-                        // same places as the coordIndex field. If the greatest
-                        // index in the colorIndex field is N, then there must
-                        // be N+1 colours in the Color node."
-                        if ( m_MaterialIndexPerVertex.size() != 0 )
-                        {
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                            {
-                                S3D_VERTEX color = m_Materials->m_DiffuseColor[m_MaterialIndexPerVertex[idx][ii]];
-                                glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
-
-                                S3D_VERTEX point = m_Point[m_CoordIndex[idx][ii]];
-                                glVertex3fv( &point.x );
-                            }
-                        }
-                        else
-                        {
-                            // "If the colorIndex field is empty, then the
-                            // coordIndex field is used to choose colours from
-                            // the Color node. If the greatest index in the
-                            // coordIndex field is N, then there must be N+1
-                            // colours in the Color node."
-
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                            {
-                                S3D_VERTEX color = m_Materials->m_DiffuseColor[m_CoordIndex[idx][ii]];
-                                glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
-
-                                S3D_VERTEX point = m_Point[m_CoordIndex[idx][ii]];
-                                glVertex3fv( &point.x );
-                            }
-                        }
-                    }
-                    else
-                    {
-                        for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                        {
-                            S3D_VERTEX point = m_Point[m_CoordIndex[idx][ii]];
-                            glVertex3fv( &point.x );
-                        }
-                    }
-                }
-                else
-                {
-                    for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                    {
-                        S3D_VERTEX point = m_Point[m_CoordIndex[idx][ii]];
-                        glVertex3fv( &point.x );
-                    }
-                }
-            }
-            else
-            {
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                {
-                    S3D_VERTEX point = m_Point[m_CoordIndex[idx][ii]];
-                    glVertex3fv( &point.x );
-                }
-            }
-        }
-
-        glEnd();
-    }
+    // The smoothed normals, used in realistic mode, are computed too
+    if( (m_PerVertexNormalsNormalized.size() > 0) &&
+        g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
+        perVertexNormalsVerify_and_Repair();
+    else
+        calcPerPointNormals();
 
-    glPopMatrix();
+    for( unsigned int idx = 0; idx < childs.size(); idx++ )
+        childs[idx]->CalcNormals();
 }
 
 
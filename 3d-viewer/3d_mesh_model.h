@@ -54,9 +54,6 @@ public:
     S3D_MESH();
     ~S3D_MESH();
 
-    void openGL_RenderAllChilds( bool aIsRenderingJustNonTransparentObjects,
-                                 bool aIsRenderingJustTransparentObjects );
-
     S3D_MATERIAL                    *m_Materials;
 
     // Point and index list
@@ -76,7 +73,17 @@ public:
 
     CBBOX &getBBox();
 
+    /**
+     * Function CalcNormals
+     * computes the normals of this mesh and its children, as their first rendering would
+     * do with the current render options, so they can be stored in the mesh cache.
+     */
+    void CalcNormals();
+
 private:
+    friend struct S3D_MESH_SERIALIZER;    // stores the computed normals in the mesh cache
+    friend class S3D_MODEL_BUFFER;        // draws the meshes
+
     std::vector< S3D_VERTEX >                 m_PerFaceNormalsRaw_X_PerFaceSquaredArea;
     std::vector< std::vector< S3D_VERTEX > >  m_PerFaceVertexNormals;
     std::vector< S3D_VERTEX >                 m_PointNormalized;
@@ -99,9 +106,6 @@ private:
     void calcBBoxAllChilds();
 
     CBBOX   m_BBox;
-
-    void openGL_Render( bool aIsRenderingJustNonTransparentObjects,
-                        bool aIsRenderingJustTransparentObjects );
 };
 
 #endif
@@ -0,0 +1,288 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_model_buffer.cpp
+ */
+
+#include <fctsys.h>
+
+#include "3d_model_buffer.h"
+#include "modelparsers.h"
+#include "info3d_visu.h"
+
+
+S3D_MODEL_BUFFER::S3D_MODEL_BUFFER( S3D_MODEL_PARSER* aParser )
+{
+    m_useMaterial = g_Parm_3D_Visu.GetFlag( FL_RENDER_MATERIAL );
+
+    // The state of the first mesh drawn in immediate mode is not known: use the
+    // default color of the materials
+    m_color = glm::vec4( 0.8f, 0.8f, 0.8f, 1.0f );
+    m_normal = S3D_VERTEX( 0.0f, 0.0f, 1.0f );
+
+    for( unsigned int idx = 0; idx < aParser->childs.size(); idx++ )
+    {
+        aParser->childs[idx]->CalcNormals();
+        addMesh( aParser->childs[idx].get() );
+    }
+
+    m_buffer.Upload();
+}
+
+
+void S3D_MODEL_BUFFER::addMesh( const S3D_MESH* aMesh )
+{
+    unsigned node = m_nodes.size();
+
+    m_nodes.push_back( NODE() );
+    m_nodes[node].mesh = aMesh;
+    m_nodes[node].firstPart = m_parts.size();
+
+    addFaces( aMesh, m_parts.size() );
+
+    m_nodes[node].endPart = m_parts.size();
+
+    for( unsigned int idx = 0; idx < aMesh->childs.size(); idx++ )
+        addMesh( aMesh->childs[idx].get() );
+
+    m_nodes[node].endNode = m_nodes.size();
+}
+
+
+int S3D_MODEL_BUFFER::getPart( unsigned aFirstPart, int aMaterial, bool aTransparent )
+{
+    for( unsigned ii = aFirstPart; ii < m_parts.size(); ii++ )
+    {
+        if( m_parts[ii].material == aMaterial && m_parts[ii].transparent == aTransparent )
+            return ii;
+    }
+
+    PART part;
+    part.material = aMaterial;
+    part.transparent = aTransparent;
+    m_parts.push_back( part );
+
+    return m_parts.size() - 1;
+}
+
+
+void S3D_MODEL_BUFFER::addFaces( const S3D_MESH* aMesh, unsigned aFirstPart )
+{
+    if( aMesh->m_CoordIndex.size() == 0 )
+        return;
+
+    S3D_MATERIAL* materials = aMesh->m_Materials;
+
+    bool smoothShapes = g_Parm_3D_Visu.IsRealisticMode()
+                        && g_Parm_3D_Visu.GetFlag( FL_RENDER_SMOOTH_NORMALS );
+    bool useModelNormals = ( aMesh->m_PerVertexNormalsNormalized.size() > 0 )
+                           && g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS );
+
+    bool meshTransparent = false;
+    float lastTransparency_value = 0.0f;
+    bool colorPerFace = false;
+    bool colorPerVertex = false;
+
+    if( materials )
+    {
+        materials->GetOpenGLColor( 0, m_useMaterial, m_color );
+        meshTransparent = m_useMaterial && materials->GetTransparency( 0 ) != 0.0f;
+
+        // Skip total transparent models
+        if( m_useMaterial && materials->m_Transparency.size() > 0 )
+        {
+            lastTransparency_value = materials->m_Transparency[0];
+
+            if( lastTransparency_value >= 1.0f )
+                return;
+        }
+
+        // see openVRML annotated reference: "If colorPerVertex is FALSE, colours are
+        // applied to each face", and "If colorPerVertex is TRUE, colours are applied
+        // to each vertex"
+        colorPerFace = !materials->m_ColorPerVertex && materials->m_DiffuseColor.size() > 1;
+        colorPerVertex = materials->m_ColorPerVertex && materials->m_DiffuseColor.size() > 1;
+    }
+
+    // In flat mode, the vertex colors are used only with face normals
+    if( !smoothShapes && aMesh->m_PerFaceNormalsNormalized.size() == 0 )
+        colorPerVertex = false;
+
+    for( unsigned int idx = 0; idx < aMesh->m_CoordIndex.size(); idx++ )
+    {
+        int material = materials ? 0 : -1;
+
+        if( colorPerFace )
+        {
+            // "If the colorIndex field is not empty, then one colour is used for each
+            // face", else "the colours in the Color node are applied to each face of
+            // the IndexedFaceSet in order"
+            if( aMesh->m_MaterialIndexPerFace.size() == aMesh->m_CoordIndex.size() )
+                material = aMesh->m_MaterialIndexPerFace[idx];
+            else
+                material = idx;
+
+            materials->GetOpenGLColor( material, m_useMaterial, m_color );
+
+            // Skip total transparent faces
+            if( m_useMaterial && (int) materials->m_Transparency.size() > material
+                && materials->m_Transparency[material] >= 1.0f )
+                continue;
+
+            // The faces are drawn in the pass of their mesh, if they match it
+            bool faceTransparent = m_useMaterial
+                                   && materials->GetTransparency( material ) != 0.0f;
+
+            if( faceTransparent != meshTransparent )
+                continue;
+        }
+
+        const std::vector<int>& coordIndex = aMesh->m_CoordIndex[idx];
+
+        m_buffer.SetGroup( getPart( aFirstPart, material, meshTransparent ) );
+
+        switch( coordIndex.size() )
+        {
+        case 3:
+            m_buffer.Begin( GL_TRIANGLES );
+            break;
+        case 4:
+            m_buffer.Begin( GL_QUADS );
+            break;
+        default:
+            m_buffer.Begin( GL_POLYGON );
+            break;
+        }
+
+        if( !smoothShapes && aMesh->m_PerFaceNormalsNormalized.size() > 0 )
+            m_normal = aMesh->m_PerFaceNormalsNormalized[idx];
+
+        for( unsigned int ii = 0; ii < coordIndex.size(); ii++ )
+        {
+            if( colorPerVertex )
+            {
+                // "If the colorIndex field is not empty, then colours are applied to
+                // each vertex of the IndexedFaceSet in exactly the same manner that the
+                // coordIndex field is used", else "the coordIndex field is used to
+                // choose colours from the Color node"
+                int colorIndex;
+
+                if( aMesh->m_MaterialIndexPerVertex.size() != 0 )
+                    colorIndex = aMesh->m_MaterialIndexPerVertex[idx][ii];
+                else
+                    colorIndex = coordIndex[ii];
+
+                S3D_VERTEX color = materials->m_DiffuseColor[colorIndex];
+                m_color = glm::vec4( color.x, color.y, color.z, 1.0f - lastTransparency_value );
+            }
+
+            if( smoothShapes )
+            {
+                if( useModelNormals )
+                    m_normal = aMesh->m_PerVertexNormalsNormalized[aMesh->m_NormalIndex[idx][ii]];
+                else
+                    m_normal = aMesh->m_PerFaceVertexNormals[idx][ii];
+            }
+
+            const S3D_VERTEX& point = aMesh->m_Point[coordIndex[ii]];
+
+            m_buffer.Color( m_color.x, m_color.y, m_color.z, m_color.w );
+            m_buffer.Normal( m_normal.x, m_normal.y, m_normal.z );
+            m_buffer.Vertex( point.x, point.y, point.z );
+        }
+
+        m_buffer.End();
+    }
+}
+
+
+void S3D_MODEL_BUFFER::Render( bool aIsRenderingJustNonTransparentObjects,
+                               bool aIsRenderingJustTransparentObjects ) const
+{
+    if( !m_buffer.Bind() )
+        return;
+
+    for( unsigned node = 0; node < m_nodes.size(); node = m_nodes[node].endNode )
+        renderNode( node, aIsRenderingJustNonTransparentObjects,
+                    aIsRenderingJustTransparentObjects );
+
+    m_buffer.Unbind();
+}
+
+
+void S3D_MODEL_BUFFER::renderNode( unsigned aNode, bool aIsRenderingJustNonTransparentObjects,
+                                   bool aIsRenderingJustTransparentObjects ) const
+{
+    const NODE&     node = m_nodes[aNode];
+    const S3D_MESH* mesh = node.mesh;
+
+    glEnable( GL_COLOR_MATERIAL );
+    SetOpenGlDefaultMaterial();
+
+    glPushMatrix();
+    glTranslatef( mesh->m_translation.x, mesh->m_translation.y, mesh->m_translation.z );
+    glRotatef( mesh->m_rotation[3], mesh->m_rotation[0], mesh->m_rotation[1],
+               mesh->m_rotation[2] );
+    glScalef( mesh->m_scale.x, mesh->m_scale.y, mesh->m_scale.z );
+
+    // The faces of the mesh are drawn with its transform applied once more, as they
+    // always were
+    bool transformed = false;
+
+    for( unsigned part = node.firstPart; part < node.endPart; part++ )
+    {
+        if( m_parts[part].transparent ? aIsRenderingJustNonTransparentObjects
+                                      : aIsRenderingJustTransparentObjects )
+            continue;
+
+        if( !transformed )
+        {
+            glPushMatrix();
+            glTranslatef( mesh->m_translation.x, mesh->m_translation.y,
+                          mesh->m_translation.z );
+            glRotatef( mesh->m_rotation[3], mesh->m_rotation[0], mesh->m_rotation[1],
+                       mesh->m_rotation[2] );
+            glScalef( mesh->m_scale.x, mesh->m_scale.y, mesh->m_scale.z );
+            transformed = true;
+        }
+
+        // Set the other parameters of the material, the color is in the buffer
+        if( m_parts[part].material >= 0 )
+            mesh->m_Materials->SetOpenGLMaterial( m_parts[part].material, m_useMaterial );
+
+        m_buffer.DrawGroup( part );
+    }
+
+    if( transformed )
+        glPopMatrix();
+
+    // Render childs recursively
+    for( unsigned child = aNode + 1; child < node.endNode; child = m_nodes[child].endNode )
+        renderNode( child, aIsRenderingJustNonTransparentObjects,
+                    aIsRenderingJustTransparentObjects );
+
+    SetOpenGlDefaultMaterial();
+
+    glPopMatrix();
+}
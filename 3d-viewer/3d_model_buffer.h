@@ -0,0 +1,103 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_model_buffer.h
+ */
+
+#ifndef _3D_MODEL_BUFFER_H_
+#define _3D_MODEL_BUFFER_H_
+
+#include <vector>
+
+#include "3d_gl_buffer.h"
+#include "3d_mesh_model.h"
+
+class S3D_MODEL_PARSER;
+
+/**
+ * Class S3D_MODEL_BUFFER
+ * stores the meshes of a 3D model in a vertex buffer, to draw them without sending
+ * their vertices to the graphic card again. A model used by several footprints is
+ * stored once, and drawn for each footprint with its own transformation.
+ *
+ * The faces are drawn as S3D_MESH drew them in immediate mode, with the render options
+ * which were set when the buffer was built: it must be built again when they change.
+ */
+class S3D_MODEL_BUFFER
+{
+public:
+    /**
+     * Constructor
+     * stores the meshes of aParser in the buffer. The OpenGL context must be current.
+     */
+    S3D_MODEL_BUFFER( S3D_MODEL_PARSER* aParser );
+
+    /**
+     * Function Render
+     * draws the meshes in the current model space.
+     * @param aIsRenderingJustNonTransparentObjects = true to draw only the opaque faces
+     * @param aIsRenderingJustTransparentObjects = true to draw only the transparent faces
+     */
+    void Render( bool aIsRenderingJustNonTransparentObjects,
+                 bool aIsRenderingJustTransparentObjects ) const;
+
+private:
+    /// Faces of a mesh drawn with the same material, stored in the buffer group of the
+    /// same index
+    struct PART
+    {
+        int     material;       ///< index of the material of the mesh, or -1 if it has none
+        bool    transparent;
+    };
+
+    /// A mesh, followed in m_nodes by the nodes of its children
+    struct NODE
+    {
+        const S3D_MESH* mesh;
+        unsigned        firstPart;
+        unsigned        endPart;
+        unsigned        endNode;    ///< index of the first node after the children
+    };
+
+    void addMesh( const S3D_MESH* aMesh );
+    void addFaces( const S3D_MESH* aMesh, unsigned aFirstPart );
+
+    ///> Returns the index of the part of the current mesh for a material, creating it
+    ///> if needed
+    int getPart( unsigned aFirstPart, int aMaterial, bool aTransparent );
+
+    void renderNode( unsigned aNode, bool aIsRenderingJustNonTransparentObjects,
+                     bool aIsRenderingJustTransparentObjects ) const;
+
+    S3D_GL_BUFFER       m_buffer;
+    std::vector<NODE>   m_nodes;
+    std::vector<PART>   m_parts;
+    bool                m_useMaterial;  ///< FL_RENDER_MATERIAL when the buffer was built
+
+    // OpenGL color and normal, when the immediate mode drew the current face
+    glm::vec4           m_color;
+    S3D_VERTEX          m_normal;
+};
+
+#endif  // _3D_MODEL_BUFFER_H_
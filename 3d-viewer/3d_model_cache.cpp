@@ -0,0 +1,338 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_model_cache.cpp
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <task_queue.h>
+
+#include <algorithm>
+
+#include "3d_struct.h"
+#include "3d_mesh_model.h"
+#include "modelparsers.h"
+#include "3d_model_cache.h"
+
+
+/// Minimal delay, in seconds, between two checks of the modification time of a file
+static const time_t RECHECK_PERIOD = 2;
+
+
+/**
+ * Function statFile
+ * reads the modification time and the size of aFilename, or sets them to 0 if the file
+ * can not be read. Unlike wxFileModificationTime(), it does not log errors.
+ */
+static void statFile( const wxString& aFilename, time_t* aModified, wxFileOffset* aSize )
+{
+    wxString filename = aFilename;
+
+#ifdef __WINDOWS__
+    filename.Replace( wxT( "/" ), wxT( "\\" ) );
+#else
+    filename.Replace( wxT( "\\" ), wxT( "/" ) );
+#endif
+
+    wxStructStat st;
+
+    if( wxStat( filename, &st ) == 0 )
+    {
+        *aModified = st.st_mtime;
+        *aSize = st.st_size;
+    }
+    else
+    {
+        *aModified = 0;
+        *aSize = 0;
+    }
+}
+
+
+/**
+ * Reads one model of a batch. The tasks only touch their own entry, except for the
+ * state and the model, which are set under the cache lock.
+ */
+struct S3D_MODEL_CACHE::LOAD_TASK
+{
+    LOAD_TASK( S3D_MODEL_CACHE* aCache, const std::vector<ENTRY*>& aEntries ) :
+        m_cache( aCache ), m_entries( aEntries )
+    {}
+
+    void operator()( int aIndex )
+    {
+        ENTRY*      entry = m_entries[aIndex];
+        S3D_MASTER* master = entry->master;
+
+        S3D_MODEL_PARSER* parser = new S3D_MODEL_PARSER( master );
+
+        if( m_cache->m_meshFiles.Load( entry->filename, master, parser->childs ) )
+        {
+            master->SetParser( parser );
+        }
+        else
+        {
+            delete parser;
+            parser = S3D_MODEL_PARSER::Create( master, master->GetShape3DExtension() );
+
+            if( parser && master->ReadData( parser ) != 0 )
+            {
+                delete parser;
+                parser = NULL;
+            }
+
+            if( parser )
+            {
+                // Computed here rather than by the first rendering, so they are cached too
+                for( unsigned i = 0; i < parser->childs.size(); i++ )
+                    parser->childs[i]->CalcNormals();
+
+                m_cache->m_meshFiles.Save( entry->filename, master, parser->childs );
+            }
+        }
+
+        MUTLOCK lock( m_cache->m_lock );
+
+        entry->parser = parser;
+        entry->state = parser ? LOADED : FAILED;
+        m_cache->m_loadedCount++;
+    }
+
+    S3D_MODEL_CACHE*            m_cache;
+    const std::vector<ENTRY*>&  m_entries;
+};
+
+
+S3D_MODEL_CACHE& S3D_MODEL_CACHE::Instance()
+{
+    static S3D_MODEL_CACHE cache;
+
+    return cache;
+}
+
+
+S3D_MODEL_CACHE::S3D_MODEL_CACHE() :
+    m_loader( NULL ),
+    m_loading( false ),
+    m_loadedCount( 0 )
+{
+}
+
+
+S3D_MODEL_CACHE::~S3D_MODEL_CACHE()
+{
+    Clear();
+}
+
+
+S3D_MODEL_PARSER* S3D_MODEL_CACHE::GetParser( S3D_MASTER* aShape )
+{
+    const wxString filename = aShape->GetShape3DFullFilename();
+
+    if( filename.IsEmpty() )
+        return NULL;
+
+    MUTLOCK lock( m_lock );
+
+    ENTRY_MAP::iterator it = m_entries.find( filename );
+
+    if( it == m_entries.end() )
+    {
+        ENTRY* entry = new ENTRY;
+
+        entry->filename = filename;
+        entry->master = NULL;
+        entry->parser = NULL;
+        m_entries[filename] = entry;
+
+        queue( entry, aShape );
+        return NULL;
+    }
+
+    ENTRY* entry = it->second;
+
+    if( entry->state != LOADED && entry->state != FAILED )
+        return NULL;
+
+    time_t now = time( NULL );
+
+    if( now - entry->checked >= RECHECK_PERIOD )
+    {
+        time_t          modified;
+        wxFileOffset    size;
+
+        statFile( filename, &modified, &size );
+        entry->checked = now;
+
+        if( modified != entry->modified || size != entry->size )
+        {
+            retire( entry );
+            queue( entry, aShape );
+            return NULL;
+        }
+    }
+
+    return entry->parser;
+}
+
+
+void S3D_MODEL_CACHE::StartLoading()
+{
+    {
+        MUTLOCK lock( m_lock );
+
+        if( m_loading || m_queued.empty() )
+            return;
+
+        m_loading = true;
+    }
+
+    // The previous loader, if any, has nothing left to do
+    joinLoader();
+
+    m_loader = new boost::thread( &S3D_MODEL_CACHE::loadQueued, this );
+}
+
+
+bool S3D_MODEL_CACHE::IsLoading()
+{
+    MUTLOCK lock( m_lock );
+
+    return m_loading;
+}
+
+
+int S3D_MODEL_CACHE::LoadedCount()
+{
+    MUTLOCK lock( m_lock );
+
+    return m_loadedCount;
+}
+
+
+void S3D_MODEL_CACHE::Clear()
+{
+    {
+        MUTLOCK lock( m_lock );
+
+        // Do not start reading the models not yet taken by the loader
+        m_queued.clear();
+    }
+
+    joinLoader();
+
+    for( ENTRY_MAP::iterator it = m_entries.begin(); it != m_entries.end(); ++it )
+    {
+        delete it->second->parser;
+        delete it->second->master;
+        delete it->second;
+    }
+
+    for( unsigned i = 0; i < m_retired.size(); i++ )
+    {
+        delete m_retired[i].parser;
+        delete m_retired[i].master;
+    }
+
+    m_entries.clear();
+    m_retired.clear();
+}
+
+
+void S3D_MODEL_CACHE::queue( ENTRY* aEntry, S3D_MASTER* aShape )
+{
+    statFile( aEntry->filename, &aEntry->modified, &aEntry->size );
+    aEntry->checked = time( NULL );
+
+    // The parsers store the materials in the master they read the file for, so each model
+    // needs its own master, which lives as long as the model.
+    // SetShape3DName() expands the environment variables: it is called here, from the
+    // main thread, not by the loader.
+    aEntry->master = new S3D_MASTER( NULL );
+    aEntry->master->SetShape3DName( aShape->GetShape3DName() );
+
+    aEntry->parser = NULL;
+    aEntry->state = QUEUED;
+    m_queued.push_back( aEntry );
+}
+
+
+void S3D_MODEL_CACHE::retire( ENTRY* aEntry )
+{
+    m_retired.push_back( *aEntry );
+
+    aEntry->master = NULL;
+    aEntry->parser = NULL;
+}
+
+
+void S3D_MODEL_CACHE::loadQueued()
+{
+    // The parsers read numbers without using the locale, so they do not switch the
+    // (global) locale: it must not be changed by a background thread.
+    for( ;; )
+    {
+        std::vector<ENTRY*> batch;
+
+        {
+            MUTLOCK lock( m_lock );
+
+            if( m_queued.empty() )
+            {
+                m_loading = false;
+                return;
+            }
+
+            batch.swap( m_queued );
+
+            for( unsigned i = 0; i < batch.size(); i++ )
+                batch[i]->state = LOADING;
+        }
+
+        // The entries being loaded are not modified by the main thread: the sizes
+        // can be read without lock.
+        std::sort( batch.begin(), batch.end(), biggerFile );
+
+        LOAD_TASK task( this, batch );
+        TASK_QUEUE<LOAD_TASK>( task, batch.size() ).Run( DefaultThreadCount() );
+    }
+}
+
+
+void S3D_MODEL_CACHE::joinLoader()
+{
+    if( m_loader )
+    {
+        m_loader->join();
+        delete m_loader;
+        m_loader = NULL;
+    }
+}
+
+
+bool S3D_MODEL_CACHE::biggerFile( const ENTRY* aFirst, const ENTRY* aSecond )
+{
+    return aFirst->size > aSecond->size;
+}
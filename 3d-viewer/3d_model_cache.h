@@ -0,0 +1,162 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_model_cache.h
+ */
+
+#ifndef _3D_MODEL_CACHE_H_
+#define _3D_MODEL_CACHE_H_
+
+#include <ctime>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+#include <boost/thread.hpp>
+
+#include <wx/string.h>
+#include <wx/filefn.h>
+
+#include <hashtables.h>
+#include <ki_mutex.h>
+
+#include "3d_mesh_cache.h"
+
+class S3D_MASTER;
+class S3D_MODEL_PARSER;
+
+/**
+ * Class S3D_MODEL_CACHE
+ * keeps the 3D model files already read, indexed by their full file name, for all the
+ * 3D viewers (the models are not read again when the viewer is closed and opened again).
+ *
+ * The models not yet in the cache are read in the background, by several threads: the
+ * viewer draws the footprints whose models are loaded, and polls LoadedCount() to redraw
+ * the board when more models are available.
+ *
+ * The models are also stored in an on-disk cache (see S3D_MESH_CACHE), so the next sessions
+ * do not have to parse the files again.
+ *
+ * A model is read again if its file was modified since it was read. The parsers stay
+ * owned by the cache: the S3D_MASTER using them must not delete them.
+ */
+class S3D_MODEL_CACHE
+{
+public:
+    ///> Returns the cache shared by the 3D viewers
+    static S3D_MODEL_CACHE& Instance();
+
+    ~S3D_MODEL_CACHE();
+
+    /**
+     * Function GetParser
+     * returns the parser holding the model of aShape, if it is loaded. Otherwise, queues
+     * the file of aShape to be loaded by the next StartLoading() and returns NULL.
+     * Called from the main thread only.
+     */
+    S3D_MODEL_PARSER* GetParser( S3D_MASTER* aShape );
+
+    /**
+     * Function StartLoading
+     * starts loading the queued models in the background, unless it is already done.
+     */
+    void StartLoading();
+
+    ///> Returns true while models are being loaded
+    bool IsLoading();
+
+    ///> Returns the number of models read since the cache was created, including the ones
+    ///> which could not be read. It changes when new models are available.
+    int LoadedCount();
+
+    /**
+     * Function Clear
+     * waits for the models being loaded and frees all the models. The S3D_MASTER using
+     * them must be given other parsers (or NULL) before being rendered again.
+     */
+    void Clear();
+
+private:
+    enum STATE
+    {
+        QUEUED,     ///< waiting for StartLoading()
+        LOADING,    ///< being read by the loader
+        LOADED,     ///< available
+        FAILED      ///< the file could not be read
+    };
+
+    struct ENTRY
+    {
+        wxString            filename;
+        time_t              modified;   ///< modification time of the file when it was queued
+        wxFileOffset        size;       ///< size of the file when it was queued
+        time_t              checked;    ///< last time the modification time was checked
+        STATE               state;
+        S3D_MASTER*         master;     ///< the shape the model is read for, owned by the cache
+        S3D_MODEL_PARSER*   parser;     ///< the model, when loaded
+    };
+
+    struct LOAD_TASK;
+    friend struct LOAD_TASK;
+
+    typedef boost::unordered_map<wxString, ENTRY*, WXSTRING_HASH> ENTRY_MAP;
+
+    S3D_MODEL_CACHE();
+
+    ///> Queues aShape's file to be read in aEntry. m_lock must be held.
+    void queue( ENTRY* aEntry, S3D_MASTER* aShape );
+
+    ///> Moves the model of aEntry to m_retired: footprints may still use it. m_lock must
+    ///> be held.
+    void retire( ENTRY* aEntry );
+
+    ///> Body of the loader thread: reads the queued models until there is none left
+    void loadQueued();
+
+    ///> Waits for the loader thread, if any
+    void joinLoader();
+
+    ///> Sort predicate putting the biggest files, which are the longest to read, first
+    static bool biggerFile( const ENTRY* aFirst, const ENTRY* aSecond );
+
+    ENTRY_MAP                       m_entries;
+    std::vector<ENTRY*>             m_queued;
+
+    ///> models of files modified after they were read, freed by Clear()
+    std::vector<ENTRY>              m_retired;
+
+    boost::thread*                  m_loader;
+
+    ///> true while the loader thread reads models
+    bool                            m_loading;
+
+    int                             m_loadedCount;
+
+    ///> the meshes of the models read by the previous sessions
+    S3D_MESH_CACHE                  m_meshFiles;
+
+    ///> protects the states and models of the entries, m_queued, m_loading and m_loadedCount
+    MUTEX                           m_lock;
+};
+
+#endif  // _3D_MODEL_CACHE_H_
@@ -39,6 +39,7 @@
 #include <info3d_visu.h>
 #include "3d_struct.h"
 #include "modelparsers.h"
+#include "3d_model_buffer.h"
 
 
 S3D_MODEL_PARSER *S3D_MODEL_PARSER::Create( S3D_MASTER* aMaster,
@@ -72,12 +73,7 @@ int S3D_MASTER::ReadData( S3D_MODEL_PARSER* aParser )
 
         if( aParser->Load( filename ) )
         {
-            // Invalidate bounding boxes
-            m_fastAABBox.Reset();
-            m_BBox.Reset();
-
-            m_parser = aParser;
-
+            SetParser( aParser );
             return 0;
         }
     }
@@ -90,12 +86,23 @@ int S3D_MASTER::ReadData( S3D_MODEL_PARSER* aParser )
 }
 
 
-void S3D_MASTER::Render( bool aIsRenderingJustNonTransparentObjects,
-                         bool aIsRenderingJustTransparentObjects )
+void S3D_MASTER::SetParser( S3D_MODEL_PARSER* aParser )
 {
-    if( m_parser == NULL )
+    if( m_parser == aParser )
         return;
 
+    // Invalidate bounding boxes
+    m_fastAABBox.Reset();
+    m_BBox.Reset();
+
+    m_parser = aParser;
+}
+
+
+void S3D_MASTER::Render( const S3D_MODEL_BUFFER& aModel,
+                         bool aIsRenderingJustNonTransparentObjects,
+                         bool aIsRenderingJustTransparentObjects )
+{
     double aVrmlunits_to_3Dunits = g_Parm_3D_Visu.m_BiuTo3Dunits * UNITS3D_TO_UNITSPCB;
 
     glScalef( aVrmlunits_to_3Dunits, aVrmlunits_to_3Dunits, aVrmlunits_to_3Dunits );
@@ -110,9 +117,7 @@ void S3D_MASTER::Render( bool aIsRenderingJustNonTransparentObjects,
 
     glScalef( m_MatScale.x, m_MatScale.y, m_MatScale.z );
 
-    for( unsigned int idx = 0; idx < m_parser->childs.size(); idx++ )
-        m_parser->childs[idx]->openGL_RenderAllChilds( aIsRenderingJustNonTransparentObjects,
-                                                       aIsRenderingJustTransparentObjects );
+    aModel.Render( aIsRenderingJustNonTransparentObjects, aIsRenderingJustTransparentObjects );
 }
 
 
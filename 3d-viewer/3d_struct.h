@@ -41,6 +41,7 @@
 class S3D_MASTER;
 class STRUCT_3D_SHAPE;
 class S3D_MODEL_PARSER;
+class S3D_MODEL_BUFFER;
 
 // Master structure for a 3D footprint shape description
 class S3D_MASTER : public EDA_ITEM
@@ -95,7 +96,23 @@ public:
      */
     int  ReadData( S3D_MODEL_PARSER* aParser );
 
-    void Render( bool aIsRenderingJustNonTransparentObjects,
+    /**
+     * Function SetParser
+     * Uses the data already read by aParser (e.g. for another footprint using the same
+     * file) to render this shape.
+     * @param aParser = the parser holding the data, or NULL to draw nothing
+     */
+    void SetParser( S3D_MODEL_PARSER* aParser );
+
+    /**
+     * Function Render
+     * draws the shape, with the scale, rotation and offset of this footprint.
+     * @param aModel = the vertex buffer of the meshes read by the parser of this shape
+     * @param aIsRenderingJustNonTransparentObjects = true to draw only the opaque faces
+     * @param aIsRenderingJustTransparentObjects = true to draw only the transparent faces
+     */
+    void Render( const S3D_MODEL_BUFFER& aModel,
+                 bool aIsRenderingJustNonTransparentObjects,
                  bool aIsRenderingJustTransparentObjects );
 
     /**
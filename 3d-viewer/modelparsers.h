@@ -37,6 +37,7 @@
 
 class S3D_MASTER;
 class X3D_MODEL_PARSER;
+class VRML_READER;
 
 /**
  * abstract class S3D_MODEL_PARSER
@@ -206,7 +207,7 @@ private:
     bool                      m_normalPerVertex;
     bool                      colorPerVertex;
     S3D_MESH_PTR              m_model;                  ///< It stores the current model that the parsing is adding data
-    FILE*                     m_file;
+    VRML_READER*              m_file;
     wxFileName                m_Filename;
     VRML2_COORDINATE_MAP      m_defCoordinateMap;
     VRML2_DEF_GROUP_MAP       m_defGroupMap;            ///< Stores a list of labels for groups and meshs that will be used later by the USE keyword
@@ -261,7 +262,7 @@ private:
     bool                     m_normalPerVertex;
     bool                     colorPerVertex;
     S3D_MESH_PTR             m_model;
-    FILE*                    m_file;
+    VRML_READER*             m_file;
     wxString                 m_Filename;
     S3D_MODEL_PARSER*        m_ModelParser;
     S3D_MASTER*              m_Master;
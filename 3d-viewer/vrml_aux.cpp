@@ -29,8 +29,327 @@
 
 #include "vrml_aux.h"
 
+#include <cfloat>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <clocale>
+#include <string>
+#include <stdint.h>
 
-bool GetString( FILE* File, char* aDstString, size_t maxDstLen )
+
+/// Powers of ten exactly represented by a double
+static const double s_pow10[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+static inline bool isDigit( int c )
+{
+    return c >= '0' && c <= '9';
+}
+
+
+/// isspace() in the C locale
+static inline bool isSpace( int c )
+{
+    return c == ' ' || ( c >= '\t' && c <= '\r' );
+}
+
+
+/// The chars which can be part of a number read by strtof(): digits, signs, decimal point,
+/// exponent, and the letters of hexadecimal values, "inf" and "nan"
+static inline bool isNumberChar( int c )
+{
+    return isDigit( c ) || c == '+' || c == '-' || c == '.'
+        || ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' );
+}
+
+
+/**
+ * Function strtofC
+ * converts the number at the start of aText like strtof() does in the C locale, whatever
+ * the current locale is.  The number is copied, with its '.' replaced by the decimal point
+ * of the current locale, and converted by strtof(): the locale cannot be switched to "C"
+ * here, because the models are read by a background thread.
+ * @param aText = the text to convert
+ * @param aValue = destination float
+ * @return int - the count of chars of aText converted, 0 if there is no number
+ */
+static int strtofC( const char* aText, float* aValue )
+{
+    char        decimalPoint = localeconv()->decimal_point[0];
+    std::string number;
+
+    for( const char* p = aText; isNumberChar( (unsigned char) *p ); p++ )
+        number += ( *p == '.' ) ? decimalPoint : *p;
+
+    const char* start = number.c_str();
+    char*       end;
+    float       value = strtof( start, &end );
+
+    if( end == start )
+        return 0;
+
+    *aValue = value;
+    return end - start;
+}
+
+
+/**
+ * Function isFloatMidpoint
+ * @return bool - true if aValue is exactly between two floats, i.e. rounding it to a float
+ * may not give the float nearest to the decimal value it was converted from.
+ */
+static inline bool isFloatMidpoint( double aValue )
+{
+    uint64_t bits;
+
+    memcpy( &bits, &aValue, sizeof( bits ) );
+
+    // a double has 29 more mantissa bits than a float
+    return ( bits & 0x1FFFFFFF ) == 0x10000000;
+}
+
+
+VRML_READER::VRML_READER() :
+    m_buffer( NULL ),
+    m_pos( NULL ),
+    m_end( NULL )
+{
+}
+
+
+VRML_READER::~VRML_READER()
+{
+    Close();
+}
+
+
+bool VRML_READER::Open( const wxString& aFilename )
+{
+    Close();
+
+    FILE* file = wxFopen( aFilename, wxT( "rb" ) );
+
+    if( file == NULL )
+        return false;
+
+    long size = -1;
+
+    if( fseek( file, 0, SEEK_END ) == 0 )
+        size = ftell( file );
+
+    if( size < 0 || fseek( file, 0, SEEK_SET ) != 0 )
+    {
+        fclose( file );
+        return false;
+    }
+
+    m_buffer = new char[size + 1];
+
+    size_t length = fread( m_buffer, 1, size, file );
+
+    fclose( file );
+
+    // The terminating '\0' stops the number parsing (and strtof()) at the end of the file
+    m_buffer[length] = 0;
+    m_pos = m_buffer;
+    m_end = m_buffer + length;
+
+    return true;
+}
+
+
+void VRML_READER::Close()
+{
+    delete[] m_buffer;
+
+    m_buffer = NULL;
+    m_pos = NULL;
+    m_end = NULL;
+}
+
+
+void VRML_READER::SkipSpaces()
+{
+    while( isSpace( *m_pos ) )
+        m_pos++;
+}
+
+
+bool VRML_READER::SkipChar( char aChar )
+{
+    if( *m_pos == aChar )
+    {
+        m_pos++;
+        return true;
+    }
+
+    return false;
+}
+
+
+bool VRML_READER::ReadFloat( float* aValue )
+{
+    SkipSpaces();
+
+    const char* p = m_pos;
+    bool negative = false;
+
+    if( ( *p == '-' || *p == '+' ) )
+        negative = *p++ == '-';
+
+    // Decimal mantissa and exponent of the value: up to 19 significant digits fit in 64 bits
+    uint64_t    mantissa = 0;
+    int         digits = 0;
+    int         exponent = 0;
+    bool        found = false;      // true if there is a digit
+    bool        exact = true;       // false if digits were dropped
+
+    for( ; isDigit( *p ); p++ )
+    {
+        found = true;
+
+        if( digits < 19 )
+        {
+            mantissa = mantissa * 10 + ( *p - '0' );
+
+            if( mantissa )
+                digits++;
+        }
+        else
+        {
+            exponent++;
+
+            if( *p != '0' )
+                exact = false;
+        }
+    }
+
+    if( *p == '.' )
+    {
+        for( p++; isDigit( *p ); p++ )
+        {
+            found = true;
+
+            if( digits < 19 )
+            {
+                mantissa = mantissa * 10 + ( *p - '0' );
+                exponent--;
+
+                if( mantissa )
+                    digits++;
+            }
+            else if( *p != '0' )
+            {
+                exact = false;
+            }
+        }
+    }
+
+    if( !found )
+    {
+        // "inf" and "nan" are left to strtofC()
+        if( !*p || !strchr( "iInN", *p ) )
+            return false;
+
+        exact = false;
+    }
+    else if( mantissa == 0 && ( *p == 'x' || *p == 'X' ) )
+    {
+        // hexadecimal value
+        exact = false;
+    }
+    else if( ( *p == 'e' || *p == 'E' ) )
+    {
+        const char* q = p + 1;
+        bool negativeExp = false;
+
+        if( ( *q == '-' || *q == '+' ) )
+            negativeExp = *q++ == '-';
+
+        if( isDigit( *q ) )
+        {
+            int exp = 0;
+
+            for( ; isDigit( *q ); q++ )
+            {
+                if( exp < 100000 )
+                    exp = exp * 10 + ( *q - '0' );
+            }
+
+            exponent += negativeExp ? -exp : exp;
+            p = q;
+        }
+    }
+
+#if FLT_EVAL_METHOD == 0
+    // When the mantissa and the power of ten are exact doubles, their product or quotient
+    // is the double nearest to the value, and rounding it to a float gives the float
+    // nearest to the value, unless it is exactly between two floats.
+    // (This needs the double operations not to be computed with more precision,
+    // as x87 instructions do.)
+    if( exact && mantissa <= ( (uint64_t) 1 << 53 ) && exponent >= -22 && exponent <= 22 )
+    {
+        double value = (double) mantissa;
+
+        if( exponent < 0 )
+            value /= s_pow10[-exponent];
+        else
+            value *= s_pow10[exponent];
+
+        if( value == 0.0
+            || ( value >= FLT_MIN && value <= FLT_MAX && !isFloatMidpoint( value ) ) )
+        {
+            *aValue = negative ? -(float) value : (float) value;
+            m_pos = p;
+            return true;
+        }
+    }
+#endif
+
+    // Other values are converted by the C library
+    int count = strtofC( m_pos, aValue );
+
+    if( count == 0 )
+        return false;
+
+    m_pos += count;
+    return true;
+}
+
+
+bool VRML_READER::ReadInt( int* aValue )
+{
+    SkipSpaces();
+
+    const char* p = m_pos;
+    bool negative = false;
+
+    if( ( *p == '-' || *p == '+' ) )
+        negative = *p++ == '-';
+
+    if( !isDigit( *p ) )
+        return false;
+
+    long long value = 0;
+
+    for( ; isDigit( *p ); p++ )
+    {
+        if( value <= INT_MAX )
+            value = value * 10 + ( *p - '0' );
+    }
+
+    *aValue = (int) ( negative ? -value : value );
+    m_pos = p;
+    return true;
+}
+
+
+bool GetString( VRML_READER* File, char* aDstString, size_t maxDstLen )
 {
 
     if( (!aDstString) || (maxDstLen == 0) )
@@ -38,7 +357,7 @@ bool GetString( FILE* File, char* aDstString, size_t maxDstLen )
 
     int c;
 
-    while( ( c = fgetc( File ) ) != EOF )
+    while( ( c = File->GetChar() ) != EOF )
     {
         if( c == '\"' )
         {
@@ -51,7 +370,7 @@ bool GetString( FILE* File, char* aDstString, size_t maxDstLen )
         return false;
     }
 
-    while( (( c = fgetc( File ) ) != EOF) && (maxDstLen > 0) )
+    while( (( c = File->GetChar() ) != EOF) && (maxDstLen > 0) )
     {
         if( c == '\"' )
         {
@@ -76,15 +395,15 @@ bool GetString( FILE* File, char* aDstString, size_t maxDstLen )
 }
 
 
-static int SkipGetChar ( FILE* File );
+static int SkipGetChar ( VRML_READER* File );
 
 
-static int SkipGetChar( FILE* File )
+static int SkipGetChar( VRML_READER* File )
 {
     int    c;
     bool    re_parse;
 
-    if( ( c = fgetc( File ) ) == EOF )
+    if( ( c = File->GetChar() ) == EOF )
     {
         // DBG( printf( "EOF\n" ) );
         return EOF;
@@ -101,7 +420,7 @@ static int SkipGetChar( FILE* File )
             // DBG( printf( "Skipping space \\t or { or [\n" ) );
             do
             {
-                if( ( c = fgetc( File ) ) == EOF )
+                if( ( c = File->GetChar() ) == EOF )
                 {
                     // DBG( printf( "EOF\n" ) );
 
@@ -117,7 +436,7 @@ static int SkipGetChar( FILE* File )
                 // DBG( printf( "Skipping # \\n or \\r or 0, 0x%02X\n", c ) );
                 do
                 {
-                    if( ( c = fgetc( File ) ) == EOF )
+                    if( ( c = File->GetChar() ) == EOF )
                     {
                         // DBG( printf( "EOF\n" ) );
                         return EOF;
@@ -126,7 +445,7 @@ static int SkipGetChar( FILE* File )
             }
             else
             {
-                if( ( c = fgetc( File ) ) == EOF )
+                if( ( c = File->GetChar() ) == EOF )
                 {
                     // DBG( printf( "EOF\n" ) );
                     return EOF;
@@ -141,7 +460,7 @@ static int SkipGetChar( FILE* File )
 }
 
 
-bool GetNextTag( FILE* File, char* tag, size_t len )
+bool GetNextTag( VRML_READER* File, char* tag, size_t len )
 {
     int c = SkipGetChar( File );
 
@@ -159,19 +478,20 @@ bool GetNextTag( FILE* File, char* tag, size_t len )
         len--;
         char* dst = &tag[1];
 
-        while( fscanf( File, "%c", dst ) && len > 0 )
+        while( len > 1 && ( c = File->GetChar() ) != EOF )
         {
-            if( (*dst == ' ') || (*dst == '[') || (*dst == '{')
-                || (*dst == '\t') || (*dst == '\n')|| (*dst == '\r') )
+            if( (c == ' ') || (c == '[') || (c == '{')
+                || (c == '\t') || (c == '\n')|| (c == '\r') )
             {
-                *dst = 0;
                 break;
             }
 
-            dst++;
+            *dst++ = c;
             len--;
         }
 
+        *dst = 0;
+
 
         // DBG( printf( "tag %s\n", tag ) );
         c = SkipGetChar( File );
@@ -179,7 +499,7 @@ bool GetNextTag( FILE* File, char* tag, size_t len )
         if( c != EOF )
         {
             // Puts again the read char in the buffer
-            ungetc( c, File );
+            File->UngetChar();
         }
     }
 
@@ -187,12 +507,12 @@ bool GetNextTag( FILE* File, char* tag, size_t len )
 }
 
 
-int Read_NotImplemented( FILE* File, char closeChar )
+int Read_NotImplemented( VRML_READER* File, char closeChar )
 {
     int c;
 
     // DBG( printf( "look for %c\n", closeChar) );
-    while( ( c = fgetc( File ) ) != EOF )
+    while( ( c = File->GetChar() ) != EOF )
     {
         if( c == '{' )
         {
@@ -216,7 +536,7 @@ int Read_NotImplemented( FILE* File, char closeChar )
 }
 
 
-int ParseVertexList( FILE* File, std::vector<glm::vec3>& dst_vector )
+int ParseVertexList( VRML_READER* File, std::vector<glm::vec3>& dst_vector )
 {
     // DBG( printf( "      ParseVertexList\n" ) );
 
@@ -233,38 +553,41 @@ int ParseVertexList( FILE* File, std::vector<glm::vec3>& dst_vector )
 }
 
 
-bool ParseVertex( FILE* File, glm::vec3& dst_vertex )
+bool ParseVertex( VRML_READER* File, glm::vec3& dst_vertex )
 {
     float   a, b, c;
-    int     ret = fscanf( File, "%e %e %e", &a, &b, &c );
+    bool    ret = File->ReadFloat( &a ) && File->ReadFloat( &b ) && File->ReadFloat( &c );
 
-    dst_vertex.x    = a;
-    dst_vertex.y    = b;
-    dst_vertex.z    = c;
+    if( ret )
+    {
+        dst_vertex.x    = a;
+        dst_vertex.y    = b;
+        dst_vertex.z    = c;
+    }
 
     int s = SkipGetChar( File );
 
     if( s != EOF )
     {
         // Puts again the read char in the buffer
-        ungetc( s, File );
+        File->UngetChar();
     }
 
     // DBG( printf( "ret%d(%.9f,%.9f,%.9f)", ret, a,b,c) );
 
-    return ret == 3;
+    return ret;
 }
 
 
-bool ParseFloat( FILE* aFile, float *aDstFloat, float aDefaultValue )
+bool ParseFloat( VRML_READER* aFile, float *aDstFloat, float aDefaultValue )
 {
     float   value;
-    int     ret = fscanf( aFile, "%e", &value );
+    bool    ret = aFile->ReadFloat( &value );
 
-    if( ret == 1 )
+    if( ret )
         *aDstFloat = value;
     else
         *aDstFloat = aDefaultValue;
 
-    return ret == 1;
+    return ret;
 }
@@ -50,6 +50,96 @@
 #endif
 #include <wx/glcanvas.h>
 
+
+/**
+ * Class VRML_READER
+ * reads a whole VRML file in memory, and returns its chars and numbers.
+ *
+ * It replaces the stdio functions (fgetc(), ungetc(), fscanf()) used to parse the VRML
+ * files: the file is read at once and the numbers are converted without the fscanf()
+ * format parsing, which is the longest part of the loading of big models (models
+ * exported from STEP files have hundreds of thousands of coordinates).
+ * Numbers are read like fscanf( "%f" ) and fscanf( "%d" ) do with the C locale, whatever
+ * the current locale is: most floats are converted directly, the other ones (long
+ * mantissas, large exponents, "inf", hexadecimal values...) by strtof(), after their '.'
+ * is replaced by the decimal point of the current locale.  So the locale does not need
+ * to be switched to "C" while reading a file.
+ */
+class VRML_READER
+{
+public:
+    VRML_READER();
+    ~VRML_READER();
+
+    /**
+     * Function Open
+     * reads the file in memory.
+     * @param aFilename = the full file name of the file to read
+     * @return bool - true if the file was read
+     */
+    bool Open( const wxString& aFilename );
+
+    ///> Frees the file contents
+    void Close();
+
+    /**
+     * Function GetChar
+     * @return int - the next char, or EOF at the end of the file (like fgetc())
+     */
+    int GetChar()
+    {
+        if( m_pos == m_end )
+            return EOF;
+
+        return (unsigned char) *m_pos++;
+    }
+
+    /**
+     * Function UngetChar
+     * puts back the last char read by GetChar() (like ungetc()).
+     */
+    void UngetChar()
+    {
+        if( m_pos > m_buffer )
+            m_pos--;
+    }
+
+    /**
+     * Function SkipSpaces
+     * skips the white spaces, like a space in a fscanf() format.
+     */
+    void SkipSpaces();
+
+    /**
+     * Function SkipChar
+     * skips the next char if it is aChar, like a char in a fscanf() format.
+     * @return bool - true if aChar was skipped
+     */
+    bool SkipChar( char aChar );
+
+    /**
+     * Function ReadFloat
+     * reads a float value, like fscanf( "%f" ).
+     * @param aValue = destination float, unchanged if no value could be read
+     * @return bool - true if a value was read
+     */
+    bool ReadFloat( float* aValue );
+
+    /**
+     * Function ReadInt
+     * reads an int value, like fscanf( "%d" ).
+     * @param aValue = destination int, unchanged if no value could be read
+     * @return bool - true if a value was read
+     */
+    bool ReadInt( int* aValue );
+
+private:
+    char*       m_buffer;       ///< the file contents, followed by a '\0'
+    const char* m_pos;          ///< the next char to read
+    const char* m_end;          ///< the end of the file contents
+};
+
+
 /**
  * Function GetEpoxyThicknessBIU
  * skip a VRML block and eventualy internal blocks until it find the close char
@@ -57,7 +147,7 @@
  * @param closeChar the expected close char of the block
  * @return int - -1 if failed, 0 if OK
  */
-int Read_NotImplemented( FILE* File, char closeChar);
+int Read_NotImplemented( VRML_READER* File, char closeChar);
 
 
 /**
@@ -67,7 +157,7 @@ int Read_NotImplemented( FILE* File, char closeChar);
  * @param dst_vector destination vector list
  * @return int - -1 if failed, 0 if OK
  */
-int ParseVertexList( FILE* File, std::vector< glm::vec3 > &dst_vector);
+int ParseVertexList( VRML_READER* File, std::vector< glm::vec3 > &dst_vector);
 
 
 /**
@@ -77,7 +167,7 @@ int ParseVertexList( FILE* File, std::vector< glm::vec3 > &dst_vector);
  * @param dst_vertex destination vector
  * @return bool - return true if the 3 elements are read
  */
-bool ParseVertex( FILE* File, glm::vec3 &dst_vertex );
+bool ParseVertex( VRML_READER* File, glm::vec3 &dst_vertex );
 
 
 /**
@@ -88,7 +178,7 @@ bool ParseVertex( FILE* File, glm::vec3 &dst_vertex );
  * @param aDefaultValue = the default value, when the actual value cannot be read
  * @return bool - Return true if the float was read without error
  */
-bool ParseFloat( FILE* aFile, float *aDstFloat, float aDefaultValue );
+bool ParseFloat( VRML_READER* aFile, float *aDstFloat, float aDefaultValue );
 
 /**
  * Function GetNextTag
@@ -98,7 +188,7 @@ bool ParseFloat( FILE* aFile, float *aDstFloat, float aDefaultValue );
  * @param len max length of storage
  * @return bool - true if succeeded, false if EOF
  */
-bool GetNextTag( FILE* File, char* tag, size_t len );
+bool GetNextTag( VRML_READER* File, char* tag, size_t len );
 
 /**
  * Function GetString
@@ -108,6 +198,6 @@ bool GetNextTag( FILE* File, char* tag, size_t len );
  * @param maxDstLen max length of storage
  * @return bool - true if successful read the string, false if failed to get a string
  */
-bool GetString( FILE* File, char* aDstString, size_t maxDstLen );
+bool GetString( VRML_READER* File, char* aDstString, size_t maxDstLen );
 
 #endif
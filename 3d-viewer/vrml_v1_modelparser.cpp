@@ -69,13 +69,12 @@ bool VRML1_MODEL_PARSER::Load( const wxString& aFilename )
 
     wxLogTrace( traceVrmlV1Parser, wxT( "Loading: %s" ), GetChars( aFilename ) );
 
-    m_file = wxFopen( aFilename, wxT( "rt" ) );
+    VRML_READER file;
 
-    if( m_file == NULL )
+    if( !file.Open( aFilename ) )
         return false;
 
-    // Switch the locale to standard C (needed to print floating point numbers)
-    LOCALE_IO toggle;
+    m_file = &file;
 
     m_ModelParser->childs.clear();
 
@@ -94,7 +93,7 @@ bool VRML1_MODEL_PARSER::Load( const wxString& aFilename )
         }
     }
 
-    fclose( m_file );
+    m_file = NULL;
 
     return true;
 }
@@ -322,8 +321,10 @@ int VRML1_MODEL_PARSER::readMaterial_shininess()
 
     float shininess_value;
 
-    while( fscanf( m_file, "%f,", &shininess_value ) )
+    while( m_file->ReadFloat( &shininess_value ) )
     {
+        m_file->SkipChar( ',' );
+
         // VRML value is normalized and openGL expects a value 0 - 128
         shininess_value = shininess_value * 128.0f;
         m_model->m_Materials->m_Shininess.push_back( shininess_value );
@@ -348,8 +349,9 @@ int VRML1_MODEL_PARSER::readMaterial_transparency()
 
     float tmp;
 
-    while( fscanf( m_file, "%f,", &tmp ) )
+    while( m_file->ReadFloat( &tmp ) )
     {
+        m_file->SkipChar( ',' );
         m_model->m_Materials->m_Transparency.push_back( tmp );
     }
 
@@ -388,8 +390,25 @@ int VRML1_MODEL_PARSER::readIndexedFaceSet_coordIndex()
 
     int dummy;    // should be -1
 
-    while( fscanf( m_file, "%d,%d,%d,%d,", &coord[0], &coord[1], &coord[2], &dummy ) )
+    int* values[4] = { &coord[0], &coord[1], &coord[2], &dummy };
+
+    for( ;; )
     {
+        // Read "i, j, k, -1," like fscanf( "%d,%d,%d,%d," ): the values not read
+        // (when a comma is missing) keep their previous value
+        int count = 0;
+
+        while( count < 4 && m_file->ReadInt( values[count] ) )
+        {
+            count++;
+
+            if( !m_file->SkipChar( ',' ) )
+                break;
+        }
+
+        if( count == 0 )
+            break;
+
         std::vector<int> coord_list;
 
         coord_list.resize( 3 );
@@ -428,8 +447,9 @@ int VRML1_MODEL_PARSER::readIndexedFaceSet_materialIndex()
 
     int index;
 
-    while( fscanf( m_file, "%d,", &index ) )
+    while( m_file->ReadInt( &index ) )
     {
+        m_file->SkipChar( ',' );
         m_model->m_MaterialIndexPerFace.push_back( index );
     }
 
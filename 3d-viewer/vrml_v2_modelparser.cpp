@@ -87,9 +87,9 @@ bool VRML2_MODEL_PARSER::Load( const wxString& aFilename )
     wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "Loading: %s" ), GetChars( aFilename ) );
     debug_enter();
 
-    m_file = wxFopen( aFilename, wxT( "rt" ) );
+    VRML_READER file;
 
-    if( m_file == NULL )
+    if( !file.Open( aFilename ) )
     {
         debug_exit();
         wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "Failed to open file: %s" ),
@@ -97,14 +97,12 @@ bool VRML2_MODEL_PARSER::Load( const wxString& aFilename )
         return false;
     }
 
+    m_file = &file;
     m_Filename = aFilename;
 
-    // Switch the locale to standard C (needed to print floating point numbers)
-    LOCALE_IO toggle;
-
     loadFileModel( S3D_MESH_PTR() );
 
-    fclose( m_file );
+    m_file = NULL;
 
     debug_exit();
     return true;
@@ -119,9 +117,9 @@ bool VRML2_MODEL_PARSER::Load( const wxString& aFilename, S3D_MESH_PTR aTransfor
                     GetChars( aFilename ) );
         debug_enter();
 
-        m_file = wxFopen( aFilename, wxT( "rt" ) );
+        VRML_READER file;
 
-        if( m_file == NULL )
+        if( !file.Open( aFilename ) )
         {
             debug_exit();
             wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "Failed to open file: %s" ),
@@ -129,14 +127,12 @@ bool VRML2_MODEL_PARSER::Load( const wxString& aFilename, S3D_MESH_PTR aTransfor
             return false;
         }
 
+        m_file = &file;
         m_Filename = aFilename;
 
-        // Switch the locale to standard C (needed to print floating point numbers)
-        LOCALE_IO toggle;
-
         loadFileModel( aTransformationModel );
 
-        fclose( m_file );
+        m_file = NULL;
 
         debug_exit();
         return true;
@@ -381,10 +377,10 @@ int VRML2_MODEL_PARSER::read_Transform()
         }
         else if( strcmp( text, "rotation" ) == 0 )
         {
-            if( fscanf( m_file, "%f %f %f %f", &m_model->m_rotation[0],
-                        &m_model->m_rotation[1],
-                        &m_model->m_rotation[2],
-                        &m_model->m_rotation[3] ) != 4 )
+            if( !( m_file->ReadFloat( &m_model->m_rotation[0] )
+                  && m_file->ReadFloat( &m_model->m_rotation[1] )
+                  && m_file->ReadFloat( &m_model->m_rotation[2] )
+                  && m_file->ReadFloat( &m_model->m_rotation[3] ) ) )
             {
                 m_model->m_rotation[0]  = 0.0f;
                 m_model->m_rotation[1]  = 0.0f;
@@ -417,10 +413,10 @@ int VRML2_MODEL_PARSER::read_Transform()
             wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "scaleOrientation is not implemented, but it will be parsed" ) );
 
             glm::vec4 vecDummy;
-            if( fscanf( m_file, "%f %f %f %f", &vecDummy[0],
-                        &vecDummy[1],
-                        &vecDummy[2],
-                        &vecDummy[3] ) != 4 )
+            if( !( m_file->ReadFloat( &vecDummy[0] )
+                  && m_file->ReadFloat( &vecDummy[1] )
+                  && m_file->ReadFloat( &vecDummy[2] )
+                  && m_file->ReadFloat( &vecDummy[3] ) ) )
             {
                 vecDummy[0]  = 0.0f;
                 vecDummy[1]  = 0.0f;
@@ -456,7 +452,7 @@ int VRML2_MODEL_PARSER::read_Transform()
         {
             int dummy;
 
-            if( fscanf( m_file, "%d", &dummy ) != 1 )
+            if( !m_file->ReadInt( &dummy ) )
             {
                 // !TODO: log errors
             }
@@ -1514,8 +1510,10 @@ int VRML2_MODEL_PARSER::read_colorIndex()
         std::vector<int> materialIndexPerVertex;
         materialIndexPerVertex.reserve( 3 );        // Start at least with 3
 
-        while( fscanf( m_file, "%d, ", &index ) == 1 )
+        while( m_file->ReadInt( &index ) )
         {
+            m_file->SkipChar( ',' );
+
             if( index == -1 )
             {
                 m_model->m_MaterialIndexPerVertex.push_back( materialIndexPerVertex );
@@ -1537,8 +1535,9 @@ int VRML2_MODEL_PARSER::read_colorIndex()
         if( m_model->m_CoordIndex.size() > 0 )
             m_model->m_MaterialIndexPerFace.reserve( m_model->m_CoordIndex.size() );
 
-        while( fscanf( m_file, "%d,", &index ) )
+        while( m_file->ReadInt( &index ) )
         {
+            m_file->SkipChar( ',' );
             m_model->m_MaterialIndexPerFace.push_back( index );
         }
 
@@ -1564,8 +1563,10 @@ int VRML2_MODEL_PARSER::read_NormalIndex()
     std::vector<int> coord_list;
     coord_list.clear();
 
-    while( fscanf( m_file, "%d, ", &dummy ) == 1 )
+    while( m_file->ReadInt( &dummy ) )
     {
+        m_file->SkipChar( ',' );
+
         if( dummy == -1 )
         {
             m_model->m_NormalIndex.push_back( coord_list );
@@ -1597,8 +1598,10 @@ int VRML2_MODEL_PARSER::read_coordIndex()
     std::vector<int> coord_list;
     coord_list.clear();
 
-    while( fscanf( m_file, "%d, ", &coordIdx ) == 1 )
+    while( m_file->ReadInt( &coordIdx ) )
     {
+        m_file->SkipChar( ',' );
+
         if( coordIdx == -1 )
         {
             m_model->m_CoordIndex.push_back( coord_list );
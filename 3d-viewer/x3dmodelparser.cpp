@@ -79,9 +79,6 @@ bool X3D_MODEL_PARSER::Load( const wxString& aFilename )
         return false;
     }
 
-    // Switch the locale to standard C (needed to print floating point numbers)
-    LOCALE_IO toggle;
-
     childs.clear();
 
     // Shapes are inside of Transform nodes
@@ -238,7 +235,7 @@ void X3D_MODEL_PARSER::readMaterial( wxXmlNode* aMatNode )
         wxStringTokenizer values;
         values.SetString( properties[ wxT( "ambientIntensity" ) ] );
 
-        if( values.GetNextToken().ToDouble( &amb ) )
+        if( values.GetNextToken().ToCDouble( &amb ) )
         {
             m_model->m_Materials->m_AmbientColor.push_back( glm::vec3( amb, amb, amb ) );
         }
@@ -249,7 +246,7 @@ void X3D_MODEL_PARSER::readMaterial( wxXmlNode* aMatNode )
 
         values.SetString( properties[ wxT( "shininess" ) ]  );
 
-        if( values.GetNextToken().ToDouble( &shine ) )
+        if( values.GetNextToken().ToCDouble( &shine ) )
         {
             // VRML value is normalized and openGL expects a value 0 - 128
             if( shine > 1.0 )
@@ -269,7 +266,7 @@ void X3D_MODEL_PARSER::readMaterial( wxXmlNode* aMatNode )
 
         values.SetString( properties[ wxT( "transparency" ) ] );
 
-        if( values.GetNextToken().ToDouble( &transp ) )
+        if( values.GetNextToken().ToCDouble( &transp ) )
         {
             m_model->m_Materials->m_Transparency.push_back( transp );
         }
@@ -347,9 +344,9 @@ bool X3D_MODEL_PARSER::parseDoubleTriplet( const wxString& aData,
     double y = 0;
     double z = 0;
 
-    bool ret = tokens.GetNextToken().ToDouble( &x )
-               && tokens.GetNextToken().ToDouble( &y )
-               && tokens.GetNextToken().ToDouble( &z );
+    bool ret = tokens.GetNextToken().ToCDouble( &x )
+               && tokens.GetNextToken().ToCDouble( &y )
+               && tokens.GetNextToken().ToCDouble( &z );
 
     aResult.x   = x;
     aResult.y   = y;
@@ -411,10 +408,10 @@ void X3D_MODEL_PARSER::readIndexedFaceSet( wxXmlNode* aFaceNode,
 
     double x = 0.0, y = 0.0, z = 0.0;
 
-    if( !( tokens.GetNextToken().ToDouble( &x )
-           && tokens.GetNextToken().ToDouble( &y )
-           && tokens.GetNextToken().ToDouble( &z )
-           && tokens.GetNextToken().ToDouble( &angle ) ) )
+    if( !( tokens.GetNextToken().ToCDouble( &x )
+           && tokens.GetNextToken().ToCDouble( &y )
+           && tokens.GetNextToken().ToCDouble( &z )
+           && tokens.GetNextToken().ToCDouble( &angle ) ) )
     {
         // DBG( printf( "rotation read error" ) );
     }
@@ -441,7 +438,7 @@ void X3D_MODEL_PARSER::readIndexedFaceSet( wxXmlNode* aFaceNode,
 
     while( point_tokens.HasMoreTokens() )
     {
-        if( point_tokens.GetNextToken().ToDouble( &point ) )
+        if( point_tokens.GetNextToken().ToCDouble( &point ) )
         {
             points.push_back( point );
         }
@@ -508,7 +505,7 @@ void X3D_MODEL_PARSER::readIndexedFaceSet( wxXmlNode* aFaceNode,
 
         while( colorpoint_tokens.HasMoreTokens() )
         {
-            if( colorpoint_tokens.GetNextToken().ToDouble( &color_point ) )
+            if( colorpoint_tokens.GetNextToken().ToCDouble( &color_point ) )
             {
                 color_points.push_back( color_point );
             }
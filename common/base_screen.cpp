@@ -38,6 +38,7 @@
 #include <base_units.h>
 
 wxString BASE_SCREEN::m_PageLayoutDescrFileName;   // the name of the page layout descr file.
+unsigned BASE_SCREEN::s_modifyGeneration = 0;
 
 BASE_SCREEN::BASE_SCREEN( KICAD_T aType ) :
     EDA_ITEM( aType )
@@ -56,6 +57,7 @@ BASE_SCREEN::BASE_SCREEN( KICAD_T aType ) :
 
     m_FlagModified     = false;     // Set when any change is made on board.
     m_FlagSave         = false;     // Used in auto save set when an auto save is required.
+    m_modifyStamp      = ++s_modifyGeneration;
 
     SetCurItem( NULL );
 }
@@ -46,6 +46,10 @@ void DHEAD::DeleteAll()
     while( item )
     {
         next = item->Next();
+
+        if( listener )
+            listener->ItemRemoved( item );
+
         delete item;            // virtual destructor, class specific
         item = next;
     }
@@ -82,6 +86,9 @@ void DHEAD::append( EDA_ITEM* aNewElement )
     aNewElement->SetList( this );
 
     ++count;
+
+    if( listener )
+        listener->ItemAdded( aNewElement );
 }
 
 
@@ -109,6 +116,18 @@ void DHEAD::append( DHEAD& aList )
 
         count += aList.count;
 
+        if( aList.listener || listener )
+        {
+            for( EDA_ITEM* item = aList.first;  item;  item = item->Next() )
+            {
+                if( aList.listener )
+                    aList.listener->ItemRemoved( item );
+
+                if( listener )
+                    listener->ItemAdded( item );
+            }
+        }
+
         aList.count = 0;
         aList.first = NULL;
         aList.last  = NULL;
@@ -153,6 +172,9 @@ void DHEAD::insert( EDA_ITEM* aNewElement, EDA_ITEM* aAfterMe )
         aNewElement->SetList( this );
 
         ++count;
+
+        if( listener )
+            listener->ItemAdded( aNewElement );
     }
 }
 
@@ -162,6 +184,9 @@ void DHEAD::remove( EDA_ITEM* aElement )
     wxASSERT( aElement );
     wxASSERT( aElement->GetList() == this );
 
+    if( listener )
+        listener->ItemRemoved( aElement );
+
     if( aElement->Next() )
     {
         aElement->Next()->SetBack( aElement->Back() );
@@ -33,9 +33,8 @@
 #include <gal/opengl/vertex_manager.h>
 #include <gal/opengl/vertex_item.h>
 #include <gal/opengl/shader.h>
-#include <confirm.h>
 #include <wx/log.h>
-#include <list>
+#include <cstring>
 #ifdef __WXDEBUG__
 #include <profile.h>
 #endif /* __WXDEBUG__ */
@@ -43,10 +42,11 @@
 using namespace KIGFX;
 
 CACHED_CONTAINER::CACHED_CONTAINER( unsigned int aSize ) :
-    VERTEX_CONTAINER( aSize ), m_item( NULL )
+    VERTEX_CONTAINER( aSize ), m_classMask( 0 ), m_item( NULL )
 {
     // In the beginning there is only free space
-    m_freeChunks.insert( CHUNK( aSize, 0 ) );
+    m_freeSpace = 0;
+    addFreeChunk( 0, aSize );
 
     // Do not have uninitialized members:
     m_chunkSize = 0;
@@ -63,9 +63,8 @@ void CACHED_CONTAINER::SetItem( VERTEX_ITEM* aItem )
     m_itemSize  = m_item->GetSize();
     m_chunkSize = m_itemSize;
 
-    if( m_itemSize == 0 )
-        m_items.insert( m_item ); // The item was not stored before
-    else
+    // Items are stored in the container when they get their first vertices
+    if( m_itemSize > 0 )
         m_chunkOffset = m_item->GetOffset();
 
 #if CACHED_CONTAINER_TEST > 1
@@ -83,12 +82,8 @@ void CACHED_CONTAINER::FinishItem()
     if( m_itemSize < m_chunkSize )
     {
         // There is some not used but reserved memory left, so we should return it to the pool
-        int itemOffset = m_item->GetOffset();
-
-        // Add the not used memory back to the pool
-        m_freeChunks.insert( CHUNK( m_chunkSize - m_itemSize, itemOffset + m_itemSize ) );
-        m_freeSpace += ( m_chunkSize - m_itemSize );
-        // mergeFreeChunks();   // veery slow and buggy
+        addFreeChunk( m_chunkOffset + m_itemSize, m_chunkSize - m_itemSize );
+        m_chunkSize = m_itemSize;
     }
 
 #if CACHED_CONTAINER_TEST > 1
@@ -112,11 +107,7 @@ VERTEX* CACHED_CONTAINER::Allocate( unsigned int aSize )
 
         // Reserve a bigger memory chunk for the current item and
         // make it multiple of 3 to store triangles
-        m_chunkSize = ( 2 * m_itemSize ) + aSize + ( 3 - aSize % 3 );
-        // Save the current size before reallocating
-        m_chunkOffset = reallocate( m_chunkSize );
-
-        if( m_chunkOffset > m_currentSize )
+        if( reallocate( ( 2 * m_itemSize ) + aSize + ( 3 - aSize % 3 ) ) == UINT_MAX )
         {
             m_failed = true;
             return NULL;
@@ -146,10 +137,18 @@ VERTEX* CACHED_CONTAINER::Allocate( unsigned int aSize )
 void CACHED_CONTAINER::Delete( VERTEX_ITEM* aItem )
 {
     wxASSERT( aItem != NULL );
-    wxASSERT( m_items.find( aItem ) != m_items.end() );
 
-    int size   = aItem->GetSize();
-    int offset = aItem->GetOffset();
+    unsigned int size   = aItem->GetSize();
+    unsigned int offset = aItem->GetOffset();
+
+    if( aItem == m_item )
+    {
+        // The current item may still reserve more memory than it uses
+        size = m_chunkSize;
+        m_item = NULL;
+        m_itemSize = 0;
+        m_chunkSize = 0;
+    }
 
 #if CACHED_CONTAINER_TEST > 1
     wxLogDebug( wxT( "Removing 0x%08lx (size %d offset %d)" ), (long) aItem, size, offset );
@@ -158,23 +157,35 @@ void CACHED_CONTAINER::Delete( VERTEX_ITEM* aItem )
     // Insert a free memory chunk entry in the place where item was stored
     if( size > 0 )
     {
-        m_freeChunks.insert( CHUNK( size, offset ) );
-        m_freeSpace += size;
+        wxASSERT( m_items.find( offset ) != m_items.end() );
+        wxASSERT( m_items.find( offset )->second == aItem );
+
+        m_items.erase( offset );
+        addFreeChunk( offset, size );
         // Indicate that the item is not stored in the container anymore
         aItem->setSize( 0 );
     }
 
-    m_items.erase( aItem );
-
 #if CACHED_CONTAINER_TEST > 1
     test();
 #endif
 
-    // Dynamic memory freeing, there is no point in holding
-    // a large amount of memory when there is no use for it
-    if( m_freeSpace > ( m_currentSize / 2 ) && m_currentSize > m_initialSize )
+    // Dynamic memory freeing, there is no point in holding a large amount of memory when there
+    // is no use for it. The container is still half empty once shrunk, so it is not enlarged
+    // again immediately.
+    if( size > 0 && m_freeSpace > ( m_currentSize / 4 * 3 ) && m_currentSize > m_initialSize )
     {
-        resizeContainer( m_currentSize / 2 );
+        // Move a part of the items towards the beginning, so the free space gathers
+        // at the end of the container. It is shrunk once the second half is free.
+        // The moves are proportional to the freed space, so deleting many items
+        // does not move the remaining ones over and over.
+        compact( UINT_MAX, size * COMPACTION_RATIO );
+
+        FREE_CHUNK_MAP::const_iterator last = m_freeChunks.end();
+
+        if( !m_freeChunks.empty() && ( --last )->first <= m_currentSize / 2
+                && last->first + last->second == m_currentSize )
+            resizeContainer( m_currentSize / 2 );
     }
 }
 
@@ -186,7 +197,6 @@ void CACHED_CONTAINER::Clear()
                                                 m_initialSize * sizeof( VERTEX ) ) );
 
     // Reset state variables
-    m_freeSpace     = m_initialSize;
     m_currentSize   = m_initialSize;
     m_failed = false;
 
@@ -196,21 +206,31 @@ void CACHED_CONTAINER::Clear()
 
     for( it = m_items.begin(); it != m_items.end(); ++it )
     {
-        ( *it )->setSize( 0 );
+        it->second->setSize( 0 );
     }
 
     m_items.clear();
 
+    m_item = NULL;
+    m_itemSize = 0;
+    m_chunkSize = 0;
 
     // Now there is only free space left
     m_freeChunks.clear();
-    m_freeChunks.insert( CHUNK( m_freeSpace, 0 ) );
+
+    for( int i = 0; i < SIZE_CLASSES; ++i )
+        m_sizeClasses[i].clear();
+
+    m_classMask = 0;
+    m_freeSpace = 0;
+    addFreeChunk( 0, m_initialSize );
 }
 
 
 unsigned int CACHED_CONTAINER::reallocate( unsigned int aSize )
 {
     wxASSERT( aSize > 0 );
+    wxASSERT( aSize > m_chunkSize );
 
 #if CACHED_CONTAINER_TEST > 2
     wxLogDebug( wxT( "Resize 0x%08lx from %d to %d" ), (long) m_item, m_itemSize, aSize );
@@ -237,182 +257,145 @@ unsigned int CACHED_CONTAINER::reallocate( unsigned int aSize )
             return UINT_MAX;
     }
 
+    if( m_chunkSize > 0 )
+    {
+        // If the chunk is followed by enough free space, it can simply be enlarged
+        FREE_CHUNK_MAP::iterator next = m_freeChunks.find( m_chunkOffset + m_chunkSize );
+
+        if( next != m_freeChunks.end() && m_chunkSize + next->second >= aSize )
+        {
+            unsigned int available = m_chunkSize + next->second;
+
+            removeFreeChunk( next );
+
+            if( available > aSize )
+                addFreeChunk( m_chunkOffset + aSize, available - aSize );
+
+            m_chunkSize = aSize;
+
+            return m_chunkOffset;
+        }
+    }
+
     // Look for the free space chunk of at least given size
-    FREE_CHUNK_MAP::iterator newChunk = m_freeChunks.lower_bound( aSize );
+    FREE_CHUNK_MAP::iterator newChunk = findFreeChunk( aSize );
 
     if( newChunk == m_freeChunks.end() )
     {
-        // In the case when there is enough space to store the vertices,
-        // but the free space is not continous we should defragment the container
-        if( !defragment() )
+        // In the case when there is enough space to store the vertices, but the free space
+        // is not continous, we have to move some items. If there is not much free space left,
+        // it is better to enlarge the container, otherwise it would be compacted again soon.
+        if( m_freeSpace < m_currentSize / 4 && resizeContainer( m_currentSize * 2 ) )
+            newChunk = findFreeChunk( aSize );
+        else if( compact( aSize ) )
+            newChunk = m_freeChunks.begin();    // the current item may have been moved too
+        else
             return UINT_MAX;
 
-        // Update the current offset
-        m_chunkOffset = m_item->GetOffset();
-
-        // We can take the first free chunk, as there is only one after defragmentation
-        // and we can be sure that it provides enough space to store the object
-        newChunk = m_freeChunks.begin();
+        wxASSERT( newChunk != m_freeChunks.end() );
     }
 
-    // Parameters of the allocated cuhnk
-    unsigned int chunkSize   = newChunk->first;
-    unsigned int chunkOffset = newChunk->second;
+    // Parameters of the allocated chunk
+    unsigned int chunkOffset = newChunk->first;
+    unsigned int chunkSize   = newChunk->second;
 
     wxASSERT( chunkSize >= aSize );
     wxASSERT( chunkOffset < m_currentSize );
 
+    // Remove the allocated chunk from the free space pool
+    removeFreeChunk( newChunk );
+
+    // If there is some space left, return it to the pool - add an entry for it
+    if( chunkSize > aSize )
+        addFreeChunk( chunkOffset + aSize, chunkSize - aSize );
+
     // Check if the item was previously stored in the container
-    if( m_itemSize > 0 )
+    if( m_chunkSize > 0 )
     {
 #if CACHED_CONTAINER_TEST > 3
-        wxLogDebug( wxT( "Moving 0x%08x from 0x%08x to 0x%08x" ),
-                    (int) m_item, oldChunkOffset, chunkOffset );
+        wxLogDebug( wxT( "Moving 0x%08lx from 0x%08x to 0x%08x" ),
+                    (long) m_item, m_chunkOffset, chunkOffset );
 #endif
         // The item was reallocated, so we have to copy all the old data to the new place
         memcpy( &m_vertices[chunkOffset], &m_vertices[m_chunkOffset],
                 m_itemSize * VertexSize );
 
         // Free the space previously used by the chunk
-        wxASSERT( m_itemSize > 0 );
-        m_freeChunks.insert( CHUNK( m_itemSize, m_chunkOffset ) );
-        m_freeSpace += m_itemSize;
+        m_items.erase( m_chunkOffset );
+        addFreeChunk( m_chunkOffset, m_chunkSize );
     }
 
-    // Remove the allocated chunk from the free space pool
-    m_freeChunks.erase( newChunk );
-
-    // If there is some space left, return it to the pool - add an entry for it
-    if( chunkSize > aSize )
-    {
-        m_freeChunks.insert( CHUNK( chunkSize - aSize, chunkOffset + aSize ) );
-    }
-
-    m_freeSpace -= aSize;
-    // mergeFreeChunks();   // veery slow and buggy
-
+    m_items[chunkOffset] = m_item;
     m_item->setOffset( chunkOffset );
 
+    m_chunkOffset = chunkOffset;
+    m_chunkSize   = aSize;
+
     return chunkOffset;
 }
 
 
-bool CACHED_CONTAINER::defragment( VERTEX* aTarget )
+bool CACHED_CONTAINER::compact( unsigned int aSize, unsigned int aMaxMoved )
 {
 #if CACHED_CONTAINER_TEST > 0
-    wxLogDebug( wxT( "Defragmenting" ) );
-
     prof_counter totalTime;
     prof_start( &totalTime, false );
 #endif
 
-    if( aTarget == NULL )
+    unsigned int moved = 0;
+    bool result = false;
+
+    while( !m_freeChunks.empty() )
     {
-        // No target was specified, so we have to reallocate our own space
-        aTarget = static_cast<VERTEX*>( malloc( m_currentSize * sizeof( VERTEX ) ) );
+        FREE_CHUNK_MAP::iterator hole = m_freeChunks.begin();
+        unsigned int holeOffset = hole->first;
+        unsigned int holeSize   = hole->second;
 
-        if( aTarget == NULL )
+        if( holeSize >= aSize )
         {
-            DisplayError( NULL, wxT( "Run out of memory" ) );
-            return false;
+            result = true;
+            break;
         }
-    }
-
-    int newOffset = 0;
-    ITEMS::iterator it, it_end;
-
-    for( it = m_items.begin(), it_end = m_items.end(); it != it_end; ++it )
-    {
-        VERTEX_ITEM* item = *it;
-        int itemOffset    = item->GetOffset();
-        int itemSize      = item->GetSize();
-
-        // Move an item to the new container
-        memcpy( &aTarget[newOffset], &m_vertices[itemOffset], itemSize * VertexSize );
-
-        // Update new offset
-        item->setOffset( newOffset );
-
-        // Move to the next free space
-        newOffset += itemSize;
-    }
-
-    free( m_vertices );
-    m_vertices = aTarget;
 
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    wxASSERT( m_freeSpace > 0 );
-    m_freeChunks.insert( CHUNK( m_freeSpace, m_currentSize - m_freeSpace ) );
-
-#if CACHED_CONTAINER_TEST > 0
-    prof_end( &totalTime );
-
-    wxLogDebug( wxT( "Defragmented the container storing %d vertices / %.1f ms" ),
-                m_currentSize - m_freeSpace, (double) totalTime.value / 1000.0 );
-#endif
-
-    return true;
-}
+        // Free chunks are always merged, so the hole is followed by an item, if any
+        ITEMS::iterator it = m_items.find( holeOffset + holeSize );
 
+        if( it == m_items.end() || moved >= aMaxMoved )
+            break;
 
-void CACHED_CONTAINER::mergeFreeChunks()
-{
-    if( m_freeChunks.size() <= 1 ) // There are no chunks that can be merged
-        return;
+        VERTEX_ITEM* item = it->second;
+        unsigned int itemSize = item->GetSize();
+        unsigned int chunkSize = ( item == m_item ) ? m_chunkSize : itemSize;
 
-#if CACHED_CONTAINER_TEST > 0
-    prof_counter totalTime;
-    prof_start( &totalTime, false );
-#endif
-
-    // Reversed free chunks map - this one stores chunk size with its offset as the key
-    std::list<CHUNK> freeChunks;
-
-    FREE_CHUNK_MAP::const_iterator it, it_end;
-
-    for( it = m_freeChunks.begin(), it_end = m_freeChunks.end(); it != it_end; ++it )
-    {
-        freeChunks.push_back( std::make_pair( it->second, it->first ) );
-    }
+        // Move the item to the beginning of the hole, which then follows the item
+        memmove( &m_vertices[holeOffset], &m_vertices[it->first], itemSize * VertexSize );
 
-    m_freeChunks.clear();
-    freeChunks.sort();
+        m_items.erase( it );
+        m_items[holeOffset] = item;
+        item->setOffset( holeOffset );
 
-    std::list<CHUNK>::const_iterator itf, itf_end;
-    unsigned int offset = freeChunks.front().first;
-    unsigned int size   = freeChunks.front().second;
-    freeChunks.pop_front();
+        if( item == m_item )
+            m_chunkOffset = holeOffset;
 
-    for( itf = freeChunks.begin(), itf_end = freeChunks.end(); itf != itf_end; ++itf )
-    {
-        if( itf->first == offset + size )
-        {
-            // These chunks can be merged, so just increase the current chunk size and go on
-            size += itf->second;
-        }
-        else
-        {
-            // These chunks cannot be merged
-            // So store the previous one
-            m_freeChunks.insert( std::make_pair( size, offset ) );
-            // and let's check the next chunk
-            offset = itf->first;
-            size   = itf->second;
+        removeFreeChunk( hole );
+        addFreeChunk( holeOffset + chunkSize, holeSize );
 
-        }
+        moved += itemSize;
     }
 
-    // Add the last one
-    m_freeChunks.insert( std::make_pair( size, offset ) );
+    if( moved > 0 )
+        m_dirty = true;
 
 #if CACHED_CONTAINER_TEST > 0
     prof_end( &totalTime );
 
-    wxLogDebug( wxT( "Merged free chunks / %.1f ms" ), (double) totalTime.value / 1000.0 );
+    wxLogDebug( wxT( "Compacted the container: moved %d vertices / %.1f ms" ),
+                moved, (double) totalTime.value / 1000.0 );
 #endif
 
     test();
+
+    return result;
 }
 
 
@@ -429,25 +412,25 @@ bool CACHED_CONTAINER::resizeContainer( unsigned int aNewSize )
     if( aNewSize < m_currentSize )
     {
         // Shrinking container
-        // Sanity check, no shrinking if we cannot fit all the data
-        if( reservedSpace() > aNewSize )
+        // Sanity check, no shrinking if the removed space is not free
+        if( m_freeChunks.empty() )
             return false;
 
-        newContainer = static_cast<VERTEX*>( malloc( aNewSize * sizeof( VERTEX ) ) );
+        FREE_CHUNK_MAP::iterator last = --m_freeChunks.end();
+        unsigned int lastOffset = last->first;
 
-        if( newContainer == NULL )
-        {
-            DisplayError( NULL, wxT( "Run out of memory" ) );
+        if( lastOffset > aNewSize || lastOffset + last->second != m_currentSize )
             return false;
-        }
 
-        // Defragment directly to the new, smaller container
-        defragment( newContainer );
+        newContainer = static_cast<VERTEX*>( realloc( m_vertices, aNewSize * sizeof( VERTEX ) ) );
+
+        if( newContainer == NULL )
+            return false;   // the old container is still valid
 
-        // We have to correct freeChunks after defragmentation
-        m_freeChunks.clear();
-        wxASSERT( aNewSize - reservedSpace() > 0 );
-        m_freeChunks.insert( CHUNK( aNewSize - reservedSpace(), reservedSpace() ) );
+        removeFreeChunk( last );
+
+        if( lastOffset < aNewSize )
+            addFreeChunk( lastOffset, aNewSize - lastOffset );
     }
     else
     {
@@ -455,18 +438,13 @@ bool CACHED_CONTAINER::resizeContainer( unsigned int aNewSize )
         newContainer = static_cast<VERTEX*>( realloc( m_vertices, aNewSize * sizeof( VERTEX ) ) );
 
         if( newContainer == NULL )
-        {
-            DisplayError( NULL, wxT( "Run out of memory" ) );
-            return false;
-        }
+            return false;   // reported by the VERTEX_MANAGER owner, see Allocate()
 
         // Add an entry for the new memory chunk at the end of the container
-        m_freeChunks.insert( CHUNK( aNewSize - m_currentSize, m_currentSize ) );
+        addFreeChunk( m_currentSize, aNewSize - m_currentSize );
     }
 
     m_vertices = newContainer;
-
-    m_freeSpace   += ( aNewSize - m_currentSize );
     m_currentSize = aNewSize;
 
     return true;
@@ -484,17 +462,97 @@ unsigned int CACHED_CONTAINER::getPowerOf2( unsigned int aNumber ) const
 }
 
 
+void CACHED_CONTAINER::addFreeChunk( unsigned int aOffset, unsigned int aSize )
+{
+    wxASSERT( aSize > 0 );
+
+    // Merge with the following chunk
+    FREE_CHUNK_MAP::iterator next = m_freeChunks.find( aOffset + aSize );
+
+    if( next != m_freeChunks.end() )
+    {
+        aSize += next->second;
+        removeFreeChunk( next );
+    }
+
+    // Merge with the preceding chunk
+    FREE_CHUNK_MAP::iterator prev = m_freeChunks.lower_bound( aOffset );
+
+    if( prev != m_freeChunks.begin() )
+    {
+        --prev;
+
+        if( prev->first + prev->second == aOffset )
+        {
+            aOffset = prev->first;
+            aSize += prev->second;
+            removeFreeChunk( prev );
+        }
+    }
+
+    m_freeChunks.insert( std::make_pair( aOffset, aSize ) );
+
+    int sizeClass = getSizeClass( aSize );
+    m_sizeClasses[sizeClass].insert( CHUNK( aSize, aOffset ) );
+    m_classMask |= 1u << sizeClass;
+
+    m_freeSpace += aSize;
+}
+
+
+void CACHED_CONTAINER::removeFreeChunk( FREE_CHUNK_MAP::iterator aChunk )
+{
+    unsigned int offset = aChunk->first;
+    unsigned int size   = aChunk->second;
+
+    int sizeClass = getSizeClass( size );
+    m_sizeClasses[sizeClass].erase( CHUNK( size, offset ) );
+
+    if( m_sizeClasses[sizeClass].empty() )
+        m_classMask &= ~( 1u << sizeClass );
+
+    m_freeChunks.erase( aChunk );
+    m_freeSpace -= size;
+}
+
+
+CACHED_CONTAINER::FREE_CHUNK_MAP::iterator CACHED_CONTAINER::findFreeChunk( unsigned int aSize )
+{
+    int sizeClass = getSizeClass( aSize );
+
+    // The best fitting chunk of its own size class
+    FREE_CHUNK_CLASS::const_iterator it = m_sizeClasses[sizeClass].lower_bound( CHUNK( aSize, 0 ) );
+
+    if( it == m_sizeClasses[sizeClass].end() )
+    {
+        // Any chunk of a bigger class is big enough, take the smallest one
+        unsigned int biggerClasses = ( sizeClass + 1 < SIZE_CLASSES )
+                                     ? m_classMask & ~( ( 2u << sizeClass ) - 1 ) : 0;
+
+        if( biggerClasses == 0 )
+            return m_freeChunks.end();
+
+        while( !( biggerClasses & ( 1u << sizeClass ) ) )
+            ++sizeClass;
+
+        it = m_sizeClasses[sizeClass].begin();
+    }
+
+    return m_freeChunks.find( it->second );
+}
+
+
 #ifdef CACHED_CONTAINER_TEST
 void CACHED_CONTAINER::showFreeChunks()
 {
-    FreeChunkMap::iterator it;
+    FREE_CHUNK_MAP::iterator it;
 
     wxLogDebug( wxT( "Free chunks:" ) );
 
     for( it = m_freeChunks.begin(); it != m_freeChunks.end(); ++it )
     {
-        unsigned int offset = getChunkOffset( *it );
-        unsigned int size   = getChunkSize( *it );
+        unsigned int offset = it->first;
+        unsigned int size   = it->second;
         wxASSERT( size > 0 );
 
         wxLogDebug( wxT( "[0x%08x-0x%08x] (size %d)" ),
@@ -505,13 +563,13 @@ void CACHED_CONTAINER::showFreeChunks()
 
 void CACHED_CONTAINER::showReservedChunks()
 {
-    Items::iterator it;
+    ITEMS::iterator it;
 
     wxLogDebug( wxT( "Reserved chunks:" ) );
 
     for( it = m_items.begin(); it != m_items.end(); ++it )
     {
-        VERTEX_ITEM* item   = *it;
+        VERTEX_ITEM* item   = it->second;
         unsigned int offset = item->GetOffset();
         unsigned int size   = item->GetSize();
         wxASSERT( size > 0 );
@@ -524,25 +582,59 @@ void CACHED_CONTAINER::showReservedChunks()
 
 void CACHED_CONTAINER::test()
 {
-    // Free space check
+    // Free space & size classes check
     unsigned int freeSpace = 0;
-    FreeChunkMap::iterator itf;
+    unsigned int classChunks = 0;
+    FREE_CHUNK_MAP::iterator itf;
 
     for( itf = m_freeChunks.begin(); itf != m_freeChunks.end(); ++itf )
-        freeSpace += getChunkSize( *itf );
+    {
+        int sizeClass = getSizeClass( itf->second );
+
+        wxASSERT( m_sizeClasses[sizeClass].count( CHUNK( itf->second, itf->first ) ) == 1 );
+        wxASSERT( m_classMask & ( 1u << sizeClass ) );
+        freeSpace += itf->second;
+    }
+
+    for( int i = 0; i < SIZE_CLASSES; ++i )
+        classChunks += m_sizeClasses[i].size();
 
     wxASSERT( freeSpace == m_freeSpace );
+    wxASSERT( classChunks == m_freeChunks.size() );
+
+    // The free & reserved chunks have to cover the whole container, without overlapping
+    // and without consecutive free chunks
+    unsigned int offset = 0;
+    bool lastFree = false;
+    ITEMS::iterator itr = m_items.begin();
+    itf = m_freeChunks.begin();
 
-    // Reserved space check
-    /*unsigned int reservedSpace = 0;
-    Items::iterator itr;
-    for( itr = m_items.begin(); itr != m_items.end(); ++itr )
-        reservedSpace += ( *itr )->GetSize();
-    reservedSpace += m_itemSize;    // Add the current chunk size
+    while( offset < m_currentSize )
+    {
+        if( itf != m_freeChunks.end() && itf->first == offset )
+        {
+            wxASSERT( !lastFree );
+            offset += itf->second;
+            lastFree = true;
+            ++itf;
+        }
+        else if( itr != m_items.end() && itr->first == offset )
+        {
+            VERTEX_ITEM* item = itr->second;
 
-    wxASSERT( ( freeSpace + reservedSpace ) == m_currentSize );*/
+            wxASSERT( item->GetOffset() == offset );
+            offset += ( item == m_item ) ? m_chunkSize : item->GetSize();
+            lastFree = false;
+            ++itr;
+        }
+        else
+        {
+            wxFAIL_MSG( wxT( "Container space is neither free nor reserved" ) );
+            break;
+        }
+    }
 
-    // Overlapping check TBD
+    wxASSERT( itf == m_freeChunks.end() && itr == m_items.end() );
 }
 
 #endif /* CACHED_CONTAINER_TEST */
@@ -27,10 +27,12 @@
  */
 
 #include <gal/opengl/opengl_gal.h>
+#include <gal/opengl/opengl_gal_worker.h>
 #include <gal/definitions.h>
 
 #include <wx/log.h>
 #include <macros.h>
+#include <confirm.h>
 #ifdef __WXDEBUG__
 #include <profile.h>
 #endif /* __WXDEBUG__ */
@@ -44,6 +46,26 @@ static void InitTesselatorCallbacks( GLUtesselator* aTesselator );
 const int glAttributes[] = { WX_GL_RGBA, WX_GL_DOUBLEBUFFER, WX_GL_DEPTH_SIZE, 16, 0 };
 wxGLContext* OPENGL_GAL::glContext = NULL;
 
+OPENGL_GAL_BASE::OPENGL_GAL_BASE() :
+    currentManager( NULL )
+{
+    // Tesselator initialization
+    tesselator = gluNewTess();
+    InitTesselatorCallbacks( tesselator );
+
+    if( tesselator == NULL )
+        throw std::runtime_error( "Could not create the tesselator" );
+
+    gluTessProperty( tesselator, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_POSITIVE );
+}
+
+
+OPENGL_GAL_BASE::~OPENGL_GAL_BASE()
+{
+    gluDeleteTess( tesselator );
+}
+
+
 OPENGL_GAL::OPENGL_GAL( wxWindow* aParent, wxEvtHandler* aMouseListener,
                         wxEvtHandler* aPaintListener, const wxString& aName ) :
     wxGLCanvas( aParent, wxID_ANY, (int*) glAttributes, wxDefaultPosition, wxDefaultSize,
@@ -68,6 +90,7 @@ OPENGL_GAL::OPENGL_GAL( wxWindow* aParent, wxEvtHandler* aMouseListener,
     // Initialize the flags
     isFramebufferInitialized = false;
     isGrouping               = false;
+    isAllocationFailed       = false;
     groupCounter             = 0;
 
 #ifdef RETINA_OPENGL_PATCH
@@ -102,15 +125,6 @@ OPENGL_GAL::OPENGL_GAL( wxWindow* aParent, wxEvtHandler* aMouseListener,
     // Grid color settings are different in Cairo and OpenGL
     SetGridColor( COLOR4D( 0.8, 0.8, 0.8, 0.1 ) );
 
-    // Tesselator initialization
-    tesselator = gluNewTess();
-    InitTesselatorCallbacks( tesselator );
-
-    if( tesselator == NULL )
-        throw std::runtime_error( "Could not create the tesselator" );
-
-    gluTessProperty( tesselator, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_POSITIVE );
-
     currentManager = &nonCachedManager;
 }
 
@@ -119,7 +133,6 @@ OPENGL_GAL::~OPENGL_GAL()
 {
     glFlush();
 
-    gluDeleteTess( tesselator );
     ClearCache();
 }
 
@@ -221,10 +234,12 @@ void OPENGL_GAL::EndDrawing()
     SwapBuffers();
 
     delete clientDC;
+
+    reportAllocationErrors();
 }
 
 
-void OPENGL_GAL::DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+void OPENGL_GAL_BASE::DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
 {
     const VECTOR2D  startEndVector = aEndPoint - aStartPoint;
     double          lineAngle = startEndVector.Angle();
@@ -242,8 +257,8 @@ void OPENGL_GAL::DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoin
 }
 
 
-void OPENGL_GAL::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
-                              double aWidth )
+void OPENGL_GAL_BASE::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
+                                   double aWidth )
 {
     VECTOR2D startEndVector = aEndPoint - aStartPoint;
     double   lineAngle      = startEndVector.Angle();
@@ -287,7 +302,7 @@ void OPENGL_GAL::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndP
 }
 
 
-void OPENGL_GAL::DrawCircle( const VECTOR2D& aCenterPoint, double aRadius )
+void OPENGL_GAL_BASE::DrawCircle( const VECTOR2D& aCenterPoint, double aRadius )
 {
     if( isFillEnabled )
     {
@@ -345,8 +360,8 @@ void OPENGL_GAL::DrawCircle( const VECTOR2D& aCenterPoint, double aRadius )
 }
 
 
-void OPENGL_GAL::DrawArc( const VECTOR2D& aCenterPoint, double aRadius, double aStartAngle,
-                          double aEndAngle )
+void OPENGL_GAL_BASE::DrawArc( const VECTOR2D& aCenterPoint, double aRadius, double aStartAngle,
+                               double aEndAngle )
 {
     if( aRadius <= 0 )
         return;
@@ -408,7 +423,7 @@ void OPENGL_GAL::DrawArc( const VECTOR2D& aCenterPoint, double aRadius, double a
 }
 
 
-void OPENGL_GAL::DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+void OPENGL_GAL_BASE::DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
 {
     // Compute the diagonal points of the rectangle
     VECTOR2D diagonalPointA( aEndPoint.x, aStartPoint.y );
@@ -445,7 +460,7 @@ void OPENGL_GAL::DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEn
 }
 
 
-void OPENGL_GAL::DrawPolyline( std::deque<VECTOR2D>& aPointList )
+void OPENGL_GAL_BASE::DrawPolyline( std::deque<VECTOR2D>& aPointList )
 {
     if( aPointList.empty() )
         return;
@@ -473,7 +488,7 @@ void OPENGL_GAL::DrawPolyline( std::deque<VECTOR2D>& aPointList )
 }
 
 
-void OPENGL_GAL::DrawPolygon( const std::deque<VECTOR2D>& aPointList )
+void OPENGL_GAL_BASE::DrawPolygon( const std::deque<VECTOR2D>& aPointList )
 {
     // Any non convex polygon needs to be tesselated
     // for this purpose the GLU standard functions are used
@@ -505,8 +520,8 @@ void OPENGL_GAL::DrawPolygon( const std::deque<VECTOR2D>& aPointList )
 }
 
 
-void OPENGL_GAL::DrawCurve( const VECTOR2D& aStartPoint, const VECTOR2D& aControlPointA,
-                            const VECTOR2D& aControlPointB, const VECTOR2D& aEndPoint )
+void OPENGL_GAL_BASE::DrawCurve( const VECTOR2D& aStartPoint, const VECTOR2D& aControlPointA,
+                                 const VECTOR2D& aControlPointB, const VECTOR2D& aEndPoint )
 {
     // FIXME The drawing quality needs to be improved
     // FIXME Perhaps choose a quad/triangle strip instead?
@@ -598,31 +613,31 @@ void OPENGL_GAL::Transform( const MATRIX3x3D& aTransformation )
 }
 
 
-void OPENGL_GAL::Rotate( double aAngle )
+void OPENGL_GAL_BASE::Rotate( double aAngle )
 {
     currentManager->Rotate( aAngle, 0.0f, 0.0f, 1.0f );
 }
 
 
-void OPENGL_GAL::Translate( const VECTOR2D& aVector )
+void OPENGL_GAL_BASE::Translate( const VECTOR2D& aVector )
 {
     currentManager->Translate( aVector.x, aVector.y, 0.0f );
 }
 
 
-void OPENGL_GAL::Scale( const VECTOR2D& aScale )
+void OPENGL_GAL_BASE::Scale( const VECTOR2D& aScale )
 {
     currentManager->Scale( aScale.x, aScale.y, 0.0f );
 }
 
 
-void OPENGL_GAL::Save()
+void OPENGL_GAL_BASE::Save()
 {
     currentManager->PushMatrix();
 }
 
 
-void OPENGL_GAL::Restore()
+void OPENGL_GAL_BASE::Restore()
 {
     currentManager->PopMatrix();
 }
@@ -679,6 +694,30 @@ void OPENGL_GAL::ClearCache()
 }
 
 
+GAL* OPENGL_GAL::CreateWorker()
+{
+    return new OPENGL_GAL_WORKER( *this );
+}
+
+
+int OPENGL_GAL::ImportGroup( GAL* aWorker, int aGroupNumber )
+{
+    const OPENGL_GAL_WORKER* worker = static_cast<const OPENGL_GAL_WORKER*>( aWorker );
+    unsigned int size;
+    const VERTEX* vertices = worker->GetGroupVertices( aGroupNumber, size );
+
+    int groupNumber = BeginGroup();
+
+    // The errors are displayed by EndDrawing(), on the main thread
+    if( !cachedManager.CopyVertices( vertices, size ) || worker->AllocationFailed() )
+        isAllocationFailed = true;
+
+    EndGroup();
+
+    return groupNumber;
+}
+
+
 void OPENGL_GAL::SaveScreen()
 {
     wxASSERT_MSG( false, wxT( "Not implemented yet" ) );
@@ -777,7 +816,7 @@ void OPENGL_GAL::drawGridLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEnd
 }
 
 
-void OPENGL_GAL::drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+void OPENGL_GAL_BASE::drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
 {
     /* Helper drawing:                   ____--- v3       ^
      *                           ____---- ...   \          \
@@ -827,7 +866,7 @@ void OPENGL_GAL::drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEnd
 }
 
 
-void OPENGL_GAL::drawSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, double aAngle )
+void OPENGL_GAL_BASE::drawSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, double aAngle )
 {
     if( isFillEnabled )
     {
@@ -843,8 +882,8 @@ void OPENGL_GAL::drawSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, d
 }
 
 
-void OPENGL_GAL::drawFilledSemiCircle( const VECTOR2D& aCenterPoint, double aRadius,
-                                       double aAngle )
+void OPENGL_GAL_BASE::drawFilledSemiCircle( const VECTOR2D& aCenterPoint, double aRadius,
+                                            double aAngle )
 {
     Save();
     currentManager->Translate( aCenterPoint.x, aCenterPoint.y, 0.0f );
@@ -872,8 +911,8 @@ void OPENGL_GAL::drawFilledSemiCircle( const VECTOR2D& aCenterPoint, double aRad
 }
 
 
-void OPENGL_GAL::drawStrokedSemiCircle( const VECTOR2D& aCenterPoint, double aRadius,
-                                        double aAngle )
+void OPENGL_GAL_BASE::drawStrokedSemiCircle( const VECTOR2D& aCenterPoint, double aRadius,
+                                             double aAngle )
 {
     double outerRadius = aRadius + ( lineWidth / 2 );
 
@@ -943,6 +982,23 @@ void OPENGL_GAL::blitCursor()
 }
 
 
+void OPENGL_GAL::reportAllocationErrors()
+{
+    bool failed = isAllocationFailed || cachedManager.AllocationFailed()
+               || nonCachedManager.AllocationFailed() || overlayManager.AllocationFailed();
+
+    if( !failed )
+        return;
+
+    isAllocationFailed = false;
+    cachedManager.ResetAllocationFailed();
+    nonCachedManager.ResetAllocationFailed();
+    overlayManager.ResetAllocationFailed();
+
+    DisplayError( NULL, wxT( "Vertex allocation error" ) );
+}
+
+
 unsigned int OPENGL_GAL::getNewGroupNumber()
 {
     wxASSERT_MSG( groups.size() < std::numeric_limits<unsigned int>::max(),
@@ -1066,7 +1122,7 @@ void OPENGL_GAL::OPENGL_TEST::error(const std::string& aError )
 void CALLBACK VertexCallback( GLvoid* aVertexPtr, void* aData )
 {
     GLdouble* vertex = static_cast<GLdouble*>( aVertexPtr );
-    OPENGL_GAL::TessParams* param = static_cast<OPENGL_GAL::TessParams*>( aData );
+    OPENGL_GAL_BASE::TessParams* param = static_cast<OPENGL_GAL_BASE::TessParams*>( aData );
     VERTEX_MANAGER* vboManager = param->vboManager;
 
     if( vboManager )
@@ -1079,7 +1135,7 @@ void CALLBACK CombineCallback( GLdouble coords[3],
                                GLfloat weight[4], GLdouble** dataOut, void* aData )
 {
     GLdouble* vertex = new GLdouble[3];
-    OPENGL_GAL::TessParams* param = static_cast<OPENGL_GAL::TessParams*>( aData );
+    OPENGL_GAL_BASE::TessParams* param = static_cast<OPENGL_GAL_BASE::TessParams*>( aData );
 
     // Save the pointer so we can delete it later
     param->intersectPoints.push_back( boost::shared_array<GLdouble>( vertex ) );
@@ -0,0 +1,81 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file opengl_gal_worker.cpp
+ * @brief Worker GAL which tessellates groups for OPENGL_GAL on another thread.
+ */
+
+#include <gal/opengl/opengl_gal_worker.h>
+
+using namespace KIGFX;
+
+OPENGL_GAL_WORKER::OPENGL_GAL_WORKER( const GAL& aGal ) :
+    stagingManager( false, STAGING_SIZE ),
+    currentTarget( TARGET_CACHED )
+{
+    copyState( aGal );
+
+    currentManager = &stagingManager;
+}
+
+
+OPENGL_GAL_WORKER::~OPENGL_GAL_WORKER()
+{
+}
+
+
+const VERTEX* OPENGL_GAL_WORKER::GetGroupVertices( int aGroupNumber, unsigned int& aSize ) const
+{
+    const GROUP& group = groups[aGroupNumber];
+
+    aSize = group.size;
+
+    return stagingManager.GetVertices( group.offset );
+}
+
+
+int OPENGL_GAL_WORKER::BeginGroup()
+{
+    GROUP group;
+    group.offset = stagingManager.GetSize();
+    group.size = 0;
+    groups.push_back( group );
+
+    return groups.size() - 1;
+}
+
+
+void OPENGL_GAL_WORKER::EndGroup()
+{
+    GROUP& group = groups.back();
+
+    group.size = stagingManager.GetSize() - group.offset;
+}
+
+
+void OPENGL_GAL_WORKER::ClearCache()
+{
+    groups.clear();
+    stagingManager.Clear();
+}
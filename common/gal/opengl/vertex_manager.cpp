@@ -33,14 +33,14 @@
 #include <gal/opengl/noncached_container.h>
 #include <gal/opengl/gpu_manager.h>
 #include <gal/opengl/vertex_item.h>
-#include <confirm.h>
+#include <cstring>
 
 using namespace KIGFX;
 
-VERTEX_MANAGER::VERTEX_MANAGER( bool aCached ) :
-    m_noTransform( true ), m_transform( 1.0f )
+VERTEX_MANAGER::VERTEX_MANAGER( bool aCached, unsigned int aSize ) :
+    m_noTransform( true ), m_transform( 1.0f ), m_allocationFailed( false )
 {
-    m_container.reset( VERTEX_CONTAINER::MakeContainer( aCached ) );
+    m_container.reset( VERTEX_CONTAINER::MakeContainer( aCached, aSize ) );
     m_gpu.reset( GPU_MANAGER::MakeManager( m_container.get() ) );
 
     // There is no shader used by default
@@ -56,7 +56,7 @@ void VERTEX_MANAGER::Vertex( GLfloat aX, GLfloat aY, GLfloat aZ ) const
 
     if( newVertex == NULL )
     {
-        DisplayError( NULL, wxT( "Vertex allocation error" ) );
+        m_allocationFailed = true;
         return;
     }
 
@@ -71,7 +71,7 @@ void VERTEX_MANAGER::Vertices( const VERTEX aVertices[], unsigned int aSize ) co
 
     if( newVertex == NULL )
     {
-        DisplayError( NULL, wxT( "Vertex allocation error" ) );
+        m_allocationFailed = true;
         return;
     }
 
@@ -83,6 +83,25 @@ void VERTEX_MANAGER::Vertices( const VERTEX aVertices[], unsigned int aSize ) co
 }
 
 
+bool VERTEX_MANAGER::CopyVertices( const VERTEX aVertices[], unsigned int aSize ) const
+{
+    if( aSize == 0 )
+        return true;
+
+    VERTEX* newVertex = m_container->Allocate( aSize );
+
+    if( newVertex == NULL )
+    {
+        m_allocationFailed = true;
+        return false;
+    }
+
+    memcpy( newVertex, aVertices, aSize * sizeof( VERTEX ) );
+
+    return true;
+}
+
+
 void VERTEX_MANAGER::SetItem( VERTEX_ITEM& aItem ) const
 {
     m_container->SetItem( &aItem );
@@ -147,6 +166,18 @@ VERTEX* VERTEX_MANAGER::GetVertices( const VERTEX_ITEM& aItem ) const
 }
 
 
+VERTEX* VERTEX_MANAGER::GetVertices( unsigned int aOffset ) const
+{
+    return m_container->GetVertices( aOffset );
+}
+
+
+unsigned int VERTEX_MANAGER::GetSize() const
+{
+    return m_container->GetSize();
+}
+
+
 void VERTEX_MANAGER::SetShader( SHADER& aShader ) const
 {
     m_gpu->SetShader( aShader );
@@ -156,6 +187,7 @@ void VERTEX_MANAGER::SetShader( SHADER& aShader ) const
 void VERTEX_MANAGER::Clear() const
 {
     m_container->Clear();
+    m_allocationFailed = false;
 }
 
 
@@ -127,10 +127,16 @@ EDGE_PTR TRIANGULATION::InitTwoEnclosingTriangles( NODES_CONTAINER::iterator aFi
     double dx = ( xmax - xmin ) / fac;
     double dy = ( ymax - ymin ) / fac;
 
-    NODE_PTR n1 = boost::make_shared<NODE>( xmin - dx, ymin - dy );
-    NODE_PTR n2 = boost::make_shared<NODE>( xmax + dx, ymin - dy );
-    NODE_PTR n3 = boost::make_shared<NODE>( xmax + dx, ymax + dy );
-    NODE_PTR n4 = boost::make_shared<NODE>( xmin - dx, ymax + dy );
+    m_boundingNodes.clear();
+    m_boundingNodes.push_back( NODE( xmin - dx, ymin - dy ) );
+    m_boundingNodes.push_back( NODE( xmax + dx, ymin - dy ) );
+    m_boundingNodes.push_back( NODE( xmax + dx, ymax + dy ) );
+    m_boundingNodes.push_back( NODE( xmin - dx, ymax + dy ) );
+
+    NODE_PTR n1( &m_boundingNodes, 0 );
+    NODE_PTR n2( &m_boundingNodes, 1 );
+    NODE_PTR n3( &m_boundingNodes, 2 );
+    NODE_PTR n4( &m_boundingNodes, 3 );
 
     // diagonal
     EDGE_PTR e1d = boost::make_shared<EDGE>();
@@ -0,0 +1,411 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cassert>
+#include <cstdlib>
+#include <algorithm>
+
+#include <math/box2.h>
+#include <geometry/seg_batch.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_circle.h>
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+// Distances between the double precision and the exact (integer) tests differ by less than
+// 2 units (rounding of the nearest points, truncation of SHAPE_CIRCLE's distance):
+// segments farther than the clearance plus this margin can not collide.
+static const int DIST_MARGIN = 4;
+
+// Arithmetic used by the distance kernels, for one double (the scalar kernel and the last
+// segments of a batch) and for the SIMD vectors.
+static inline void vStore( double* aP, double aX )          { *aP = aX; }
+static inline double vAdd( double aA, double aB )           { return aA + aB; }
+static inline double vSub( double aA, double aB )           { return aA - aB; }
+static inline double vMul( double aA, double aB )           { return aA * aB; }
+static inline double vDiv( double aA, double aB )           { return aA / aB; }
+static inline double vMin( double aA, double aB )           { return aA < aB ? aA : aB; }
+static inline double vMax( double aA, double aB )           { return aA > aB ? aA : aB; }
+
+///> Returns 0 where aA and aB are both <= 0, aValue elsewhere
+static inline double vZeroIfBothNotPositive( double aValue, double aA, double aB )
+{
+    return ( aA <= 0.0 && aB <= 0.0 ) ? 0.0 : aValue;
+}
+
+#if defined( __AVX__ )
+
+typedef __m256d VDOUBLE;
+static const int VSIZE = 4;
+
+static inline VDOUBLE vSplat( double aX )                   { return _mm256_set1_pd( aX ); }
+static inline VDOUBLE vLoad( const double* aP )             { return _mm256_loadu_pd( aP ); }
+static inline void vStore( double* aP, VDOUBLE aX )         { _mm256_storeu_pd( aP, aX ); }
+static inline VDOUBLE vAdd( VDOUBLE aA, VDOUBLE aB )        { return _mm256_add_pd( aA, aB ); }
+static inline VDOUBLE vSub( VDOUBLE aA, VDOUBLE aB )        { return _mm256_sub_pd( aA, aB ); }
+static inline VDOUBLE vMul( VDOUBLE aA, VDOUBLE aB )        { return _mm256_mul_pd( aA, aB ); }
+static inline VDOUBLE vDiv( VDOUBLE aA, VDOUBLE aB )        { return _mm256_div_pd( aA, aB ); }
+static inline VDOUBLE vMin( VDOUBLE aA, VDOUBLE aB )        { return _mm256_min_pd( aA, aB ); }
+static inline VDOUBLE vMax( VDOUBLE aA, VDOUBLE aB )        { return _mm256_max_pd( aA, aB ); }
+
+static inline VDOUBLE vZeroIfBothNotPositive( VDOUBLE aValue, VDOUBLE aA, VDOUBLE aB )
+{
+    const VDOUBLE zero = _mm256_setzero_pd();
+    VDOUBLE mask = _mm256_and_pd( _mm256_cmp_pd( aA, zero, _CMP_LE_OQ ),
+                                  _mm256_cmp_pd( aB, zero, _CMP_LE_OQ ) );
+
+    return _mm256_andnot_pd( mask, aValue );
+}
+
+#elif defined( __SSE2__ )
+
+typedef __m128d VDOUBLE;
+static const int VSIZE = 2;
+
+static inline VDOUBLE vSplat( double aX )                   { return _mm_set1_pd( aX ); }
+static inline VDOUBLE vLoad( const double* aP )             { return _mm_loadu_pd( aP ); }
+static inline void vStore( double* aP, VDOUBLE aX )         { _mm_storeu_pd( aP, aX ); }
+static inline VDOUBLE vAdd( VDOUBLE aA, VDOUBLE aB )        { return _mm_add_pd( aA, aB ); }
+static inline VDOUBLE vSub( VDOUBLE aA, VDOUBLE aB )        { return _mm_sub_pd( aA, aB ); }
+static inline VDOUBLE vMul( VDOUBLE aA, VDOUBLE aB )        { return _mm_mul_pd( aA, aB ); }
+static inline VDOUBLE vDiv( VDOUBLE aA, VDOUBLE aB )        { return _mm_div_pd( aA, aB ); }
+static inline VDOUBLE vMin( VDOUBLE aA, VDOUBLE aB )        { return _mm_min_pd( aA, aB ); }
+static inline VDOUBLE vMax( VDOUBLE aA, VDOUBLE aB )        { return _mm_max_pd( aA, aB ); }
+
+static inline VDOUBLE vZeroIfBothNotPositive( VDOUBLE aValue, VDOUBLE aA, VDOUBLE aB )
+{
+    const VDOUBLE zero = _mm_setzero_pd();
+    VDOUBLE mask = _mm_and_pd( _mm_cmple_pd( aA, zero ), _mm_cmple_pd( aB, zero ) );
+
+    return _mm_andnot_pd( mask, aValue );
+}
+
+#else
+
+typedef double VDOUBLE;
+static const int VSIZE = 1;
+
+static inline VDOUBLE vSplat( double aX )                   { return aX; }
+static inline VDOUBLE vLoad( const double* aP )             { return *aP; }
+
+#endif
+
+
+/**
+ * Squared distance between points aP and segments (aA, aA + aD). The squared length of a
+ * segment is an integer: it is clamped to 1, which gives the distance to aA for zero-length
+ * segments.
+ */
+template <class V>
+static inline V pointDist2( V aPx, V aPy, V aAx, V aAy, V aDx, V aDy, V aZero, V aOne )
+{
+    V wx = vSub( aPx, aAx );
+    V wy = vSub( aPy, aAy );
+    V len2 = vMax( vAdd( vMul( aDx, aDx ), vMul( aDy, aDy ) ), aOne );
+
+    // parameter of the projection of aP on the segment, clamped to the segment ends
+    V t = vDiv( vAdd( vMul( wx, aDx ), vMul( wy, aDy ) ), len2 );
+    t = vMin( vMax( t, aZero ), aOne );
+
+    V ex = vSub( wx, vMul( t, aDx ) );
+    V ey = vSub( wy, vMul( t, aDy ) );
+
+    return vAdd( vMul( ex, ex ), vMul( ey, ey ) );
+}
+
+
+///> Cross product of vectors aU and aV
+template <class V>
+static inline V cross( V aUx, V aUy, V aVx, V aVy )
+{
+    return vSub( vMul( aUx, aVy ), vMul( aUy, aVx ) );
+}
+
+
+/**
+ * Squared distance between segments (aA, aA + aD) and (aQ, aQ + aE): the distance of the
+ * closest end point to the other segment, or 0 if the segments intersect.
+ */
+template <class V>
+static inline V segDist2( V aAx, V aAy, V aDx, V aDy, V aQx, V aQy, V aEx, V aEy,
+                          V aZero, V aOne )
+{
+    V bx = vAdd( aAx, aDx );
+    V by = vAdd( aAy, aDy );
+    V rx = vAdd( aQx, aEx );
+    V ry = vAdd( aQy, aEy );
+
+    V d2 = pointDist2( aQx, aQy, aAx, aAy, aDx, aDy, aZero, aOne );
+    d2 = vMin( d2, pointDist2( rx, ry, aAx, aAy, aDx, aDy, aZero, aOne ) );
+    d2 = vMin( d2, pointDist2( aAx, aAy, aQx, aQy, aEx, aEy, aZero, aOne ) );
+    d2 = vMin( d2, pointDist2( bx, by, aQx, aQy, aEx, aEy, aZero, aOne ) );
+
+    // the segments intersect if the ends of each one are on both sides of the other. Points
+    // lying on the line count as being on both sides: in doubt, the exact test is run.
+    V s1 = vMul( cross( aDx, aDy, vSub( aQx, aAx ), vSub( aQy, aAy ) ),
+                 cross( aDx, aDy, vSub( rx, aAx ), vSub( ry, aAy ) ) );
+    V s2 = vMul( cross( aEx, aEy, vSub( aAx, aQx ), vSub( aAy, aQy ) ),
+                 cross( aEx, aEy, vSub( bx, aQx ), vSub( by, aQy ) ) );
+
+    return vZeroIfBothNotPositive( d2, s1, s2 );
+}
+
+
+/**
+ * Squared distance between the bounding boxes of segments (aA, aA + aD) and the box
+ * (aMin, aMax).
+ */
+template <class V>
+static inline V boxDist2( V aAx, V aAy, V aDx, V aDy, V aMinX, V aMinY, V aMaxX, V aMaxY,
+                          V aZero )
+{
+    V bx = vAdd( aAx, aDx );
+    V by = vAdd( aAy, aDy );
+
+    V gx = vMax( vMax( vSub( aMinX, vMax( aAx, bx ) ), vSub( vMin( aAx, bx ), aMaxX ) ), aZero );
+    V gy = vMax( vMax( vSub( aMinY, vMax( aAy, by ) ), vSub( vMin( aAy, by ), aMaxY ) ), aZero );
+
+    return vAdd( vMul( gx, gx ), vMul( gy, gy ) );
+}
+
+
+bool SEG_BATCH::needsExactTest( const VECTOR2I& aD )
+{
+    int ax = std::abs( aD.x );
+    int ay = std::abs( aD.y );
+
+    // SEG::PointCloserThan() approximates the distance to nearly horizontal, vertical and
+    // diagonal segments by the distance to the closest horizontal, vertical or diagonal
+    // line, which is exact only for truly horizontal, vertical or diagonal segments.
+    bool approximated = ( ax - ay >= -1 && ax - ay <= 1 ) || ax <= 1 || ay <= 1;
+    bool exact = ax == 0 || ay == 0 || ax == ay;
+
+    return approximated && !exact;
+}
+
+
+void SEG_BATCH::Add( const SEG& aSeg )
+{
+    assert( m_count < MAX_SIZE );
+
+    m_ax[m_count] = aSeg.A.x;
+    m_ay[m_count] = aSeg.A.y;
+    m_dx[m_count] = aSeg.B.x - aSeg.A.x;
+    m_dy[m_count] = aSeg.B.y - aSeg.A.y;
+    m_count++;
+}
+
+
+int SEG_BATCH::Fill( const SHAPE_LINE_CHAIN& aChain, int aFirst )
+{
+    int last = std::min( aChain.SegmentCount(), aFirst + MAX_SIZE );
+
+    m_count = 0;
+
+    for( int i = aFirst; i < last; i++ )
+        Add( aChain.CSegment( i ) );
+
+    return last;
+}
+
+
+void SEG_BATCH::SquaredDistances( const SEG& aSeg, double* aDist ) const
+{
+    VECTOR2I e = aSeg.B - aSeg.A;
+    int i = 0;
+
+    if( VSIZE > 1 )
+    {
+        const VDOUBLE qx = vSplat( aSeg.A.x ), qy = vSplat( aSeg.A.y );
+        const VDOUBLE ex = vSplat( e.x ), ey = vSplat( e.y );
+        const VDOUBLE zero = vSplat( 0.0 ), one = vSplat( 1.0 );
+
+        for( ; i + VSIZE <= m_count; i += VSIZE )
+        {
+            vStore( aDist + i, segDist2( vLoad( m_ax + i ), vLoad( m_ay + i ),
+                                         vLoad( m_dx + i ), vLoad( m_dy + i ),
+                                         qx, qy, ex, ey, zero, one ) );
+        }
+    }
+
+    for( ; i < m_count; i++ )
+    {
+        aDist[i] = segDist2( m_ax[i], m_ay[i], m_dx[i], m_dy[i],
+                             (double) aSeg.A.x, (double) aSeg.A.y, (double) e.x, (double) e.y,
+                             0.0, 1.0 );
+    }
+}
+
+
+void SEG_BATCH::SquaredDistances( const VECTOR2I& aP, double* aDist ) const
+{
+    int i = 0;
+
+    if( VSIZE > 1 )
+    {
+        const VDOUBLE px = vSplat( aP.x ), py = vSplat( aP.y );
+        const VDOUBLE zero = vSplat( 0.0 ), one = vSplat( 1.0 );
+
+        for( ; i + VSIZE <= m_count; i += VSIZE )
+        {
+            vStore( aDist + i, pointDist2( px, py, vLoad( m_ax + i ), vLoad( m_ay + i ),
+                                           vLoad( m_dx + i ), vLoad( m_dy + i ), zero, one ) );
+        }
+    }
+
+    for( ; i < m_count; i++ )
+    {
+        aDist[i] = pointDist2( (double) aP.x, (double) aP.y, m_ax[i], m_ay[i], m_dx[i], m_dy[i],
+                               0.0, 1.0 );
+    }
+}
+
+
+bool SEG_BATCH::boxCandidates( const VECTOR2I& aMin, const VECTOR2I& aMax, int aDist,
+                               bool* aCandidates ) const
+{
+    double box[MAX_SIZE];
+    int i = 0;
+
+    if( VSIZE > 1 )
+    {
+        const VDOUBLE minX = vSplat( aMin.x ), minY = vSplat( aMin.y );
+        const VDOUBLE maxX = vSplat( aMax.x ), maxY = vSplat( aMax.y );
+        const VDOUBLE zero = vSplat( 0.0 );
+
+        for( ; i + VSIZE <= m_count; i += VSIZE )
+        {
+            vStore( box + i, boxDist2( vLoad( m_ax + i ), vLoad( m_ay + i ),
+                                       vLoad( m_dx + i ), vLoad( m_dy + i ),
+                                       minX, minY, maxX, maxY, zero ) );
+        }
+    }
+
+    for( ; i < m_count; i++ )
+    {
+        box[i] = boxDist2( m_ax[i], m_ay[i], m_dx[i], m_dy[i], (double) aMin.x, (double) aMin.y,
+                           (double) aMax.x, (double) aMax.y, 0.0 );
+    }
+
+    // one unit more than the distance: the squares are not exact in double precision
+    double limit = std::abs( (double) aDist ) + 1.0;
+    bool any = false;
+
+    limit *= limit;
+
+    for( i = 0; i < m_count; i++ )
+    {
+        aCandidates[i] = box[i] <= limit;
+        any |= aCandidates[i];
+    }
+
+    return any;
+}
+
+
+int SEG_BATCH::Collide( const SEG& aSeg, int aClearance ) const
+{
+    BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
+
+    // no bounding box is closer than 0
+    if( m_count == 0 || dist_sq == 0 )
+        return -1;
+
+    const BOX2I box( aSeg.A, aSeg.B - aSeg.A );
+    bool candidates[MAX_SIZE];
+
+    // most segments are rejected by their bounding boxes, as SHAPE_LINE_CHAIN::Collide() does
+    if( !boxCandidates( box.GetOrigin(), box.GetEnd(), aClearance, candidates ) )
+        return -1;
+
+    // then by their distance, unless the segment itself gets an approximated test
+    double dist[MAX_SIZE];
+    bool exact = needsExactTest( aSeg.B - aSeg.A );
+    double limit = std::abs( (double) aClearance ) + DIST_MARGIN;
+
+    if( !exact )
+        SquaredDistances( aSeg, dist );
+
+    limit *= limit;
+
+    for( int i = 0; i < m_count; i++ )
+    {
+        if( !candidates[i] )
+            continue;
+
+        const SEG s = Segment( i );
+
+        if( !exact && dist[i] > limit && !needsExactTest( s.B - s.A ) )
+            continue;
+
+        if( box.SquaredDistance( BOX2I( s.A, s.B - s.A ) ) < dist_sq && s.Collide( aSeg, aClearance ) )
+            return i;
+    }
+
+    return -1;
+}
+
+
+int SEG_BATCH::Collide( const SHAPE_CIRCLE& aCircle, int aClearance ) const
+{
+    if( m_count == 0 )
+        return -1;
+
+    const VECTOR2I c = aCircle.GetCenter();
+    int rc = std::max( aCircle.GetRadius() + aClearance, 0 );
+    bool candidates[MAX_SIZE];
+
+    // the test is SEG::Distance() <= rc, the distance being truncated
+    if( !boxCandidates( c, c, rc + DIST_MARGIN, candidates ) )
+        return -1;
+
+    double dist[MAX_SIZE];
+    double limit = (double) rc + DIST_MARGIN;
+
+    SquaredDistances( c, dist );
+    limit *= limit;
+
+    for( int i = 0; i < m_count; i++ )
+    {
+        if( candidates[i] && dist[i] <= limit && aCircle.Collide( Segment( i ), aClearance ) )
+            return i;
+    }
+
+    return -1;
+}
+
+
+const char* SEG_BATCH::KernelName()
+{
+#if defined( __AVX__ )
+    return "AVX";
+#elif defined( __SSE2__ )
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -30,6 +30,7 @@
 #include <geometry/shape_circle.h>
 #include <geometry/shape_rect.h>
 #include <geometry/shape_segment.h>
+#include <geometry/seg_batch.h>
 
 typedef VECTOR2I::extended_type ecoord;
 
@@ -137,14 +138,12 @@ static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_LINE_CHAIN& aB,
                             bool aNeedMTV, VECTOR2I& aMTV )
 {
     bool found = false;
+    SEG_BATCH batch;
 
-    for( int s = 0; s < aB.SegmentCount(); s++ )
+    for( int s = 0; s < aB.SegmentCount() && !found; )
     {
-        if( aA.Collide( aB.CSegment( s ), aClearance ) )
-        {
-            found = true;
-            break;
-        }
+        s = batch.Fill( aB, s );
+        found = batch.Collide( aA, aClearance ) >= 0;
     }
 
     if( !aNeedMTV || !found )
@@ -181,9 +180,19 @@ static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_SEGMENT& aSeg, i
 static inline bool Collide( const SHAPE_LINE_CHAIN& aA, const SHAPE_LINE_CHAIN& aB, int aClearance,
                             bool aNeedMTV, VECTOR2I& aMTV )
 {
-    for( int i = 0; i < aB.SegmentCount(); i++ )
-        if( aA.Collide( aB.CSegment( i ), aClearance ) )
-            return true;
+    SEG_BATCH batch;
+
+    // each batch of segments of aA is tested against all the segments of aB
+    for( int i = 0; i < aA.SegmentCount(); )
+    {
+        i = batch.Fill( aA, i );
+
+        for( int j = 0; j < aB.SegmentCount(); j++ )
+        {
+            if( batch.Collide( aB.CSegment( j ), aClearance ) >= 0 )
+                return true;
+        }
+    }
 
     return false;
 }
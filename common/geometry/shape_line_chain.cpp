@@ -24,6 +24,7 @@
 
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_circle.h>
+#include <geometry/seg_batch.h>
 
 using boost::optional;
 
@@ -37,21 +38,15 @@ bool SHAPE_LINE_CHAIN::Collide( const VECTOR2I& aP, int aClearance ) const
 
 bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance ) const
 {
-    BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
-    BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
+    SEG_BATCH batch;
 
-    for( int i = 0; i < SegmentCount(); i++ )
+    // test the segments by batches, the far ones are rejected several at once
+    for( int i = 0; i < SegmentCount(); )
     {
-        const SEG& s = CSegment( i );
-        BOX2I box_b( s.A, s.B - s.A );
-
-        BOX2I::ecoord_type d = box_a.SquaredDistance( box_b );
+        i = batch.Fill( *this, i );
 
-        if( d < dist_sq )
-        {
-            if( s.Collide( aSeg, aClearance ) )
-                return true;
-        }
+        if( batch.Collide( aSeg, aClearance ) >= 0 )
+            return true;
     }
 
     return false;
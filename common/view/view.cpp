@@ -33,6 +33,7 @@
 #include <gal/definitions.h>
 #include <gal/graphics_abstraction_layer.h>
 #include <painter.h>
+#include <task_queue.h>
 
 #ifdef PROFILE
 #include <profile.h>
@@ -44,6 +45,8 @@ VIEW::VIEW( bool aIsDynamic ) :
     m_enableOrderModifier( true ),
     m_scale( 4.0 ),
     m_minScale( 4.0 ), m_maxScale( 15000 ),
+    m_detailThreshold( 0.0 ),
+    m_detailLevel( 0 ),
     m_painter( NULL ),
     m_gal( NULL ),
     m_dynamic( aIsDynamic )
@@ -135,10 +138,7 @@ void VIEW::Remove( VIEW_ITEM* aItem )
         MarkTargetDirty( l.target );
 
         // Clear the GAL cache
-        int prevGroup = aItem->getGroup( layers[i] );
-
-        if( prevGroup >= 0 )
-            m_gal->DeleteGroup( prevGroup );
+        deleteGroups( aItem, layers[i] );
     }
 
     aItem->deleteGroups();
@@ -310,6 +310,7 @@ void VIEW::SetScale( double aScale, const VECTOR2D& aAnchor )
 
     m_gal->SetZoomFactor( m_scale );
     m_gal->ComputeWorldScreenMatrix();
+    updateDetailLevel();
 
     VECTOR2D delta = ToWorld( a ) - aAnchor;
 
@@ -398,10 +399,14 @@ struct VIEW::updateItemsColor
     {
         // Obtain the color that should be used for coloring the item
         const COLOR4D color = painter->GetSettings()->GetColor( aItem, layer );
-        int group = aItem->getGroup( layer );
 
-        if( group >= 0 )
-            gal->ChangeGroupColor( group, color );
+        for( int level = 0; level <= MAX_DETAIL_LEVEL; ++level )
+        {
+            int group = aItem->getGroup( detailGroupKey( layer, level ) );
+
+            if( group >= 0 )
+                gal->ChangeGroupColor( group, color );
+        }
 
         return true;
     }
@@ -459,10 +464,13 @@ struct VIEW::changeItemsDepth
 
     bool operator()( VIEW_ITEM* aItem )
     {
-        int group = aItem->getGroup( layer );
+        for( int level = 0; level <= MAX_DETAIL_LEVEL; ++level )
+        {
+            int group = aItem->getGroup( detailGroupKey( layer, level ) );
 
-        if( group >= 0 )
-            gal->ChangeGroupDepth( group, depth );
+            if( group >= 0 )
+                gal->ChangeGroupDepth( group, depth );
+        }
 
         return true;
     }
@@ -623,7 +631,8 @@ void VIEW::draw( VIEW_ITEM* aItem, int aLayer, bool aImmediate )
     if( IsCached( aLayer ) && !aImmediate )
     {
         // Draw using cached information or create one
-        int group = aItem->getGroup( aLayer );
+        int key = groupKey( aItem, aLayer );
+        int group = aItem->getGroup( key );
 
         if( group >= 0 )
         {
@@ -632,7 +641,7 @@ void VIEW::draw( VIEW_ITEM* aItem, int aLayer, bool aImmediate )
         else
         {
             group = m_gal->BeginGroup();
-            aItem->setGroup( aLayer, group );
+            aItem->setGroup( key, group );
 
             if( !m_painter->Draw( aItem, aLayer ) )
                 aItem->ViewDraw( aLayer, m_gal ); // Alternative drawing method
@@ -695,16 +704,13 @@ struct VIEW::recacheItem
 
     bool operator()( VIEW_ITEM* aItem )
     {
-        // Remove previously cached group
-        int group = aItem->getGroup( layer );
-
-        if( group >= 0 )
-            gal->DeleteGroup( group );
+        // Remove previously cached groups
+        view->deleteGroups( aItem, layer );
 
         if( immediately )
         {
-            group = gal->BeginGroup();
-            aItem->setGroup( layer, group );
+            int group = gal->BeginGroup();
+            aItem->setGroup( view->groupKey( aItem, layer ), group );
 
             if( !view->m_painter->Draw( aItem, layer ) )
                 aItem->ViewDraw( layer, gal ); // Alternative drawing method
@@ -727,6 +733,100 @@ struct VIEW::recacheItem
 };
 
 
+struct VIEW::recacheJob
+{
+    VIEW_ITEM*  item;
+    VIEW_LAYER* layer;
+    int         worker;     ///< worker which drew the item, -1 if the painter could not do it
+    int         group;      ///< group number in the worker
+    int         key;        ///< key under which the group is stored in the item
+};
+
+
+struct VIEW::collectRecacheJobs
+{
+    collectRecacheJobs( VIEW* aView, VIEW_LAYER* aLayer, std::vector<recacheJob>& aJobs ) :
+        view( aView ), layer( aLayer ), jobs( aJobs )
+    {
+    }
+
+    bool operator()( VIEW_ITEM* aItem )
+    {
+        // Remove previously cached groups
+        view->deleteGroups( aItem, layer->id );
+
+        recacheJob job = { aItem, layer, -1, -1, view->groupKey( aItem, layer->id ) };
+        jobs.push_back( job );
+
+        return true;
+    }
+
+    VIEW* view;
+    VIEW_LAYER* layer;
+    std::vector<recacheJob>& jobs;
+};
+
+
+struct VIEW::recacheTask
+{
+    recacheTask( std::vector<recacheJob>& aJobs, std::vector<GAL*>& aGals,
+                 std::vector<PAINTER*>& aPainters ) :
+        jobs( aJobs ), gals( aGals ), painters( aPainters ), next( 0 )
+    {
+    }
+
+    ///> Each task draws with its own worker, the jobs are shared in chunks
+    void operator()( int aTask )
+    {
+        GAL* gal = gals[aTask];
+        PAINTER* painter = painters[aTask];
+
+        for( ;; )
+        {
+            unsigned int first;
+
+            {
+                MUTLOCK lock( nextLock );
+
+                first = next;
+                next += CHUNK_SIZE;
+            }
+
+            if( first >= jobs.size() )
+                return;
+
+            unsigned int last = std::min<unsigned int>( first + CHUNK_SIZE, jobs.size() );
+
+            for( unsigned int i = first; i < last; ++i )
+            {
+                recacheJob& job = jobs[i];
+
+                gal->SetLayerDepth( job.layer->renderingOrder );
+                int group = gal->BeginGroup();
+
+                if( painter->Draw( job.item, job.layer->id ) )
+                {
+                    job.worker = aTask;
+                    job.group = group;
+                }
+
+                gal->EndGroup();
+            }
+        }
+    }
+
+    static const unsigned int CHUNK_SIZE = 256;
+
+    std::vector<recacheJob>& jobs;
+    std::vector<GAL*>& gals;
+    std::vector<PAINTER*>& painters;
+
+    ///> Index of the first job which is not drawn yet, protected by nextLock
+    unsigned int next;
+    MUTEX nextLock;
+};
+
+
 void VIEW::Clear()
 {
     BOX2I r;
@@ -784,6 +884,9 @@ void VIEW::Redraw()
                    ToWorld( screenSize ) - ToWorld( VECTOR2D( 0, 0 ) ) );
     rect.Normalize();
 
+    // The painter settings may have been replaced since the last change of scale
+    updateDetailLevel();
+
     redrawRect( rect );
 
     // All targets were redrawn, so nothing is dirty
@@ -885,6 +988,66 @@ void VIEW::sortLayers()
 }
 
 
+void VIEW::SetDetailThreshold( double aPixelSize )
+{
+    m_detailThreshold = aPixelSize;
+
+    updateDetailLevel();
+    MarkDirty();
+}
+
+
+void VIEW::updateDetailLevel()
+{
+    int level = 0;
+    double detailSize = 0.0;
+
+    if( m_detailThreshold > 0.0 && m_gal )
+    {
+        // Each level of detail covers a 4 times larger range of pixel sizes than the previous
+        double pixelSize = 1.0 / m_gal->GetWorldScale();
+        double bandStart = m_detailThreshold;
+
+        while( level < MAX_DETAIL_LEVEL && pixelSize >= bandStart )
+        {
+            detailSize = bandStart;
+            bandStart *= 4.0;
+            ++level;
+        }
+    }
+
+    m_detailLevel = level;
+
+    if( m_painter )
+        m_painter->GetSettings()->SetDetailLevel( level, detailSize );
+}
+
+
+int VIEW::groupKey( const VIEW_ITEM* aItem, int aLayer ) const
+{
+    if( m_detailLevel > 0 && m_painter->HasDetailLevels( aItem, aLayer ) )
+        return detailGroupKey( aLayer, m_detailLevel );
+
+    return aLayer;
+}
+
+
+void VIEW::deleteGroups( VIEW_ITEM* aItem, int aLayer )
+{
+    for( int level = 0; level <= MAX_DETAIL_LEVEL; ++level )
+    {
+        int key = detailGroupKey( aLayer, level );
+        int group = aItem->getGroup( key );
+
+        if( group >= 0 )
+        {
+            m_gal->DeleteGroup( group );
+            aItem->setGroup( key, -1 );
+        }
+    }
+}
+
+
 void VIEW::updateItemColor( VIEW_ITEM* aItem, int aLayer )
 {
     wxASSERT( (unsigned) aLayer < m_layers.size() );
@@ -892,11 +1055,15 @@ void VIEW::updateItemColor( VIEW_ITEM* aItem, int aLayer )
 
     // Obtain the color that should be used for coloring the item on the specific layerId
     const COLOR4D color = m_painter->GetSettings()->GetColor( aItem, aLayer );
-    int group = aItem->getGroup( aLayer );
 
-    // Change the color, only if it has group assigned
-    if( group >= 0 )
-        m_gal->ChangeGroupColor( group, color );
+    for( int level = 0; level <= MAX_DETAIL_LEVEL; ++level )
+    {
+        int group = aItem->getGroup( detailGroupKey( aLayer, level ) );
+
+        // Change the color, only if it has group assigned
+        if( group >= 0 )
+            m_gal->ChangeGroupColor( group, color );
+    }
 }
 
 
@@ -910,14 +1077,11 @@ void VIEW::updateItemGeometry( VIEW_ITEM* aItem, int aLayer )
     m_gal->SetTarget( l.target );
     m_gal->SetLayerDepth( l.renderingOrder );
 
-    // Redraw the item from scratch
-    int group = aItem->getGroup( aLayer );
+    // Redraw the item from scratch, the other levels of detail are redrawn when needed
+    deleteGroups( aItem, aLayer );
 
-    if( group >= 0 )
-        m_gal->DeleteGroup( group );
-
-    group = m_gal->BeginGroup();
-    aItem->setGroup( aLayer, group );
+    int group = m_gal->BeginGroup();
+    aItem->setGroup( groupKey( aItem, aLayer ), group );
 
     if( !m_painter->Draw( static_cast<EDA_ITEM*>( aItem ), aLayer ) )
         aItem->ViewDraw( aLayer, m_gal ); // Alternative drawing method
@@ -958,13 +1122,7 @@ void VIEW::updateLayers( VIEW_ITEM* aItem )
         if( IsCached( l.id ) )
         {
             // Redraw the item from scratch
-            int prevGroup = aItem->getGroup( layers[i] );
-
-            if( prevGroup >= 0 )
-            {
-                m_gal->DeleteGroup( prevGroup );
-                aItem->setGroup( l.id, -1 );
-            }
+            deleteGroups( aItem, layers[i] );
         }
     }
 
@@ -999,28 +1157,136 @@ bool VIEW::areRequiredLayersEnabled( int aLayerId ) const
 }
 
 
-void VIEW::RecacheAllItems( bool aImmediately )
+bool VIEW::recacheParallel()
 {
-    BOX2I r;
+    int threadCount = DefaultThreadCount();
 
-    r.SetMaximum();
+    std::vector<GAL*> gals;
+    std::vector<PAINTER*> painters;
+
+    // Each thread needs its own GAL and painter, as they store the drawing state
+    for( int i = 0; i < threadCount; ++i )
+    {
+        GAL* gal = m_gal->CreateWorker();
+        PAINTER* painter = gal ? m_painter->CreateWorker( gal ) : NULL;
+
+        if( !painter )
+        {
+            delete gal;
+            break;
+        }
+
+        gals.push_back( gal );
+        painters.push_back( painter );
+    }
+
+    if( gals.empty() )
+        return false;
 
 #ifdef PROFILE
-    prof_counter totalRealTime;
-    prof_start( &totalRealTime );
+    prof_counter tessellationTime, uploadTime;
+    prof_start( &tessellationTime );
 #endif /* PROFILE */
 
+    BOX2I r;
+    r.SetMaximum();
+
+    std::vector<recacheJob> jobs;
+
     for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
     {
         VIEW_LAYER* l = &( ( *i ).second );
 
         if( IsCached( l->id ) )
         {
-            m_gal->SetTarget( l->target );
-            m_gal->SetLayerDepth( l->renderingOrder );
-            recacheItem visitor( this, m_gal, l->id, aImmediately );
+            collectRecacheJobs visitor( this, l, jobs );
             l->items->Query( r, visitor );
-            MarkTargetDirty( l->target );
+        }
+    }
+
+    recacheTask task( jobs, gals, painters );
+    TASK_QUEUE<recacheTask>( task, (int) gals.size() ).Run( (int) gals.size() );
+
+#ifdef PROFILE
+    prof_end( &tessellationTime );
+    prof_start( &uploadTime );
+#endif /* PROFILE */
+
+    // Groups are created in the same order as the serial recaching does
+    VIEW_LAYER* layer = NULL;
+
+    for( unsigned int i = 0; i < jobs.size(); ++i )
+    {
+        const recacheJob& job = jobs[i];
+        int group;
+
+        if( job.layer != layer )
+        {
+            layer = job.layer;
+            m_gal->SetTarget( layer->target );
+            m_gal->SetLayerDepth( layer->renderingOrder );
+            MarkTargetDirty( layer->target );
+        }
+
+        if( job.worker >= 0 )
+        {
+            group = m_gal->ImportGroup( gals[job.worker], job.group );
+        }
+        else
+        {
+            group = m_gal->BeginGroup();
+            job.item->ViewDraw( layer->id, m_gal );     // Alternative drawing method
+            m_gal->EndGroup();
+        }
+
+        job.item->setGroup( job.key, group );
+    }
+
+    for( unsigned int i = 0; i < gals.size(); ++i )
+    {
+        delete painters[i];
+        delete gals[i];
+    }
+
+#ifdef PROFILE
+    prof_end( &uploadTime );
+
+    wxLogDebug( wxT( "RecacheAllItems: %u items, %u threads, tessellation %.1f ms, "
+                     "upload %.1f ms" ), (unsigned) jobs.size(), (unsigned) gals.size(),
+                tessellationTime.msecs(), uploadTime.msecs() );
+#endif /* PROFILE */
+
+    return true;
+}
+
+
+void VIEW::RecacheAllItems( bool aImmediately )
+{
+    BOX2I r;
+
+    r.SetMaximum();
+
+#ifdef PROFILE
+    prof_counter totalRealTime;
+    prof_start( &totalRealTime );
+#endif /* PROFILE */
+
+    updateDetailLevel();
+
+    if( !aImmediately || !recacheParallel() )
+    {
+        for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
+        {
+            VIEW_LAYER* l = &( ( *i ).second );
+
+            if( IsCached( l->id ) )
+            {
+                m_gal->SetTarget( l->target );
+                m_gal->SetLayerDepth( l->renderingOrder );
+                recacheItem visitor( this, m_gal, l->id, aImmediately );
+                l->items->Query( r, visitor );
+                MarkTargetDirty( l->target );
+            }
         }
     }
 
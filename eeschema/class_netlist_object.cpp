@@ -51,7 +51,16 @@ bool IsBusLabel( const wxString& aLabel )
     wxCHECK_MSG( busLabelRe.IsValid(), false,
                  wxT( "Invalid regular expression in IsBusLabel()." ) );
 
-    return busLabelRe.Matches( aLabel );
+    bool isBusLabel;
+
+    // busLabelRe stores the result of the last match, so it cannot be used
+    // by several threads at the same time
+#ifdef USE_OPENMP
+    #pragma omp critical( busLabelRe )
+#endif /* USE_OPENMP */
+    isBusLabel = busLabelRe.Matches( aLabel );
+
+    return isBusLabel;
 }
 
 
@@ -253,8 +262,15 @@ void NETLIST_OBJECT::ConvertBusToNetListItems( NETLIST_OBJECT_LIST& aNetListItem
     wxString tmp, busName, busNumber;
     long begin, end, member;
 
-    busName = busLabelRe.GetMatch( m_Label, 1 );
-    busNumber = busLabelRe.GetMatch( m_Label, 2 );
+    // Match again: the last match of busLabelRe can be another label
+#ifdef USE_OPENMP
+    #pragma omp critical( busLabelRe )
+#endif /* USE_OPENMP */
+    {
+        busLabelRe.Matches( m_Label );
+        busName = busLabelRe.GetMatch( m_Label, 1 );
+        busNumber = busLabelRe.GetMatch( m_Label, 2 );
+    }
 
     /* Search for  '[' because a bus label is like "busname[nn..mm]" */
     i = busNumber.Find( '[' );
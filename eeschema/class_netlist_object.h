@@ -37,6 +37,8 @@
 #include <sch_item_struct.h>
 
 class NETLIST_OBJECT_LIST;
+class NETLIST_CONNECTION_GRID;
+class NETLIST_SHEET_CACHE;
 class SCH_COMPONENT;
 
 
@@ -276,6 +278,12 @@ class NETLIST_OBJECT_LIST : public NETLIST_OBJECTS
     int m_lastBusNetCode;   // Used in intermediate calculation:
                             // last net code created for bus members
 
+    // Union-find forests of the net codes (and bus net codes) merged while searching
+    // physical connections: m_netCodeParents[code] is the code it was merged into.
+    // Codes not yet stored are not merged.
+    std::vector<int> m_netCodeParents;
+    std::vector<int> m_busNetCodeParents;
+
 public:
     /**
      * Constructor.
@@ -299,10 +307,20 @@ public:
      * the master function of tgis class.
      * Build the list of connected objects (pins, labels ...) and
      * all info to generate netlists or run ERC diags
+     * With a cache, the items of each sheet are extracted and connected on several
+     * threads, then the connections between sheets are found.
+     * The result (items order and net codes) is the same with and without cache.
      * @param aSheets = the flattened sheet list
+     * @param aCache = the items of the sheets not modified since the previous call
+     *                 are taken from this cache, which is updated for the other sheets
+     *                 (can be NULL to rebuild and connect all the sheets at once)
+     * @param aUseGrid = false to find the physical connections without cache by scanning
+     *                   all the items of the sheet for each item, as before the connection
+     *                   grid (the reference of the grid, used to check it)
      * @return true if OK, false is not item found
      */
-    bool BuildNetListInfo( SCH_SHEET_LIST& aSheets );
+    bool BuildNetListInfo( SCH_SHEET_LIST& aSheets, NETLIST_SHEET_CACHE* aCache = NULL,
+                           bool aUseGrid = true );
 
     /**
      * Acces to an item in list
@@ -382,6 +400,10 @@ public:
     #endif
 
 private:
+    // The tasks of gatherCachedSheetItems() build and connect the sheet items
+    friend struct SHEET_BUILD_TASK;
+    friend struct SHEET_CONNECT_TASK;
+
     /*
      * Propagate aNewNetCode to items having an internal netcode aOldNetCode
      * used to interconnect group of items already physically connected,
@@ -416,16 +438,77 @@ private:
      */
     void sheetLabelConnect( NETLIST_OBJECT* aSheetLabel );
 
-    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start );
+    /*
+     * Append the items of aSheet, in drawing list order.
+     */
+    void buildSheetItems( SCH_SHEET_PATH* aSheet );
+
+    /*
+     * Fill this (empty) list with the items of aSheets, sorted by sheet, and connected:
+     * same result as building and connecting all the items, but the items and the
+     * connections of the unmodified sheets are taken from aCache.
+     */
+    void gatherCachedSheetItems( const std::vector<SCH_SHEET_PATH*>& aSheets,
+                                 NETLIST_SHEET_CACHE& aCache );
+
+    /*
+     * Find the physical connections (wires, buses, junctions ...) between items,
+     * and give a net code (from 1) to each group of connected items.
+     * The list is expected sorted by sheet.
+     */
+    void connectSheetItems();
+
+    /*
+     * Same as connectSheetItems(), without the connection grid nor the union-find of the
+     * net codes: each item is tested against all the next items of its sheet, and net
+     * codes are propagated to the whole list on each merge.  Much slower, only used as
+     * a reference.
+     */
+    void connectSheetItemsBySweep();
+
+    /*
+     * Append copies of the items of aSheetItems (built by buildSheetItems()),
+     * with net codes shifted after the net codes already used in this list.
+     */
+    void appendSheetItems( const NETLIST_OBJECT_LIST& aSheetItems );
+
+    /*
+     * Find the net code aCode is merged into (aIsBus = true for bus net codes),
+     * i.e. the net code an item having aCode now belongs to.
+     * Used only while searching physical connections.
+     */
+    int findNetCode( int aCode, bool aIsBus );
+
+    /*
+     * Merge the net code aOldNetCode into aNewNetCode: same result as
+     * propageNetCode(), without walking the list. Both codes must be
+     * returned by findNetCode().
+     */
+    void mergeNetCodes( int aOldNetCode, int aNewNetCode, bool aIsBus );
+
+    /*
+     * Search connections between end points of aRef and end points of other items
+     * of its sheet, found in aGrid, and merge their net codes.
+     */
+    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
+                              const NETLIST_CONNECTION_GRID& aGrid );
 
     /*
      * Search connections betweena junction and segments
      * Propagate the junction net code to objects connected by this junction.
      * The junction must have a valid net code
-     * The list of objects is expected sorted by sheets.
-     * Search is done from index aIdxStart to the last element of list
+     * The segments are the segments of the junction sheet, found in aGrid.
+     */
+    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus,
+                                const NETLIST_CONNECTION_GRID& aGrid );
+
+    /*
+     * Reference versions of the two functions above, for connectSheetItemsBySweep():
+     * the candidates are all the items of the sheet from index aIdxStart, and the net
+     * codes are merged by propageNetCode().
      */
-    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus, int aIdxStart );
+    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, unsigned aIdxStart );
+    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus, unsigned aIdxStart );
 
     void connectBusLabels();
 
@@ -453,6 +536,84 @@ private:
 };
 
 
+/**
+ * Class NETLIST_SHEET_CACHE
+ * keeps the netlist items of each sheet of a hierarchy, and their physical connections,
+ * so NETLIST_OBJECT_LIST::BuildNetListInfo() only rebuilds and connects again the items
+ * of the sheets modified since its previous call.
+ * An entry is valid while the modify stamp of the sheet screen is unchanged, and the
+ * whole cache is cleared when the libraries are modified.
+ */
+class NETLIST_SHEET_CACHE
+{
+public:
+    NETLIST_SHEET_CACHE();
+    ~NETLIST_SHEET_CACHE();
+
+    /**
+     * Function Clear
+     * removes all the entries.
+     */
+    void Clear();
+
+    /**
+     * Function SetLibrariesModifyHash
+     * clears the cache if aHash (a PART_LIBS::GetModifyHash() value) is not the value
+     * used to build its entries: pins and power labels come from the library parts.
+     */
+    void SetLibrariesModifyHash( int aHash );
+
+    /**
+     * Function Find
+     * @return the items of aSheet, in drawing list order, if they are still valid, or NULL.
+     */
+    const NETLIST_OBJECT_LIST* Find( const SCH_SHEET_PATH& aSheet );
+
+    /**
+     * Function Store
+     * replaces the items of aSheet, built from the current state of its screen.
+     * The cache takes ownership of aItems.
+     */
+    void Store( const SCH_SHEET_PATH& aSheet, NETLIST_OBJECT_LIST* aItems );
+
+    /**
+     * Function FindConnected
+     * @return the items of aSheet with their physical connections, or NULL if they
+     *         were not connected since the last Store() call.
+     */
+    const NETLIST_OBJECT_LIST* FindConnected( const SCH_SHEET_PATH& aSheet );
+
+    /**
+     * Function StoreConnected
+     * keeps aConnected, the copies of the items of aSheet, in the same order, connected.
+     * The items of aSheet must be stored.  The cache takes ownership of aConnected.
+     */
+    void StoreConnected( const SCH_SHEET_PATH& aSheet, NETLIST_OBJECT_LIST* aConnected );
+
+    /**
+     * Function RemoveUnused
+     * removes the entries not found nor stored since the previous call,
+     * i.e. the entries of sheets which are no longer in the hierarchy.
+     */
+    void RemoveUnused();
+
+private:
+    struct ENTRY
+    {
+        SCH_SHEET_PATH          m_sheet;
+        unsigned                m_modifyStamp;  // modify stamp of the sheet screen
+        NETLIST_OBJECT_LIST*    m_items;        // items in drawing list order
+        NETLIST_OBJECT_LIST*    m_connected;    // copies of m_items, connected
+        bool                    m_used;
+    };
+
+    ENTRY* findEntry( const SCH_SHEET_PATH& aSheet );
+
+    std::vector<ENTRY*>     m_entries;
+    int                     m_libModifyHash;
+};
+
+
 /**
  * Function IsBusLabel
  * test if \a aLabel has a bus notation.
@@ -46,10 +46,206 @@
 #include <algorithm>
 #include <invoke_sch_dialog.h>
 #include <boost/foreach.hpp>
+#include <boost/unordered_map.hpp>
+#include <task_queue.h>
 
 #define IS_WIRE false
 #define IS_BUS true
 
+// Size of the cells of NETLIST_CONNECTION_GRID, in internal units (mils)
+#define CONNECTION_GRID_CELL_SIZE   500
+
+// Segments covering more cells than this are not bucketed, but tested for every point
+#define CONNECTION_GRID_MAX_CELLS   256
+
+/**
+ * When this trace mask is enabled (WXTRACE=KISCHNETLISTCACHE), each netlist built
+ * from the sheet cache is compared to the netlist built without cache.
+ */
+static const wxChar traceNetlistCache[] = wxT( "KISCHNETLISTCACHE" );
+
+
+/**
+ * Class NETLIST_CONNECTION_GRID
+ * buckets the items of one sheet in a hash grid, to find the items which can be
+ * connected to a point without scanning all the items of the sheet.
+ * Items are stored by their index in the NETLIST_OBJECT_LIST.
+ */
+class NETLIST_CONNECTION_GRID
+{
+public:
+    /**
+     * Function Build
+     * fills the grid with the items of aList belonging to aSheet, from index aStart
+     * to the end of the list (the physical connections of an item are searched
+     * in this range).
+     */
+    void Build( const NETLIST_OBJECT_LIST& aList, unsigned aStart, const SCH_SHEET_PATH& aSheet );
+
+    /**
+     * Function QueryPoints
+     * collects the items having an end point in the cell of aPos, and which are
+     * connected by their end points (wire items or bus items, depending on aIsBus).
+     */
+    void QueryPoints( const wxPoint& aPos, bool aIsBus, std::vector<unsigned>& aResult ) const
+    {
+        query( aIsBus ? m_busPoints : m_wirePoints, aPos, aResult );
+    }
+
+    /**
+     * Function QuerySegments
+     * collects the wires (or buses, if aIsBus is true) which can contain aPos.
+     */
+    void QuerySegments( const wxPoint& aPos, bool aIsBus, std::vector<unsigned>& aResult ) const
+    {
+        query( aIsBus ? m_buses : m_wires, aPos, aResult );
+
+        const std::vector<unsigned>& large = aIsBus ? m_largeBuses : m_largeWires;
+        aResult.insert( aResult.end(), large.begin(), large.end() );
+    }
+
+private:
+    typedef boost::unordered_map< unsigned long long, std::vector<unsigned> > CELLS;
+
+    static int cellCoord( int aCoord )
+    {
+        // Round toward negative infinity, also for negative coordinates
+        if( aCoord >= 0 )
+            return aCoord / CONNECTION_GRID_CELL_SIZE;
+
+        return -1 - ( -1 - aCoord ) / CONNECTION_GRID_CELL_SIZE;
+    }
+
+    static unsigned long long cellKey( int aCellX, int aCellY )
+    {
+        return ( (unsigned long long) (unsigned) aCellX << 32 ) | (unsigned) aCellY;
+    }
+
+    static void query( const CELLS& aCells, const wxPoint& aPos, std::vector<unsigned>& aResult )
+    {
+        aResult.clear();
+
+        CELLS::const_iterator it = aCells.find( cellKey( cellCoord( aPos.x ),
+                                                         cellCoord( aPos.y ) ) );
+
+        if( it != aCells.end() )
+            aResult = it->second;
+    }
+
+    static void addPoints( CELLS& aCells, const NETLIST_OBJECT* aItem, unsigned aIdx );
+    static void addSegment( CELLS& aCells, std::vector<unsigned>& aLarge,
+                            const NETLIST_OBJECT* aItem, unsigned aIdx );
+
+    CELLS                   m_wirePoints;
+    CELLS                   m_busPoints;
+    CELLS                   m_wires;
+    CELLS                   m_buses;
+    std::vector<unsigned>   m_largeWires;
+    std::vector<unsigned>   m_largeBuses;
+};
+
+
+void NETLIST_CONNECTION_GRID::Build( const NETLIST_OBJECT_LIST& aList,
+                                     unsigned aStart, const SCH_SHEET_PATH& aSheet )
+{
+    m_wirePoints.clear();
+    m_busPoints.clear();
+    m_wires.clear();
+    m_buses.clear();
+    m_largeWires.clear();
+    m_largeBuses.clear();
+
+    for( unsigned ii = aStart; ii < aList.size(); ii++ )
+    {
+        const NETLIST_OBJECT* item = aList.GetItem( ii );
+
+        // The list is sorted by sheet: items of other sheets having the same
+        // time stamps (Cmp() == 0) can be mixed with the items of aSheet
+        if( item->m_SheetPath.Cmp( aSheet ) != 0 )
+            break;
+
+        if( item->m_SheetPath != aSheet )
+            continue;
+
+        // Same item types as the ones tested by pointToPointConnect()
+        // and segmentToPointConnect()
+        switch( item->m_Type )
+        {
+        case NET_SEGMENT:
+            addPoints( m_wirePoints, item, ii );
+            addSegment( m_wires, m_largeWires, item, ii );
+            break;
+
+        case NET_PIN:
+        case NET_LABEL:
+        case NET_HIERLABEL:
+        case NET_GLOBLABEL:
+        case NET_SHEETLABEL:
+        case NET_PINLABEL:
+        case NET_NOCONNECT:
+            addPoints( m_wirePoints, item, ii );
+            break;
+
+        case NET_JUNCTION:
+            addPoints( m_wirePoints, item, ii );
+            addPoints( m_busPoints, item, ii );
+            break;
+
+        case NET_BUS:
+            addPoints( m_busPoints, item, ii );
+            addSegment( m_buses, m_largeBuses, item, ii );
+            break;
+
+        case NET_BUSLABELMEMBER:
+        case NET_SHEETBUSLABELMEMBER:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            addPoints( m_busPoints, item, ii );
+            break;
+
+        case NET_ITEM_UNSPECIFIED:
+            break;
+        }
+    }
+}
+
+
+void NETLIST_CONNECTION_GRID::addPoints( CELLS& aCells, const NETLIST_OBJECT* aItem,
+                                         unsigned aIdx )
+{
+    unsigned long long startKey = cellKey( cellCoord( aItem->m_Start.x ), cellCoord( aItem->m_Start.y ) );
+    unsigned long long endKey = cellKey( cellCoord( aItem->m_End.x ), cellCoord( aItem->m_End.y ) );
+
+    aCells[startKey].push_back( aIdx );
+
+    if( endKey != startKey )
+        aCells[endKey].push_back( aIdx );
+}
+
+
+void NETLIST_CONNECTION_GRID::addSegment( CELLS& aCells, std::vector<unsigned>& aLarge,
+                                          const NETLIST_OBJECT* aItem, unsigned aIdx )
+{
+    int xmin = cellCoord( std::min( aItem->m_Start.x, aItem->m_End.x ) );
+    int xmax = cellCoord( std::max( aItem->m_Start.x, aItem->m_End.x ) );
+    int ymin = cellCoord( std::min( aItem->m_Start.y, aItem->m_End.y ) );
+    int ymax = cellCoord( std::max( aItem->m_Start.y, aItem->m_End.y ) );
+
+    // Schematic wires are usually horizontal or vertical, so their bounding box
+    // covers only a few cells.  Long oblique wires are kept aside.
+    if( (long long) ( xmax - xmin + 1 ) * ( ymax - ymin + 1 ) > CONNECTION_GRID_MAX_CELLS )
+    {
+        aLarge.push_back( aIdx );
+        return;
+    }
+
+    for( int x = xmin; x <= xmax; x++ )
+    {
+        for( int y = ymin; y <= ymax; y++ )
+            aCells[cellKey( x, y )].push_back( aIdx );
+    }
+}
+
 //Imported function:
 int TestDuplicateSheetNames( bool aCreateMarker );
 
@@ -152,7 +348,9 @@ void NETLIST_OBJECT_LIST::SortListbyNetcode()
 
 void NETLIST_OBJECT_LIST::SortListbySheet()
 {
-    sort( this->begin(), this->end(), NETLIST_OBJECT_LIST::sortItemsBySheet );
+    // The sort is stable: the items of a sheet keep their drawing list order, whatever
+    // the other sheets are, so gatherCachedSheetItems() gives the same order.
+    stable_sort( this->begin(), this->end(), NETLIST_OBJECT_LIST::sortItemsBySheet );
 }
 
 
@@ -164,8 +362,12 @@ NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::BuildNetListBase()
     // Creates the flattened sheet list:
     SCH_SHEET_LIST aSheets;
 
+    // Items of the sheets not modified since the last netlist are taken from the cache,
+    // unless the component libraries have changed
+    m_netlistCache->SetLibrariesModifyHash( Prj().SchLibs()->GetModifyHash() );
+
     // Build netlist info
-    bool success = ret->BuildNetListInfo( aSheets );
+    bool success = ret->BuildNetListInfo( aSheets, m_netlistCache );
 
     if( !success )
     {
@@ -173,6 +375,9 @@ NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::BuildNetListBase()
         return ret.release();
     }
 
+    if( wxLog::IsAllowedTraceMask( traceNetlistCache ) )
+        checkNetlistCache( ret.get(), aSheets );
+
     wxString msg = wxString::Format( _( "Net count = %zu" ), ret->size() );
 
     SetStatusText( msg );
@@ -181,126 +386,87 @@ NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::BuildNetListBase()
 }
 
 
-bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
+/// Formats aList as a kicad netlist, without the header (date, source file)
+static std::string formatNetlist( NETLIST_OBJECT_LIST* aList, PART_LIBS* aLibs )
 {
-    SCH_SHEET_PATH* sheet;
-
-    // Fill list with connected items from the flattened sheet list
-    for( sheet = aSheets.GetFirst(); sheet != NULL;
-         sheet = aSheets.GetNext() )
-    {
-        for( SCH_ITEM* item = sheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
-        {
-            item->GetNetListItem( *this, sheet );
-        }
-    }
-
-    if( size() == 0 )
-        return false;
+    NETLIST_EXPORTER_KICAD  exporter( aList, aLibs );
+    STRING_FORMATTER        formatter;
 
-    // Sort objects by Sheet
-    SortListbySheet();
-
-    sheet = &(GetItem( 0 )->m_SheetPath);
-    m_lastNetCode = m_lastBusNetCode = 1;
+    exporter.Format( &formatter, GNL_ALL & ~GNL_HEADER );
 
-    for( unsigned ii = 0, istart = 0; ii < size(); ii++ )
-    {
-        NETLIST_OBJECT* net_item = GetItem( ii );
+    // The exporter marks the redundant pins
+    for( unsigned ii = 0; ii < aList->size(); ii++ )
+        aList->GetItem( ii )->m_Flag = 0;
 
-        if( net_item->m_SheetPath != *sheet )   // Sheet change
-        {
-            sheet  = &(net_item->m_SheetPath);
-            istart = ii;
-        }
+    return formatter.GetString();
+}
 
-        switch( net_item->m_Type )
-        {
-        case NET_ITEM_UNSPECIFIED:
-            wxMessageBox( wxT( "BuildNetListBase() error" ) );
-            break;
 
-        case NET_PIN:
-        case NET_PINLABEL:
-        case NET_SHEETLABEL:
-        case NET_NOCONNECT:
-            if( net_item->GetNet() != 0 )
-                break;
+void SCH_EDIT_FRAME::checkNetlistCache( NETLIST_OBJECT_LIST* aList, SCH_SHEET_LIST& aSheets )
+{
+    NETLIST_OBJECT_LIST reference;
 
-        case NET_SEGMENT:
-            // Test connections point to point type without bus.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+    reference.BuildNetListInfo( aSheets, NULL );
 
-            pointToPointConnect( net_item, IS_WIRE, istart );
-            break;
+    std::string cached   = formatNetlist( aList, Prj().SchLibs() );
+    std::string expected = formatNetlist( &reference, Prj().SchLibs() );
 
-        case NET_JUNCTION:
-            // Control of the junction outside BUS.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+    if( cached == expected )
+    {
+        wxLogTrace( traceNetlistCache, wxT( "Netlist from sheet cache: identical (%zu items)" ),
+                    aList->size() );
+        return;
+    }
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+    size_t diff = 0;
 
-            // Control of the junction, on BUS.
-            if( net_item->m_BusNetCode == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+    while( diff < cached.size() && diff < expected.size() && cached[diff] == expected[diff] )
+        diff++;
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
-            break;
+    wxLogTrace( traceNetlistCache,
+                wxT( "Netlist from sheet cache differs from the full build at offset %zu:\n"
+                     "cached:\n%s\nexpected:\n%s" ),
+                diff,
+                GetChars( FROM_UTF8( cached.substr( diff, 200 ).c_str() ) ),
+                GetChars( FROM_UTF8( expected.substr( diff, 200 ).c_str() ) ) );
 
-        case NET_LABEL:
-        case NET_HIERLABEL:
-        case NET_GLOBLABEL:
-            // Test connections type junction without bus.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+    wxFAIL_MSG( wxT( "Netlist from sheet cache differs from the full build" ) );
+}
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
-            break;
 
-        case NET_SHEETBUSLABELMEMBER:
-            if( net_item->m_BusNetCode != 0 )
-                break;
+bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets, NETLIST_SHEET_CACHE* aCache,
+                                            bool aUseGrid )
+{
+    std::vector<SCH_SHEET_PATH*> sheets;
 
-        case NET_BUS:
-            // Control type connections point to point mode bus
-            if( net_item->m_BusNetCode == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+    for( SCH_SHEET_PATH* sheet = aSheets.GetFirst(); sheet != NULL;
+         sheet = aSheets.GetNext() )
+    {
+        sheets.push_back( sheet );
+    }
 
-            pointToPointConnect( net_item, IS_BUS, istart );
-            break;
+    if( !aCache )
+    {
+        // Fill list with connected items from the flattened sheet list
+        for( unsigned ii = 0; ii < sheets.size(); ii++ )
+            buildSheetItems( sheets[ii] );
 
-        case NET_BUSLABELMEMBER:
-        case NET_HIERBUSLABELMEMBER:
-        case NET_GLOBBUSLABELMEMBER:
-            // Control connections similar has on BUS
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+        // Sort objects by Sheet, and find the physical connections
+        SortListbySheet();
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
-            break;
-        }
+        if( aUseGrid )
+            connectSheetItems();
+        else
+            connectSheetItemsBySweep();
+    }
+    else
+    {
+        gatherCachedSheetItems( sheets, *aCache );
     }
 
+    if( size() == 0 )
+        return false;
+
 #if defined(NETLIST_DEBUG) && defined(DEBUG)
     std::cout << "\n\nafter sheet local\n\n";
     DumpNetTable();
@@ -682,65 +848,477 @@ void NETLIST_OBJECT_LIST::propageNetCode( int aOldNetCode, int aNewNetCode, bool
 }
 
 
-void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
-                                               int start )
+void NETLIST_OBJECT_LIST::buildSheetItems( SCH_SHEET_PATH* aSheet )
 {
-    int netCode;
+    for( SCH_ITEM* item = aSheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
+    {
+        item->GetNetListItem( *this, aSheet );
+    }
+}
 
-    if( aIsBus == false )    // Objects other than BUS and BUSLABELS
+
+/**
+ * Struct SHEET_PATH_ORDER
+ * compares the indexes of two sheets of a sheet list in the order
+ * NETLIST_OBJECT_LIST::sortItemsBySheet() gives to their items.
+ */
+struct SHEET_PATH_ORDER
+{
+    SHEET_PATH_ORDER( const std::vector<SCH_SHEET_PATH*>& aSheets ) :
+        m_sheets( aSheets )
     {
-        netCode = aRef->GetNet();
+    }
 
-        for( unsigned i = start; i < size(); i++ )
-        {
-            NETLIST_OBJECT* item = GetItem( i );
+    bool operator()( int aFirst, int aSecond ) const
+    {
+        return m_sheets[aFirst]->Cmp( *m_sheets[aSecond] ) < 0;
+    }
 
-            if( item->m_SheetPath != aRef->m_SheetPath )  //used to be > (why?)
-                continue;
+    const std::vector<SCH_SHEET_PATH*>& m_sheets;
+};
 
-            switch( item->m_Type )
-            {
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_JUNCTION:
-            case NET_NOCONNECT:
-                if( aRef->m_Start == item->m_Start
-                    || aRef->m_Start == item->m_End
-                    || aRef->m_End   == item->m_Start
-                    || aRef->m_End   == item->m_End )
-                {
-                    if( item->GetNet() == 0 )
-                        item->SetNet( netCode );
-                    else
-                        propageNetCode( item->GetNet(), netCode, IS_WIRE );
-                }
-                break;
 
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_ITEM_UNSPECIFIED:
-                break;
-            }
-        }
-    }
-    else    // Object type BUS, BUSLABELS, and junctions.
+/**
+ * Struct SHEET_BUILD_TASK
+ * builds the items of the sheets which have a list in aNewItems, for TASK_QUEUE.
+ */
+struct SHEET_BUILD_TASK
+{
+    SHEET_BUILD_TASK( const std::vector<SCH_SHEET_PATH*>& aSheets,
+                      std::vector<NETLIST_OBJECT_LIST*>& aNewItems ) :
+        m_sheets( aSheets ), m_newItems( aNewItems )
+    {}
+
+    void operator()( int aIndex )
     {
-        netCode = aRef->m_BusNetCode;
+        if( m_newItems[aIndex] )
+            m_newItems[aIndex]->buildSheetItems( m_sheets[aIndex] );
+    }
 
-        for( unsigned i = start; i < size(); i++ )
-        {
-            NETLIST_OBJECT* item = GetItem( i );
+    const std::vector<SCH_SHEET_PATH*>&     m_sheets;
+    std::vector<NETLIST_OBJECT_LIST*>&      m_newItems;
+};
 
-            if( item->m_SheetPath != aRef->m_SheetPath )
-                continue;
+
+/**
+ * Struct SHEET_CONNECT_TASK
+ * fills the lists of aNewConnected with copies of the items of their sheet, and finds
+ * their physical connections, for TASK_QUEUE.  aBlocks gives the sheet index of each
+ * list, a NULL list is a sheet whose connections are cached.
+ */
+struct SHEET_CONNECT_TASK
+{
+    SHEET_CONNECT_TASK( const std::vector<const NETLIST_OBJECT_LIST*>& aSheetItems,
+                        const std::vector<int>& aBlocks,
+                        std::vector<NETLIST_OBJECT_LIST*>& aNewConnected ) :
+        m_sheetItems( aSheetItems ), m_blocks( aBlocks ), m_newConnected( aNewConnected )
+    {}
+
+    void operator()( int aIndex )
+    {
+        NETLIST_OBJECT_LIST* connected = m_newConnected[aIndex];
+
+        if( !connected )
+            return;
+
+        const NETLIST_OBJECT_LIST* items = m_sheetItems[m_blocks[aIndex]];
+
+        for( unsigned jj = 0; jj < items->size(); jj++ )
+            connected->push_back( new NETLIST_OBJECT( *items->GetItem( jj ) ) );
+
+        connected->connectSheetItems();
+    }
+
+    const std::vector<const NETLIST_OBJECT_LIST*>&  m_sheetItems;
+    const std::vector<int>&                         m_blocks;
+    std::vector<NETLIST_OBJECT_LIST*>&              m_newConnected;
+};
+
+
+void NETLIST_OBJECT_LIST::gatherCachedSheetItems( const std::vector<SCH_SHEET_PATH*>& aSheets,
+                                                  NETLIST_SHEET_CACHE& aCache )
+{
+    int sheetCount = aSheets.size();
+    std::vector<const NETLIST_OBJECT_LIST*> sheetItems( sheetCount, NULL );
+    std::vector<NETLIST_OBJECT_LIST*> newItems( sheetCount, NULL );
+
+    for( int ii = 0; ii < sheetCount; ii++ )
+    {
+        sheetItems[ii] = aCache.Find( *aSheets[ii] );
+
+        if( !sheetItems[ii] )
+            newItems[ii] = new NETLIST_OBJECT_LIST;
+    }
+
+    // Items of a sheet do not depend on the other sheets, so the sheets not found
+    // in the cache are built concurrently.
+    {
+        SHEET_BUILD_TASK task( aSheets, newItems );
+        TASK_QUEUE<SHEET_BUILD_TASK> queue( task, sheetCount );
+        queue.Run( DefaultThreadCount() );
+    }
+
+    for( int ii = 0; ii < sheetCount; ii++ )
+    {
+        if( newItems[ii] )
+        {
+            aCache.Store( *aSheets[ii], newItems[ii] );
+            sheetItems[ii] = newItems[ii];
+        }
+    }
+
+    aCache.RemoveUnused();
+
+    // Net codes are given to the items in the order they have once the whole list
+    // is sorted by sheet, so the list is sorted exactly as BuildNetListInfo() does
+    // without cache: the netlist does not depend on the cache.
+    // This sort is stable, so the items of a sheet keep their drawing list order, and
+    // sorting the sheets gives the same order as sorting all the items.  The connections
+    // found for a sheet are valid until the sheet is modified.
+    std::vector<int> blocks;
+
+    for( int ii = 0; ii < sheetCount; ii++ )
+    {
+        if( sheetItems[ii]->size() )
+            blocks.push_back( ii );
+    }
+
+    std::stable_sort( blocks.begin(), blocks.end(), SHEET_PATH_ORDER( aSheets ) );
+
+    int blockCount = blocks.size();
+    std::vector<const NETLIST_OBJECT_LIST*> connected( blockCount, NULL );
+    std::vector<NETLIST_OBJECT_LIST*> newConnected( blockCount, NULL );
+
+    for( int ii = 0; ii < blockCount; ii++ )
+    {
+        connected[ii] = aCache.FindConnected( *aSheets[blocks[ii]] );
+
+        if( !connected[ii] )
+            newConnected[ii] = new NETLIST_OBJECT_LIST;
+    }
+
+    // The physical connections of a sheet do not depend on the other sheets: they
+    // are found concurrently, with net codes starting from 1 for each sheet, on copies
+    // of the cached items (which are only read).
+    {
+        SHEET_CONNECT_TASK task( sheetItems, blocks, newConnected );
+        TASK_QUEUE<SHEET_CONNECT_TASK> queue( task, blockCount );
+        queue.Run( DefaultThreadCount() );
+    }
+
+    // Net codes of each sheet are shifted after the codes of the previous sheets:
+    // they are the codes given when connecting the whole list at once.
+    m_lastNetCode = m_lastBusNetCode = 1;
+
+    for( int ii = 0; ii < blockCount; ii++ )
+    {
+        if( newConnected[ii] )
+        {
+            aCache.StoreConnected( *aSheets[blocks[ii]], newConnected[ii] );
+            connected[ii] = newConnected[ii];
+        }
+
+        appendSheetItems( *connected[ii] );
+    }
+}
+
+
+void NETLIST_OBJECT_LIST::connectSheetItems()
+{
+    m_lastNetCode = m_lastBusNetCode = 1;
+
+    if( size() == 0 )
+        return;
+
+    SCH_SHEET_PATH* sheet = &(GetItem( 0 )->m_SheetPath);
+    m_netCodeParents.clear();
+    m_busNetCodeParents.clear();
+
+    // Items of the current sheet, bucketed by connection points
+    NETLIST_CONNECTION_GRID grid;
+
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* net_item = GetItem( ii );
+
+        if( ii == 0 || net_item->m_SheetPath != *sheet )   // Sheet change
+        {
+            sheet  = &(net_item->m_SheetPath);
+            grid.Build( *this, ii, *sheet );
+        }
+
+        // Net codes of this item may have been merged into other ones
+        net_item->SetNet( findNetCode( net_item->GetNet(), IS_WIRE ) );
+        net_item->m_BusNetCode = findNetCode( net_item->m_BusNetCode, IS_BUS );
+
+        switch( net_item->m_Type )
+        {
+        case NET_ITEM_UNSPECIFIED:
+            wxFAIL_MSG( wxT( "BuildNetListBase() error" ) );   // can run in a worker thread
+            break;
+
+        case NET_PIN:
+        case NET_PINLABEL:
+        case NET_SHEETLABEL:
+        case NET_NOCONNECT:
+            if( net_item->GetNet() != 0 )
+                break;
+
+        case NET_SEGMENT:
+            // Test connections point to point type without bus.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            pointToPointConnect( net_item, IS_WIRE, grid );
+            break;
+
+        case NET_JUNCTION:
+            // Control of the junction outside BUS.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_WIRE, grid );
+
+            // Control of the junction, on BUS.
+            if( net_item->m_BusNetCode == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_BUS, grid );
+            break;
+
+        case NET_LABEL:
+        case NET_HIERLABEL:
+        case NET_GLOBLABEL:
+            // Test connections type junction without bus.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_WIRE, grid );
+            break;
+
+        case NET_SHEETBUSLABELMEMBER:
+            if( net_item->m_BusNetCode != 0 )
+                break;
+
+        case NET_BUS:
+            // Control type connections point to point mode bus
+            if( net_item->m_BusNetCode == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            pointToPointConnect( net_item, IS_BUS, grid );
+            break;
+
+        case NET_BUSLABELMEMBER:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            // Control connections similar has on BUS
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_BUS, grid );
+            break;
+        }
+    }
+
+    // Store the final net codes of physically connected items
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* net_item = GetItem( ii );
+
+        net_item->SetNet( findNetCode( net_item->GetNet(), IS_WIRE ) );
+        net_item->m_BusNetCode = findNetCode( net_item->m_BusNetCode, IS_BUS );
+    }
+
+    m_netCodeParents.clear();
+    m_busNetCodeParents.clear();
+}
+
+
+void NETLIST_OBJECT_LIST::connectSheetItemsBySweep()
+{
+    m_lastNetCode = m_lastBusNetCode = 1;
+
+    if( size() == 0 )
+        return;
+
+    SCH_SHEET_PATH* sheet = &(GetItem( 0 )->m_SheetPath);
+
+    for( unsigned ii = 0, istart = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* net_item = GetItem( ii );
+
+        if( net_item->m_SheetPath != *sheet )   // Sheet change
+        {
+            sheet  = &(net_item->m_SheetPath);
+            istart = ii;
+        }
+
+        switch( net_item->m_Type )
+        {
+        case NET_ITEM_UNSPECIFIED:
+            wxFAIL_MSG( wxT( "BuildNetListBase() error" ) );
+            break;
+
+        case NET_PIN:
+        case NET_PINLABEL:
+        case NET_SHEETLABEL:
+        case NET_NOCONNECT:
+            if( net_item->GetNet() != 0 )
+                break;
+
+        case NET_SEGMENT:
+            // Test connections point to point type without bus.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            pointToPointConnect( net_item, IS_WIRE, istart );
+            break;
+
+        case NET_JUNCTION:
+            // Control of the junction outside BUS.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_WIRE, istart );
+
+            // Control of the junction, on BUS.
+            if( net_item->m_BusNetCode == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_BUS, istart );
+            break;
+
+        case NET_LABEL:
+        case NET_HIERLABEL:
+        case NET_GLOBLABEL:
+            // Test connections type junction without bus.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_WIRE, istart );
+            break;
+
+        case NET_SHEETBUSLABELMEMBER:
+            if( net_item->m_BusNetCode != 0 )
+                break;
+
+        case NET_BUS:
+            // Control type connections point to point mode bus
+            if( net_item->m_BusNetCode == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            pointToPointConnect( net_item, IS_BUS, istart );
+            break;
+
+        case NET_BUSLABELMEMBER:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            // Control connections similar has on BUS
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_BUS, istart );
+            break;
+        }
+    }
+}
+
+
+void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
+                                               unsigned aIdxStart )
+{
+    int netCode;
+
+    if( aIsBus == false )    // Objects other than BUS and BUSLABELS
+    {
+        netCode = aRef->GetNet();
+
+        for( unsigned i = aIdxStart; i < size(); i++ )
+        {
+            NETLIST_OBJECT* item = GetItem( i );
+
+            if( item->m_SheetPath != aRef->m_SheetPath )  //used to be > (why?)
+                continue;
+
+            switch( item->m_Type )
+            {
+            case NET_SEGMENT:
+            case NET_PIN:
+            case NET_LABEL:
+            case NET_HIERLABEL:
+            case NET_GLOBLABEL:
+            case NET_SHEETLABEL:
+            case NET_PINLABEL:
+            case NET_JUNCTION:
+            case NET_NOCONNECT:
+                if( aRef->m_Start == item->m_Start
+                    || aRef->m_Start == item->m_End
+                    || aRef->m_End   == item->m_Start
+                    || aRef->m_End   == item->m_End )
+                {
+                    if( item->GetNet() == 0 )
+                        item->SetNet( netCode );
+                    else
+                        propageNetCode( item->GetNet(), netCode, IS_WIRE );
+                }
+                break;
+
+            case NET_BUS:
+            case NET_BUSLABELMEMBER:
+            case NET_SHEETBUSLABELMEMBER:
+            case NET_HIERBUSLABELMEMBER:
+            case NET_GLOBBUSLABELMEMBER:
+            case NET_ITEM_UNSPECIFIED:
+                break;
+            }
+        }
+    }
+    else    // Object type BUS, BUSLABELS, and junctions.
+    {
+        netCode = aRef->m_BusNetCode;
+
+        for( unsigned i = aIdxStart; i < size(); i++ )
+        {
+            NETLIST_OBJECT* item = GetItem( i );
+
+            if( item->m_SheetPath != aRef->m_SheetPath )
+                continue;
 
             switch( item->m_Type )
             {
@@ -779,7 +1357,7 @@ void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus
 
 
 void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction,
-                                                bool aIsBus, int aIdxStart )
+                                                bool aIsBus, unsigned aIdxStart )
 {
     for( unsigned i = aIdxStart; i < size(); i++ )
     {
@@ -822,6 +1400,290 @@ void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction,
 }
 
 
+void NETLIST_OBJECT_LIST::appendSheetItems( const NETLIST_OBJECT_LIST& aSheetItems )
+{
+    // aSheetItems net codes start from 1, and are consecutive
+    int netCodeShift = m_lastNetCode - 1;
+    int busNetCodeShift = m_lastBusNetCode - 1;
+
+    for( unsigned ii = 0; ii < aSheetItems.size(); ii++ )
+    {
+        NETLIST_OBJECT* item = new NETLIST_OBJECT( *aSheetItems.GetItem( ii ) );
+
+        if( item->GetNet() )
+            item->SetNet( item->GetNet() + netCodeShift );
+
+        if( item->m_BusNetCode )
+            item->m_BusNetCode += busNetCodeShift;
+
+        push_back( item );
+    }
+
+    m_lastNetCode += aSheetItems.m_lastNetCode - 1;
+    m_lastBusNetCode += aSheetItems.m_lastBusNetCode - 1;
+}
+
+
+NETLIST_SHEET_CACHE::NETLIST_SHEET_CACHE()
+{
+    m_libModifyHash = 0;
+}
+
+
+NETLIST_SHEET_CACHE::~NETLIST_SHEET_CACHE()
+{
+    Clear();
+}
+
+
+void NETLIST_SHEET_CACHE::Clear()
+{
+    for( unsigned ii = 0; ii < m_entries.size(); ii++ )
+    {
+        delete m_entries[ii]->m_items;
+        delete m_entries[ii]->m_connected;
+        delete m_entries[ii];
+    }
+
+    m_entries.clear();
+}
+
+
+void NETLIST_SHEET_CACHE::SetLibrariesModifyHash( int aHash )
+{
+    if( aHash != m_libModifyHash )
+    {
+        Clear();
+        m_libModifyHash = aHash;
+    }
+}
+
+
+NETLIST_SHEET_CACHE::ENTRY* NETLIST_SHEET_CACHE::findEntry( const SCH_SHEET_PATH& aSheet )
+{
+    for( unsigned ii = 0; ii < m_entries.size(); ii++ )
+    {
+        if( m_entries[ii]->m_sheet == aSheet )
+            return m_entries[ii];
+    }
+
+    return NULL;
+}
+
+
+const NETLIST_OBJECT_LIST* NETLIST_SHEET_CACHE::Find( const SCH_SHEET_PATH& aSheet )
+{
+    ENTRY* entry = findEntry( aSheet );
+
+    if( !entry || entry->m_modifyStamp != aSheet.LastScreen()->GetModifyStamp() )
+        return NULL;
+
+    entry->m_used = true;
+
+    return entry->m_items;
+}
+
+
+void NETLIST_SHEET_CACHE::Store( const SCH_SHEET_PATH& aSheet, NETLIST_OBJECT_LIST* aItems )
+{
+    ENTRY* entry = findEntry( aSheet );
+
+    if( entry )
+    {
+        delete entry->m_items;
+        delete entry->m_connected;
+    }
+    else
+    {
+        entry = new ENTRY;
+        entry->m_sheet = aSheet;
+        m_entries.push_back( entry );
+    }
+
+    entry->m_modifyStamp = aSheet.LastScreen()->GetModifyStamp();
+    entry->m_items = aItems;
+    entry->m_connected = NULL;
+    entry->m_used = true;
+}
+
+
+const NETLIST_OBJECT_LIST* NETLIST_SHEET_CACHE::FindConnected( const SCH_SHEET_PATH& aSheet )
+{
+    ENTRY* entry = findEntry( aSheet );
+
+    if( !entry )
+        return NULL;
+
+    return entry->m_connected;
+}
+
+
+void NETLIST_SHEET_CACHE::StoreConnected( const SCH_SHEET_PATH& aSheet,
+                                          NETLIST_OBJECT_LIST* aConnected )
+{
+    ENTRY* entry = findEntry( aSheet );
+
+    wxCHECK_RET( entry, wxT( "StoreConnected(): the sheet items are not stored" ) );
+
+    delete entry->m_connected;
+    entry->m_connected = aConnected;
+}
+
+
+void NETLIST_SHEET_CACHE::RemoveUnused()
+{
+    unsigned count = 0;
+
+    for( unsigned ii = 0; ii < m_entries.size(); ii++ )
+    {
+        ENTRY* entry = m_entries[ii];
+
+        if( entry->m_used )
+        {
+            entry->m_used = false;
+            m_entries[count++] = entry;
+        }
+        else
+        {
+            delete entry->m_items;
+            delete entry->m_connected;
+            delete entry;
+        }
+    }
+
+    m_entries.resize( count );
+}
+
+
+int NETLIST_OBJECT_LIST::findNetCode( int aCode, bool aIsBus )
+{
+    std::vector<int>& parents = aIsBus ? m_busNetCodeParents : m_netCodeParents;
+
+    if( aCode >= (int) parents.size() )
+        return aCode;
+
+    int root = aCode;
+
+    while( parents[root] != root )
+        root = parents[root];
+
+    // Shorten the path for the next searches
+    while( parents[aCode] != root )
+    {
+        int next = parents[aCode];
+        parents[aCode] = root;
+        aCode = next;
+    }
+
+    return root;
+}
+
+
+void NETLIST_OBJECT_LIST::mergeNetCodes( int aOldNetCode, int aNewNetCode, bool aIsBus )
+{
+    if( aOldNetCode == aNewNetCode )
+        return;
+
+    std::vector<int>& parents = aIsBus ? m_busNetCodeParents : m_netCodeParents;
+
+    int maxCode = std::max( aOldNetCode, aNewNetCode );
+
+    while( (int) parents.size() <= maxCode )
+        parents.push_back( (int) parents.size() );
+
+    parents[aOldNetCode] = aNewNetCode;
+}
+
+
+void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
+                                               const NETLIST_CONNECTION_GRID& aGrid )
+{
+    // Candidates having an end point near an end point of aRef.
+    // They are tested in any order: each connected item gets the net code of aRef.
+    std::vector<unsigned> candidates;
+    std::vector<unsigned> endCandidates;
+
+    aGrid.QueryPoints( aRef->m_Start, aIsBus, candidates );
+
+    if( aRef->m_End != aRef->m_Start )
+    {
+        aGrid.QueryPoints( aRef->m_End, aIsBus, endCandidates );
+        candidates.insert( candidates.end(), endCandidates.begin(), endCandidates.end() );
+    }
+
+    int netCode = aIsBus ? aRef->m_BusNetCode : aRef->GetNet();
+
+    for( unsigned i = 0; i < candidates.size(); i++ )
+    {
+        NETLIST_OBJECT* item = GetItem( candidates[i] );
+
+        if(  aRef->m_Start != item->m_Start
+          && aRef->m_Start != item->m_End
+          && aRef->m_End   != item->m_Start
+          && aRef->m_End   != item->m_End )
+            continue;
+
+        if( aIsBus == IS_WIRE )     // Objects other than BUS and BUSLABELS
+        {
+            int itemNetCode = findNetCode( item->GetNet(), IS_WIRE );
+
+            if( itemNetCode )
+                mergeNetCodes( itemNetCode, netCode, IS_WIRE );
+
+            item->SetNet( netCode );
+        }
+        else                        // Object type BUS, BUSLABELS, and junctions.
+        {
+            int itemNetCode = findNetCode( item->m_BusNetCode, IS_BUS );
+
+            if( itemNetCode )
+                mergeNetCodes( itemNetCode, netCode, IS_BUS );
+
+            item->m_BusNetCode = netCode;
+        }
+    }
+}
+
+
+void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction,
+                                                bool aIsBus,
+                                                const NETLIST_CONNECTION_GRID& aGrid )
+{
+    // Wires (or buses) of the junction sheet which can contain the junction
+    std::vector<unsigned> candidates;
+
+    aGrid.QuerySegments( aJonction->m_Start, aIsBus, candidates );
+
+    for( unsigned i = 0; i < candidates.size(); i++ )
+    {
+        NETLIST_OBJECT* segment = GetItem( candidates[i] );
+
+        if( !IsPointOnSegment( segment->m_Start, segment->m_End, aJonction->m_Start ) )
+            continue;
+
+        // Propagation Netcode has all the objects of the same Netcode.
+        if( aIsBus == IS_WIRE )
+        {
+            int segmentNetCode = findNetCode( segment->GetNet(), IS_WIRE );
+
+            if( segmentNetCode )
+                mergeNetCodes( segmentNetCode, aJonction->GetNet(), IS_WIRE );
+
+            segment->SetNet( aJonction->GetNet() );
+        }
+        else
+        {
+            int segmentNetCode = findNetCode( segment->m_BusNetCode, IS_BUS );
+
+            if( segmentNetCode )
+                mergeNetCodes( segmentNetCode, aJonction->m_BusNetCode, IS_BUS );
+
+            segment->m_BusNetCode = aJonction->m_BusNetCode;
+        }
+    }
+}
+
+
 void NETLIST_OBJECT_LIST::labelConnect( NETLIST_OBJECT* aLabelRef )
 {
     if( aLabelRef->GetNet() == 0 )
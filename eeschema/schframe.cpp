@@ -40,6 +40,7 @@
 #include <general.h>
 #include <eeschema_id.h>
 #include <netlist.h>
+#include <class_netlist_object.h>
 #include <lib_pin.h>
 #include <class_library.h>
 #include <schframe.h>
@@ -342,6 +343,7 @@ SCH_EDIT_FRAME::SCH_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ):
     m_dlgFindReplace = NULL;
     m_findReplaceData = new wxFindReplaceData( wxFR_DOWN );
     m_undoItem = NULL;
+    m_netlistCache = new NETLIST_SHEET_CACHE;
     m_hasAutoSave = true;
 
     SetForceHVLines( true );
@@ -427,11 +429,13 @@ SCH_EDIT_FRAME::~SCH_EDIT_FRAME()
 
     delete m_CurrentSheet;          // a SCH_SHEET_PATH, on the heap.
     delete m_undoItem;
+    delete m_netlistCache;
     delete g_RootSheet;
     delete m_findReplaceData;
 
     m_CurrentSheet = NULL;
     m_undoItem = NULL;
+    m_netlistCache = NULL;
     g_RootSheet = NULL;
     m_findReplaceData = NULL;
 }
@@ -53,6 +53,7 @@ class SCH_TEXT;
 class SCH_BITMAP;
 class SCH_SHEET;
 class SCH_SHEET_PATH;
+class SCH_SHEET_LIST;
 class SCH_SHEET_PIN;
 class SCH_COMPONENT;
 class SCH_FIELD;
@@ -62,6 +63,7 @@ class DIALOG_SCH_FIND;
 class wxFindDialogEvent;
 class wxFindReplaceData;
 class SCHLIB_FILTER;
+class NETLIST_SHEET_CACHE;
 
 
 /// enum used in RotationMiroir()
@@ -139,6 +141,7 @@ private:
     SCH_COLLECTOR           m_collectedItems;     ///< List of collected items.
     SCH_FIND_COLLECTOR      m_foundItems;         ///< List of find/replace items.
     SCH_ITEM*               m_undoItem;           ///< Copy of the current item being edited.
+    NETLIST_SHEET_CACHE*    m_netlistCache;       ///< Netlist items of the unmodified sheets.
     wxString                m_simulatorCommand;   ///< Command line used to call the circuit
                                                   ///< simulator (gnucap, spice, ...)
     wxString                m_netListerCommand;   ///< Command line to call a custom net list
@@ -223,6 +226,14 @@ protected:
      */
     void sendNetlist();
 
+    /**
+     * Function checkNetlistCache
+     * compares the kicad netlist of \a aList, built from the sheet cache, to the
+     * netlist built again without cache, and asserts if they differ.
+     * Called by BuildNetListBase() when the KISCHNETLISTCACHE trace mask is enabled.
+     */
+    void checkNetlistCache( NETLIST_OBJECT_LIST* aList, SCH_SHEET_LIST& aSheets );
+
 public:
     SCH_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent );
     ~SCH_EDIT_FRAME();
@@ -79,6 +79,7 @@ private:
     GRIDS       m_grids;            ///< List of valid grid sizes.
     bool        m_FlagModified;     ///< Indicates current drawing has been modified.
     bool        m_FlagSave;         ///< Indicates automatic file save.
+    unsigned    m_modifyStamp;      ///< Changes each time the drawing is modified.
     EDA_ITEM*   m_CurrentItem;      ///< Currently selected object
     GRID_TYPE   m_Grid;             ///< Current grid selection.
     wxPoint     m_scrollCenter;     ///< Current scroll center point in logical units.
@@ -93,6 +94,8 @@ private:
 
     double      m_Zoom;             ///< Current zoom coefficient.
 
+    static unsigned s_modifyGeneration; ///< Last value given to a m_modifyStamp.
+
     //----< Old public API now is private, and migratory>------------------------
     // called only from EDA_DRAW_FRAME
     friend class EDA_DRAW_FRAME;
@@ -308,13 +311,21 @@ public:
         return m_RedoList.m_CommandsList.size();
     }
 
-    void SetModify()        { m_FlagModified = true; }
+    void SetModify()        { m_FlagModified = true; m_modifyStamp = ++s_modifyGeneration; }
     void ClrModify()        { m_FlagModified = false; }
     void SetSave()          { m_FlagSave = true; }
     void ClrSave()          { m_FlagSave = false; }
     bool IsModify() const   { return m_FlagModified; }
     bool IsSave() const     { return m_FlagSave; }
 
+    /**
+     * Function GetModifyStamp
+     * @return a value which changes each time SetModify() is called, and which is
+     * never used by another screen.  Data computed from the drawing is still valid
+     * as long as the stamp is unchanged.
+     */
+    unsigned GetModifyStamp() const { return m_modifyStamp; }
+
 
     //----<zoom stuff>---------------------------------------------------------
 
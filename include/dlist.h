@@ -33,6 +33,25 @@
 class EDA_ITEM;
 
 
+/**
+ * Class DHEAD_LISTENER
+ * is told about the elements added to and removed from a DHEAD, e.g. to maintain an
+ * index of the list elements.  Elements may also tell it that their shape has changed.
+ */
+class DHEAD_LISTENER
+{
+public:
+    virtual ~DHEAD_LISTENER() {}
+
+    virtual void ItemAdded( EDA_ITEM* aItem ) = 0;
+
+    /// Called before the item is unlinked (or deleted by DeleteAll())
+    virtual void ItemRemoved( EDA_ITEM* aItem ) = 0;
+
+    virtual void ItemChanged( EDA_ITEM* aItem ) = 0;
+};
+
+
 /**
  * Class DHEAD
  * is only for use by template class DLIST, use that instead.
@@ -44,6 +63,7 @@ protected:
     EDA_ITEM*     last;           ///< last elment in list, or NULL if empty
     unsigned      count;          ///< how many elements are in the list, automatically maintained.
     bool          meOwner;        ///< I must delete the objects I hold in my destructor
+    DHEAD_LISTENER* listener;     ///< told about list changes, or NULL
 
     /**
      * Constructor DHEAD
@@ -54,7 +74,8 @@ protected:
         first(0),
         last(0),
         count(0),
-        meOwner(true)
+        meOwner(true),
+        listener(0)
     {
     }
 
@@ -118,6 +139,24 @@ public:
      */
     void SetOwnership( bool Iown ) { meOwner = Iown; }
 
+    /**
+     * Function SetListener
+     * sets the object told about the elements added to and removed from this list.
+     * Elements already on the list are not reported.
+     * @param aListener is the listener, or NULL to remove it.
+     */
+    void SetListener( DHEAD_LISTENER* aListener ) { listener = aListener; }
+
+    /**
+     * Function ItemChanged
+     * is called by an element of the list when its shape, position or name has changed.
+     */
+    void ItemChanged( EDA_ITEM* aElement )
+    {
+        if( listener )
+            listener->ItemChanged( aElement );
+    }
+
 
     /**
      * Function GetCount
@@ -410,6 +410,32 @@ public:
      */
     virtual void ClearCache() = 0;
 
+    /**
+     * @brief Creates a GAL which stores groups on behalf of this one, so items can be
+     * drawn on several threads at the same time. Each thread uses its own worker, which
+     * starts with the current settings (world transformation, colors, depth) of this GAL.
+     * The groups of a worker are moved to this GAL with ImportGroup().
+     *
+     * @return the worker (owned by the caller), or NULL if the GAL does not support them.
+     */
+    virtual GAL* CreateWorker()
+    {
+        return NULL;
+    }
+
+    /**
+     * @brief Creates a group containing a group drawn by a worker. It has to be called
+     * from the thread which uses this GAL, after the worker finished drawing.
+     *
+     * @param aWorker is a worker created with CreateWorker().
+     * @param aGroupNumber is the number of the group in the worker.
+     * @return the number of the new group, or -1 if the GAL does not support workers.
+     */
+    virtual int ImportGroup( GAL* aWorker, int aGroupNumber )
+    {
+        return -1;
+    }
+
     // --------------------------------------------------------
     // Handling the world <-> screen transformation
     // --------------------------------------------------------
@@ -875,6 +901,13 @@ protected:
     /// Instance of object that stores information about how to draw texts
     STROKE_FONT        strokeFont;
 
+    /**
+     * @brief Copies the view and drawing settings of another GAL (used by the workers).
+     *
+     * @param aGal is the GAL to copy the settings from.
+     */
+    void copyState( const GAL& aGal );
+
     /// Compute the scaling factor for the world->screen matrix
     inline void ComputeWorldScale()
     {
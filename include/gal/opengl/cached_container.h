@@ -35,6 +35,7 @@
 #include <gal/opengl/vertex_container.h>
 #include <map>
 #include <set>
+#include <climits>
 
 // Debug messages verbosity level
 // #define CACHED_CONTAINER_TEST 1
@@ -44,6 +45,15 @@ namespace KIGFX
 class VERTEX_ITEM;
 class SHADER;
 
+/**
+ * Class CACHED_CONTAINER
+ *
+ * Free chunks are indexed by their offset, so they are merged with their neighbours as soon as
+ * they are freed, and sorted in size classes (powers of 2), so a chunk for a new item is found
+ * without looking through all of them. When no free chunk is big enough, the items are moved
+ * towards the beginning of the container only until a big enough chunk is made, instead of
+ * defragmenting the whole container.
+ */
 class CACHED_CONTAINER : public VERTEX_CONTAINER
 {
 public:
@@ -65,16 +75,34 @@ public:
     virtual void Clear();
 
 protected:
-    ///> Maps size of free memory chunks to their offsets
+    ///> Size & offset of a free memory chunk
     typedef std::pair<unsigned int, unsigned int> CHUNK;
-    typedef std::multimap<unsigned int, unsigned int> FREE_CHUNK_MAP;
 
-    /// List of all the stored items
-    typedef std::set<VERTEX_ITEM*> ITEMS;
+    ///> Maps offsets of free memory chunks to their sizes
+    typedef std::map<unsigned int, unsigned int> FREE_CHUNK_MAP;
+
+    ///> Free chunks of a size class, sorted by size
+    typedef std::set<CHUNK> FREE_CHUNK_CLASS;
+
+    ///> Maps offsets of the stored items to the items
+    typedef std::map<unsigned int, VERTEX_ITEM*> ITEMS;
+
+    ///> Number of size classes, a class stores the chunks of size [2^n, 2^(n+1))
+    static const int SIZE_CLASSES = 32;
+
+    ///> Maximal number of vertices moved per freed vertex, when the container is compacted
+    ///> to be shrunk
+    static const unsigned int COMPACTION_RATIO = 4;
 
-    ///> Stores size & offset of free chunks.
+    ///> Stores offset & size of free chunks.
     FREE_CHUNK_MAP      m_freeChunks;
 
+    ///> Free chunks sorted by size classes
+    FREE_CHUNK_CLASS    m_sizeClasses[SIZE_CLASSES];
+
+    ///> Bit n is set if the size class n has free chunks
+    unsigned int        m_classMask;
+
     ///> Stored VERTEX_ITEMs
     ITEMS               m_items;
 
@@ -91,33 +119,27 @@ protected:
      * resizes the chunk that stores the current item to the given size.
      *
      * @param aSize is the number of vertices to be stored.
-     * @return offset of the new chunk.
+     * @return offset of the new chunk or UINT_MAX in case of failure.
      */
     virtual unsigned int reallocate( unsigned int aSize );
 
     /**
-     * Function defragment()
-     * removes empty spaces between chunks, so after that there is a long continous space
-     * for storing vertices at the and of the container.
+     * Function compact()
+     * moves the items stored after the first free chunk to its beginning, so the free chunks
+     * are merged. It stops as soon as the first free chunk has at least aSize vertices, so only
+     * a part of the container is usually moved.
      *
-     * @param aTarget is the already allocated destination for defragmented data. It has to be
-     * at least of the same size as the current container. If left NULL, it will be allocated
-     * inside the defragment() function.
-     * @return false in case of failure (eg. memory shortage)
-     */
-    virtual bool defragment( VERTEX* aTarget = NULL );
-
-    /**
-     * Function mergeFreeChunks()
-     * looks for consecutive free memory chunks and merges them, decreasing fragmentation of
-     * memory.
+     * @param aSize is the size of the free chunk to be made.
+     * @param aMaxMoved is the maximal number of vertices to be moved.
+     * @return true if the first free chunk has at least aSize vertices.
      */
-    virtual void mergeFreeChunks();
+    bool compact( unsigned int aSize, unsigned int aMaxMoved = UINT_MAX );
 
     /**
      * Function resizeContainer()
      *
-     * prepares a bigger container of a given size.
+     * prepares a bigger container of a given size. A smaller one can be prepared only if the
+     * space to be removed is free.
      * @param aNewSize is the new size of container, expressed in vertices
      * @return false in case of failure (eg. memory shortage)
      */
@@ -133,25 +155,46 @@ protected:
 
 private:
     /**
-     * Function getChunkSize()
-     * returns size of the given chunk.
+     * Function addFreeChunk()
+     * returns a memory chunk to the pool, merging it with the neighbouring free chunks.
      *
-     * @param aChunk is the chunk.
+     * @param aOffset is the offset of the chunk.
+     * @param aSize is the size of the chunk.
      */
-    inline int getChunkSize( const CHUNK& aChunk ) const
-    {
-        return aChunk.first;
-    }
+    void addFreeChunk( unsigned int aOffset, unsigned int aSize );
+
+    /**
+     * Function removeFreeChunk()
+     * removes a chunk from the pool.
+     *
+     * @param aChunk is the chunk to be removed.
+     */
+    void removeFreeChunk( FREE_CHUNK_MAP::iterator aChunk );
 
     /**
-     * Function getChunkOffset()
-     * returns offset of the chunk.
+     * Function findFreeChunk()
+     * looks for the smallest free chunk of the first size class which has chunks of at
+     * least the given size.
      *
-     * @param aChunk is the chunk.
+     * @param aSize is the minimal size of the chunk.
+     * @return the chunk or m_freeChunks.end() if there is none.
      */
-    inline unsigned int getChunkOffset( const CHUNK& aChunk ) const
+    FREE_CHUNK_MAP::iterator findFreeChunk( unsigned int aSize );
+
+    /**
+     * Function getSizeClass()
+     * returns the size class of chunks of the given size.
+     *
+     * @param aSize is the size of a chunk.
+     */
+    inline int getSizeClass( unsigned int aSize ) const
     {
-        return aChunk.second;
+        int sizeClass = 0;
+
+        while( aSize >>= 1 )
+            ++sizeClass;
+
+        return sizeClass;
     }
 
     /// Debug & test functions
@@ -0,0 +1,140 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file opengl_gal_worker.h
+ * @brief Worker GAL which tessellates groups for OPENGL_GAL on another thread.
+ */
+
+#ifndef OPENGL_GAL_WORKER_H_
+#define OPENGL_GAL_WORKER_H_
+
+#include <gal/opengl/opengl_gal.h>
+
+#include <vector>
+
+namespace KIGFX
+{
+/**
+ * @brief Class OPENGL_GAL_WORKER stores the vertices of groups in main memory, without using
+ * the OpenGL context.
+ *
+ * The groups are tessellated by the worker thread, then copied to the cached vertex buffer of
+ * the OPENGL_GAL which created the worker (see OPENGL_GAL::ImportGroup()). Only the drawing
+ * and group methods do something, the other ones are ignored.
+ */
+class OPENGL_GAL_WORKER : public OPENGL_GAL_BASE
+{
+public:
+    /**
+     * @brief Constructor OPENGL_GAL_WORKER
+     *
+     * @param aGal is the GAL whose settings are used to draw the groups.
+     */
+    OPENGL_GAL_WORKER( const GAL& aGal );
+
+    virtual ~OPENGL_GAL_WORKER();
+
+    /**
+     * @brief Returns the vertices of a group.
+     *
+     * @param aGroupNumber is the group number.
+     * @param aSize is set to the number of vertices of the group.
+     * @return the vertices, which are valid until the next group is drawn.
+     */
+    const VERTEX* GetGroupVertices( int aGroupNumber, unsigned int& aSize ) const;
+
+    /**
+     * @brief Returns true if the staging buffer could not hold all the vertices, so some
+     * groups are incomplete. The worker does not display the error, it runs on another thread.
+     */
+    bool AllocationFailed() const
+    {
+        return stagingManager.AllocationFailed();
+    }
+
+    // Methods which are ignored by the workers
+    virtual void BeginDrawing() {}
+    virtual void EndDrawing() {}
+    virtual void ResizeScreen( int aWidth, int aHeight ) {}
+    virtual bool Show( bool aShow ) { return false; }
+    virtual void Flush() {}
+    virtual void ClearScreen( const COLOR4D& aColor ) {}
+    virtual void Transform( const MATRIX3x3D& aTransformation ) {}
+    virtual void DrawGroup( int aGroupNumber ) {}
+    virtual void ChangeGroupColor( int aGroupNumber, const COLOR4D& aNewColor ) {}
+    virtual void ChangeGroupDepth( int aGroupNumber, int aDepth ) {}
+    virtual void SaveScreen() {}
+    virtual void RestoreScreen() {}
+    virtual void ClearTarget( RENDER_TARGET aTarget ) {}
+    virtual void DrawCursor( const VECTOR2D& aCursorPosition ) {}
+
+    // --------------------------------------------
+    // Group methods
+    // ---------------------------------------------
+
+    /// @copydoc GAL::BeginGroup()
+    virtual int BeginGroup();
+
+    /// @copydoc GAL::EndGroup()
+    virtual void EndGroup();
+
+    /// @copydoc GAL::DeleteGroup()
+    virtual void DeleteGroup( int aGroupNumber ) {}
+
+    /// @copydoc GAL::ClearCache()
+    virtual void ClearCache();
+
+    /// @copydoc GAL::SetTarget()
+    virtual void SetTarget( RENDER_TARGET aTarget )
+    {
+        currentTarget = aTarget;
+    }
+
+    /// @copydoc GAL::GetTarget()
+    virtual RENDER_TARGET GetTarget() const
+    {
+        return currentTarget;
+    }
+
+protected:
+    virtual void drawGridLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) {}
+
+private:
+    ///< Part of the staging buffer holding a group
+    struct GROUP
+    {
+        unsigned int offset;
+        unsigned int size;
+    };
+
+    ///< Initial size of the staging buffer (in vertices)
+    static const unsigned int STAGING_SIZE = 65536;
+
+    VERTEX_MANAGER          stagingManager;         ///< Stores the vertices of all the groups
+    std::vector<GROUP>      groups;                 ///< Groups stored in the staging buffer
+    RENDER_TARGET           currentTarget;          ///< Current rendering target
+};
+} // namespace KIGFX
+
+#endif /* OPENGL_GAL_WORKER_H_ */
@@ -55,8 +55,9 @@ public:
      *
      * @param aCached says if vertices should be cached in GPU or system memory. For data that
      * does not change every frame, it is better to store vertices in GPU memory.
+     * @param aSize is the initial size of the container (in vertices), 0 for the default size.
      */
-    VERTEX_MANAGER( bool aCached );
+    VERTEX_MANAGER( bool aCached, unsigned int aSize = 0 );
 
     /**
      * Function Vertex()
@@ -96,6 +97,38 @@ public:
      */
     void Vertices( const VERTEX aVertices[], unsigned int aSize ) const;
 
+    /**
+     * Function CopyVertices()
+     * adds vertices to the currently set item as they are: the current transformation matrix,
+     * color and shader are not applied. It is used to store vertices prepared by another
+     * VERTEX_MANAGER.
+     *
+     * @param aVertices contains vertices to be added
+     * @param aSize is the number of vertices to be added.
+     * @return false if the vertices could not be allocated.
+     */
+    bool CopyVertices( const VERTEX aVertices[], unsigned int aSize ) const;
+
+    /**
+     * Function AllocationFailed()
+     * returns true if vertices could not be allocated since the last call to
+     * ResetAllocationFailed() or Clear(). The manager does not display the errors, as it may be
+     * used by a worker thread: its owner reports them from the main thread.
+     */
+    bool AllocationFailed() const
+    {
+        return m_allocationFailed;
+    }
+
+    /**
+     * Function ResetAllocationFailed()
+     * forgets the allocation errors, once they are reported.
+     */
+    void ResetAllocationFailed() const
+    {
+        m_allocationFailed = false;
+    }
+
     /**
      * Function Color()
      * changes currently used color that will be applied to newly added vertices.
@@ -273,6 +306,22 @@ public:
      */
     VERTEX* GetVertices( const VERTEX_ITEM& aItem ) const;
 
+    /**
+     * Function GetVertices()
+     * returns a pointer to the vertices stored at the given offset. It is meant for noncached
+     * managers, whose vertices are stored one after the other.
+     *
+     * @param aOffset is the offset of the first vertex.
+     */
+    VERTEX* GetVertices( unsigned int aOffset ) const;
+
+    /**
+     * Function GetSize()
+     * returns the number of vertices stored by a noncached manager, which is also the offset of
+     * the next vertex to be added.
+     */
+    unsigned int GetSize() const;
+
     const glm::mat4& GetTransformation() const
     {
         return m_transform;
@@ -340,6 +389,8 @@ protected:
     GLubyte                 m_color[ColorStride];
     /// Currently used shader and its parameters
     GLfloat                 m_shader[ShaderStride];
+    /// True if vertices could not be allocated, see AllocationFailed()
+    mutable bool            m_allocationFailed;
 };
 
 } // namespace KIGFX
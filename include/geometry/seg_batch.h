@@ -0,0 +1,167 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <math/vector2d.h>
+#include <geometry/seg.h>
+
+class SHAPE_LINE_CHAIN;
+class SHAPE_CIRCLE;
+
+/**
+ * Class SEG_BATCH
+ *
+ * A small group of segments (typically consecutive segments of a line chain) stored as a
+ * structure of arrays, so a segment or a circle can be tested against all of them at once.
+ * The bounding box and segment distances are first computed in double precision, several
+ * segments per instruction (AVX or SSE2 when the compiler targets them, plain C++ otherwise),
+ * and the exact integer tests of SEG and SHAPE_CIRCLE are run only on the segments which
+ * are close enough.
+ * The results are therefore the same as the ones of the exact tests.
+ *
+ * The batch lives on the stack: it does not allocate memory.
+ */
+class SEG_BATCH
+{
+public:
+    ///> Maximum number of segments in a batch
+    static const int MAX_SIZE = 32;
+
+    SEG_BATCH() :
+        m_count( 0 )
+    {
+    }
+
+    void Clear()
+    {
+        m_count = 0;
+    }
+
+    int Size() const
+    {
+        return m_count;
+    }
+
+    bool IsFull() const
+    {
+        return m_count == MAX_SIZE;
+    }
+
+    /**
+     * Function Add()
+     *
+     * Appends aSeg to the batch, which must not be full.
+     */
+    void Add( const SEG& aSeg );
+
+    /**
+     * Function Fill()
+     *
+     * Replaces the contents of the batch with the segments of aChain, starting from segment
+     * aFirst, as many as fit.
+     * @return the index of the first segment of aChain which did not fit, or the segment count
+     * of aChain if all the remaining segments were added.
+     */
+    int Fill( const SHAPE_LINE_CHAIN& aChain, int aFirst = 0 );
+
+    /**
+     * Function Segment()
+     *
+     * Returns segment aIndex of the batch.
+     */
+    const SEG Segment( int aIndex ) const
+    {
+        // the coordinates are integers, stored exactly
+        return SEG( VECTOR2I( (int) m_ax[aIndex], (int) m_ay[aIndex] ),
+                    VECTOR2I( (int) ( m_ax[aIndex] + m_dx[aIndex] ),
+                              (int) ( m_ay[aIndex] + m_dy[aIndex] ) ) );
+    }
+
+    /**
+     * Function SquaredDistances()
+     *
+     * Computes the squared distances between aSeg and each segment of the batch, in
+     * double precision (i.e. within a fraction of unit of the exact distances).
+     * @param aDist receives Size() distances.
+     */
+    void SquaredDistances( const SEG& aSeg, double* aDist ) const;
+
+    /**
+     * Function SquaredDistances()
+     *
+     * Computes the squared distances between aP and each segment of the batch, in
+     * double precision.
+     * @param aDist receives Size() distances.
+     */
+    void SquaredDistances( const VECTOR2I& aP, double* aDist ) const;
+
+    /**
+     * Function Collide()
+     *
+     * Finds a segment of the batch colliding with aSeg, with the test of
+     * SHAPE_LINE_CHAIN::Collide(): Segment( i ).Collide( aSeg, aClearance ) is true and the
+     * bounding boxes of the segments are closer than aClearance.
+     * @return the index of the first colliding segment, or -1 if there is none.
+     */
+    int Collide( const SEG& aSeg, int aClearance = 0 ) const;
+
+    /**
+     * Function Collide()
+     *
+     * Finds a segment of the batch colliding with aCircle, i.e. for which
+     * aCircle.Collide( Segment( i ), aClearance ) is true.
+     * @return the index of the first colliding segment, or -1 if there is none.
+     */
+    int Collide( const SHAPE_CIRCLE& aCircle, int aClearance = 0 ) const;
+
+    /**
+     * Function KernelName()
+     *
+     * Returns the name of the instruction set used to compute the distances
+     * ("AVX", "SSE2" or "scalar"), as chosen at compile time.
+     */
+    static const char* KernelName();
+
+private:
+    ///> Returns true if SEG::Collide() may find a segment with direction aD colliding
+    ///> with an object farther than the clearance (see SEG::PointCloserThan()), in which
+    ///> case the distance can not be used to reject the segment.
+    static bool needsExactTest( const VECTOR2I& aD );
+
+    ///> Marks in aCandidates the segments whose bounding boxes may be closer than aDist to
+    ///> the box (aMin, aMax). Returns false if there is none.
+    bool boxCandidates( const VECTOR2I& aMin, const VECTOR2I& aMax, int aDist,
+                        bool* aCandidates ) const;
+
+    ///> start points and directions of the segments
+    double m_ax[MAX_SIZE];
+    double m_ay[MAX_SIZE];
+    double m_dx[MAX_SIZE];
+    double m_dy[MAX_SIZE];
+
+    int m_count;
+};
+
+#endif    // __SEG_BATCH_H
@@ -207,6 +207,39 @@ public:
         m_backgroundColor = aColor;
     }
 
+    /**
+     * Function SetDetailLevel
+     * Sets the level of detail used to draw the items (see VIEW::SetDetailThreshold()).
+     * @param aLevel is the level of detail, 0 means that every detail has to be drawn.
+     * @param aDetailSize is the size (in world units) of the smallest detail that is visible,
+     * so anything smaller may be simplified or skipped.
+     */
+    inline void SetDetailLevel( int aLevel, double aDetailSize )
+    {
+        m_detailLevel = aLevel;
+        m_detailSize = aDetailSize;
+    }
+
+    /**
+     * Function GetDetailLevel
+     * Returns the current level of detail.
+     * @return The level of detail, 0 if every detail has to be drawn.
+     */
+    inline int GetDetailLevel() const
+    {
+        return m_detailLevel;
+    }
+
+    /**
+     * Function GetDetailSize
+     * Returns the size of the smallest detail that is visible at the current level of detail.
+     * @return The size in world units, 0 if every detail has to be drawn.
+     */
+    inline double GetDetailSize() const
+    {
+        return m_detailSize;
+    }
+
 protected:
     /**
      * Function update
@@ -235,6 +268,9 @@ protected:
 
     COLOR4D m_backgroundColor;      ///< The background color
 
+    int     m_detailLevel;          ///< Level of detail, 0 means full detail
+    double  m_detailSize;           ///< Size of the smallest visible detail
+
     /// Map of colors that were usually used for display
     std::map<EDA_COLOR_T, COLOR4D> m_legacyColorMap;
 };
@@ -301,6 +337,32 @@ public:
      */
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer ) = 0;
 
+    /**
+     * Function CreateWorker
+     * Creates a painter with the same settings, drawing with another GAL. It is used to draw
+     * items on several threads at the same time, so Draw() must not modify the items.
+     * @param aGal is the GAL used by the new painter (usually a worker of the main GAL).
+     * @return The new painter (owned by the caller) or NULL if it is not supported.
+     */
+    virtual PAINTER* CreateWorker( GAL* aGal ) const
+    {
+        return NULL;
+    }
+
+    /**
+     * Function HasDetailLevels
+     * Tells if the item is drawn differently depending on the level of detail (see
+     * RENDER_SETTINGS::SetDetailLevel()). The VIEW caches such items once per level of detail,
+     * the other ones are cached once.
+     * @param aItem is the item.
+     * @param aLayer is the layer on which the item is drawn.
+     * @return True if the item is simplified at low levels of detail.
+     */
+    virtual bool HasDetailLevels( const VIEW_ITEM* aItem, int aLayer ) const
+    {
+        return false;
+    }
+
 protected:
     /// Instance of graphic abstraction layer that gives an interface to call
     /// commands used to draw (eg. DrawLine, DrawCircle, etc.)
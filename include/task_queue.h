@@ -0,0 +1,269 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file task_queue.h
+ * @brief Runs independent tasks on several threads.
+ */
+
+#ifndef TASK_QUEUE_H_
+#define TASK_QUEUE_H_
+
+#include <algorithm>
+#include <deque>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include <ki_mutex.h>
+
+
+/**
+ * Function DefaultThreadCount
+ * @return the number of threads which can run at the same time on this computer.
+ */
+inline int DefaultThreadCount()
+{
+    return std::max( 1, (int) boost::thread::hardware_concurrency() );
+}
+
+
+/**
+ * Class THREAD_POOL
+ * keeps threads waiting for jobs, for the callers which run short tasks very often
+ * (e.g. on each mouse move), where starting new threads each time would cost more
+ * than the tasks themselves.
+ *
+ * The thread calling Run() runs the job too, and the runs of its job which no pool
+ * thread has started when it is done are run by the calling thread itself: Run() only
+ * waits for runs already in progress, so it can be called from a job.
+ */
+class THREAD_POOL
+{
+public:
+    /**
+     * Constructor
+     * @param aThreadCount is the number of threads running jobs, including the thread
+     *                     calling Run(): aThreadCount - 1 threads are started.
+     */
+    THREAD_POOL( int aThreadCount = DefaultThreadCount() ) :
+        m_quit( false )
+    {
+        for( int i = 1; i < aThreadCount; ++i )
+            m_threads.push_back( new boost::thread( &THREAD_POOL::worker, this ) );
+    }
+
+    ~THREAD_POOL()
+    {
+        {
+            boost::mutex::scoped_lock lock( m_lock );
+            m_quit = true;
+        }
+
+        m_wakeUp.notify_all();
+
+        for( unsigned i = 0; i < m_threads.size(); ++i )
+            m_threads[i].join();
+    }
+
+    /**
+     * Function ThreadCount
+     * @return the number of threads running jobs, including the thread calling Run().
+     */
+    int ThreadCount() const
+    {
+        return m_threads.size() + 1;
+    }
+
+    /**
+     * Function Run
+     * runs aJob aCount times, concurrently on the pool threads and on the calling
+     * thread, and returns when all the runs are finished.
+     */
+    void Run( const boost::function<void()>& aJob, int aCount )
+    {
+        int posted = aCount - 1;
+        JOB job = { &aJob, posted, 0 };
+
+        if( posted > 0 )
+        {
+            {
+                boost::mutex::scoped_lock lock( m_lock );
+                m_jobs.push_back( &job );
+            }
+
+            for( int i = 0; i < posted; ++i )
+                m_wakeUp.notify_one();
+        }
+
+        aJob();
+
+        boost::mutex::scoped_lock lock( m_lock );
+
+        // Run the copies still waiting for a thread
+        if( job.m_pending > 0 )
+        {
+            m_jobs.erase( std::find( m_jobs.begin(), m_jobs.end(), &job ) );
+
+            for( ; job.m_pending > 0; job.m_pending-- )
+            {
+                lock.unlock();
+                aJob();
+                lock.lock();
+            }
+        }
+
+        while( job.m_running > 0 )
+            m_finished.wait( lock );
+    }
+
+private:
+    struct JOB
+    {
+        const boost::function<void()>* m_function;
+        int m_pending;          ///< runs not started yet
+        int m_running;          ///< runs in progress on the pool threads
+    };
+
+    void worker()
+    {
+        boost::mutex::scoped_lock lock( m_lock );
+
+        for( ;; )
+        {
+            while( !m_quit && m_jobs.empty() )
+                m_wakeUp.wait( lock );
+
+            if( m_quit )
+                return;
+
+            JOB* job = m_jobs.front();
+
+            if( --job->m_pending == 0 )
+                m_jobs.pop_front();
+
+            job->m_running++;
+
+            lock.unlock();
+            ( *job->m_function )();
+            lock.lock();
+
+            if( --job->m_running == 0 )
+                m_finished.notify_all();
+        }
+    }
+
+    boost::ptr_vector<boost::thread> m_threads;
+
+    ///> Jobs with runs not started yet, protected by m_lock
+    std::deque<JOB*>            m_jobs;
+    bool                        m_quit;
+
+    boost::mutex                m_lock;
+    boost::condition_variable   m_wakeUp;
+    boost::condition_variable   m_finished;
+};
+
+
+/**
+ * Class TASK_QUEUE
+ * runs aCount independent tasks, numbered from 0 to aCount - 1, on several threads.
+ * TASK is a functor called with the task number: TASK::operator()( int ).  It is
+ * called concurrently, so it must be safe to run different tasks at the same time.
+ *
+ * Tasks are started in increasing number order by the first available thread, so
+ * putting the longest tasks first gives the best load balancing.
+ * It uses boost::thread, so it does not depend on the compiler OpenMP support.
+ */
+template <class TASK>
+class TASK_QUEUE
+{
+public:
+    TASK_QUEUE( TASK& aTask, int aCount ) :
+        m_task( aTask ), m_count( aCount ), m_next( 0 )
+    {}
+
+    /**
+     * Function Run
+     * runs all the tasks and returns when they are finished.
+     * @param aThreadCount is the maximal number of threads running tasks, including
+     *                     the calling thread.
+     */
+    void Run( int aThreadCount )
+    {
+        // Something which will not invoke a thread copy constructor
+        boost::ptr_vector<boost::thread> threads;
+
+        aThreadCount = std::min( aThreadCount, m_count );
+
+        // The calling thread runs tasks too
+        for( int i = 1; i < aThreadCount; ++i )
+            threads.push_back( new boost::thread( &TASK_QUEUE::worker, this ) );
+
+        worker();
+
+        for( unsigned i = 0; i < threads.size(); ++i )
+            threads[i].join();
+    }
+
+    /**
+     * Function Run
+     * runs all the tasks on the threads of aPool and returns when they are finished.
+     */
+    void Run( THREAD_POOL& aPool )
+    {
+        aPool.Run( boost::bind( &TASK_QUEUE::worker, this ),
+                   std::min( aPool.ThreadCount(), m_count ) );
+    }
+
+private:
+    void worker()
+    {
+        for( ;; )
+        {
+            int task;
+
+            {
+                MUTLOCK lock( m_lock );
+
+                if( m_next >= m_count )
+                    return;
+
+                task = m_next++;
+            }
+
+            m_task( task );
+        }
+    }
+
+    TASK&   m_task;
+    int     m_count;
+
+    ///> Number of the next task to start, protected by m_lock
+    int     m_next;
+    MUTEX   m_lock;
+};
+
+#endif  // TASK_QUEUE_H_
@@ -47,6 +47,7 @@
 
 #include <list>
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <ttl/ttl_util.h>
@@ -69,10 +70,8 @@ namespace hed
 // Helper typedefs
 class NODE;
 class EDGE;
-typedef boost::shared_ptr<NODE> NODE_PTR;
 typedef boost::shared_ptr<EDGE> EDGE_PTR;
 typedef boost::weak_ptr<EDGE> EDGE_WEAK_PTR;
-typedef std::vector<NODE_PTR> NODES_CONTAINER;
 
 /**
  * \class NODE
@@ -106,8 +105,8 @@ protected:
     /// Tag for quick connection resolution
     int m_tag;
 
-    /// List of board items that share this node
-    std::list<const BOARD_CONNECTED_ITEM*> m_parents;
+    /// List of board items that share this node (usually a few, so a vector is the cheapest)
+    std::vector<const BOARD_CONNECTED_ITEM*> m_parents;
 
     /// Layers that are occupied by this node
     LSET m_layers;
@@ -191,7 +190,8 @@ public:
 
     inline void RemoveParent( const BOARD_CONNECTED_ITEM* aParent )
     {
-        m_parents.remove( aParent );
+        m_parents.erase( std::remove( m_parents.begin(), m_parents.end(), aParent ),
+                         m_parents.end() );
         m_layers.reset();   // mark as needs updating
     }
 
@@ -208,6 +208,93 @@ public:
 };
 
 
+/// Nodes are stored by value in pools, owned by the users of the triangulation
+typedef std::vector<NODE> NODE_POOL;
+
+
+/**
+ * \class NODE_PTR
+ * \brief Handle of a node stored in a NODE_POOL.
+ *
+ * The node is addressed by its index in the pool, so the handle stays valid when the pool
+ * grows. The handle does not own the node: the pool has to outlive it.
+ * Two handles are equal if they refer to the same node.
+ */
+class NODE_PTR
+{
+    /// Type used for the conversion to bool, which cannot be mixed with integers
+    typedef NODE_POOL* NODE_PTR::*UNSPECIFIED_BOOL;
+
+public:
+    /// Constructs a null handle
+    NODE_PTR() : m_pool( NULL ), m_index( 0 )
+    {
+    }
+
+    /// Constructs a handle of the node at index \e aIndex in \e aPool
+    NODE_PTR( NODE_POOL* aPool, unsigned int aIndex ) : m_pool( aPool ), m_index( aIndex )
+    {
+    }
+
+    inline NODE* get() const
+    {
+        return m_pool ? &( *m_pool )[m_index] : NULL;
+    }
+
+    inline NODE* operator->() const
+    {
+        return &( *m_pool )[m_index];
+    }
+
+    inline NODE& operator*() const
+    {
+        return ( *m_pool )[m_index];
+    }
+
+    /// Returns the index of the node in its pool
+    inline unsigned int GetIndex() const
+    {
+        return m_index;
+    }
+
+    /// Makes the handle null
+    inline void reset()
+    {
+        m_pool = NULL;
+        m_index = 0;
+    }
+
+    inline operator UNSPECIFIED_BOOL() const
+    {
+        return m_pool ? &NODE_PTR::m_pool : NULL;
+    }
+
+    inline bool operator==( const NODE_PTR& aOther ) const
+    {
+        return m_pool == aOther.m_pool && m_index == aOther.m_index;
+    }
+
+    inline bool operator!=( const NODE_PTR& aOther ) const
+    {
+        return !( *this == aOther );
+    }
+
+private:
+    NODE_POOL*      m_pool;
+    unsigned int    m_index;
+};
+
+
+/// Hash of a node handle, for boost::unordered containers
+inline std::size_t hash_value( const NODE_PTR& aNode )
+{
+    return aNode.GetIndex();
+}
+
+
+typedef std::vector<NODE_PTR> NODES_CONTAINER;
+
+
 /**
  * \class EDGE
  * \brief \b %Edge class in the in the half-edge data structure.
@@ -369,6 +456,9 @@ protected:
 
     ttl::TRIANGULATION_HELPER* m_helper;
 
+    /// Nodes of the two enclosing triangles
+    NODE_POOL m_boundingNodes;
+
     void addLeadingEdge( EDGE_PTR& aEdge )
     {
         aEdge->SetAsLeadingEdge();
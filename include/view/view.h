@@ -238,6 +238,26 @@ public:
         m_maxScale = aMaximum;
     }
 
+    /**
+     * Function SetDetailThreshold()
+     * Enables drawing simplified items when the view is zoomed out. The items are simplified
+     * once a pixel is bigger than the threshold, and each further level of detail starts when
+     * a pixel is 4 times bigger. The items are cached once per level of detail (see
+     * PAINTER::HasDetailLevels()).
+     * @param aPixelSize is the size of a pixel (in world units) from which the items are
+     * simplified, 0 to always draw every detail.
+     */
+    void SetDetailThreshold( double aPixelSize );
+
+    /**
+     * Function GetDetailLevel()
+     * @return Current level of detail, 0 if every detail is drawn.
+     */
+    inline int GetDetailLevel() const
+    {
+        return m_detailLevel;
+    }
+
     /**
      * Function SetCenter()
      * Sets the center point of the VIEW (i.e. the point in world space that will be drawn in the middle
@@ -564,6 +584,7 @@ public:
     const BOX2I CalculateExtents() ;
 
     static const int VIEW_MAX_LAYERS = 256;      ///< maximum number of layers that may be shown
+    static const int MAX_DETAIL_LEVEL = 3;       ///< lowest level of detail
 
 private:
     struct VIEW_LAYER
@@ -586,6 +607,9 @@ private:
     // Function objects that need to access VIEW/VIEW_ITEM private/protected members
     struct clearLayerCache;
     struct recacheItem;
+    struct recacheJob;
+    struct collectRecacheJobs;
+    struct recacheTask;
     struct drawItem;
     struct unlinkItem;
     struct updateItemsColor;
@@ -596,6 +620,17 @@ private:
     ///* Redraws contents within rect aRect
     void redrawRect( const BOX2I& aRect );
 
+    /**
+     * Function recacheParallel()
+     * Draws again all the items of the cached layers, using several threads to tessellate
+     * them with worker GALs. The groups are then moved to the main GAL in the same order
+     * as RecacheAllItems() creates them.
+     *
+     * @return false if the GAL or the painter cannot draw on several threads, nothing is
+     * done in this case.
+     */
+    bool recacheParallel();
+
     inline void markTargetClean( int aTarget )
     {
         wxASSERT( aTarget < TARGETS_NUMBER );
@@ -650,6 +685,30 @@ private:
      */
     void invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags );
 
+    /**
+     * Function updateDetailLevel()
+     * Computes the level of detail for the current scale and passes it to the painter.
+     */
+    void updateDetailLevel();
+
+    /**
+     * Function groupKey()
+     * Returns the key under which the group of an item is stored for the current level of
+     * detail (see VIEW_ITEM::getGroup()).
+     * @param aItem is the item.
+     * @param aLayer is the layer on which the item is drawn.
+     */
+    int groupKey( const VIEW_ITEM* aItem, int aLayer ) const;
+
+    /// Returns the key of the group of an item drawn on a layer with a level of detail.
+    static inline int detailGroupKey( int aLayer, int aLevel )
+    {
+        return aLayer + aLevel * VIEW_MAX_LAYERS;
+    }
+
+    /// Deletes the groups of an item on a layer, for all the levels of detail
+    void deleteGroups( VIEW_ITEM* aItem, int aLayer );
+
     /// Updates colors that are used for an item to be drawn
     void updateItemColor( VIEW_ITEM* aItem, int aLayer );
 
@@ -698,6 +757,12 @@ private:
     /// Scale upper limit
     double m_maxScale;
 
+    /// Size of a pixel from which the items are simplified, 0 if they are never simplified
+    double m_detailThreshold;
+
+    /// Current level of detail
+    int m_detailLevel;
+
     /// PAINTER contains information how do draw items
     PAINTER* m_painter;
 
@@ -212,6 +212,13 @@ protected:
      */
     void duplicateItems( bool aIncrement ); //override
 
+    /**
+     * Function showUndoStepMemory
+     * shows in the status bar the item count and the estimated memory of the undo step
+     * aList, after it is added to the undo list.
+     */
+    void showUndoStepMemory( const PICKED_ITEMS_LIST& aList );
+
     // protected so that PCB::IFACE::CreateWindow() is the only factory.
     PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent );
 
@@ -1402,8 +1409,12 @@ public:
      * @param aActiveWindow = the current active window, if a progress bar is shown
      *                      = NULL to do not display a progress bar
      * @param aVerbose = true to show error messages
+     * @param aSkippedCount = if not NULL, stores the count of zones which were not
+     *                        refilled, because nothing they depend on was modified
+     *                        since they were filled (see ZONE_CONTAINER::BuildFillFingerprint)
      */
-    int Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose = true );
+    int Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose = true,
+                        int* aSkippedCount = NULL );
 
 
     /**
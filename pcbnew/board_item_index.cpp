@@ -0,0 +1,420 @@
+/**
+ * @file board_item_index.cpp
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+#include <limits>
+
+#include <class_module.h>
+#include <class_track.h>
+
+#include <board_item_index.h>
+
+
+/* Order keys of items appended to a list are spaced by ORDER_STEP, so many items can be
+ * inserted between them before renumbering.  Renumbering spreads the keys of a window of
+ * items around the new one, and the window grows until there is at least ORDER_MIN_STEP
+ * between the keys.
+ */
+#define ORDER_STEP      ( (uint64_t) 1 << 32 )
+#define ORDER_MIN_STEP  ( (uint64_t) 1 << 16 )
+
+
+BOARD_ITEM_INDEX::BOARD_ITEM_INDEX()
+{
+}
+
+
+BOARD_ITEM_INDEX::~BOARD_ITEM_INDEX()
+{
+}
+
+
+void BOARD_ITEM_INDEX::ItemAdded( EDA_ITEM* aItem )
+{
+    ITEM_RTREE* tree = getTree( aItem );
+
+    if( !tree )
+        return;
+
+    m_changedModules.erase( aItem );
+
+    ENTRY* entry = find( aItem );
+
+    if( entry )     // an item is indexed only once
+        ItemRemoved( aItem );
+
+    entry = &m_entries[aItem];
+
+    insertTree( *tree, aItem, *entry );
+    setOrder( aItem );
+
+    if( aItem->Type() == PCB_MODULE_T )
+        insertNames( static_cast<MODULE*>( aItem ), *entry );
+}
+
+
+void BOARD_ITEM_INDEX::ItemRemoved( EDA_ITEM* aItem )
+{
+    ITEM_RTREE* tree = getTree( aItem );
+    ENTRY* entry = find( aItem );
+
+    if( tree && entry )
+    {
+        removeTree( *tree, aItem, *entry );
+
+        if( aItem->Type() == PCB_MODULE_T )
+            removeNames( static_cast<MODULE*>( aItem ), *entry );
+
+        m_entries.erase( aItem );
+    }
+
+    m_changedModules.erase( aItem );
+}
+
+
+void BOARD_ITEM_INDEX::ItemChanged( EDA_ITEM* aItem )
+{
+    ITEM_RTREE* tree = getTree( aItem );
+    ENTRY* entry = find( aItem );
+
+    if( !tree || !entry )
+        return;
+
+    // A footprint reports each change of its pads: it is indexed again once, when needed
+    if( aItem->Type() == PCB_MODULE_T )
+    {
+        m_changedModules.insert( aItem );
+        return;
+    }
+
+    removeTree( *tree, aItem, *entry );
+    insertTree( *tree, aItem, *entry );
+}
+
+
+void BOARD_ITEM_INDEX::updateModules()
+{
+    for( boost::unordered_set<EDA_ITEM*>::iterator it = m_changedModules.begin();
+         it != m_changedModules.end(); ++it )
+    {
+        MODULE* module = static_cast<MODULE*>( *it );
+        ENTRY* entry = find( module );
+
+        if( !entry )
+            continue;
+
+        removeTree( m_moduleTree, module, *entry );
+        insertTree( m_moduleTree, module, *entry );
+        removeNames( module, *entry );
+        insertNames( module, *entry );
+    }
+
+    m_changedModules.clear();
+}
+
+
+void BOARD_ITEM_INDEX::Clear()
+{
+    m_trackTree.RemoveAll();
+    m_moduleTree.RemoveAll();
+    m_entries.clear();
+    m_references.clear();
+    m_paths.clear();
+    m_changedModules.clear();
+}
+
+
+void BOARD_ITEM_INDEX::QueryTracks( const wxPoint& aPosition, std::vector<TRACK*>& aResult )
+{
+    std::vector<EDA_ITEM*> found;
+
+    search( m_trackTree, aPosition, found );
+
+    aResult.clear();
+
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+        aResult.push_back( static_cast<TRACK*>( found[ii] ) );
+}
+
+
+void BOARD_ITEM_INDEX::QueryModules( const wxPoint& aPosition, std::vector<MODULE*>& aResult )
+{
+    std::vector<EDA_ITEM*> found;
+
+    {
+        MUTLOCK lock( m_lock );
+
+        updateModules();
+        search( m_moduleTree, aPosition, found );
+    }
+
+    aResult.clear();
+
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+        aResult.push_back( static_cast<MODULE*>( found[ii] ) );
+}
+
+
+MODULE* BOARD_ITEM_INDEX::FindModuleByReference( const wxString& aReference )
+{
+    MUTLOCK lock( m_lock );
+
+    updateModules();
+
+    return findByName( m_references, aReference );
+}
+
+
+MODULE* BOARD_ITEM_INDEX::FindModuleByPath( const wxString& aPath )
+{
+    MUTLOCK lock( m_lock );
+
+    updateModules();
+
+    return findByName( m_paths, aPath.Upper() );
+}
+
+
+BOARD_ITEM_INDEX::ITEM_RTREE* BOARD_ITEM_INDEX::getTree( const EDA_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        return &m_trackTree;
+
+    case PCB_MODULE_T:
+        return &m_moduleTree;
+
+    default:
+        return NULL;
+    }
+}
+
+
+EDA_RECT BOARD_ITEM_INDEX::getBBox( const EDA_ITEM* aItem )
+{
+    if( aItem->Type() == PCB_MODULE_T )
+    {
+        // The cached bounding box is used by MODULE::HitTest(), the pads are found
+        // in the footprint area, which is computed now as the cached box may be stale.
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+        EDA_RECT bbox = module->GetBoundaryBox();
+
+        bbox.Merge( module->GetFootprintRect() );
+
+        return bbox;
+    }
+
+    return aItem->GetBoundingBox();
+}
+
+
+BOARD_ITEM_INDEX::ENTRY* BOARD_ITEM_INDEX::find( EDA_ITEM* aItem )
+{
+    ENTRY_MAP::iterator it = m_entries.find( aItem );
+
+    if( it == m_entries.end() )
+        return NULL;
+
+    return &it->second;
+}
+
+
+void BOARD_ITEM_INDEX::setOrder( EDA_ITEM* aItem )
+{
+    // The item is already linked to its neighbours.  When a list is appended, the next
+    // items are not indexed yet: they will get larger keys.
+    ENTRY* back = aItem->Back() ? find( aItem->Back() ) : NULL;
+    ENTRY* next = aItem->Next() ? find( aItem->Next() ) : NULL;
+    uint64_t low = back ? back->m_order : 0;
+    ENTRY& entry = m_entries[aItem];
+
+    if( next )
+    {
+        if( next->m_order - low >= 2 )
+        {
+            entry.m_order = low + ( next->m_order - low ) / 2;
+            return;
+        }
+    }
+    else if( low <= std::numeric_limits<uint64_t>::max() - ORDER_STEP )
+    {
+        entry.m_order = low + ORDER_STEP;
+        return;
+    }
+
+    renumber( aItem );
+}
+
+
+void BOARD_ITEM_INDEX::renumber( EDA_ITEM* aItem )
+{
+    for( int half = 16; ; half *= 2 )
+    {
+        EDA_ITEM* first = aItem;
+        EDA_ITEM* last = aItem;
+        uint64_t count = 1;
+
+        for( int ii = 0; ii < half && first->Back(); ++ii, ++count )
+            first = first->Back();
+
+        for( int ii = 0; ii < half && last->Next(); ++ii, ++count )
+            last = last->Next();
+
+        ENTRY* back = first->Back() ? find( first->Back() ) : NULL;
+        ENTRY* next = last->Next() ? find( last->Next() ) : NULL;
+        uint64_t low = back ? back->m_order : 0;
+        uint64_t high = next ? next->m_order : std::numeric_limits<uint64_t>::max();
+        uint64_t step = ( high - low ) / ( count + 1 );
+
+        // The whole list always fits, but maybe not with the minimal step
+        if( step < ORDER_MIN_STEP && ( first->Back() || last->Next() ) )
+            continue;
+
+        uint64_t order = low;
+
+        for( EDA_ITEM* item = first; item != last->Next(); item = item->Next() )
+        {
+            order += step;
+
+            // Items of an appended list which are not indexed yet are skipped
+            ENTRY* entry = find( item );
+
+            if( entry )
+                entry->m_order = order;
+        }
+
+        return;
+    }
+}
+
+
+void BOARD_ITEM_INDEX::insertTree( ITEM_RTREE& aTree, EDA_ITEM* aItem, ENTRY& aEntry )
+{
+    EDA_RECT bbox = getBBox( aItem );
+    bbox.Normalize();
+    bbox.Inflate( 1 );      // EDA_RECT::Contains() includes the box edges
+
+    const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+    const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+    aTree.Insert( mmin, mmax, aItem );
+    aEntry.m_bbox = bbox;
+}
+
+
+void BOARD_ITEM_INDEX::removeTree( ITEM_RTREE& aTree, EDA_ITEM* aItem, const ENTRY& aEntry )
+{
+    const EDA_RECT& bbox = aEntry.m_bbox;
+    const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+    const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+    aTree.Remove( mmin, mmax, aItem );
+}
+
+
+void BOARD_ITEM_INDEX::search( ITEM_RTREE& aTree, const wxPoint& aPosition,
+                               std::vector<EDA_ITEM*>& aItems )
+{
+    const int mmin[2] = { aPosition.x, aPosition.y };
+
+    aItems.clear();
+
+    ITEM_COLLECTOR collector( aItems );
+    aTree.Search( mmin, mmin, collector );
+
+    if( aItems.size() < 2 )
+        return;
+
+    // Restore the list order
+    std::vector< std::pair<uint64_t, EDA_ITEM*> > sorted;
+    sorted.reserve( aItems.size() );
+
+    for( unsigned ii = 0; ii < aItems.size(); ++ii )
+        sorted.push_back( std::make_pair( find( aItems[ii] )->m_order, aItems[ii] ) );
+
+    std::sort( sorted.begin(), sorted.end() );
+
+    for( unsigned ii = 0; ii < sorted.size(); ++ii )
+        aItems[ii] = sorted[ii].second;
+}
+
+
+void BOARD_ITEM_INDEX::insertNames( MODULE* aModule, ENTRY& aEntry )
+{
+    aEntry.m_reference = aModule->GetReference();
+    aEntry.m_path = aModule->GetPath().Upper();
+
+    m_references.insert( std::make_pair( aEntry.m_reference, aModule ) );
+    m_paths.insert( std::make_pair( aEntry.m_path, aModule ) );
+}
+
+
+void BOARD_ITEM_INDEX::removeNames( MODULE* aModule, const ENTRY& aEntry )
+{
+    NAME_MAP* maps[] = { &m_references, &m_paths };
+    const wxString* names[] = { &aEntry.m_reference, &aEntry.m_path };
+
+    for( int ii = 0; ii < 2; ++ii )
+    {
+        std::pair<NAME_MAP::iterator, NAME_MAP::iterator> range =
+                maps[ii]->equal_range( *names[ii] );
+
+        for( NAME_MAP::iterator it = range.first; it != range.second; ++it )
+        {
+            if( it->second == aModule )
+            {
+                maps[ii]->erase( it );
+                break;
+            }
+        }
+    }
+}
+
+
+MODULE* BOARD_ITEM_INDEX::findByName( NAME_MAP& aMap, const wxString& aName )
+{
+    std::pair<NAME_MAP::iterator, NAME_MAP::iterator> range = aMap.equal_range( aName );
+    MODULE* found = NULL;
+    uint64_t foundOrder = 0;
+
+    // Several footprints may have the same name, the first one in the list is returned
+    for( NAME_MAP::iterator it = range.first; it != range.second; ++it )
+    {
+        uint64_t order = find( it->second )->m_order;
+
+        if( !found || order < foundOrder )
+        {
+            found = it->second;
+            foundOrder = order;
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file board_item_index.h
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef _BOARD_ITEM_INDEX_H
+#define _BOARD_ITEM_INDEX_H
+
+#include <vector>
+#include <stdint.h>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <dlist.h>
+#include <class_eda_rect.h>
+#include <hashtables.h>
+#include <geometry/rtree.h>
+#include <ki_mutex.h>
+
+class TRACK;
+class MODULE;
+
+
+/**
+ * Class BOARD_ITEM_INDEX
+ * is a spatial index (R-trees) over the tracks, vias and footprints of a BOARD, used
+ * by the BOARD locate functions instead of walking the whole track and footprint lists.
+ * Footprints are also indexed by reference and by path (time stamp) for the BOARD
+ * find functions.
+ *
+ * It listens to the BOARD::m_Track and BOARD::m_Modules lists, so it is kept up to date
+ * however items are added to or removed from them.  Tracks report their shape changes,
+ * footprints report the changes of their bounding box (MODULE::CalculateBoundingBox()),
+ * of their pads (D_PAD setters), of their reference (TEXTE_MODULE::SetText()) and of
+ * their path (MODULE::SetPath()).  Changed footprints are indexed again by the next
+ * footprint query, with an area computed from their pads and drawings at that time, so
+ * the pad lookup does not depend on the cached MODULE bounding box being up to date.
+ *
+ * Queries may run on several threads, as long as the board is not changed meanwhile.
+ *
+ * Queries return the items whose indexed bounding box contains a point, in list order,
+ * so the locate functions keep returning the first matching item of the list.  To do
+ * this, each item has an order key, increasing along the list, which is chosen between
+ * the keys of its neighbours when the item is inserted.  Layers are not indexed: the
+ * caller filters the candidates by layer.
+ */
+class BOARD_ITEM_INDEX : public DHEAD_LISTENER
+{
+public:
+    BOARD_ITEM_INDEX();
+    ~BOARD_ITEM_INDEX();
+
+    void ItemAdded( EDA_ITEM* aItem );
+    void ItemRemoved( EDA_ITEM* aItem );
+    void ItemChanged( EDA_ITEM* aItem );
+
+    /**
+     * Function Clear
+     * removes all the items from the index.
+     */
+    void Clear();
+
+    /**
+     * Function QueryTracks
+     * collects the tracks and vias whose bounding box contains aPosition.
+     * @param aResult is filled with the candidates, in track list order.
+     */
+    void QueryTracks( const wxPoint& aPosition, std::vector<TRACK*>& aResult );
+
+    /**
+     * Function QueryModules
+     * collects the footprints whose area contains aPosition: their bounding box
+     * (MODULE::HitTest()) or the area of their pads and drawings
+     * (MODULE::GetFootprintRect()).
+     * @param aResult is filled with the candidates, in footprint list order.
+     */
+    void QueryModules( const wxPoint& aPosition, std::vector<MODULE*>& aResult );
+
+    /**
+     * Function FindModuleByReference
+     * @return the first footprint of the list whose reference is aReference, or NULL.
+     */
+    MODULE* FindModuleByReference( const wxString& aReference );
+
+    /**
+     * Function FindModuleByPath
+     * @return the first footprint of the list whose path is aPath (case insensitive),
+     *         or NULL.
+     */
+    MODULE* FindModuleByPath( const wxString& aPath );
+
+private:
+    typedef RTree<EDA_ITEM*, int, 2, float> ITEM_RTREE;
+
+    struct ENTRY
+    {
+        EDA_RECT    m_bbox;     ///< bounding box stored in the tree
+        uint64_t    m_order;    ///< order key in the list
+        wxString    m_reference;    ///< footprint reference stored in m_references
+        wxString    m_path;         ///< footprint path stored in m_paths (upper case)
+    };
+
+    typedef boost::unordered_map<EDA_ITEM*, ENTRY> ENTRY_MAP;
+    typedef boost::unordered_multimap<wxString, MODULE*, WXSTRING_HASH> NAME_MAP;
+
+    /// Collects the items found by a search.
+    struct ITEM_COLLECTOR
+    {
+        ITEM_COLLECTOR( std::vector<EDA_ITEM*>& aItems ) :
+            m_items( aItems )
+        {}
+
+        bool operator()( EDA_ITEM* aItem )
+        {
+            m_items.push_back( aItem );
+            return true;
+        }
+
+        std::vector<EDA_ITEM*>& m_items;
+    };
+
+    ///> Returns the tree storing aItem type, or NULL if this type is not indexed.
+    ITEM_RTREE* getTree( const EDA_ITEM* aItem );
+
+    ///> Returns the area of aItem found by the locate functions.
+    static EDA_RECT getBBox( const EDA_ITEM* aItem );
+
+    ///> Indexes again the footprints changed since the last footprint query.
+    ///> m_lock must be locked.
+    void updateModules();
+
+    ///> Sets the order key of a new item, between the keys of its neighbours.
+    void setOrder( EDA_ITEM* aItem );
+
+    ///> Spreads the order keys of the items around aItem to make room for its key.
+    void renumber( EDA_ITEM* aItem );
+
+    ///> Returns the entry of aItem, or NULL if it is not indexed.
+    ENTRY* find( EDA_ITEM* aItem );
+
+    void insertTree( ITEM_RTREE& aTree, EDA_ITEM* aItem, ENTRY& aEntry );
+    void removeTree( ITEM_RTREE& aTree, EDA_ITEM* aItem, const ENTRY& aEntry );
+    void search( ITEM_RTREE& aTree, const wxPoint& aPosition, std::vector<EDA_ITEM*>& aItems );
+
+    void insertNames( MODULE* aModule, ENTRY& aEntry );
+    void removeNames( MODULE* aModule, const ENTRY& aEntry );
+
+    ///> Returns the first footprint of the list stored in aMap with aName.
+    MODULE* findByName( NAME_MAP& aMap, const wxString& aName );
+
+    ITEM_RTREE  m_trackTree;
+    ITEM_RTREE  m_moduleTree;
+
+    ///> Indexed items.  The bounding boxes are needed to remove an item from a tree after
+    ///> it has changed.
+    ENTRY_MAP   m_entries;
+
+    NAME_MAP    m_references;
+    NAME_MAP    m_paths;
+
+    ///> Footprints changed since they were indexed, protected by m_lock
+    boost::unordered_set<EDA_ITEM*> m_changedModules;
+
+    ///> Serializes the footprint queries, which update the footprint tree
+    MUTEX       m_lock;
+};
+
+
+#endif  // _BOARD_ITEM_INDEX_H
@@ -297,20 +297,20 @@ void ZONE_CONTAINER::TransformSolidAreasShapesToPolygonSet(
     int i_start_contour = 0;
     for( unsigned ic = 0; ic < cornerscount; ic++ )
     {
-        seg_start.x = m_FilledPolysList[ ic ].x;
-        seg_start.y = m_FilledPolysList[ ic ].y;
+        seg_start.x = m_FilledPolysList.GetX( ic );
+        seg_start.y = m_FilledPolysList.GetY( ic );
         unsigned ic_next = ic+1;
 
-        if( !m_FilledPolysList[ic].end_contour &&
+        if( !m_FilledPolysList.IsEndContour( ic ) &&
             ic_next < cornerscount )
         {
-            seg_end.x = m_FilledPolysList[ ic_next ].x;
-            seg_end.y = m_FilledPolysList[ ic_next ].y;
+            seg_end.x = m_FilledPolysList.GetX( ic_next );
+            seg_end.y = m_FilledPolysList.GetY( ic_next );
         }
         else
         {
-            seg_end.x = m_FilledPolysList[ i_start_contour ].x;
-            seg_end.y = m_FilledPolysList[ i_start_contour ].y;
+            seg_end.x = m_FilledPolysList.GetX( i_start_contour );
+            seg_end.y = m_FilledPolysList.GetY( i_start_contour );
             i_start_contour = ic_next;
         }
 
@@ -38,11 +38,14 @@
 #include <class_pcb_text.h>
 #include <class_mire.h>
 #include <class_module.h>
+#include <class_pad.h>
 #include <class_dimension.h>
 #include <class_zone.h>
 #include <class_edge_mod.h>
+#include <3d_struct.h>
 
 #include <ratsnest_data.h>
+#include <drc_stuff.h>
 
 #include <tools/selection_tool.h>
 #include <tool/tool_manager.h>
@@ -180,6 +183,170 @@ static bool TestForExistingItem( BOARD* aPcb, BOARD_ITEM* aItem )
 }
 
 
+/// Returns the memory used by the characters of aText
+static size_t textMemory( const wxString& aText )
+{
+    return ( aText.length() + 1 ) * sizeof( wxChar );
+}
+
+
+/// Returns the memory used by the elements of aVector
+template <class T>
+static size_t vectorMemory( const std::vector<T>& aVector )
+{
+    return aVector.capacity() * sizeof( T );
+}
+
+
+/**
+ * Function cornersMemory
+ * returns the share of this copy of aCorners in the memory of its corners: corners
+ * shared by several copies of a zone (the board zone and its undo copies) are split
+ * between them, so the memory of all the copies adds up to the memory really used.
+ */
+static size_t cornersMemory( const CPOLYGONS_LIST& aCorners )
+{
+    return aCorners.GetMemorySize() / aCorners.ShareCount();
+}
+
+
+/// Returns the memory used by a CPolyLine, aPoly may be NULL
+static size_t polyLineMemory( const CPolyLine* aPoly )
+{
+    if( !aPoly )
+        return 0;
+
+    return sizeof( CPolyLine ) + cornersMemory( aPoly->m_CornersList ) +
+           vectorMemory( aPoly->m_HatchLines );
+}
+
+
+/// Returns the memory used by a graphic item or a footprint graphic item
+static size_t drawSegmentMemory( const DRAWSEGMENT* aSegment, size_t aSize )
+{
+    return aSize + vectorMemory( aSegment->GetPolyPoints() ) +
+           vectorMemory( aSegment->GetBezierPoints() );
+}
+
+
+/**
+ * Function itemMemory
+ * estimates the memory used by a board item: the item, its children, and the buffers
+ * it owns (texts, corners and points).  The corners of zone outlines and fillings shared
+ * with other copies of the zone are counted for their share only.
+ * Memory allocator overheads are not counted.
+ * @param aItem = the item
+ * @return the size in bytes
+ */
+static size_t itemMemory( const BOARD_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        size_t size = sizeof( MODULE ) + textMemory( module->GetDescription() ) +
+                      textMemory( module->GetKeywords() ) + textMemory( module->GetPath() );
+
+        // Reference and value are allocated with the module
+        size += itemMemory( &module->Reference() ) + itemMemory( &module->Value() );
+
+        for( const D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            size += itemMemory( pad );
+
+        for( const BOARD_ITEM* item = module->GraphicalItems(); item; item = item->Next() )
+            size += itemMemory( item );
+
+        size += module->Models().GetCount() * sizeof( S3D_MASTER );
+
+        return size;
+    }
+
+    case PCB_PAD_T:
+        return sizeof( D_PAD );
+
+    case PCB_MODULE_TEXT_T:
+        return sizeof( TEXTE_MODULE ) +
+               textMemory( static_cast<const TEXTE_MODULE*>( aItem )->GetText() );
+
+    case PCB_MODULE_EDGE_T:
+        return drawSegmentMemory( static_cast<const EDGE_MODULE*>( aItem ),
+                                  sizeof( EDGE_MODULE ) );
+
+    case PCB_ZONE_AREA_T:
+    {
+        const ZONE_CONTAINER* zone = static_cast<const ZONE_CONTAINER*>( aItem );
+
+        return sizeof( ZONE_CONTAINER ) + polyLineMemory( zone->Outline() ) +
+               polyLineMemory( zone->GetSmoothedPoly() ) +
+               vectorMemory( zone->FillSegments() ) +
+               cornersMemory( zone->GetFilledPolysList() );
+    }
+
+    case PCB_LINE_T:
+        return drawSegmentMemory( static_cast<const DRAWSEGMENT*>( aItem ),
+                                  sizeof( DRAWSEGMENT ) );
+
+    case PCB_TRACE_T:
+        return sizeof( TRACK );
+
+    case PCB_VIA_T:
+        return sizeof( VIA );
+
+    case PCB_TEXT_T:
+        return sizeof( TEXTE_PCB ) +
+               textMemory( static_cast<const TEXTE_PCB*>( aItem )->GetText() );
+
+    case PCB_TARGET_T:
+        return sizeof( PCB_TARGET );
+
+    case PCB_DIMENSION_T:
+        return sizeof( DIMENSION ) + textMemory( static_cast<const DIMENSION*>( aItem )->GetText() );
+
+    default:
+        return sizeof( BOARD_ITEM );
+    }
+}
+
+
+/**
+ * Function undoCommandMemory
+ * estimates the memory used by the items owned by an undo command: the copies of changed
+ * items, and the deleted items.
+ * @param aList = the undo command
+ * @return the size in bytes
+ */
+static size_t undoCommandMemory( const PICKED_ITEMS_LIST& aList )
+{
+    size_t size = 0;
+
+    for( unsigned ii = 0; ii < aList.GetCount(); ii++ )
+    {
+        const BOARD_ITEM* image = (const BOARD_ITEM*) aList.GetPickedItemLink( ii );
+
+        if( image )
+            size += itemMemory( image );
+
+        if( aList.GetPickedItemStatus( ii ) == UR_DELETED )
+            size += itemMemory( (const BOARD_ITEM*) aList.GetPickedItem( ii ) );
+    }
+
+    return size;
+}
+
+
+void PCB_EDIT_FRAME::showUndoStepMemory( const PICKED_ITEMS_LIST& aList )
+{
+    wxString msg;
+
+    msg.Printf( _( "Undo step %d: %u items, %.1f kB" ), GetScreen()->GetUndoCommandCount(),
+                aList.GetCount(), undoCommandMemory( aList ) / 1024.0 );
+
+    SetStatusText( msg );
+}
+
+
 void BOARD_ITEM::SwapData( BOARD_ITEM* aImage )
 {
     if( aImage == NULL )
@@ -358,9 +525,14 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( BOARD_ITEM*    aItem,
 
     if( commandToUndo->GetCount() )
     {
+        // Changed items have to be tested again by the incremental DRC
+        m_drc->AddChangedItems( *commandToUndo );
+
         /* Save the copy in undo list */
         GetScreen()->PushCommandToUndoList( commandToUndo );
 
+        showUndoStepMemory( *commandToUndo );
+
         /* Clear redo list, because after new save there is no redo to do */
         GetScreen()->ClearUndoORRedoList( GetScreen()->m_RedoList );
     }
@@ -444,9 +616,14 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
 
     if( commandToUndo->GetCount() )
     {
+        // Changed items have to be tested again by the incremental DRC
+        m_drc->AddChangedItems( *commandToUndo );
+
         /* Save the copy in undo list */
         GetScreen()->PushCommandToUndoList( commandToUndo );
 
+        showUndoStepMemory( *commandToUndo );
+
         /* Clear redo list, because after a new command one cannot redo a command */
         GetScreen()->ClearUndoORRedoList( GetScreen()->m_RedoList );
     }
@@ -622,6 +799,8 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
     if( not_found )
         wxMessageBox( wxT( "Incomplete undo/redo operation: some items not found" ) );
 
+    m_drc->AddChangedItems( *aList );
+
     // Rebuild pointers and ratsnest that can be changed.
     if( reBuild_ratsnest && aRebuildRatsnet )
     {
@@ -43,6 +43,7 @@
 #include <base_units.h>
 #include <ratsnest_data.h>
 #include <ratsnest_viewitem.h>
+#include <board_item_index.h>
 #include <worksheet_viewitem.h>
 
 #include <pcbnew.h>
@@ -107,11 +108,20 @@ BOARD::BOARD() :
 
     // Initialize ratsnest
     m_ratsnest = new RN_DATA( this );
+
+    m_itemIndex = new BOARD_ITEM_INDEX;
+    m_Track.SetListener( m_itemIndex );
+    m_Modules.SetListener( m_itemIndex );
 }
 
 
 BOARD::~BOARD()
 {
+    // The lists are deleted after the index
+    m_Track.SetListener( NULL );
+    m_Modules.SetListener( NULL );
+    delete m_itemIndex;
+
     while( m_ZoneDescriptorList.size() )
     {
         ZONE_CONTAINER* area_to_remove = m_ZoneDescriptorList[0];
@@ -1265,65 +1275,26 @@ NETINFO_ITEM* BOARD::FindNet( const wxString& aNetname ) const
 
 MODULE* BOARD::FindModuleByReference( const wxString& aReference ) const
 {
-    struct FINDER : public INSPECTOR
-    {
-        MODULE* found;
-
-        FINDER() : found( 0 )  {}
-
-        // implement interface INSPECTOR
-        SEARCH_RESULT Inspect( EDA_ITEM* item, const void* data )
-        {
-            MODULE*         module = (MODULE*) item;
-            const wxString& ref    = *(const wxString*) data;
-
-            if( ref == module->GetReference() )
-            {
-                found = module;
-                return SEARCH_QUIT;
-            }
-
-            return SEARCH_CONTINUE;
-        }
-    } inspector;
-
-    // search only for MODULES
-    static const KICAD_T scanTypes[] = { PCB_MODULE_T, EOT };
-
-    // visit this BOARD with the above inspector
-    BOARD* nonconstMe = (BOARD*) this;
-    nonconstMe->Visit( &inspector, &aReference, scanTypes );
-
-    return inspector.found;
+    return m_itemIndex->FindModuleByReference( aReference );
 }
 
 
 MODULE* BOARD::FindModule( const wxString& aRefOrTimeStamp, bool aSearchByTimeStamp ) const
 {
     if( aSearchByTimeStamp )
-    {
-        for( MODULE* module = m_Modules;  module;  module = module->Next() )
-        {
-            if( aRefOrTimeStamp.CmpNoCase( module->GetPath() ) == 0 )
-                return module;
-        }
-    }
-    else
-    {
+        return m_itemIndex->FindModuleByPath( aRefOrTimeStamp );
 
 #if 0   // case independent compare, why?
-        for( MODULE* module = m_Modules;  module;  module = module->Next() )
-        {
-            if( aRefOrTimeStamp.CmpNoCase( module->GetReference() ) == 0 )
-                return module;
-        }
-#else
-        return FindModuleByReference( aRefOrTimeStamp );
-#endif
-
+    for( MODULE* module = m_Modules;  module;  module = module->Next() )
+    {
+        if( aRefOrTimeStamp.CmpNoCase( module->GetReference() ) == 0 )
+            return module;
     }
 
     return NULL;
+#else
+    return FindModuleByReference( aRefOrTimeStamp );
+#endif
 }
 
 
@@ -1472,9 +1443,14 @@ int BOARD::SetAreasNetCodesFromNetNames()
 
 VIA* BOARD::GetViaByPosition( const wxPoint& aPosition, LAYER_ID aLayer) const
 {
-    for( VIA *via = GetFirstVia( m_Track); via; via = GetFirstVia( via->Next() ) )
+    std::vector<TRACK*> candidates;
+    m_itemIndex->QueryTracks( aPosition, candidates );
+
+    for( unsigned ii = 0; ii < candidates.size(); ++ii )
     {
-        if( (via->GetStart() == aPosition) &&
+        VIA* via = dyn_cast<VIA*>( candidates[ii] );
+
+        if( via && (via->GetStart() == aPosition) &&
                 (via->GetState( BUSY | IS_DELETED ) == 0) &&
                 ((aLayer == UNDEFINED_LAYER) || (via->IsOnLayer( aLayer ))) )
             return via;
@@ -1489,15 +1465,7 @@ D_PAD* BOARD::GetPad( const wxPoint& aPosition, LSET aLayerMask )
     if( !aLayerMask.any() )
         aLayerMask = LSET::AllCuMask();
 
-    for( MODULE* module = m_Modules;  module;  module = module->Next() )
-    {
-        D_PAD* pad = module->GetPad( aPosition, aLayerMask );
-
-        if( pad )
-            return pad;
-    }
-
-    return NULL;
+    return getPad( aPosition, aLayerMask );
 }
 
 
@@ -1507,9 +1475,19 @@ D_PAD* BOARD::GetPad( TRACK* aTrace, ENDPOINT_T aEndPoint )
 
     LSET aLayerMask( aTrace->GetLayer() );
 
-    for( MODULE* module = m_Modules;  module;  module = module->Next() )
+    return getPad( aPosition, aLayerMask );
+}
+
+
+D_PAD* BOARD::getPad( const wxPoint& aPosition, LSET aLayerMask )
+{
+    // Pads are inside the bounding box of their footprint
+    std::vector<MODULE*> candidates;
+    m_itemIndex->QueryModules( aPosition, candidates );
+
+    for( unsigned ii = 0; ii < candidates.size(); ++ii )
     {
-        D_PAD*  pad = module->GetPad( aPosition, aLayerMask );
+        D_PAD* pad = candidates[ii]->GetPad( aPosition, aLayerMask );
 
         if( pad )
             return pad;
@@ -1668,35 +1646,50 @@ void BOARD::GetSortedPadListByXthenYCoord( std::vector<D_PAD*>& aVector, int aNe
 TRACK* BOARD::GetTrack( TRACK* aTrace, const wxPoint& aPosition,
         LSET aLayerMask ) const
 {
-    for( TRACK* track = aTrace; track; track = track->Next() )
+    // The index knows the list order, but not which tracks are after aTrace:
+    // searching from another track than the first one walks the list
+    if( aTrace != m_Track.GetFirst() )
     {
-        LAYER_ID layer = track->GetLayer();
-
-        if( track->GetState( BUSY | IS_DELETED ) )
-            continue;
-
-        if( m_designSettings.IsLayerVisible( layer ) == false )
-            continue;
-
-        if( track->Type() == PCB_VIA_T )    /* VIA encountered. */
+        for( TRACK* track = aTrace; track; track = track->Next() )
         {
-            if( track->HitTest( aPosition ) )
+            if( isTrackAt( track, aPosition, aLayerMask ) )
                 return track;
         }
-        else
-        {
-            if( !aLayerMask[layer] )
-                continue;   // Segments on different layers.
 
-            if( track->HitTest( aPosition ) )
-                return track;
-        }
+        return NULL;
+    }
+
+    std::vector<TRACK*> candidates;
+    m_itemIndex->QueryTracks( aPosition, candidates );
+
+    for( unsigned ii = 0; ii < candidates.size(); ++ii )
+    {
+        if( isTrackAt( candidates[ii], aPosition, aLayerMask ) )
+            return candidates[ii];
     }
 
     return NULL;
 }
 
 
+bool BOARD::isTrackAt( const TRACK* aTrack, const wxPoint& aPosition, LSET aLayerMask ) const
+{
+    LAYER_ID layer = aTrack->GetLayer();
+
+    if( aTrack->GetState( BUSY | IS_DELETED ) )
+        return false;
+
+    if( m_designSettings.IsLayerVisible( layer ) == false )
+        return false;
+
+    // Vias are on all the layers of the mask
+    if( aTrack->Type() != PCB_VIA_T && !aLayerMask[layer] )
+        return false;   // Segments on different layers.
+
+    return aTrack->HitTest( aPosition );
+}
+
+
 TRACK* BOARD::MarkTrace( TRACK*  aTrace, int* aCount,
                          double* aTraceLength, double* aPadToDieLength,
                          bool    aReorder )
@@ -1947,8 +1940,14 @@ MODULE* BOARD::GetFootprint( const wxPoint& aPosition, LAYER_ID aActiveLayer,
     int     alt_min_dim = 0x7FFFFFFF;
     bool    current_layer_back = IsBackLayer( aActiveLayer );
 
-    for( pt_module = m_Modules;  pt_module;  pt_module = (MODULE*) pt_module->Next() )
+    // Footprints whose bounds contain the ref point, in list order
+    std::vector<MODULE*> candidates;
+    m_itemIndex->QueryModules( aPosition, candidates );
+
+    for( unsigned ii = 0; ii < candidates.size(); ++ii )
     {
+        pt_module = candidates[ii];
+
         // is the ref point within the module's bounds?
         if( !pt_module->HitTest( aPosition ) )
             continue;
@@ -2008,21 +2007,29 @@ MODULE* BOARD::GetFootprint( const wxPoint& aPosition, LAYER_ID aActiveLayer,
 
 BOARD_CONNECTED_ITEM* BOARD::GetLockPoint( const wxPoint& aPosition, LSET aLayerMask )
 {
-    for( MODULE* module = m_Modules; module; module = module->Next() )
-    {
-        D_PAD* pad = module->GetPad( aPosition, aLayerMask );
+    D_PAD* pad = getPad( aPosition, aLayerMask );
 
-        if( pad )
-            return pad;
-    }
+    if( pad )
+        return pad;
 
-    // No pad has been located so check for a segment of the trace.
-    TRACK* segment = ::GetTrack( m_Track, NULL, aPosition, aLayerMask );
+    // No pad has been located so check for a segment of the trace ending at aPosition
+    // (same test as ::GetTrack()), then for any segment at aPosition.
+    std::vector<TRACK*> candidates;
+    m_itemIndex->QueryTracks( aPosition, candidates );
 
-    if( segment == NULL )
-        segment = GetTrack( m_Track, aPosition, aLayerMask );
+    for( unsigned ii = 0; ii < candidates.size(); ++ii )
+    {
+        TRACK* segment = candidates[ii];
+
+        if( segment->GetState( IS_DELETED | BUSY ) )
+            continue;
+
+        if( ( aPosition == segment->GetStart() || aPosition == segment->GetEnd() )
+                && ( aLayerMask & segment->GetLayerSet() ).any() )
+            return segment;
+    }
 
-    return segment;
+    return GetTrack( m_Track, aPosition, aLayerMask );
 }
 
 
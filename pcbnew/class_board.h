@@ -57,6 +57,7 @@ class MSG_PANEL_ITEM;
 class NETLIST;
 class REPORTER;
 class RN_DATA;
+class BOARD_ITEM_INDEX;
 
 namespace KIGFX
 {
@@ -197,6 +198,7 @@ private:
     EDA_RECT                m_BoundingBox;
     NETINFO_LIST            m_NetInfo;              ///< net info list (name, design constraints ..
     RN_DATA*                m_ratsnest;
+    BOARD_ITEM_INDEX*       m_itemIndex;            ///< spatial index used by the locate functions
 
     BOARD_DESIGN_SETTINGS   m_designSettings;
     ZONE_SETTINGS           m_zoneSettings;
@@ -222,6 +224,20 @@ private:
      */
     void chainMarkedSegments( wxPoint aPosition, LSET aLayerMask, TRACK_PTRS* aList );
 
+    /**
+     * Function getPad
+     * finds the first pad at \a aPosition on \a aLayerMask, in footprint list order.
+     */
+    D_PAD* getPad( const wxPoint& aPosition, LSET aLayerMask );
+
+    /**
+     * Function isTrackAt
+     * is the GetTrack() test of a track: \a aTrack is not flagged as deleted or busy,
+     * is on a visible layer of \a aLayerMask (any layer for a via) and is hit by
+     * \a aPosition.
+     */
+    bool isTrackAt( const TRACK* aTrack, const wxPoint& aPosition, LSET aLayerMask ) const;
+
 public:
     static inline bool ClassOf( const EDA_ITEM* aItem )
     {
@@ -1252,6 +1268,15 @@ public:
      */
     D_PAD* GetPad( TRACK* aTrace, ENDPOINT_T aEndPoint );
 
+    /**
+     * Function GetItemIndex
+     * @return the spatial index of the tracks and footprints of the board.
+     */
+    BOARD_ITEM_INDEX* GetItemIndex() const
+    {
+        return m_itemIndex;
+    }
+
     /**
      * Function GetPadFast
      * return pad found at \a aPosition on \a aLayerMask using the fast search method.
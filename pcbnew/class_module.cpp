@@ -489,10 +489,24 @@ void MODULE::DrawEdgesOnly( EDA_DRAW_PANEL* panel, wxDC* DC, const wxPoint& offs
 }
 
 
+void MODULE::SetPath( const wxString& aPath )
+{
+    m_Path = aPath;
+
+    // Update the board path index
+    if( GetList() )
+        GetList()->ItemChanged( this );
+}
+
+
 void MODULE::CalculateBoundingBox()
 {
     m_BoundaryBox = GetFootprintRect();
     m_Surface = std::abs( (double) m_BoundaryBox.GetWidth() * m_BoundaryBox.GetHeight() );
+
+    // Update the board spatial index
+    if( GetList() )
+        GetList()->ItemChanged( this );
 }
 
 
@@ -138,6 +138,13 @@ public:
      */
     void CalculateBoundingBox();
 
+    /**
+     * Function GetBoundaryBox
+     * @return the bounding box computed by the last CalculateBoundingBox() call,
+     *         which is used by HitTest().
+     */
+    const EDA_RECT& GetBoundaryBox() const { return m_BoundaryBox; }
+
     /**
      * Function GetFootprintRect()
      * Returns the area of the module footprint excluding any text.
@@ -173,7 +180,7 @@ public:
     void SetKeywords( const wxString& aKeywords ) { m_KeyWord = aKeywords; }
 
     const wxString& GetPath() const { return m_Path; }
-    void SetPath( const wxString& aPath ) { m_Path = aPath; }
+    void SetPath( const wxString& aPath );
 
     int GetLocalSolderMaskMargin() const { return m_LocalSolderMaskMargin; }
     void SetLocalSolderMaskMargin( int aMargin ) { m_LocalSolderMaskMargin = aMargin; }
@@ -241,6 +241,17 @@ void D_PAD::SetDrawCoord()
 
     RotatePoint( &m_Pos.x, &m_Pos.y, angle );
     m_Pos += module->GetPosition();
+
+    areaChanged();
+}
+
+
+void D_PAD::areaChanged()
+{
+    MODULE* module = GetParent();
+
+    if( module && module->GetList() )
+        module->GetList()->ItemChanged( module );
 }
 
 
@@ -272,6 +283,7 @@ void D_PAD::SetOrientation( double aAngle )
 {
     NORMALIZE_ANGLE_POS( aAngle );
     m_Orient = aAngle;
+    areaChanged();
 }
 
 
@@ -850,6 +862,7 @@ void D_PAD::Rotate( const wxPoint& aRotCentre, double aAngle )
     NORMALIZE_ANGLE_360( m_Orient );
 
     SetLocalCoord();
+    areaChanged();
 }
 
 
@@ -121,6 +121,13 @@ public:
 
     void Copy( TEXTE_MODULE* source ); // copy structure
 
+    /**
+     * Function SetText
+     * changes the text and, for a reference, tells the parent footprint list, so
+     * the footprint is found by its new reference.
+     */
+    void SetText( const wxString& aText );
+
     int GetLength() const;        // text length
 
     /**
@@ -189,6 +196,9 @@ public:
 #endif
 
 private:
+    ///> Tells the list of the parent footprint that its reference has changed.
+    void referenceChanged();
+
     /* Note: orientation in 1/10 deg relative to the footprint
      * Physical orient is m_Orient + m_Parent->m_Orient
      */
@@ -332,6 +332,7 @@ void TRACK::Rotate( const wxPoint& aRotCentre, double aAngle )
 {
     RotatePoint( &m_Start, aRotCentre, aAngle );
     RotatePoint( &m_End, aRotCentre, aAngle );
+    shapeChanged();
 }
 
 
@@ -340,6 +341,14 @@ void TRACK::Flip( const wxPoint& aCentre )
     m_Start.y = aCentre.y - (m_Start.y - aCentre.y);
     m_End.y   = aCentre.y - (m_End.y - aCentre.y);
     SetLayer( FlipLayer( GetLayer() ) );
+    shapeChanged();
+}
+
+
+void TRACK::shapeChanged()
+{
+    if( GetList() )
+        GetList()->ItemChanged( this );
 }
 
 
@@ -347,6 +356,7 @@ void VIA::Flip( const wxPoint& aCentre )
 {
     m_Start.y = aCentre.y - (m_Start.y - aCentre.y);
     m_End.y   = aCentre.y - (m_End.y - aCentre.y);
+    shapeChanged();
 }
 
 
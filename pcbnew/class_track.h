@@ -101,22 +101,23 @@ public:
     {
         m_Start += aMoveVector;
         m_End   += aMoveVector;
+        shapeChanged();
     }
 
     virtual void Rotate( const wxPoint& aRotCentre, double aAngle );
 
     virtual void Flip( const wxPoint& aCentre );
 
-    void SetPosition( const wxPoint& aPos )     { m_Start = aPos; }     // was overload
+    void SetPosition( const wxPoint& aPos )     { m_Start = aPos; shapeChanged(); } // was overload
     const wxPoint& GetPosition() const          { return m_Start; }     // was overload
 
-    void SetWidth( int aWidth )                 { m_Width = aWidth; }
+    void SetWidth( int aWidth )                 { m_Width = aWidth; shapeChanged(); }
     int GetWidth() const                        { return m_Width; }
 
-    void SetEnd( const wxPoint& aEnd )          { m_End = aEnd; }
+    void SetEnd( const wxPoint& aEnd )          { m_End = aEnd; shapeChanged(); }
     const wxPoint& GetEnd() const               { return m_End; }
 
-    void SetStart( const wxPoint& aStart )      { m_Start = aStart; }
+    void SetStart( const wxPoint& aStart )      { m_Start = aStart; shapeChanged(); }
     const wxPoint& GetStart() const             { return m_Start; }
 
 
@@ -326,6 +327,13 @@ protected:
     void DrawShortNetname( EDA_DRAW_PANEL* panel, wxDC* aDC, GR_DRAWMODE aDrawMode,
             EDA_COLOR_T aBgColor );
 
+    /**
+     * Function shapeChanged
+     * tells the list holding this track (i.e. the board spatial index) that its
+     * ends or width have changed.  To be called by all the functions changing them.
+     */
+    void shapeChanged();
+
     int         m_Width;            ///< Thickness of track, or via diameter
     wxPoint     m_Start;            ///< Line start point
     wxPoint     m_End;              ///< Line end point
@@ -405,7 +413,12 @@ public:
     void LayerPair( LAYER_ID* top_layer, LAYER_ID* bottom_layer ) const;
 
     const wxPoint& GetPosition() const  {  return m_Start; }       // was overload
-    void SetPosition( const wxPoint& aPoint ) { m_Start = aPoint;  m_End = aPoint; }    // was overload
+    void SetPosition( const wxPoint& aPoint )           // was overload
+    {
+        m_Start = aPoint;
+        m_End = aPoint;
+        shapeChanged();
+    }
 
     virtual bool HitTest( const wxPoint& aPosition ) const;
 
@@ -289,13 +289,38 @@ public:
      * removed from solid areas
      * if not null:
      * Only the zone outline (with holes, if any) is stored in aOutlineBuffer
-     * with holes linked. Therefore only one polygon is created
+     * with holes linked. Therefore only one polygon is created, and the zone itself
+     * is not modified (so it can be called while other zones are being filled)
      *
      * When aOutlineBuffer is not null, his function calls
      * AddClearanceAreasPolygonsToPolysList() to add holes for pads and tracks
      * and other items not in net.
+     * @param aFeatures = the holes built by BuildFillFingerprint() for this zone, or NULL
+     * to build them
      */
-    bool BuildFilledSolidAreasPolygons( BOARD* aPcb, CPOLYGONS_LIST* aOutlineBuffer = NULL );
+    bool BuildFilledSolidAreasPolygons( BOARD* aPcb, CPOLYGONS_LIST* aOutlineBuffer = NULL,
+                                        const CPOLYGONS_LIST* aFeatures = NULL );
+
+    /**
+     * Function BuildFillFingerprint
+     * computes a hash of everything the filled areas of this zone depend on: its outline
+     * and settings, the obstacles found by buildFeatureHoleList(), and the items of its
+     * net used to remove insulated copper islands.
+     * If the fingerprint is the one stored when the zone was filled, refilling the zone
+     * would give the same filled areas.
+     * @param aPcb = the board containing the zone
+     * @param aFeatures = a buffer to keep the obstacles, to be given to
+     * BuildFilledSolidAreasPolygons() if the zone is refilled, or NULL
+     * @return the fingerprint (never 0)
+     */
+    size_t BuildFillFingerprint( BOARD* aPcb, CPOLYGONS_LIST* aFeatures = NULL );
+
+    /**
+     * Function GetFillFingerprint
+     * @return the fingerprint stored when the zone was filled, or 0 if unknown
+     */
+    size_t GetFillFingerprint() const { return m_fillFingerprint; }
+    void SetFillFingerprint( size_t aFingerprint ) { m_fillFingerprint = aFingerprint; }
 
     /**
      * Function CopyPolygonsFromKiPolygonListToFilledPolysList
@@ -332,10 +357,13 @@ public:
      * BuildFilledSolidAreasPolygons() call this function just after creating the
      *  filled copper area polygon (without clearance areas
      * @param aPcb: the current board
+     * @param aFeatures: the holes, already built by buildFeatureHoleList(), or NULL
      * _NG version uses SHAPE_POLY_SET instead of Boost.Polygon
      */
-    void AddClearanceAreasPolygonsToPolysList( BOARD* aPcb );
-    void AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb );
+    void AddClearanceAreasPolygonsToPolysList( BOARD* aPcb,
+                                               const CPOLYGONS_LIST* aFeatures = NULL );
+    void AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb,
+                                                  const CPOLYGONS_LIST* aFeatures = NULL );
 
 
      /**
@@ -586,6 +614,13 @@ public:
 private:
     void buildFeatureHoleList( BOARD* aPcb, CPOLYGONS_LIST& aFeatures );
 
+    /**
+     * Function buildSmoothedPoly
+     * @return a new corner-smoothed copy of m_Poly, according to the corner smoothing
+     * settings.  The caller owns the returned polygon.
+     */
+    CPolyLine* buildSmoothedPoly() const;
+
     CPolyLine*            m_Poly;                ///< Outline of the zone.
     CPolyLine*            m_smoothedPoly;        // Corner-smoothed version of m_Poly
     int                   m_cornerSmoothingType;
@@ -620,6 +655,9 @@ private:
     /** True when a zone was filled, false after deleting the filled areas. */
     bool                  m_IsFilled;
 
+    /** Fingerprint of the fill inputs (see BuildFillFingerprint()), 0 if unknown. */
+    size_t                m_fillFingerprint;
+
     ///< Width of the gap in thermal reliefs.
     int                   m_ThermalReliefGap;
 
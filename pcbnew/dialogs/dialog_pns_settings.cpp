@@ -28,9 +28,6 @@
 DIALOG_PNS_SETTINGS::DIALOG_PNS_SETTINGS( wxWindow* aParent, PNS_ROUTING_SETTINGS& aSettings ) :
     DIALOG_PNS_SETTINGS_BASE( aParent ), m_settings( aSettings )
 {
-    // "Figure out what's best" is not available yet
-    m_mode->Enable( RM_Smart, false );
-
     // Load widgets' values from settings
     m_mode->SetSelection( m_settings.Mode() );
     m_shoveVias->SetValue( m_settings.ShoveVias() );
@@ -45,10 +45,21 @@
 
 #include <pcbnew.h>
 #include <drc_stuff.h>
+#include <drc_item_index.h>
+#include <task_queue.h>
 
+#include <class_undoredo_container.h>
 #include <dialog_drc.h>
 #include <wx/progdlg.h>
 
+#ifdef PROFILE
+#include <profile.h>
+#endif
+
+// Number of reference pads, and of reference segments, tested by a task
+#define DRC_PAD_BLOCK       64
+#define DRC_TRACK_BLOCK     16
+
 
 void DRC::ShowDialog()
 {
@@ -72,6 +83,10 @@ void DRC::ShowDialog()
     else
         updatePointers();
 
+    // Update the markers of the last run if the board was edited while the dialog was closed
+    if( TestChangedItems() )
+        m_mainWindow->GetCanvas()->Refresh();
+
     m_ui->Show( true );
 }
 
@@ -97,6 +112,22 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
 {
     m_mainWindow = aPcbWindow;
     m_pcb = aPcbWindow->GetBoard();
+
+    init();
+}
+
+
+DRC::DRC( BOARD* aBoard )
+{
+    m_mainWindow = NULL;
+    m_pcb = aBoard;
+
+    init();
+}
+
+
+void DRC::init()
+{
     m_ui  = 0;
 
     // establish initial values for everything:
@@ -112,6 +143,8 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     // m_rptFilename set to empty by its constructor
 
     m_currentMarker = NULL;
+    m_markerItems[0] = m_markerItems[1] = NULL;
+    m_markersBoard = NULL;
 
     m_segmAngle  = 0;
     m_segmLength = 0;
@@ -186,6 +219,11 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 
     // someone should have cleared the two lists before calling this.
 
+    // Forget the previous run: markers are created again from scratch.
+    m_markerSources.clear();
+    m_changedItems.clear();
+    m_markersBoard = NULL;
+
     if( !testNetClasses() )
     {
         // testing the netclasses is a special case because if the netclasses
@@ -220,7 +258,11 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testTracks( true );
+    // The markers can be updated by TestChangedItems() after the board is edited, unless
+    // the user aborted the test: some segments were not tested, so only a full run gives
+    // the right markers.
+    if( testTracks( true ) )
+        m_markersBoard = m_pcb;
 
     // Before testing segments and unconnected, refill all zones:
     // this is a good caution, because filled areas can be outdated.
@@ -230,8 +272,16 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
+    int unchangedZones = 0;
+
     m_mainWindow->Fill_All_Zones( aMessages ? aMessages->GetParent() : m_mainWindow,
-                                  false );
+                                  false, &unchangedZones );
+
+    if( aMessages && unchangedZones )
+    {
+        aMessages->AppendText( wxString::Format( _( "%d unchanged zones not refilled\n" ),
+                                                 unchangedZones ) );
+    }
 
     // test zone clearances to other zones
     if( aMessages )
@@ -299,7 +349,8 @@ void DRC::ListUnconnectedPads()
 void DRC::updatePointers()
 {
     // update my pointers, m_mainWindow is the only unchangeable one
-    m_pcb = m_mainWindow->GetBoard();
+    if( m_mainWindow )
+        m_pcb = m_mainWindow->GetBoard();
 
     if( m_ui )  // Use diag list boxes only in DRC dialog
     {
@@ -327,8 +378,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_CLEARANCE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -343,8 +393,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_TRACKWIDTH, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -358,8 +407,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_VIASIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -373,8 +421,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_VIADRILLSIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -388,8 +435,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_uVIASIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -403,8 +449,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_uVIADRILLSIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -436,18 +481,38 @@ bool DRC::testNetClasses()
 }
 
 
-void DRC::testPad2Pad()
+void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
 {
-    std::vector<D_PAD*> sortedPads;
+    m_pcb->Add( aMarker );
 
-    m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
+    if( m_mainWindow )
+        m_mainWindow->GetGalCanvas()->GetView()->Add( aMarker );
+}
+
+
+void DRC::addMarkerToPcb( MARKER_PCB* aMarker, const BOARD_ITEM* aRefItem,
+                          const BOARD_ITEM* const aItems[2] )
+{
+    DRC_MARKER_SOURCE& source = m_markerSources[aMarker];
+
+    source.m_refItem   = aRefItem;
+    source.m_otherItem = ( aItems[0] == aRefItem ) ? aItems[1] : aItems[0];
 
-    // find the max size of the pads (used to stop the test)
+    addMarkerToPcb( aMarker );
+}
+
+
+/**
+ * Function getMaxPadSize
+ * @return the largest bounding radius of aPads, used to stop the pad to pad tests.
+ */
+static int getMaxPadSize( const std::vector<D_PAD*>& aPads )
+{
     int max_size = 0;
 
-    for( unsigned i = 0; i < sortedPads.size(); ++i )
+    for( unsigned i = 0; i < aPads.size(); ++i )
     {
-        D_PAD* pad = sortedPads[i];
+        D_PAD* pad = aPads[i];
 
         // GetBoundingRadius() is the radius of the minimum sized circle fully containing the pad
         int radius = pad->GetBoundingRadius();
@@ -455,37 +520,129 @@ void DRC::testPad2Pad()
             max_size = radius;
     }
 
-    // Test the pads
-    D_PAD** listEnd = &sortedPads[ sortedPads.size() ];
+    return max_size;
+}
+
 
-    for( unsigned i = 0; i< sortedPads.size(); ++i )
+void DRC::testPad2Pad()
+{
+    std::vector<D_PAD*> sortedPads;
+
+    m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
+
+    // Test all the pads
+    std::vector<int> ranks( sortedPads.size() );
+
+    for( unsigned i = 0; i < ranks.size(); ++i )
+        ranks[i] = i;
+
+    std::vector<MARKER_PCB*>        markers( ranks.size(), (MARKER_PCB*) NULL );
+    std::vector<const BOARD_ITEM*>  items( 2 * ranks.size(), (const BOARD_ITEM*) NULL );
+
+    testPadRanks( sortedPads, ranks, markers, items );
+
+    for( unsigned i = 0; i < ranks.size(); ++i )
     {
-        D_PAD* pad = sortedPads[i];
+        if( markers[i] )
+            addMarkerToPcb( markers[i], sortedPads[i], &items[2 * i] );
+    }
+}
 
-        int    x_limit = max_size + pad->GetClearance() +
-                         pad->GetBoundingRadius() + pad->GetPosition().x;
 
-        if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+/**
+ * Struct DRC_PAD_TASK
+ * runs doPadToPadsDrc() on a block of DRC_PAD_BLOCK reference pads, for TASK_QUEUE.
+ */
+struct DRC_PAD_TASK
+{
+    DRC_PAD_TASK( BOARD* aBoard, std::vector<D_PAD*>& aSortedPads, int aMaxSize,
+                  const std::vector<int>& aRanks, std::vector<MARKER_PCB*>& aMarkers,
+                  std::vector<const BOARD_ITEM*>& aItems ) :
+        m_board( aBoard ), m_sortedPads( aSortedPads ), m_maxSize( aMaxSize ),
+        m_ranks( aRanks ), m_markers( aMarkers ), m_items( aItems )
+    {}
+
+    void operator()( int aBlock )
+    {
+        // doPadToPadsDrc() stores intermediate results in its DRC object,
+        // so each task uses its own one.
+        DRC     worker( m_board );
+        D_PAD** listEnd = &m_sortedPads[0] + m_sortedPads.size();
+        int     first = aBlock * DRC_PAD_BLOCK;
+        int     last = std::min( first + DRC_PAD_BLOCK, (int) m_ranks.size() );
+
+        for( int i = first; i < last; ++i )
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            int    rank = m_ranks[i];
+            D_PAD* pad = m_sortedPads[rank];
+
+            int    x_limit = m_maxSize + pad->GetClearance() +
+                             pad->GetBoundingRadius() + pad->GetPosition().x;
+
+            if( !worker.doPadToPadsDrc( pad, &m_sortedPads[rank], listEnd, x_limit ) )
+            {
+                wxASSERT( worker.m_currentMarker );
+                m_markers[i] = worker.m_currentMarker;
+                m_items[2 * i] = worker.m_markerItems[0];
+                m_items[2 * i + 1] = worker.m_markerItems[1];
+                worker.m_currentMarker = NULL;
+            }
         }
     }
+
+    BOARD*                          m_board;
+    std::vector<D_PAD*>&            m_sortedPads;
+    int                             m_maxSize;
+    const std::vector<int>&         m_ranks;
+    std::vector<MARKER_PCB*>&       m_markers;
+    std::vector<const BOARD_ITEM*>& m_items;
+};
+
+
+void DRC::testPadRanks( std::vector<D_PAD*>& aSortedPads,
+                        const std::vector<int>& aRanks, std::vector<MARKER_PCB*>& aMarkers,
+                        std::vector<const BOARD_ITEM*>& aItems )
+{
+    if( aSortedPads.empty() || aRanks.empty() )
+        return;
+
+    // find the max size of the pads (used to stop the test).  This also computes the
+    // bounding radius of each pad before the threads read it: D_PAD caches it on the
+    // first call.
+    int maxSize = getMaxPadSize( aSortedPads );
+
+    // The tasks only read the board items.  The marker found for a pad is stored in
+    // aMarkers, and the caller adds the markers to the board afterwards in that order.
+    DRC_PAD_TASK task( m_pcb, aSortedPads, maxSize, aRanks, aMarkers, aItems );
+    int          blockCount = ( aRanks.size() + DRC_PAD_BLOCK - 1 ) / DRC_PAD_BLOCK;
+
+    TASK_QUEUE<DRC_PAD_TASK> queue( task, blockCount );
+    queue.Run( DefaultThreadCount() );
 }
 
 
-void DRC::testTracks( bool aShowProgressBar )
+bool DRC::testTracks( bool aShowProgressBar )
 {
     wxProgressDialog * progressDialog = NULL;
     const int delta = 500;  // This is the number of tests between 2 calls to the
                             // progress bar
-    int count = 0;
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
 
-    int deltamax = count/delta;
+#ifdef PROFILE
+    prof_counter totalRealTime;
+    prof_start( &totalRealTime );
+#endif
+
+    // Only the tracks and pads near each segment are tested, they are found using
+    // a spatial index instead of scanning the whole board for each segment.
+    DRC_ITEM_INDEX index;
+    index.Build( m_pcb );
+
+    const std::vector<TRACK*>& tracks = index.GetTracks();
+
+    // the last segment has no following segment to test, it is not a reference segment.
+    int segmCount = tracks.empty() ? 0 : tracks.size() - 1;
+
+    int deltamax = segmCount/delta;
 
     if( aShowProgressBar && deltamax > 3 )
     {
@@ -495,34 +652,506 @@ void DRC::testTracks( bool aShowProgressBar )
         progressDialog->Update( 0, wxEmptyString );
     }
 
-    int ii = 0;
-    count = 0;
+    std::vector<int> ranks( segmCount );
+
+    for( int rank = 0; rank < segmCount; ++rank )
+        ranks[rank] = rank;
+
+    std::vector<MARKER_PCB*>        markers( segmCount, (MARKER_PCB*) NULL );
+    std::vector<const BOARD_ITEM*>  items( 2 * segmCount, (const BOARD_ITEM*) NULL );
+
+    int tested = 0;
+    int count = 0;
+
+    // Segments are tested by blocks of delta segments, so that the progress bar
+    // is updated (and the user can abort the test) from the main thread.
+    for( int first = 0; first < segmCount; first += delta )
+    {
+        int last = std::min( first + delta, segmCount );
+
+        testTrackRanks( index, ranks, first, last, markers, items );
+
+        tested = last;
+
+        if( progressDialog )
+        {
+            if( !progressDialog->Update( std::min( ++count, deltamax ), wxEmptyString ) )
+                break;  // Aborted by user
+        }
+    }
+
+    for( int rank = 0; rank < tested; ++rank )
+    {
+        if( markers[rank] )
+            addMarkerToPcb( markers[rank], tracks[rank], &items[2 * rank] );
+    }
 
+    if( progressDialog )
+        progressDialog->Destroy();
+
+#ifdef PROFILE
+    prof_end( &totalRealTime );
+
+    wxLogDebug( wxT( "DRC track clearances: %d segments in %.1f ms (%.0f segments/s)" ),
+                tested, totalRealTime.msecs(),
+                totalRealTime.usecs() ? tested * 1e6 / totalRealTime.usecs() : 0.0 );
+#endif /* PROFILE */
+
+    return tested == segmCount;
+}
+
+
+int DRC::TestTrackClearances( bool aUseIndex )
+{
+    updatePointers();
+
+    int segmCount = 0;
+
+    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
+        segmCount++;
+
+    if( aUseIndex )
+    {
+        testTracks( false );
+        return segmCount;
+    }
+
+    // The full sweep: each segment is tested against all the following segments and all
+    // the pads of the board.
     for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
     {
-        if ( ii++ > delta )
+        if( !doTrackDrc( segm, segm->Next(), true ) )
+        {
+            wxASSERT( m_currentMarker );
+            addMarkerToPcb( m_currentMarker, segm, m_markerItems );
+            m_currentMarker = NULL;
+        }
+    }
+
+    return segmCount;
+}
+
+
+/**
+ * Struct DRC_TRACK_TASK
+ * runs doTrackDrc() on a block of DRC_TRACK_BLOCK reference segments, for TASK_QUEUE.
+ */
+struct DRC_TRACK_TASK
+{
+    DRC_TRACK_TASK( BOARD* aBoard, DRC_ITEM_INDEX& aIndex, const std::vector<int>& aRanks,
+                    int aFirst, int aLast, std::vector<MARKER_PCB*>& aMarkers,
+                    std::vector<const BOARD_ITEM*>& aItems ) :
+        m_board( aBoard ), m_index( aIndex ), m_ranks( aRanks ), m_first( aFirst ),
+        m_last( aLast ), m_markers( aMarkers ), m_items( aItems )
+    {}
+
+    void operator()( int aBlock )
+    {
+        // doTrackDrc() stores intermediate results in its DRC object,
+        // so each task uses its own one.
+        DRC                         worker( m_board );
+        const std::vector<TRACK*>&  tracks = m_index.GetTracks();
+        std::vector<D_PAD*>         nearPads;
+        std::vector<TRACK*>         nearTracks;
+
+        int first = m_first + aBlock * DRC_TRACK_BLOCK;
+        int last = std::min( first + DRC_TRACK_BLOCK, m_last );
+
+        for( int i = first; i < last; ++i )
         {
-            ii = 0;
-            count++;
+            int    rank = m_ranks[i];
+            TRACK* segm = tracks[rank];
 
-            if( progressDialog )
+            m_index.QueryPads( segm, nearPads );
+            m_index.QueryTracks( segm, rank + 1, nearTracks );
+
+            if( !worker.doTrackDrc( segm, nearPads, nearTracks ) )
             {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
+                wxASSERT( worker.m_currentMarker );
+                m_markers[i] = worker.m_currentMarker;
+                m_items[2 * i] = worker.m_markerItems[0];
+                m_items[2 * i + 1] = worker.m_markerItems[1];
+                worker.m_currentMarker = NULL;
             }
         }
+    }
 
-        if( !doTrackDrc( segm, segm->Next(), true ) )
+    BOARD*                          m_board;
+    DRC_ITEM_INDEX&                 m_index;
+    const std::vector<int>&         m_ranks;
+    int                             m_first;
+    int                             m_last;
+    std::vector<MARKER_PCB*>&       m_markers;
+    std::vector<const BOARD_ITEM*>& m_items;
+};
+
+
+void DRC::testTrackRanks( DRC_ITEM_INDEX& aIndex, const std::vector<int>& aRanks,
+                          int aFirst, int aLast, std::vector<MARKER_PCB*>& aMarkers,
+                          std::vector<const BOARD_ITEM*>& aItems )
+{
+    if( aFirst >= aLast )
+        return;
+
+    // The tasks only read the board items: the pad bounding radii, cached by the pads,
+    // were computed when building aIndex.  The marker found for a segment is stored in
+    // aMarkers, and the caller adds the markers to the board afterwards in that order.
+    DRC_TRACK_TASK task( m_pcb, aIndex, aRanks, aFirst, aLast, aMarkers, aItems );
+    int            blockCount = ( aLast - aFirst + DRC_TRACK_BLOCK - 1 ) / DRC_TRACK_BLOCK;
+
+    TASK_QUEUE<DRC_TRACK_TASK> queue( task, blockCount );
+    queue.Run( DefaultThreadCount() );
+}
+
+
+void DRC::AddChangedItems( const PICKED_ITEMS_LIST& aItems )
+{
+    // Nothing to update if there is no previous run
+    if( !m_markersBoard )
+        return;
+
+    // Items removed from the board are forgotten now, while they are still allocated:
+    // once the undo list is cleared, their address can be reused by a new item, which
+    // would be taken for the removed one by the next TestChangedItems() call.
+    std::set<const BOARD_ITEM*> removed;
+
+    for( unsigned ii = 0; ii < aItems.GetCount(); ++ii )
+    {
+        BOARD_ITEM* item = static_cast<BOARD_ITEM*>( aItems.GetPickedItem( ii ) );
+
+        if( !item )
+            continue;
+
+        if( item->Type() == PCB_MODULE_T )
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            // The pads of a deleted footprint are deleted, and an undo or redo of a
+            // changed footprint swaps its pads with the ones of its copy (the link).
+            MODULE* module = static_cast<MODULE*>( item );
+            BOARD_ITEM* link = static_cast<BOARD_ITEM*>( aItems.GetPickedItemLink( ii ) );
+
+            if( aItems.GetPickedItemStatus( ii ) == UR_DELETED )
+            {
+                for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+                    removed.insert( pad );
+            }
+            else if( link && link->Type() == PCB_MODULE_T )
+            {
+                for( D_PAD* pad = static_cast<MODULE*>( link )->Pads(); pad; pad = pad->Next() )
+                    removed.insert( pad );
+            }
         }
+
+        if( aItems.GetPickedItemStatus( ii ) == UR_DELETED )
+            removed.insert( item );
+        else
+            m_changedItems.insert( item );
     }
 
-    if( progressDialog )
-        progressDialog->Destroy();
+    if( removed.empty() )
+        return;
+
+    for( std::set<const BOARD_ITEM*>::const_iterator it = removed.begin();
+         it != removed.end(); ++it )
+    {
+        m_changedItems.erase( *it );
+    }
+
+    // A marker of a removed item is obsolete: its source is cleared, so TestChangedItems()
+    // deletes it.  The item tested against a removed item is tested again.
+    std::map<MARKER_PCB*, DRC_MARKER_SOURCE>::iterator src;
+
+    for( src = m_markerSources.begin(); src != m_markerSources.end(); ++src )
+    {
+        DRC_MARKER_SOURCE& source = src->second;
+
+        if( source.m_refItem && removed.count( source.m_refItem ) )
+        {
+            source.m_refItem   = NULL;
+            source.m_otherItem = NULL;
+        }
+        else if( source.m_otherItem && removed.count( source.m_otherItem ) )
+        {
+            m_changedItems.insert( source.m_refItem );
+            source.m_otherItem = NULL;
+        }
+    }
+}
+
+
+bool DRC::IsDialogShown() const
+{
+    return m_ui && m_ui->IsShown();
+}
+
+
+bool DRC::TestChangedItems()
+{
+    updatePointers();
+
+    if( !m_markersBoard || m_markersBoard != m_pcb )
+    {
+        m_markerSources.clear();
+        m_changedItems.clear();
+        m_markersBoard = NULL;
+        return false;
+    }
+
+    // Nothing changed since the last update
+    if( m_changedItems.empty() )
+        return true;
+
+#ifdef PROFILE
+    prof_counter totalRealTime;
+    prof_start( &totalRealTime );
+#endif
+
+    // Clear the current item if it is a marker, because it could be deleted below
+    BOARD_ITEM* curItem = m_mainWindow->GetCurItem();
+
+    if( curItem && curItem->Type() == PCB_MARKER_T )
+        m_mainWindow->SetCurItem( NULL );
+
+    // Forget the markers deleted by the user since the last run
+    std::set<MARKER_PCB*> boardMarkers;
+
+    for( int ii = 0; ii < m_pcb->GetMARKERCount(); ++ii )
+        boardMarkers.insert( m_pcb->GetMARKER( ii ) );
+
+    std::map<MARKER_PCB*, DRC_MARKER_SOURCE>::iterator src = m_markerSources.begin();
+
+    while( src != m_markerSources.end() )
+    {
+        if( boardMarkers.count( src->first ) )
+            ++src;
+        else
+            m_markerSources.erase( src++ );
+    }
+
+    // The markers of the other tests (net classes, zones, keepout areas, texts) and the
+    // unconnected pads are deleted: these tests are run again on the whole board below.
+    for( std::set<MARKER_PCB*>::const_iterator it = boardMarkers.begin();
+         it != boardMarkers.end(); ++it )
+    {
+        if( !m_markerSources.count( *it ) )
+            m_pcb->Delete( *it );
+    }
+
+    for( unsigned ii = 0; ii < m_unconnected.size(); ++ii )
+        delete m_unconnected[ii];
+
+    m_unconnected.clear();
+
+    // If the net classes do not pass the checks anymore, a full run would stop after
+    // reporting them (see RunTests()): do the same.
+    if( !testNetClasses() )
+    {
+        for( src = m_markerSources.begin(); src != m_markerSources.end(); ++src )
+            m_pcb->Delete( src->first );
+
+        m_markerSources.clear();
+        m_changedItems.clear();
+        m_markersBoard = NULL;
+
+        updatePointers();
+        return true;
+    }
+
+    // Changed footprints change their pads.  The removed items were already forgotten
+    // by AddChangedItems(), so all the changed items are on the board.
+    std::set<const BOARD_ITEM*> changed;
+    changed.swap( m_changedItems );
+
+    for( MODULE* module = m_pcb->m_Modules; module; module = module->Next() )
+    {
+        if( !changed.count( module ) )
+            continue;
+
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            changed.insert( pad );
+    }
+
+    DRC_ITEM_INDEX index;
+    index.Build( m_pcb );
+
+    const std::vector<TRACK*>& tracks = index.GetTracks();
+
+    std::vector<D_PAD*> sortedPads;
+    m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
+
+    // Ranks of the items currently on the board
+    std::map<const BOARD_ITEM*, int> trackRank;
+    std::map<const BOARD_ITEM*, int> padRank;
+
+    for( unsigned ii = 0; ii < tracks.size(); ++ii )
+        trackRank[tracks[ii]] = ii;
+
+    for( unsigned ii = 0; ii < sortedPads.size(); ++ii )
+        padRank[sortedPads[ii]] = ii;
+
+    // Collect the reference items to test again: the changed items and their neighbours...
+    std::set<int> dirtyTracks;
+    std::set<int> dirtyPads;
+
+    std::vector<TRACK*> nearTracks;
+    std::vector<D_PAD*> nearPads;
+
+    for( std::set<const BOARD_ITEM*>::const_iterator it = changed.begin();
+         it != changed.end(); ++it )
+    {
+        std::map<const BOARD_ITEM*, int>::const_iterator rank;
+
+        if( ( rank = trackRank.find( *it ) ) != trackRank.end() )
+        {
+            dirtyTracks.insert( rank->second );
+            index.QueryTracks( tracks[rank->second]->GetBoundingBox(), nearTracks );
+        }
+        else if( ( rank = padRank.find( *it ) ) != padRank.end() )
+        {
+            const D_PAD* pad = sortedPads[rank->second];
+
+            dirtyPads.insert( rank->second );
+            index.QueryTracks( DRC_ITEM_INDEX::PadBoundingBox( pad ), nearTracks );
+            index.QueryPads( DRC_ITEM_INDEX::PadBoundingBox( pad ), nearPads );
+
+            for( unsigned ii = 0; ii < nearPads.size(); ++ii )
+                dirtyPads.insert( padRank[nearPads[ii]] );
+        }
+        else    // not tested by the clearance tests
+        {
+            continue;
+        }
+
+        for( unsigned ii = 0; ii < nearTracks.size(); ++ii )
+            dirtyTracks.insert( trackRank[nearTracks[ii]] );
+    }
+
+    // ... and the items which had a marker involving a changed item.
+    for( src = m_markerSources.begin(); src != m_markerSources.end(); ++src )
+    {
+        const DRC_MARKER_SOURCE& source = src->second;
+
+        if( !changed.count( source.m_refItem ) && !changed.count( source.m_otherItem ) )
+            continue;
+
+        std::map<const BOARD_ITEM*, int>::const_iterator rank;
+
+        if( ( rank = trackRank.find( source.m_refItem ) ) != trackRank.end() )
+            dirtyTracks.insert( rank->second );
+        else if( ( rank = padRank.find( source.m_refItem ) ) != padRank.end() )
+            dirtyPads.insert( rank->second );
+    }
+
+    // The last segment is never a reference segment (see testTracks())
+    if( !tracks.empty() )
+        dirtyTracks.erase( tracks.size() - 1 );
+
+    if( !m_doPad2PadTest )
+        dirtyPads.clear();
+
+    // Remove the markers of the items to test again, and of the removed items (their
+    // source was cleared by AddChangedItems()).
+    src = m_markerSources.begin();
+
+    while( src != m_markerSources.end() )
+    {
+        const DRC_MARKER_SOURCE& source = src->second;
+        std::map<const BOARD_ITEM*, int>::const_iterator rank;
+
+        bool obsolete = changed.count( source.m_refItem ) || changed.count( source.m_otherItem );
+
+        if( ( rank = trackRank.find( source.m_refItem ) ) != trackRank.end() )
+            obsolete |= dirtyTracks.count( rank->second ) > 0;
+        else if( ( rank = padRank.find( source.m_refItem ) ) != padRank.end() )
+            obsolete |= dirtyPads.count( rank->second ) > 0;
+        else
+            obsolete = true;    // the reference item is no longer on the board
+
+        if( obsolete )
+        {
+            m_pcb->Delete( src->first );
+            m_markerSources.erase( src++ );
+        }
+        else
+        {
+            ++src;
+        }
+    }
+
+    // Now test again
+    std::vector<int> ranks( dirtyPads.begin(), dirtyPads.end() );
+    std::vector<MARKER_PCB*>        markers( ranks.size(), (MARKER_PCB*) NULL );
+    std::vector<const BOARD_ITEM*>  items( 2 * ranks.size(), (const BOARD_ITEM*) NULL );
+
+    testPadRanks( sortedPads, ranks, markers, items );
+
+    for( unsigned ii = 0; ii < ranks.size(); ++ii )
+    {
+        if( markers[ii] )
+            addMarkerToPcb( markers[ii], sortedPads[ranks[ii]], &items[2 * ii] );
+    }
+
+    ranks.assign( dirtyTracks.begin(), dirtyTracks.end() );
+    markers.assign( ranks.size(), (MARKER_PCB*) NULL );
+    items.assign( 2 * ranks.size(), (const BOARD_ITEM*) NULL );
+
+    testTrackRanks( index, ranks, 0, ranks.size(), markers, items );
+
+    for( unsigned ii = 0; ii < ranks.size(); ++ii )
+    {
+        if( markers[ii] )
+            addMarkerToPcb( markers[ii], tracks[ranks[ii]], &items[2 * ii] );
+    }
+
+    // The board holds only the clearance markers now.  Put them in the order of a full
+    // run: the pad markers in pad rank order, then the track markers in segment order.
+    // A reference item has at most one marker.
+    std::vector< std::pair<int, MARKER_PCB*> > order;
+
+    for( src = m_markerSources.begin(); src != m_markerSources.end(); ++src )
+    {
+        const BOARD_ITEM* ref = src->second.m_refItem;
+        std::map<const BOARD_ITEM*, int>::const_iterator rank = padRank.find( ref );
+
+        if( rank != padRank.end() )
+            order.push_back( std::make_pair( rank->second, src->first ) );
+        else
+            order.push_back( std::make_pair( (int) sortedPads.size() + trackRank[ref],
+                                             src->first ) );
+    }
+
+    std::sort( order.begin(), order.end() );
+
+    for( unsigned ii = 0; ii < order.size(); ++ii )
+        m_pcb->Remove( order[ii].second );
+
+    for( unsigned ii = 0; ii < order.size(); ++ii )
+        m_pcb->Add( order[ii].second );
+
+    // The other tests are fast, and their results can depend on any change: run them
+    // again on the whole board, in the order of RunTests().  The zones are not refilled,
+    // these tests only use their outlines.
+    testZones();
+
+    if( m_doUnconnectedTest )
+        testUnconnected();
+
+    if( m_doKeepoutTest )
+        testKeepoutAreas();
+
+    testTexts();
+
+#ifdef PROFILE
+    prof_end( &totalRealTime );
+
+    wxLogDebug( wxT( "Incremental DRC: %d changed items, %u pads and %u segments tested in %.1f ms" ),
+                (int) changed.size(), (unsigned) dirtyPads.size(), (unsigned) dirtyTracks.size(),
+                totalRealTime.msecs() );
+#endif /* PROFILE */
+
+    // update the m_ui listboxes
+    updatePointers();
+
+    return true;
 }
 
 
@@ -590,8 +1219,7 @@ void DRC::testZones()
         {
             m_currentMarker = fillMarker( test_area,
                                           DRCE_SUSPICIOUS_NET_FOR_ZONE_OUTLINE, m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+            addMarkerToPcb( m_currentMarker );
             m_currentMarker = NULL;
         }
     }
@@ -626,8 +1254,7 @@ void DRC::testKeepoutAreas()
                 {
                     m_currentMarker = fillMarker( segm, NULL,
                                                   DRCE_TRACK_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker );
                     m_currentMarker = 0;
                 }
             }
@@ -643,8 +1270,7 @@ void DRC::testKeepoutAreas()
                 {
                     m_currentMarker = fillMarker( segm, NULL,
                                                   DRCE_VIA_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker );
                     m_currentMarker = 0;
                 }
             }
@@ -704,8 +1330,7 @@ void DRC::testTexts()
                         m_currentMarker = fillMarker( track, text,
                                                       DRCE_TRACK_INSIDE_TEXT,
                                                       m_currentMarker );
-                        m_pcb->Add( m_currentMarker );
-                        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                        addMarkerToPcb( m_currentMarker );
                         m_currentMarker = NULL;
                         break;
                     }
@@ -723,8 +1348,7 @@ void DRC::testTexts()
                     {
                         m_currentMarker = fillMarker( track, text,
                                                       DRCE_VIA_INSIDE_TEXT, m_currentMarker );
-                        m_pcb->Add( m_currentMarker );
-                        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                        addMarkerToPcb( m_currentMarker );
                         m_currentMarker = NULL;
                         break;
                     }
@@ -774,8 +1398,7 @@ void DRC::testTexts()
                 {
                     m_currentMarker = fillMarker( pad, text,
                                                   DRCE_PAD_INSIDE_TEXT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker );
                     m_currentMarker = NULL;
                     break;
                 }
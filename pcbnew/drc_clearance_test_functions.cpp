@@ -147,6 +147,22 @@ bool trapezoid2pointDRC( wxPoint aTref[4], wxPoint aPcompare, int aDist )
 
 
 bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
+{
+    std::vector<D_PAD*> pads;
+    std::vector<TRACK*> tracks;
+
+    if( testPads )
+        pads = m_pcb->GetPads();
+
+    for( TRACK* track = aStart; track; track = track->Next() )
+        tracks.push_back( track );
+
+    return doTrackDrc( aRefSeg, pads, tracks );
+}
+
+
+bool DRC::doTrackDrc( TRACK* aRefSeg, const std::vector<D_PAD*>& aPads,
+                      const std::vector<TRACK*>& aTracks )
 {
     TRACK*    track;
     wxPoint   delta;           // lenght on X and Y axis of segments
@@ -270,11 +286,11 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     dummypad.SetLayerSet( LSET::AllCuMask() );     // Ensure the hole is on all layers
 
     // Compute the min distance to pads
-    if( testPads )
+    if( aPads.size() )
     {
-        for( unsigned ii = 0;  ii<m_pcb->GetPadCount();  ++ii )
+        for( unsigned ii = 0;  ii < aPads.size();  ++ii )
         {
-            D_PAD* pad = m_pcb->GetPad( ii );
+            D_PAD* pad = aPads[ii];
 
             /* No problem if pads are on an other layer,
              * But if a drill hole exists	(a pad on a single layer can have a hole!)
@@ -336,8 +352,10 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     // Test the reference segment with other track segments
     wxPoint segStartPoint;
     wxPoint segEndPoint;
-    for( track = aStart; track; track = track->Next() )
+    for( unsigned ii = 0; ii < aTracks.size(); ++ii )
     {
+        track = aTracks[ii];
+
         // No problem if segments have the same net code:
         if( net_code_ref == track->GetNetCode() )
             continue;
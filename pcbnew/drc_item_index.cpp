@@ -0,0 +1,194 @@
+/**
+ * @file drc_item_index.cpp
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_pad.h>
+
+#include <drc_item_index.h>
+
+
+/* Coordinates used in DRC tests are rotated and rounded to integers, so a violation
+ * can be found for items a few internal units farther than the exact clearance.
+ * Search areas are enlarged by this amount to never miss such an item.
+ */
+#define DRC_INDEX_SLOP  4
+
+
+DRC_ITEM_INDEX::DRC_ITEM_INDEX()
+{
+    m_maxClearance = 0;
+}
+
+
+DRC_ITEM_INDEX::~DRC_ITEM_INDEX()
+{
+}
+
+
+void DRC_ITEM_INDEX::Clear()
+{
+    m_trackTree.RemoveAll();
+    m_padTree.RemoveAll();
+    m_tracks.clear();
+    m_pads.clear();
+    m_maxClearance = 0;
+}
+
+
+void DRC_ITEM_INDEX::Build( BOARD* aBoard )
+{
+    Clear();
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        insert( m_trackTree, track->GetBoundingBox(), m_tracks.size() );
+        m_tracks.push_back( track );
+
+        m_maxClearance = std::max( m_maxClearance, track->GetClearance() );
+    }
+
+    for( unsigned ii = 0; ii < aBoard->GetPadCount(); ++ii )
+    {
+        D_PAD* pad = aBoard->GetPad( ii );
+
+        insert( m_padTree, PadBoundingBox( pad ), ii );
+        m_pads.push_back( pad );
+
+        m_maxClearance = std::max( m_maxClearance, pad->GetClearance() );
+    }
+}
+
+
+EDA_RECT DRC_ITEM_INDEX::PadBoundingBox( const D_PAD* aPad )
+{
+    // The pad shape is tested at ShapePos(), and its hole (which can be bigger
+    // than the shape, for NPTH pads) at GetPosition(): both must be inside the box
+    EDA_RECT bbox( aPad->ShapePos(), wxSize( 0, 0 ) );
+    bbox.Inflate( aPad->GetBoundingRadius() );
+
+    wxSize drill = aPad->GetDrillSize();
+
+    if( drill.x || drill.y )
+    {
+        EDA_RECT hole( aPad->GetPosition(), wxSize( 0, 0 ) );
+        hole.Inflate( std::max( drill.x, drill.y ) / 2 + 1 );
+        bbox.Merge( hole );
+    }
+
+    return bbox;
+}
+
+
+void DRC_ITEM_INDEX::QueryTracks( const TRACK* aRefSeg, int aFirstRank,
+                                  std::vector<TRACK*>& aResult )
+{
+    std::vector<int> ranks;
+
+    search( m_trackTree, aRefSeg->GetBoundingBox(), aFirstRank, ranks );
+
+    aResult.clear();
+
+    for( unsigned ii = 0; ii < ranks.size(); ++ii )
+        aResult.push_back( m_tracks[ranks[ii]] );
+}
+
+
+void DRC_ITEM_INDEX::QueryPads( const TRACK* aRefSeg, std::vector<D_PAD*>& aResult )
+{
+    std::vector<int> ranks;
+
+    search( m_padTree, aRefSeg->GetBoundingBox(), 0, ranks );
+
+    aResult.clear();
+
+    for( unsigned ii = 0; ii < ranks.size(); ++ii )
+        aResult.push_back( m_pads[ranks[ii]] );
+}
+
+
+void DRC_ITEM_INDEX::QueryTracks( const EDA_RECT& aArea, std::vector<TRACK*>& aResult )
+{
+    std::vector<int> ranks;
+
+    search( m_trackTree, aArea, 0, ranks );
+
+    aResult.clear();
+
+    for( unsigned ii = 0; ii < ranks.size(); ++ii )
+        aResult.push_back( m_tracks[ranks[ii]] );
+}
+
+
+void DRC_ITEM_INDEX::QueryPads( const EDA_RECT& aArea, std::vector<D_PAD*>& aResult )
+{
+    std::vector<int> ranks;
+
+    search( m_padTree, aArea, 0, ranks );
+
+    aResult.clear();
+
+    for( unsigned ii = 0; ii < ranks.size(); ++ii )
+        aResult.push_back( m_pads[ranks[ii]] );
+}
+
+
+void DRC_ITEM_INDEX::insert( RANK_RTREE& aTree, const EDA_RECT& aBBox, int aRank )
+{
+    EDA_RECT bbox = aBBox;
+    bbox.Normalize();
+
+    const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+    const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+    aTree.Insert( mmin, mmax, aRank );
+}
+
+
+void DRC_ITEM_INDEX::search( RANK_RTREE& aTree, const EDA_RECT& aArea, int aFirstRank,
+                             std::vector<int>& aRanks )
+{
+    // Any item closer than the clearance to the reference item has its bounding box
+    // inside the reference bounding box inflated by the largest clearance.
+    EDA_RECT bbox = aArea;
+    bbox.Normalize();
+    bbox.Inflate( m_maxClearance + DRC_INDEX_SLOP );
+
+    const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+    const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+    aRanks.clear();
+
+    RANK_COLLECTOR collector( aRanks, aFirstRank );
+    aTree.Search( mmin, mmax, collector );
+
+    // Restore the list order
+    std::sort( aRanks.begin(), aRanks.end() );
+}
@@ -0,0 +1,170 @@
+/**
+ * @file drc_item_index.h
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef _DRC_ITEM_INDEX_H
+#define _DRC_ITEM_INDEX_H
+
+#include <vector>
+#include <geometry/rtree.h>
+
+class BOARD;
+class TRACK;
+class D_PAD;
+class EDA_RECT;
+
+
+/**
+ * Class DRC_ITEM_INDEX
+ * is a spatial index (R-tree) over the tracks, vias and pads of a BOARD, used by
+ * the DRC to find the items near a reference segment instead of walking the whole
+ * track and pad lists for each segment.
+ *
+ * Items are stored by their rank in BOARD::m_Track and in the board pad list,
+ * and queries return them sorted by that rank.  Therefore the candidates are visited
+ * in the same order as the linear scan would visit them, and the first violation
+ * found for a segment (i.e. the reported marker) is unchanged.
+ *
+ * Once built, the index is only read by queries, so QueryTracks() and QueryPads()
+ * can be called from several threads at the same time.
+ */
+class DRC_ITEM_INDEX
+{
+public:
+    DRC_ITEM_INDEX();
+    ~DRC_ITEM_INDEX();
+
+    /**
+     * Function Build
+     * clears the index and fills it with the tracks and pads of aBoard.
+     * The board must not be modified while the index is in use.  The bounding radius
+     * of each pad, which D_PAD computes and caches on the first call, is computed here:
+     * the index and the pads can then be read by several threads.
+     */
+    void Build( BOARD* aBoard );
+
+    /**
+     * Function Clear
+     * removes all the items from the index.
+     */
+    void Clear();
+
+    /**
+     * Function GetTracks
+     * @return the indexed tracks and vias, in BOARD::m_Track order.
+     */
+    const std::vector<TRACK*>& GetTracks() const { return m_tracks; }
+
+    /**
+     * Function GetPads
+     * @return the indexed pads, in BOARD::GetPad() order.
+     */
+    const std::vector<D_PAD*>& GetPads() const { return m_pads; }
+
+    /**
+     * Function GetMaxClearance
+     * @return the largest clearance of all the indexed items.
+     */
+    int GetMaxClearance() const { return m_maxClearance; }
+
+    /**
+     * Function QueryTracks
+     * collects the tracks and vias which can be closer than the clearance to aRefSeg.
+     * @param aRefSeg is the reference segment.
+     * @param aFirstRank is the rank of the first track to return: tracks before it in
+     *                   the track list are ignored (usually the rank of aRefSeg + 1).
+     * @param aResult is filled with the candidates, in track list order.
+     */
+    void QueryTracks( const TRACK* aRefSeg, int aFirstRank, std::vector<TRACK*>& aResult );
+
+    /**
+     * Function QueryPads
+     * collects the pads (and pad holes) which can be closer than the clearance to aRefSeg.
+     * @param aRefSeg is the reference segment.
+     * @param aResult is filled with the candidates, in pad list order.
+     */
+    void QueryPads( const TRACK* aRefSeg, std::vector<D_PAD*>& aResult );
+
+    /**
+     * Function QueryTracks
+     * collects the tracks and vias which can be closer than the clearance to an area.
+     * @param aArea is the bounding box of an item.
+     * @param aResult is filled with the candidates, in track list order.
+     */
+    void QueryTracks( const EDA_RECT& aArea, std::vector<TRACK*>& aResult );
+
+    /**
+     * Function QueryPads
+     * collects the pads which can be closer than the clearance to an area.
+     * @param aArea is the bounding box of an item.
+     * @param aResult is filled with the candidates, in pad list order.
+     */
+    void QueryPads( const EDA_RECT& aArea, std::vector<D_PAD*>& aResult );
+
+    /**
+     * Function PadBoundingBox
+     * @return the area of aPad used by the DRC tests, i.e. the bounding box
+     *         of its shape and of its hole.
+     */
+    static EDA_RECT PadBoundingBox( const D_PAD* aPad );
+
+private:
+    typedef RTree<int, int, 2, float> RANK_RTREE;
+
+    /// Collects the ranks of the items found by a search.
+    struct RANK_COLLECTOR
+    {
+        RANK_COLLECTOR( std::vector<int>& aRanks, int aFirstRank ) :
+            m_ranks( aRanks ), m_firstRank( aFirstRank )
+        {}
+
+        bool operator()( int aRank )
+        {
+            if( aRank >= m_firstRank )
+                m_ranks.push_back( aRank );
+
+            return true;
+        }
+
+        std::vector<int>&   m_ranks;
+        int                 m_firstRank;
+    };
+
+    void insert( RANK_RTREE& aTree, const EDA_RECT& aBBox, int aRank );
+    void search( RANK_RTREE& aTree, const EDA_RECT& aArea, int aFirstRank,
+                 std::vector<int>& aRanks );
+
+    RANK_RTREE          m_trackTree;
+    RANK_RTREE          m_padTree;
+
+    std::vector<TRACK*> m_tracks;
+    std::vector<D_PAD*> m_pads;
+
+    int                 m_maxClearance;
+};
+
+
+#endif  // _DRC_ITEM_INDEX_H
@@ -55,6 +55,9 @@ MARKER_PCB* DRC::fillMarker( const TRACK* aTrack, BOARD_ITEM* aItem, int aErrorC
     wxPoint  position;
     wxPoint  posB;
 
+    m_markerItems[0] = aTrack;
+    m_markerItems[1] = aItem;
+
     if( aItem )     // aItem might be NULL
     {
         textB = aItem->GetSelectMenuText();
@@ -133,6 +136,9 @@ MARKER_PCB* DRC::fillMarker( D_PAD* aPad, BOARD_ITEM* aItem, int aErrorCode, MAR
     wxPoint  posA = aPad->GetPosition();
     wxPoint  posB;
 
+    m_markerItems[0] = aPad;
+    m_markerItems[1] = aItem;
+
     if( aItem )
     {
         textB = aItem->GetSelectMenuText();
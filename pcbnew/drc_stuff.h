@@ -30,6 +30,8 @@
 #define _DRC_STUFF_H
 
 #include <vector>
+#include <map>
+#include <set>
 #include <boost/shared_ptr.hpp>
 
 #define OK_DRC  0
@@ -90,7 +92,9 @@ class ZONE_CONTAINER;
 class TRACK;
 class MARKER_PCB;
 class DRC_ITEM;
+class DRC_ITEM_INDEX;
 class NETCLASS;
+class PICKED_ITEMS_LIST;
 
 
 /**
@@ -140,6 +144,18 @@ public:
 typedef std::vector<DRC_ITEM*> DRC_LIST;
 
 
+/**
+ * Struct DRC_MARKER_SOURCE
+ * remembers which items caused a track or pad clearance marker, so that an incremental
+ * DRC run knows the markers made obsolete by a change.
+ */
+struct DRC_MARKER_SOURCE
+{
+    const BOARD_ITEM*   m_refItem;      ///< the item under test (a TRACK or a D_PAD)
+    const BOARD_ITEM*   m_otherItem;    ///< the item it was tested against, or NULL
+};
+
+
 /**
  * Class DRC
  * is the Design Rule Checker, and performs all the DRC tests.  The output of
@@ -152,6 +168,8 @@ typedef std::vector<DRC_ITEM*> DRC_LIST;
 class DRC
 {
     friend class DIALOG_DRC_CONTROL;
+    friend struct DRC_PAD_TASK;
+    friend struct DRC_TRACK_TASK;
 
 private:
 
@@ -199,6 +217,24 @@ private:
 
     DRC_LIST            m_unconnected;  ///< list of unconnected pads, as DRC_ITEMs
 
+    /// The items given to the last fillMarker() call for a track or a pad.
+    const BOARD_ITEM*   m_markerItems[2];
+
+    /* Incremental DRC state: the track and pad clearance markers created by the last
+     * run, with the items which caused them, and the items changed since that run.
+     * m_markersBoard is the board these items belong to, or NULL if there is no run
+     * to update.
+     */
+    std::map<MARKER_PCB*, DRC_MARKER_SOURCE>    m_markerSources;
+    std::set<const BOARD_ITEM*>                 m_changedItems;
+    BOARD*                                      m_markersBoard;
+
+
+    /**
+     * Function init
+     * sets the initial values of the settings and of the test state, for the constructors.
+     */
+    void init();
 
     /**
      * Function updatePointers
@@ -252,6 +288,57 @@ private:
      */
     MARKER_PCB* fillMarker( int aErrorCode, const wxString& aMessage, MARKER_PCB* fillMe );
 
+    /**
+     * Function addMarkerToPcb
+     * adds a DRC marker to the BOARD and to the GAL view.
+     * Must be called only from the main thread: the DRC tests which run on several
+     * threads keep their markers aside and add them once all threads are done, in
+     * an order which does not depend on the number of threads.
+     * @param aMarker The marker to add, the BOARD takes ownership of it.
+     */
+    void addMarkerToPcb( MARKER_PCB* aMarker );
+
+    /**
+     * Function addMarkerToPcb
+     * adds a track or pad clearance marker to the BOARD and to the GAL view, and
+     * remembers the items which caused it for the incremental DRC.
+     * @param aMarker The marker to add, the BOARD takes ownership of it.
+     * @param aRefItem The track or pad under test when the marker was created.
+     * @param aItems The two items given to fillMarker() when the marker was created.
+     */
+    void addMarkerToPcb( MARKER_PCB* aMarker, const BOARD_ITEM* aRefItem,
+                         const BOARD_ITEM* const aItems[2] );
+
+    /**
+     * Function testTrackRanks
+     * runs doTrackDrc() on a list of reference segments, on several threads (a TASK_QUEUE).
+     * Each segment is tested against the pads near it and the tracks near it which follow
+     * it in the track list.  The board is only read.
+     * @param aIndex The spatial index of the board items.
+     * @param aRanks The ranks in the track list of the segments to test.
+     * @param aFirst The first entry of aRanks to test.
+     * @param aLast The entry of aRanks following the last one to test.
+     * @param aMarkers receives the marker (or NULL) found for aRanks[i] at index i.
+     * @param aItems receives the two items which caused aMarkers[i] at index 2*i and 2*i+1.
+     *               Both vectors must have the size of aRanks.
+     */
+    void testTrackRanks( DRC_ITEM_INDEX& aIndex, const std::vector<int>& aRanks,
+                         int aFirst, int aLast, std::vector<MARKER_PCB*>& aMarkers,
+                         std::vector<const BOARD_ITEM*>& aItems );
+
+    /**
+     * Function testPadRanks
+     * runs doPadToPadsDrc() on a list of reference pads, on several threads (a TASK_QUEUE).
+     * The board is only read.
+     * @param aSortedPads The board pads, sorted by GetSortedPadListByXthenYCoord().
+     * @param aRanks The ranks in aSortedPads of the pads to test.
+     * @param aMarkers receives the marker (or NULL) found for aRanks[i] at index i.
+     * @param aItems receives the two items which caused aMarkers[i] at index 2*i and 2*i+1.
+     */
+    void testPadRanks( std::vector<D_PAD*>& aSortedPads,
+                       const std::vector<int>& aRanks, std::vector<MARKER_PCB*>& aMarkers,
+                       std::vector<const BOARD_ITEM*>& aItems );
+
 
     //-----<categorical group tests>-----------------------------------------
 
@@ -273,8 +360,9 @@ private:
      * because this test can take a while, a progress bar can be displayed
      * @param aShowProgressBar = true to show a progrsse bar
      * (Note: it is shown only if there are many tracks)
+     * @return false if the test was aborted by the user, true if all tracks were tested.
      */
-    void testTracks( bool aShowProgressBar );
+    bool testTracks( bool aShowProgressBar );
 
     void testPad2Pad();
 
@@ -312,6 +400,18 @@ private:
      */
     bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true );
 
+    /**
+     * Function doTrackDrc
+     * tests the current segment against a given set of pads and tracks.
+     * @param aRefSeg The segment to test
+     * @param aPads The pads to test against, in board pad list order (can be empty)
+     * @param aTracks The tracks to test against, in track list order
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackDrc( TRACK* aRefSeg, const std::vector<D_PAD*>& aPads,
+                     const std::vector<TRACK*>& aTracks );
+
     /**
      * Function doTrackKeepoutDrc
      * tests the current segment or via.
@@ -392,6 +492,14 @@ private:
 public:
     DRC( PCB_EDIT_FRAME* aPcbWindow );
 
+    /**
+     * Constructor
+     * creates a DRC testing aBoard without an edit frame: only the tests which do not
+     * need one can be run (see TestTrackClearances()), and the markers are added to the
+     * board only, not to a view.
+     */
+    DRC( BOARD* aBoard );
+
     ~DRC();
 
     /**
@@ -483,6 +591,50 @@ public:
      */
     void RunTests( wxTextCtrl* aMessages = NULL );
 
+    /**
+     * Function TestTrackClearances
+     * runs only the track and via clearance tests, without progress bar, and adds the
+     * markers found to the board. It can be used without an edit frame.
+     * @param aUseIndex true to test each segment against the items found near it by a
+     *  DRC_ITEM_INDEX, as RunTests() does.  false to test it against all the following
+     *  segments and all the pads, as the DRC did before the index (the reference of the
+     *  indexed test, used to check and benchmark it).
+     * @return the number of segments tested.
+     */
+    int TestTrackClearances( bool aUseIndex = true );
+
+    /**
+     * Function AddChangedItems
+     * records items modified, added or deleted by a command, from its undo/redo list,
+     * to be tested by the next TestChangedItems() call.
+     * The items are only stored, they are not tested until the next update.  The markers
+     * of the deleted items are invalidated at once, and the deleted items are not kept, so
+     * a new item allocated at the address of a deleted one is not mistaken for it.
+     * @param aItems The command items list.
+     */
+    void AddChangedItems( const PICKED_ITEMS_LIST& aItems );
+
+    /**
+     * Function IsDialogShown
+     * @return true if the DRC dialog exists and is shown.
+     */
+    bool IsDialogShown() const;
+
+    /**
+     * Function TestChangedItems
+     * updates the markers of the last RunTests() call after the items recorded by
+     * AddChangedItems() were changed.  For the track and pad clearances, only the changed
+     * items, the items near them and the items which had a marker involving them are
+     * tested again, the other markers are kept.  The other tests (net classes, zones,
+     * keepout areas, texts, unconnected pads) are run again on the whole board, but the
+     * zones are not refilled.  The markers are in the same order as after a full run.
+     * It is called by ShowDialog(), and by PCB_EDIT_FRAME::OnModify() while the dialog
+     * is shown, so the markers follow the edits.
+     * @return false if there is no previous run on the current board to update
+     *         (RunTests() must be called in this case), true otherwise.
+     */
+    bool TestChangedItems();
+
     /**
      * Function ListUnconnectedPad
      * gathers a list of all the unconnected pads and shows them in the
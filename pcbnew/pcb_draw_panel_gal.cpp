@@ -164,6 +164,10 @@ EDA_DRAW_PANEL_GAL( aParentWindow, aWindowId, aPosition, aSize, aGalType )
     m_view->SetLayerDisplayOnly( ITEM_GAL_LAYER( GRID_VISIBLE ) );
     m_view->SetLayerDisplayOnly( ITEM_GAL_LAYER( DRC_VISIBLE ) );
 
+    // Simplify texts and zones when a pixel is bigger than 0.05 mm (i.e. a dense board is
+    // zoomed out), they are cached separately for each level of detail
+    m_view->SetDetailThreshold( Millimeter2iu( 0.05 ) );
+
     // Load display options (such as filled/outline display of items).
     // Can be made only if the parent window is an EDA_DRAW_FRAME (or a derived class)
     // which is not always the case (namely when it is used from a wxDialog like the pad editor)
@@ -155,40 +155,48 @@ void NETLIST::Format( const char* aDocName, OUTPUTFORMATTER* aOut, int aNestLeve
 void NETLIST::AddComponent( COMPONENT* aComponent )
 {
     m_components.push_back( aComponent );
+    m_componentMapsValid = false;
 }
 
 
-COMPONENT* NETLIST::GetComponentByReference( const wxString& aReference )
+void NETLIST::buildComponentMaps()
 {
-    COMPONENT* component = NULL;
+    if( m_componentMapsValid )
+        return;
+
+    m_componentsByReference.clear();
+    m_componentsByTimeStamp.clear();
 
+    // insert() does not replace an existing key, so the first component is kept
     for( unsigned i = 0;  i < m_components.size();  i++ )
     {
-        if( m_components[i].GetReference() == aReference )
-        {
-            component = &m_components[i];
-            break;
-        }
+        COMPONENT* component = &m_components[i];
+
+        m_componentsByReference.insert( std::make_pair( component->GetReference(), component ) );
+        m_componentsByTimeStamp.insert( std::make_pair( component->GetTimeStamp(), component ) );
     }
 
-    return component;
+    m_componentMapsValid = true;
+}
+
+
+COMPONENT* NETLIST::GetComponentByReference( const wxString& aReference )
+{
+    buildComponentMaps();
+
+    COMPONENT_MAP::const_iterator it = m_componentsByReference.find( aReference );
+
+    return it != m_componentsByReference.end() ? it->second : NULL;
 }
 
 
 COMPONENT* NETLIST::GetComponentByTimeStamp( const wxString& aTimeStamp )
 {
-    COMPONENT* component = NULL;
+    buildComponentMaps();
 
-    for( unsigned i = 0;  i < m_components.size();  i++ )
-    {
-        if( m_components[i].GetTimeStamp() == aTimeStamp )
-        {
-            component = &m_components[i];
-            break;
-        }
-    }
+    COMPONENT_MAP::const_iterator it = m_componentsByTimeStamp.find( aTimeStamp );
 
-    return component;
+    return it != m_componentsByTimeStamp.end() ? it->second : NULL;
 }
 
 
@@ -205,6 +213,7 @@ static bool ByFPID( const COMPONENT& ref, const COMPONENT& cmp )
 void NETLIST::SortByFPID()
 {
     m_components.sort( ByFPID );
+    m_componentMapsValid = false;
 }
 
 
@@ -221,6 +230,7 @@ bool operator < ( const COMPONENT& item1, const COMPONENT& item2 )
 void NETLIST::SortByReference()
 {
     m_components.sort();
+    m_componentMapsValid = false;
 }
 
 
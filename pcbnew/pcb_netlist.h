@@ -31,9 +31,11 @@
  */
 
 #include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/unordered_map.hpp>
 #include <wx/arrstr.h>
 
 #include <fpid.h>
+#include <hashtables.h>
 #include <class_module.h>
 
 
@@ -211,8 +213,17 @@ typedef COMPONENTS::const_iterator     COMPONENTS_CITER;
  */
 class NETLIST
 {
+    typedef boost::unordered_map<wxString, COMPONENT*, WXSTRING_HASH> COMPONENT_MAP;
+
     COMPONENTS         m_components;           ///< Components found in the netlist.
 
+    /// Components by reference and by time stamp, built by the first lookup after the
+    /// component list has changed.  They store the first component of the list for
+    /// each key.
+    COMPONENT_MAP      m_componentsByReference;
+    COMPONENT_MAP      m_componentsByTimeStamp;
+    bool               m_componentMapsValid;
+
     /// Remove footprints from #BOARD not found in netlist when true.
     bool               m_deleteExtraFootprints;
 
@@ -231,7 +242,8 @@ public:
         m_deleteExtraFootprints( false ),
         m_isDryRun( false ),
         m_findByTimeStamp( false ),
-        m_replaceFootprints( false )
+        m_replaceFootprints( false ),
+        m_componentMapsValid( false )
     {
     }
 
@@ -245,7 +257,11 @@ public:
      * Function Clear
      * removes all components from the netlist.
      */
-    void Clear() { m_components.clear(); }
+    void Clear()
+    {
+        m_components.clear();
+        m_componentMapsValid = false;
+    }
 
     /**
      * Function GetCount
@@ -295,6 +311,12 @@ public:
 
     void SortByReference();
 
+private:
+    ///> Builds m_componentsByReference and m_componentsByTimeStamp if needed.
+    void buildComponentMaps();
+
+public:
+
     void SetDeleteExtraFootprints( bool aDeleteExtraFootprints )
     {
         m_deleteExtraFootprints = aDeleteExtraFootprints;
@@ -41,6 +41,32 @@
 
 using namespace KIGFX;
 
+
+/**
+ * Function simplifyContour
+ * Removes the points of a contour which are closer than aTolerance to the previous point kept,
+ * so the details smaller than a pixel are not tessellated.
+ * @return False if the whole contour is smaller than aTolerance.
+ */
+static bool simplifyContour( std::deque<VECTOR2D>& aPoints, double aTolerance )
+{
+    if( aPoints.empty() )
+        return false;
+
+    const double minDistance = aTolerance * aTolerance;
+    std::deque<VECTOR2D>::iterator last = aPoints.begin();
+
+    for( std::deque<VECTOR2D>::iterator it = last + 1; it != aPoints.end(); ++it )
+    {
+        if( ( *it - *last ).SquaredEuclideanNorm() >= minDistance )
+            *++last = *it;
+    }
+
+    aPoints.erase( last + 1, aPoints.end() );
+
+    return aPoints.size() >= 3;
+}
+
 PCB_RENDER_SETTINGS::PCB_RENDER_SETTINGS()
 {
     m_backgroundColor = COLOR4D( 0.0, 0.0, 0.0, 1.0 );
@@ -211,6 +237,39 @@ PCB_PAINTER::PCB_PAINTER( GAL* aGal ) :
 }
 
 
+PAINTER* PCB_PAINTER::CreateWorker( GAL* aGal ) const
+{
+    PCB_PAINTER* painter = new PCB_PAINTER( aGal );
+    painter->m_pcbSettings = m_pcbSettings;
+
+    return painter;
+}
+
+
+bool PCB_PAINTER::HasDetailLevels( const VIEW_ITEM* aItem, int aLayer ) const
+{
+    const EDA_ITEM* item = static_cast<const EDA_ITEM*>( aItem );
+
+    switch( item->Type() )
+    {
+    case PCB_TEXT_T:
+    case PCB_MODULE_TEXT_T:
+    case PCB_ZONE_AREA_T:
+    case PCB_DIMENSION_T:
+        return true;
+
+    case PCB_ZONE_T:
+    case PCB_TRACE_T:
+    case PCB_PAD_T:
+        // Only the labels are simplified
+        return IsNetnameLayer( aLayer );
+
+    default:
+        return false;
+    }
+}
+
+
 bool PCB_PAINTER::Draw( const VIEW_ITEM* aItem, int aLayer )
 {
     const EDA_ITEM* item = static_cast<const EDA_ITEM*>( aItem );
@@ -296,6 +355,10 @@ void PCB_PAINTER::draw( const TRACK* aTrack, int aLayer )
             double textOrientation = -atan( line.y / line.x );
             double textSize = std::min( static_cast<double>( width ), length / netName.length() );
 
+            // Labels which cannot be read are not worth drawing
+            if( !isReadable( textSize * 0.7 ) )
+                return;
+
             // Set a proper color for the label
             const COLOR4D& color = m_pcbSettings.GetColor( aTrack, aTrack->GetLayer() );
             const COLOR4D labelColor = m_pcbSettings.GetColor( NULL, aLayer );
@@ -477,6 +540,10 @@ void PCB_PAINTER::draw( const D_PAD* aPad, int aLayer )
             if( size > maxSize )
                 size = maxSize;
 
+            // Labels which cannot be read are not worth drawing
+            if( !isReadable( size * 0.7 ) )
+                return;
+
             m_gal->Save();
             m_gal->Translate( position );
 
@@ -780,6 +847,12 @@ void PCB_PAINTER::draw( const TEXTE_PCB* aText, int aLayer )
     VECTOR2D position( aText->GetTextPosition().x, aText->GetTextPosition().y );
     double   orientation = aText->GetOrientation() * M_PI / 1800.0;
 
+    if( !isReadable( aText->GetSize().y ) )
+    {
+        drawTextBox( aText, orientation, color );
+        return;
+    }
+
     if( m_pcbSettings.m_sketchMode[aLayer] )
     {
         // Outline mode
@@ -809,6 +882,12 @@ void PCB_PAINTER::draw( const TEXTE_MODULE* aText, int aLayer )
     VECTOR2D position( aText->GetTextPosition().x, aText->GetTextPosition().y );
     double   orientation = aText->GetDrawRotation() * M_PI / 1800.0;
 
+    if( !isReadable( aText->GetSize().y ) )
+    {
+        drawTextBox( aText, orientation, color );
+        return;
+    }
+
     if( m_pcbSettings.m_sketchMode[aLayer] )
     {
         // Outline mode
@@ -854,6 +933,9 @@ void PCB_PAINTER::draw( const ZONE_CONTAINER* aZone )
     std::deque<VECTOR2D> corners;
     PCB_RENDER_SETTINGS::DisplayZonesMode displayMode = m_pcbSettings.m_displayZoneMode;
 
+    // Details smaller than a pixel are removed from the outlines at low levels of detail
+    double detailSize = m_pcbSettings.GetDetailSize();
+
     // Draw the outline
     m_gal->SetStrokeColor( color );
     m_gal->SetIsFill( false );
@@ -867,6 +949,9 @@ void PCB_PAINTER::draw( const ZONE_CONTAINER* aZone )
 
         if( outline->IsEndContour( i ) )
         {
+            if( detailSize > 0.0 )
+                simplifyContour( corners, detailSize );
+
             // The last point for closing the polyline
             corners.push_back( corners[0] );
             m_gal->DrawPolyline( corners );
@@ -885,10 +970,14 @@ void PCB_PAINTER::draw( const ZONE_CONTAINER* aZone )
         m_gal->SetFillColor( color );
         m_gal->SetLineWidth( aZone->GetMinThickness() );
 
+        // The outline of the filling is thinner than a pixel at low levels of detail, so the
+        // polygons are enough
+        bool strokeFilling = aZone->GetMinThickness() >= detailSize;
+
         if( displayMode == PCB_RENDER_SETTINGS::DZ_SHOW_FILLED )
         {
             m_gal->SetIsFill( true );
-            m_gal->SetIsStroke( true );
+            m_gal->SetIsStroke( strokeFilling );
         }
         else if( displayMode == PCB_RENDER_SETTINGS::DZ_SHOW_OUTLINED )
         {
@@ -904,10 +993,19 @@ void PCB_PAINTER::draw( const ZONE_CONTAINER* aZone )
 
             if( polyIterator->end_contour )
             {
+                // Skip the polygons which are smaller than a pixel
+                if( detailSize > 0.0 && !simplifyContour( corners, detailSize ) )
+                {
+                    corners.clear();
+                    continue;
+                }
+
                 if( displayMode == PCB_RENDER_SETTINGS::DZ_SHOW_FILLED )
                 {
                     m_gal->DrawPolygon( corners );
-                    m_gal->DrawPolyline( corners );
+
+                    if( strokeFilling )
+                        m_gal->DrawPolyline( corners );
                 }
                 else if( displayMode == PCB_RENDER_SETTINGS::DZ_SHOW_OUTLINED )
                 {
@@ -946,6 +1044,12 @@ void PCB_PAINTER::draw( const DIMENSION* aDimension, int aLayer )
     VECTOR2D position( text.GetTextPosition().x, text.GetTextPosition().y );
     double   orientation = text.GetOrientation() * M_PI / 1800.0;
 
+    if( !isReadable( text.GetSize().y ) )
+    {
+        drawTextBox( &text, orientation, strokeColor );
+        return;
+    }
+
     m_gal->SetLineWidth( text.GetThickness() );
     m_gal->SetTextAttributes( &text );
     m_gal->StrokeText( text.GetShownText(), position, orientation );
@@ -1007,4 +1111,34 @@ void PCB_PAINTER::draw( const MARKER_PCB* aMarker )
 }
 
 
+bool PCB_PAINTER::isReadable( double aTextSize ) const
+{
+    return aTextSize >= MIN_TEXT_PIXELS * m_pcbSettings.GetDetailSize();
+}
+
+
+void PCB_PAINTER::drawTextBox( const EDA_TEXT* aText, double aOrientation,
+                               const COLOR4D& aColor )
+{
+    // The box is lighter than the text would be, as it is mostly empty
+    COLOR4D boxColor( aColor );
+    boxColor.a *= 0.5;
+
+    EDA_RECT box = aText->GetTextBox( -1 );
+    VECTOR2D position( aText->GetTextPosition() );
+
+    m_gal->SetIsFill( true );
+    m_gal->SetIsStroke( false );
+    m_gal->SetFillColor( boxColor );
+
+    m_gal->Save();
+    m_gal->Translate( position );
+    m_gal->Rotate( -aOrientation );
+    m_gal->DrawRectangle( VECTOR2D( box.GetOrigin() ) - position,
+                          VECTOR2D( box.GetEnd() ) - position );
+    m_gal->Restore();
+}
+
+
 const double PCB_RENDER_SETTINGS::MAX_FONT_SIZE = Millimeter2iu( 10.0 );
+const double PCB_PAINTER::MIN_TEXT_PIXELS = 4.0;
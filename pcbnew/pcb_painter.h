@@ -32,6 +32,7 @@
 
 
 class EDA_ITEM;
+class EDA_TEXT;
 class COLORS_DESIGN_SETTINGS;
 class DISPLAY_OPTIONS;
 
@@ -197,9 +198,34 @@ public:
     /// @copydoc PAINTER::Draw()
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer );
 
+    /// @copydoc PAINTER::CreateWorker()
+    virtual PAINTER* CreateWorker( GAL* aGal ) const;
+
+    /// @copydoc PAINTER::HasDetailLevels()
+    virtual bool HasDetailLevels( const VIEW_ITEM* aItem, int aLayer ) const;
+
 protected:
     PCB_RENDER_SETTINGS m_pcbSettings;
 
+    ///> Minimal size of a readable text (in pixels), smaller texts are simplified
+    static const double MIN_TEXT_PIXELS;
+
+    /**
+     * Function isReadable
+     * Tells if a text is big enough to be read at the current level of detail.
+     * @param aTextSize is the height of the text.
+     */
+    bool isReadable( double aTextSize ) const;
+
+    /**
+     * Function drawTextBox
+     * Draws the bounding box of a text instead of its glyphs, when it is too small to be read.
+     * @param aText is the text.
+     * @param aOrientation is the orientation of the text (in radians).
+     * @param aColor is the color of the text.
+     */
+    void drawTextBox( const EDA_TEXT* aText, double aOrientation, const COLOR4D& aColor );
+
     // Drawing functions for various types of PCB-specific items
     void draw( const TRACK* aTrack, int aLayer );
     void draw( const VIA* aVia, int aLayer );
@@ -961,6 +961,16 @@ void PCB_EDIT_FRAME::OnModify( )
 
     if( m_Draw3DFrame )
         m_Draw3DFrame->ReloadRequest();
+
+    // Keep the DRC markers up to date while the DRC dialog is shown, but not in the
+    // middle of a command: the item being edited has flags set.
+    BOARD_ITEM* curItem = GetCurItem();
+
+    if( m_drc && m_drc->IsDialogShown() && !( curItem && curItem->GetFlags() ) )
+    {
+        if( m_drc->TestChangedItems() )
+            m_canvas->Refresh();
+    }
 }
 
 
@@ -27,10 +27,6 @@
  * @brief Class that computes missing connections on a PCB.
  */
 
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif /* USE_OPENMP */
-
 #include <ratsnest_data.h>
 
 #include <class_board.h>
@@ -38,11 +34,12 @@
 #include <class_pad.h>
 #include <class_track.h>
 #include <class_zone.h>
+#include <task_queue.h>
 
 #include <boost/range/adaptor/map.hpp>
-#include <boost/scoped_ptr.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/bind.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 
 #include <cassert>
 #include <algorithm>
@@ -52,6 +49,12 @@
 #include <profile.h>
 #endif
 
+///> Nets having at least this number of nodes are split in several parts processed concurrently.
+#define RN_SPLIT_NET_MIN_NODES  2000
+
+///> Minimal number of nodes in a part of a split net.
+#define RN_MIN_PART_NODES       500
+
 static uint64_t getDistance( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2 )
 {
     // Drop the least significant bits to avoid overflow
@@ -70,27 +73,43 @@ static bool sortDistance( const RN_NODE_PTR& aOrigin, const RN_NODE_PTR& aNode1,
 }
 
 
-static bool sortWeight( const RN_EDGE_PTR& aEdge1, const RN_EDGE_PTR& aEdge2 )
+/**
+ * Struct RN_MST_EDGE
+ * is an edge of the graph given to kruskalMST(): a triangulation edge or an existing
+ * connection (of zero weight).
+ */
+struct RN_MST_EDGE
 {
-    return aEdge1->GetWeight() < aEdge2->GetWeight();
-}
+    RN_MST_EDGE( const RN_NODE_PTR& aSource, const RN_NODE_PTR& aTarget, unsigned int aWeight ) :
+        m_source( aSource ), m_target( aTarget ), m_weight( aWeight )
+    {}
 
+    RN_NODE_PTR m_source;
+    RN_NODE_PTR m_target;
+    unsigned int m_weight;
+};
 
-bool sortArea( const RN_POLY& aP1, const RN_POLY& aP2 )
+typedef std::vector<RN_MST_EDGE> RN_MST_EDGES;
+
+
+static bool sortWeight( const RN_MST_EDGE& aEdge1, const RN_MST_EDGE& aEdge2 )
 {
-    return aP1.m_bbox.GetArea() < aP2.m_bbox.GetArea();
+    return aEdge1.m_weight < aEdge2.m_weight;
 }
 
 
-bool operator==( const RN_NODE_PTR& aFirst, const RN_NODE_PTR& aSecond )
+static bool sortPosition( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2 )
 {
-    return aFirst->GetX() == aSecond->GetX() && aFirst->GetY() == aSecond->GetY();
+    if( aNode1->GetX() != aNode2->GetX() )
+        return aNode1->GetX() < aNode2->GetX();
+
+    return aNode1->GetY() < aNode2->GetY();
 }
 
 
-bool operator!=( const RN_NODE_PTR& aFirst, const RN_NODE_PTR& aSecond )
+bool sortArea( const RN_POLY& aP1, const RN_POLY& aP2 )
 {
-    return aFirst->GetX() != aSecond->GetX() || aFirst->GetY() != aSecond->GetY();
+    return aP1.m_bbox.GetArea() < aP2.m_bbox.GetArea();
 }
 
 
@@ -112,8 +131,74 @@ static bool isEdgeConnectingNode( const RN_EDGE_PTR& aEdge, const RN_NODE_PTR& a
 }
 
 
-static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
-                                                 std::vector<RN_NODE_PTR>& aNodes )
+///> Adds the existing connections of a net to the edges given to kruskalMST().
+static void addConnections( const RN_LINKS& aLinks, RN_MST_EDGES& aEdges )
+{
+    BOOST_FOREACH( const RN_CONNECTION& connection, aLinks.GetConnections() )
+    {
+        if( connection.IsUsed() )
+            aEdges.push_back( RN_MST_EDGE( connection.GetSourceNode(),
+                                           connection.GetTargetNode(), 0 ) );
+    }
+}
+
+
+///> Adds the edges of a triangulation to the edges given to kruskalMST(), weighted by
+///> their length. Like TRIANGULATOR::GetEdges(), but without building a list of edges.
+static void addTriangulationEdges( const TRIANGULATOR& aTriangulator, RN_MST_EDGES& aEdges )
+{
+    // Each triangle has three half-edges, shared by two triangles unless on the boundary
+    aEdges.reserve( aEdges.size() + 2 * aTriangulator.NoTriangles() + 1 );
+
+    BOOST_FOREACH( const RN_EDGE_PTR& leadingEdge, aTriangulator.GetLeadingEdges() )
+    {
+        RN_EDGE* edge = leadingEdge.get();
+
+        for( int i = 0; i < 3; ++i )
+        {
+            RN_EDGE_PTR twinEdge = edge->GetTwinEdge();
+
+            // Only one of the half-edges
+            if( !twinEdge || edge > twinEdge.get() )
+            {
+                const RN_NODE_PTR& source = edge->GetSourceNode();
+                const RN_NODE_PTR& target = edge->GetTargetNode();
+
+                aEdges.push_back( RN_MST_EDGE( source, target, getDistance( source, target ) ) );
+            }
+
+            edge = edge->GetNextEdgeInFace().get();
+        }
+    }
+}
+
+
+///> Returns the root of the subtree of a node (node slots are used as indices).
+static unsigned int rootNode( std::vector<unsigned int>& aParents, unsigned int aNode )
+{
+    while( aParents[aNode] != aNode )
+    {
+        aParents[aNode] = aParents[aParents[aNode]];
+        aNode = aParents[aNode];
+    }
+
+    return aNode;
+}
+
+
+/**
+ * Function kruskalMST()
+ * computes the ratsnest of a net: the minimum spanning tree of its nodes, where existing
+ * connections come first.
+ * Node tags are set, nodes joined by existing connections share the same tag.
+ * @param aEdges are the existing connections, followed by the triangulation edges.
+ * @param aNodes are the nodes of the net.
+ * @param aSlotCount is the number of node slots of the net (see RN_LINKS).
+ * @return The ratsnest edges.
+ */
+static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_MST_EDGES& aEdges,
+                                                 const std::vector<RN_NODE_PTR>& aNodes,
+                                                 unsigned int aSlotCount )
 {
     unsigned int nodeNumber = aNodes.size();
     unsigned int mstExpectedSize = nodeNumber - 1;
@@ -124,66 +209,53 @@ static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
     std::vector<RN_EDGE_MST_PTR>* mst = new std::vector<RN_EDGE_MST_PTR>;
     mst->reserve( mstExpectedSize );
 
-    // Set tags for marking cycles
-    boost::unordered_map<RN_NODE_PTR, int> tags;
-    unsigned int tag = 0;
-    BOOST_FOREACH( RN_NODE_PTR& node, aNodes )
-    {
-        node->SetTag( tag );
-        tags[node] = tag++;
-    }
+    // Subtrees of nodes joined together, to detect cycles in the graph. They are merged by
+    // size, so building the tree takes a nearly linear time.
+    std::vector<unsigned int> parents( aSlotCount );
+    std::vector<unsigned int> sizes( aSlotCount, 1 );
 
-    // Lists of nodes connected together (subtrees) to detect cycles in the graph
-    std::vector<std::list<int> > cycles( nodeNumber );
-    for( unsigned int i = 0; i < nodeNumber; ++i )
-        cycles[i].push_back( i );
+    for( unsigned int i = 0; i < aSlotCount; ++i )
+        parents[i] = i;
 
-    // Kruskal algorithm requires edges to be sorted by their weight
-    aEdges.sort( sortWeight );
+    // Kruskal algorithm requires edges to be sorted by their weight. The sort is stable to keep
+    // existing connections first.
+    std::stable_sort( aEdges.begin(), aEdges.end(), sortWeight );
 
-    while( mstSize < mstExpectedSize && !aEdges.empty() )
-    {
-        RN_EDGE_PTR& dt = aEdges.front();
+    RN_MST_EDGES::const_iterator edge = aEdges.begin();
 
-        int srcTag = tags[dt->GetSourceNode()];
-        int trgTag = tags[dt->GetTargetNode()];
+    while( mstSize < mstExpectedSize && edge != aEdges.end() )
+    {
+        unsigned int source = rootNode( parents, edge->m_source.GetIndex() );
+        unsigned int target = rootNode( parents, edge->m_target.GetIndex() );
 
         // Check if by adding this edge we are going to join two different forests
-        if( srcTag != trgTag )
+        if( source != target )
         {
             // Because edges are sorted by their weight, first we always process connected
             // items (weight == 0). Once we stumble upon an edge with non-zero weight,
             // it means that the rest of the lines are ratsnest.
-            if( !ratsnestLines && dt->GetWeight() != 0 )
+            if( !ratsnestLines && edge->m_weight != 0 )
+            {
                 ratsnestLines = true;
 
-            // Update tags
-            std::list<int>::iterator it, itEnd;
-
-            if( ratsnestLines )
-            {
-                for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it )
-                    tags[aNodes[*it]] = srcTag;
-            }
-            else
-            {
-                for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it ) {
-                    tags[aNodes[*it]] = srcTag;
-                    aNodes[*it]->SetTag( srcTag );
-                }
+                // Nodes connected by copper are tagged with the root of their subtree
+                BOOST_FOREACH( const RN_NODE_PTR& node, aNodes )
+                    node->SetTag( rootNode( parents, node.GetIndex() ) );
             }
 
-            // Move nodes that were marked with old tag to the list marked with the new tag
-            cycles[srcTag].splice( cycles[srcTag].end(), cycles[trgTag] );
+            if( sizes[source] < sizes[target] )
+                std::swap( source, target );
+
+            parents[target] = source;
+            sizes[source] += sizes[target];
 
             if( ratsnestLines )
             {
-                // Do a copy of edge, but make it RN_EDGE_MST. In contrary to RN_EDGE,
                 // RN_EDGE_MST saves both source and target node and does not require any other
                 // edges to exist for getting source/target nodes
-                RN_EDGE_MST_PTR newEdge = boost::make_shared<RN_EDGE_MST>( dt->GetSourceNode(),
-                                                                           dt->GetTargetNode(),
-                                                                           dt->GetWeight() );
+                RN_EDGE_MST_PTR newEdge = boost::make_shared<RN_EDGE_MST>( edge->m_source,
+                                                                           edge->m_target,
+                                                                           edge->m_weight );
                 mst->push_back( newEdge );
                 ++mstSize;
             }
@@ -194,12 +266,15 @@ static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
             }
         }
 
-        // Remove the edge that was just processed
-        aEdges.erase( aEdges.begin() );
+        ++edge;
     }
 
-    // Probably we have discarded some of edges, so reduce the size
-    mst->resize( mstSize );
+    // All the nodes are connected by copper
+    if( !ratsnestLines )
+    {
+        BOOST_FOREACH( const RN_NODE_PTR& node, aNodes )
+            node->SetTag( rootNode( parents, node.GetIndex() ) );
+    }
 
     return mst;
 }
@@ -249,14 +324,42 @@ void RN_NET::validateEdge( RN_EDGE_MST_PTR& aEdge )
 }
 
 
-const RN_NODE_PTR& RN_LINKS::AddNode( int aX, int aY )
+///> Key of a position in RN_LINKS::m_nodeIndex.
+static uint64_t positionKey( int aX, int aY )
 {
-    RN_NODE_SET::iterator node;
-    bool wasNewElement;
+    return ( (uint64_t) (uint32_t) aX << 32 ) | (uint32_t) aY;
+}
 
-    boost::tie( node, wasNewElement ) = m_nodes.emplace( boost::make_shared<RN_NODE>( aX, aY ) );
 
-    return *node;
+RN_NODE_PTR RN_LINKS::AddNode( int aX, int aY )
+{
+    // Most of the calls are for an existing node
+    std::pair<boost::unordered_map<uint64_t, unsigned int>::iterator, bool> slot =
+            m_nodeIndex.insert( std::make_pair( positionKey( aX, aY ), 0u ) );
+
+    if( !slot.second )
+        return GetNode( slot.first->second );
+
+    unsigned int index;
+
+    if( m_freeNodes.empty() )
+    {
+        index = m_nodes.size();
+        m_nodes.push_back( RN_NODE( aX, aY ) );
+        m_usedNodes.push_back( true );
+    }
+    else
+    {
+        index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        m_nodes[index] = RN_NODE( aX, aY );
+        m_usedNodes[index] = true;
+    }
+
+    slot.first->second = index;
+    ++m_nodeCount;
+
+    return GetNode( index );
 }
 
 
@@ -264,7 +367,14 @@ bool RN_LINKS::RemoveNode( const RN_NODE_PTR& aNode )
 {
     if( aNode->GetRefCount() == 0 )
     {
-        m_nodes.erase( aNode );
+        unsigned int index = aNode.GetIndex();
+
+        assert( m_usedNodes[index] );
+
+        m_nodeIndex.erase( positionKey( aNode->GetX(), aNode->GetY() ) );
+        m_usedNodes[index] = false;
+        m_freeNodes.push_back( index );
+        --m_nodeCount;
 
         return true;
     }
@@ -273,62 +383,331 @@ bool RN_LINKS::RemoveNode( const RN_NODE_PTR& aNode )
 }
 
 
-RN_EDGE_MST_PTR RN_LINKS::AddConnection( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2,
-                                          unsigned int aDistance )
+void RN_LINKS::GetNodes( std::vector<RN_NODE_PTR>& aNodes ) const
+{
+    aNodes.reserve( aNodes.size() + m_nodeCount );
+
+    for( unsigned int i = 0; i < m_nodes.size(); ++i )
+    {
+        if( m_usedNodes[i] )
+            aNodes.push_back( GetNode( i ) );
+    }
+}
+
+
+int RN_LINKS::AddConnection( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2 )
 {
     assert( aNode1 != aNode2 );
-    RN_EDGE_MST_PTR edge = boost::make_shared<RN_EDGE_MST>( aNode1, aNode2, aDistance );
-    m_edges.push_back( edge );
 
-    return edge;
+    int index;
+
+    if( m_freeConnections.empty() )
+    {
+        index = m_connections.size();
+        m_connections.push_back( RN_CONNECTION( aNode1, aNode2 ) );
+    }
+    else
+    {
+        index = m_freeConnections.back();
+        m_freeConnections.pop_back();
+        m_connections[index] = RN_CONNECTION( aNode1, aNode2 );
+    }
+
+    ++m_connectionCount;
+
+    return index;
+}
+
+
+void RN_LINKS::RemoveConnection( int aIndex )
+{
+    assert( m_connections[aIndex].IsUsed() );
+
+    m_connections[aIndex] = RN_CONNECTION();
+    m_freeConnections.push_back( aIndex );
+    --m_connectionCount;
 }
 
 
-void RN_NET::compute()
+void RN_NET::compute( int aThreadCount )
 {
-    const RN_LINKS::RN_NODE_SET& boardNodes = m_links.GetNodes();
-    const RN_LINKS::RN_EDGE_LIST& boardEdges = m_links.GetConnections();
+    unsigned int nodeCount = m_links.GetNodeCount();
 
     // Special cases do not need complicated algorithms
-    if( boardNodes.size() <= 2 )
+    if( nodeCount <= 2 )
     {
         m_rnEdges.reset( new std::vector<RN_EDGE_MST_PTR>( 0 ) );
 
         // Check if the only possible connection exists
-        if( boardEdges.size() == 0 && boardNodes.size() == 2 )
+        if( m_links.GetConnectionCount() == 0 && nodeCount == 2 )
         {
-            RN_LINKS::RN_NODE_SET::iterator last = ++boardNodes.begin();
+            std::vector<RN_NODE_PTR> nodes;
+            m_links.GetNodes( nodes );
 
             // There can be only one possible connection, but it is missing
-            m_rnEdges->push_back( boost::make_shared<RN_EDGE_MST>( *boardNodes.begin(), *last ) );
+            m_rnEdges->push_back( boost::make_shared<RN_EDGE_MST>( nodes[0], nodes[1] ) );
         }
 
         return;
     }
 
-    // Move and sort (sorting speeds up) all nodes to a vector for the Delaunay triangulation
-    std::vector<RN_NODE_PTR> nodes( boardNodes.size() );
-    std::partial_sort_copy( boardNodes.begin(), boardNodes.end(), nodes.begin(), nodes.end() );
+    if( aThreadCount > 1 && nodeCount >= RN_SPLIT_NET_MIN_NODES )
+    {
+        int stripCount = std::min<int>( aThreadCount, nodeCount / RN_MIN_PART_NODES );
 
-    TRIANGULATOR triangulator;
-    triangulator.CreateDelaunay( nodes.begin(), nodes.end() );
-    boost::scoped_ptr<RN_LINKS::RN_EDGE_LIST> triangEdges( triangulator.GetEdges() );
+        if( computeSplit( stripCount, aThreadCount ) )
+            return;
+    }
 
-    // Compute weight/distance for edges resulting from triangulation
-    RN_LINKS::RN_EDGE_LIST::iterator eit, eitEnd;
-    for( eit = (*triangEdges).begin(), eitEnd = (*triangEdges).end(); eit != eitEnd; ++eit )
-        (*eit)->SetWeight( getDistance( (*eit)->GetSourceNode(), (*eit)->GetTargetNode() ) );
+    // Sort all nodes for the Delaunay triangulation. Sorting them by position speeds up
+    // a lot the triangulation, as a new node is close to the previous one.
+    std::vector<RN_NODE_PTR> nodes;
+    m_links.GetNodes( nodes );
+    std::sort( nodes.begin(), nodes.end(), sortPosition );
 
-    // Add the currently existing connections list to the results of triangulation
-    std::copy( boardEdges.begin(), boardEdges.end(), std::front_inserter( *triangEdges ) );
+    // The currently existing connections come first, then the results of triangulation
+    RN_MST_EDGES edges;
+    addConnections( m_links, edges );
+
+    {
+        TRIANGULATOR triangulator;
+        triangulator.CreateDelaunay( nodes.begin(), nodes.end() );
+        addTriangulationEdges( triangulator, edges );
+    }
 
     // Get the minimal spanning tree
-    m_rnEdges.reset( kruskalMST( *triangEdges, nodes ) );
+    m_rnEdges.reset( kruskalMST( edges, nodes, m_links.GetNodeSlotCount() ) );
+}
+
+
+/**
+ * Struct RN_NET_PART
+ * is a part of a net split to compute its ratsnest concurrently: either a strip of nodes,
+ * or a seam (the nodes close to the boundary of two neighbour strips).
+ */
+struct RN_NET_PART
+{
+    ///> Nodes of the part, sorted by position.
+    std::vector<RN_NODE_PTR> m_nodes;
+
+    ///> True for a strip, false for a seam.
+    bool m_isStrip;
+
+    ///> Existing connections between the nodes of a strip.
+    RN_MST_EDGES m_connections;
+
+    ///> Tag of the first node of a strip (node tags are their index in the whole net).
+    int m_firstTag;
+
+    ///> Edges of the part that can be in the ratsnest.
+    RN_MST_EDGES m_edges;
+};
+
+
+/**
+ * Struct RN_NET_PART_TASK
+ * triangulates the parts of a split net. For a strip, only the edges of its minimum spanning
+ * forest are kept: any other edge is the longest one of a cycle, so it cannot be in the
+ * minimum spanning tree of the whole net either.
+ */
+struct RN_NET_PART_TASK
+{
+    RN_NET_PART_TASK( boost::ptr_vector<RN_NET_PART>& aParts ) : m_parts( aParts )
+    {}
+
+    void operator()( int aIndex )
+    {
+        RN_NET_PART& part = m_parts[aIndex];
+
+        if( part.m_nodes.size() == 2 )
+        {
+            // Nothing to triangulate
+            part.m_edges.push_back( RN_MST_EDGE( part.m_nodes[0], part.m_nodes[1],
+                        getDistance( part.m_nodes[0], part.m_nodes[1] ) ) );
+            return;
+        }
+
+        RN_MST_EDGES edges;
+
+        {
+            TRIANGULATOR triangulator;
+            triangulator.CreateDelaunay( part.m_nodes.begin(), part.m_nodes.end() );
+            addTriangulationEdges( triangulator, edges );
+        }
+
+        if( !part.m_isStrip )
+        {
+            part.m_edges.swap( edges );
+            return;
+        }
+
+        // Kruskal algorithm, existing connections first
+        std::vector<int> parents( part.m_nodes.size() );
+
+        for( unsigned int i = 0; i < parents.size(); ++i )
+            parents[i] = i;
+
+        BOOST_FOREACH( const RN_MST_EDGE& edge, part.m_connections )
+            join( part, parents, edge );
+
+        std::sort( edges.begin(), edges.end(), sortWeight );
+
+        BOOST_FOREACH( const RN_MST_EDGE& edge, edges )
+        {
+            if( join( part, parents, edge ) )
+                part.m_edges.push_back( edge );
+        }
+    }
+
+private:
+    ///> Merges the subtrees of the nodes of aEdge. Returns false if they were already merged.
+    static bool join( const RN_NET_PART& aPart, std::vector<int>& aParents,
+                      const RN_MST_EDGE& aEdge )
+    {
+        int source = root( aParents, aEdge.m_source->GetTag() - aPart.m_firstTag );
+        int target = root( aParents, aEdge.m_target->GetTag() - aPart.m_firstTag );
+
+        if( source == target )
+            return false;
+
+        aParents[target] = source;
+
+        return true;
+    }
+
+    static int root( std::vector<int>& aParents, int aNode )
+    {
+        while( aParents[aNode] != aNode )
+        {
+            aParents[aNode] = aParents[aParents[aNode]];
+            aNode = aParents[aNode];
+        }
+
+        return aNode;
+    }
+
+    boost::ptr_vector<RN_NET_PART>& m_parts;
+};
+
+
+bool RN_NET::computeSplit( int aStripCount, int aThreadCount )
+{
+    // Nodes are split in strips of consecutive x coordinates.
+    // Node tags are used as their index until kruskalMST() sets them.
+    std::vector<RN_NODE_PTR> nodes;
+    m_links.GetNodes( nodes );
+    std::sort( nodes.begin(), nodes.end(), sortPosition );
+
+    for( unsigned int i = 0; i < nodes.size(); ++i )
+        nodes[i]->SetTag( i );
+
+    int nodeCount = nodes.size();
+    int stripSize = ( nodeCount + aStripCount - 1 ) / aStripCount;
+    std::vector<int> stripStart;
+
+    for( int i = 0; i < nodeCount; i += stripSize )
+        stripStart.push_back( i );
+
+    stripStart.push_back( nodeCount );
+
+    boost::ptr_vector<RN_NET_PART> parts;
+
+    for( unsigned int i = 0; i + 1 < stripStart.size(); ++i )
+    {
+        RN_NET_PART* strip = new RN_NET_PART;
+        strip->m_isStrip = true;
+        strip->m_firstTag = stripStart[i];
+        strip->m_nodes.assign( nodes.begin() + stripStart[i], nodes.begin() + stripStart[i + 1] );
+        parts.push_back( strip );
+    }
+
+    RN_MST_EDGES edges;
+    addConnections( m_links, edges );
+
+    BOOST_FOREACH( const RN_MST_EDGE& edge, edges )
+    {
+        int source = edge.m_source->GetTag();
+        int target = edge.m_target->GetTag();
+
+        // Connections between strips are only needed for the whole net
+        if( source / stripSize == target / stripSize )
+            parts[source / stripSize].m_connections.push_back( edge );
+    }
+
+    // An edge of the triangulation of the whole net which joins two nodes of a strip is
+    // in the triangulation of the strip too. The edges between two strips are found by
+    // triangulating the nodes close to their boundary (a seam), closer than seamWidth.
+    // Edges missing from the parts are longer than the smallest seam width.
+    int64_t minSeamWidth = std::numeric_limits<int64_t>::max();
+    int stripCount = parts.size();
+
+    for( int i = 0; i + 1 < stripCount; ++i )
+    {
+        const RN_NODE_PTR& first = nodes[stripStart[i]];
+        const RN_NODE_PTR& boundary = nodes[stripStart[i + 1]];
+        const RN_NODE_PTR& last = nodes[stripStart[i + 2] - 1];
+
+        int64_t seamWidth = std::min( (int64_t) boundary->GetX() - first->GetX(),
+                                      (int64_t) last->GetX() - boundary->GetX() ) / 2;
+        minSeamWidth = std::min( minSeamWidth, seamWidth );
+
+        int begin = stripStart[i + 1] - 1;
+
+        while( begin > stripStart[i] &&
+               (int64_t) boundary->GetX() - nodes[begin - 1]->GetX() <= seamWidth )
+            --begin;
+
+        int end = stripStart[i + 1] + 1;
+
+        while( end < stripStart[i + 2] &&
+               (int64_t) nodes[end]->GetX() - boundary->GetX() <= seamWidth )
+            ++end;
+
+        RN_NET_PART* seam = new RN_NET_PART;
+        seam->m_isStrip = false;
+        seam->m_firstTag = begin;
+        seam->m_nodes.assign( nodes.begin() + begin, nodes.begin() + end );
+        parts.push_back( seam );
+    }
+
+    RN_NET_PART_TASK task( parts );
+    TASK_QUEUE<RN_NET_PART_TASK> queue( task, parts.size() );
+    queue.Run( aThreadCount );
+
+    for( unsigned int i = 0; i < parts.size(); ++i )
+    {
+        edges.insert( edges.end(), parts[i].m_edges.begin(), parts[i].m_edges.end() );
+        RN_MST_EDGES().swap( parts[i].m_edges );
+    }
+
+    std::vector<RN_EDGE_MST_PTR>* mst = kruskalMST( edges, nodes, m_links.GetNodeSlotCount() );
+
+    // A ratsnest edge of the whole net could be missing only if it is longer than the
+    // longest edge found: then it would be a better choice than that one.
+    int64_t dist = minSeamWidth >> 16;
+    uint64_t maxWeight = dist * dist;
+
+    BOOST_FOREACH( const RN_EDGE_MST_PTR& edge, *mst )
+    {
+        if( edge->GetWeight() > maxWeight )
+        {
+            delete mst;
+            return false;
+        }
+    }
+
+    m_rnEdges.reset( mst );
+
+    return true;
 }
 
 
 void RN_NET::clearNode( const RN_NODE_PTR& aNode )
 {
+    // The slot of the node is reused by the next node added
+    m_blockedNodes.erase( aNode );
+    m_simpleNodes.erase( aNode );
+
     if( !m_rnEdges )
         return;
 
@@ -401,12 +780,12 @@ bool RN_POLY::HitTest( const RN_NODE_PTR& aNode ) const
 }
 
 
-void RN_NET::Update()
+void RN_NET::Update( int aThreadCount )
 {
     // Add edges resulting from nodes being connected by zones
     processZones();
 
-    compute();
+    compute( aThreadCount );
 
     BOOST_FOREACH( RN_EDGE_MST_PTR& edge, *m_rnEdges )
         validateEdge( edge );
@@ -549,15 +928,15 @@ void RN_NET::RemoveItem( const TRACK* aTrack )
 {
     try
     {
-        RN_EDGE_MST_PTR& edge = m_tracks.at( aTrack );
+        int connection = m_tracks.at( aTrack );
 
         // Save nodes, so they can be cleared later
-        RN_NODE_PTR start = edge->GetSourceNode();
+        RN_NODE_PTR start = m_links.GetConnection( connection ).GetSourceNode();
         start->RemoveParent( aTrack );
-        RN_NODE_PTR end = edge->GetTargetNode();
+        RN_NODE_PTR end = m_links.GetConnection( connection ).GetTargetNode();
         end->RemoveParent( aTrack );
 
-        m_links.RemoveConnection( edge );
+        m_links.RemoveConnection( connection );
 
         // Remove nodes associated with the edge. It is done in a safe way, there is a check
         // if nodes are not used by other edges.
@@ -594,8 +973,8 @@ void RN_NET::RemoveItem( const ZONE_CONTAINER* aZone )
         polygons.clear();
 
         // Remove all connections added by the zone
-        std::deque<RN_EDGE_MST_PTR>& edges = m_zones.at( aZone ).m_Edges;
-        BOOST_FOREACH( RN_EDGE_PTR edge, edges )
+        std::vector<int>& edges = m_zones.at( aZone ).m_Edges;
+        BOOST_FOREACH( int edge, edges )
             m_links.RemoveConnection( edge );
         edges.clear();
 
@@ -609,15 +988,15 @@ void RN_NET::RemoveItem( const ZONE_CONTAINER* aZone )
 
 const RN_NODE_PTR RN_NET::GetClosestNode( const RN_NODE_PTR& aNode ) const
 {
-    const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
-    RN_LINKS::RN_NODE_SET::const_iterator it, itEnd;
-
     unsigned int minDistance = std::numeric_limits<unsigned int>::max();
     RN_NODE_PTR closest;
 
-    for( it = nodes.begin(), itEnd = nodes.end(); it != itEnd; ++it )
+    for( unsigned int i = 0; i < m_links.GetNodeSlotCount(); ++i )
     {
-        RN_NODE_PTR node = *it;
+        if( !m_links.IsNodeUsed( i ) )
+            continue;
+
+        RN_NODE_PTR node = m_links.GetNode( i );
 
         // Obviously the distance between node and itself is the shortest,
         // that's why we have to skip it
@@ -639,15 +1018,15 @@ const RN_NODE_PTR RN_NET::GetClosestNode( const RN_NODE_PTR& aNode ) const
 const RN_NODE_PTR RN_NET::GetClosestNode( const RN_NODE_PTR& aNode,
                                           const RN_NODE_FILTER& aFilter ) const
 {
-    const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
-    RN_LINKS::RN_NODE_SET::const_iterator it, itEnd;
-
     unsigned int minDistance = std::numeric_limits<unsigned int>::max();
     RN_NODE_PTR closest;
 
-    for( it = nodes.begin(), itEnd = nodes.end(); it != itEnd; ++it )
+    for( unsigned int i = 0; i < m_links.GetNodeSlotCount(); ++i )
     {
-        RN_NODE_PTR node = *it;
+        if( !m_links.IsNodeUsed( i ) )
+            continue;
+
+        RN_NODE_PTR node = m_links.GetNode( i );
 
         // Obviously the distance between node and itself is the shortest,
         // that's why we have to skip it
@@ -669,12 +1048,11 @@ const RN_NODE_PTR RN_NET::GetClosestNode( const RN_NODE_PTR& aNode,
 
 std::list<RN_NODE_PTR> RN_NET::GetClosestNodes( const RN_NODE_PTR& aNode, int aNumber ) const
 {
-    std::list<RN_NODE_PTR> closest;
-    const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
+    std::vector<RN_NODE_PTR> nodes;
+    m_links.GetNodes( nodes );
 
     // Copy nodes
-    BOOST_FOREACH( const RN_NODE_PTR& node, nodes )
-        closest.push_back( node );
+    std::list<RN_NODE_PTR> closest( nodes.begin(), nodes.end() );
 
     // Sort by the distance from aNode
     closest.sort( boost::bind( sortDistance, boost::cref( aNode ), _1, _2 ) );
@@ -694,12 +1072,11 @@ std::list<RN_NODE_PTR> RN_NET::GetClosestNodes( const RN_NODE_PTR& aNode, int aN
 std::list<RN_NODE_PTR> RN_NET::GetClosestNodes( const RN_NODE_PTR& aNode,
                                                 const RN_NODE_FILTER& aFilter, int aNumber ) const
 {
-    std::list<RN_NODE_PTR> closest;
-    const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
+    std::vector<RN_NODE_PTR> nodes;
+    m_links.GetNodes( nodes );
 
     // Copy nodes
-    BOOST_FOREACH( const RN_NODE_PTR& node, nodes )
-        closest.push_back( node );
+    std::list<RN_NODE_PTR> closest( nodes.begin(), nodes.end() );
 
     // Sort by the distance from aNode
     closest.sort( boost::bind( sortDistance, boost::cref( aNode ), _1, _2 ) );
@@ -758,10 +1135,10 @@ std::list<RN_NODE_PTR> RN_NET::GetNodes( const BOARD_CONNECTED_ITEM* aItem ) con
         case PCB_TRACE_T:
         {
             const TRACK* track = static_cast<const TRACK*>( aItem );
-            const RN_EDGE_MST_PTR& edge = m_tracks.at( track );
+            const RN_CONNECTION& connection = m_links.GetConnection( m_tracks.at( track ) );
 
-            nodes.push_back( edge->GetSourceNode() );
-            nodes.push_back( edge->GetTargetNode() );
+            nodes.push_back( connection.GetSourceNode() );
+            nodes.push_back( connection.GetTargetNode() );
         }
         break;
 
@@ -858,7 +1235,7 @@ void RN_NET::GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
     {
         for( TRACK_EDGE_MAP::const_iterator it = m_tracks.begin(); it != m_tracks.end(); ++it )
         {
-            if( it->second->GetTag() == tag )
+            if( m_links.GetConnection( it->second ).GetTag() == tag )
                 aOutput.push_back( const_cast<TRACK*>( it->first ) );
         }
     }
@@ -867,9 +1244,9 @@ void RN_NET::GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
     {
         for( ZONE_DATA_MAP::const_iterator it = m_zones.begin(); it != m_zones.end(); ++it )
         {
-            BOOST_FOREACH( const RN_EDGE_MST_PTR& edge, it->second.m_Edges )
+            BOOST_FOREACH( int edge, it->second.m_Edges )
             {
-                if( edge->GetTag() == tag )
+                if( m_links.GetConnection( edge ).GetTag() == tag )
                 {
                     aOutput.push_back( const_cast<ZONE_CONTAINER*>( it->first ) );
                     break;
@@ -993,15 +1370,15 @@ void RN_NET::processZones()
         RN_ZONE_DATA& zoneData = it->second;
 
         // Reset existing connections
-        BOOST_FOREACH( RN_EDGE_MST_PTR edge, zoneData.m_Edges )
+        BOOST_FOREACH( int edge, zoneData.m_Edges )
             m_links.RemoveConnection( edge );
 
         zoneData.m_Edges.clear();
         LSET layers = zone->GetLayerSet();
 
         // Compute new connections
-        RN_LINKS::RN_NODE_SET candidates = m_links.GetNodes();
-        RN_LINKS::RN_NODE_SET::iterator point, pointEnd;
+        std::vector<RN_NODE_PTR> candidates;
+        m_links.GetNodes( candidates );
 
         // Sorting by area should speed up the processing, as smaller polygons are computed
         // faster and may reduce the number of points for further checks
@@ -1011,25 +1388,24 @@ void RN_NET::processZones()
                 polyEnd = zoneData.m_Polygons.end(); poly != polyEnd; ++poly )
         {
             const RN_NODE_PTR& node = poly->GetNode();
+            unsigned int i = 0;
 
-            point = candidates.begin();
-            pointEnd = candidates.end();
-
-            while( point != pointEnd )
+            while( i < candidates.size() )
             {
-                if( *point != node && ( (*point)->GetLayers() & layers ).any()
-                        && poly->HitTest( *point ) )
+                RN_NODE_PTR point = candidates[i];
+
+                if( point != node && ( point->GetLayers() & layers ).any()
+                        && poly->HitTest( point ) )
                 {
-                    RN_EDGE_MST_PTR connection = m_links.AddConnection( node, *point );
-                    zoneData.m_Edges.push_back( connection );
+                    zoneData.m_Edges.push_back( m_links.AddConnection( node, point ) );
 
                     // This point already belongs to a polygon, we do not need to check it anymore
-                    point = candidates.erase( point );
-                    pointEnd = candidates.end();
+                    candidates[i] = candidates.back();
+                    candidates.pop_back();
                 }
                 else
                 {
-                    ++point;
+                    ++i;
                 }
             }
         }
@@ -1227,6 +1603,59 @@ void RN_DATA::ProcessBoard()
 }
 
 
+/**
+ * Struct RN_NET_UPDATE_TASK
+ * recomputes the ratsnest of a list of nets, one net per task.
+ */
+struct RN_NET_UPDATE_TASK
+{
+    RN_NET_UPDATE_TASK( boost::ptr_vector<RN_NET>& aNets, const std::vector<int>& aNetCodes ) :
+        m_nets( aNets ), m_netCodes( aNetCodes )
+    {}
+
+    void operator()( int aIndex )
+    {
+        RN_NET& net = m_nets[m_netCodes[aIndex]];
+
+        net.ClearSimple();
+        net.Update();
+    }
+
+    boost::ptr_vector<RN_NET>&  m_nets;
+    const std::vector<int>&     m_netCodes;
+};
+
+
+/**
+ * Struct RN_NET_SIZE_COMPARE
+ * sorts net codes by decreasing size of their net.
+ */
+struct RN_NET_SIZE_COMPARE
+{
+    RN_NET_SIZE_COMPARE( const boost::ptr_vector<RN_NET>& aNets ) : m_nets( aNets )
+    {}
+
+    bool operator()( int aNetCode1, int aNetCode2 ) const
+    {
+        return m_nets[aNetCode1].GetNodeCount() > m_nets[aNetCode2].GetNodeCount();
+    }
+
+    const boost::ptr_vector<RN_NET>& m_nets;
+};
+
+
+RN_DATA::RN_DATA( const BOARD* aBoard ) :
+    m_board( aBoard ), m_threadCount( DefaultThreadCount() )
+{
+}
+
+
+void RN_DATA::SetThreadCount( int aCount )
+{
+    m_threadCount = aCount > 0 ? aCount : DefaultThreadCount();
+}
+
+
 void RN_DATA::Recalculate( int aNet )
 {
     unsigned int netCount = m_board->GetNetCount();
@@ -1241,22 +1670,34 @@ void RN_DATA::Recalculate( int aNet )
     prof_start( &totalRealTime );
 #endif
 
-        unsigned int i;
+        std::vector<int> netCodes;
 
-#ifdef USE_OPENMP
-        #pragma omp parallel shared(netCount) private(i)
+        // Start with net number 1, as 0 stands for not connected
+        for( unsigned int i = 1; i < netCount; ++i )
         {
-            #pragma omp for schedule(guided, 1)
-#else /* USE_OPENMP */
+            if( m_nets[i].IsDirty() )
+                netCodes.push_back( i );
+        }
+
+        // The largest nets take the longest time, so they are started first
+        std::stable_sort( netCodes.begin(), netCodes.end(), RN_NET_SIZE_COMPARE( m_nets ) );
+
+        // Very large nets are split and recomputed one at a time, using all the threads
+        unsigned int first = 0;
+
+        while( m_threadCount > 1 && first < netCodes.size()
+               && m_nets[netCodes[first]].GetNodeCount() >= RN_SPLIT_NET_MIN_NODES )
         {
-#endif
-            // Start with net number 1, as 0 stands for not connected
-            for( i = 1; i < netCount; ++i )
-            {
-                if( m_nets[i].IsDirty() )
-                    updateNet( i );
-            }
-        }  /* end of parallel section */
+            updateNet( netCodes[first++], m_threadCount );
+        }
+
+        // Other nets are recomputed concurrently, each one by a single thread
+        netCodes.erase( netCodes.begin(), netCodes.begin() + first );
+
+        RN_NET_UPDATE_TASK task( m_nets, netCodes );
+        TASK_QUEUE<RN_NET_UPDATE_TASK> queue( task, netCodes.size() );
+        queue.Run( m_threadCount );
+
 #ifdef PROFILE
     prof_end( &totalRealTime );
 
@@ -1265,12 +1706,12 @@ void RN_DATA::Recalculate( int aNet )
     }
     else if( aNet > 0 )         // Recompute only specific net
     {
-        updateNet( aNet );
+        updateNet( aNet, m_threadCount );
     }
 }
 
 
-void RN_DATA::updateNet( int aNetCode )
+void RN_DATA::updateNet( int aNetCode, int aThreadCount )
 {
     assert( aNetCode < (int) m_nets.size() );
 
@@ -1278,5 +1719,5 @@ void RN_DATA::updateNet( int aNetCode )
         return;
 
     m_nets[aNetCode].ClearSimple();
-    m_nets[aNetCode].Update();
+    m_nets[aNetCode].Update( aThreadCount );
 }
@@ -38,6 +38,8 @@
 #include <boost/unordered_set.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/foreach.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 
 class BOARD;
 class BOARD_ITEM;
@@ -68,9 +70,6 @@ typedef hed::EDGE_MST       RN_EDGE_MST;
 typedef hed::TRIANGULATION  TRIANGULATOR;
 typedef boost::shared_ptr<hed::EDGE_MST> RN_EDGE_MST_PTR;
 
-bool operator==( const RN_NODE_PTR& aFirst, const RN_NODE_PTR& aSecond );
-bool operator!=( const RN_NODE_PTR& aFirst, const RN_NODE_PTR& aSecond );
-
 struct RN_NODE_OR_FILTER;
 struct RN_NODE_AND_FILTER;
 
@@ -149,43 +148,67 @@ struct RN_NODE_OR_FILTER : public RN_NODE_FILTER
 };
 
 
-///> Functor comparing if two nodes are equal by their coordinates. It is required to make set of
-///> shared pointers work properly.
-struct RN_NODE_COMPARE : std::binary_function<RN_NODE_PTR, RN_NODE_PTR, bool>
+/**
+ * Class RN_CONNECTION
+ * is an existing connection between two nodes (a track, or a zone joining items).
+ */
+class RN_CONNECTION
 {
-    bool operator()( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2 ) const
+public:
+    RN_CONNECTION()
+    {}
+
+    RN_CONNECTION( const RN_NODE_PTR& aSource, const RN_NODE_PTR& aTarget ) :
+        m_source( aSource ), m_target( aTarget )
+    {}
+
+    const RN_NODE_PTR& GetSourceNode() const
     {
-        return aNode1 == aNode2;
+        return m_source;
     }
-};
 
-///> Functor calculating hash for a given node. It is required to make set of shared pointers
-///> work properly.
-struct RN_NODE_HASH : std::unary_function<RN_NODE_PTR, std::size_t>
-{
-    std::size_t operator()( const RN_NODE_PTR& aNode ) const
+    const RN_NODE_PTR& GetTargetNode() const
+    {
+        return m_target;
+    }
+
+    ///> Returns the tag of the connected nodes.
+    int GetTag() const
     {
-        std::size_t hash = 2166136261u;
+        int tag = m_source->GetTag();
 
-        hash ^= aNode->GetX();
-        hash *= 16777619;
-        hash ^= aNode->GetY();
+        if( tag >= 0 )
+            return tag;
 
-        return hash;
+        return m_target->GetTag();
     }
+
+    ///> Returns false for a free slot of RN_LINKS.
+    bool IsUsed() const
+    {
+        return m_source.get() != NULL;
+    }
+
+private:
+    RN_NODE_PTR m_source;
+    RN_NODE_PTR m_target;
 };
 
 
 /**
  * Class RN_LINKS
  * Manages data describing nodes and connections for a given net.
+ *
+ * Nodes and connections are stored in vectors and addressed by their index. The slot of a
+ * removed node or connection is put in a free-list and reused by the next one added, so the
+ * vectors have holes: GetNodeSlotCount() and IsNodeUsed() allow to walk through the nodes.
+ * Node handles refer to the node vector of the RN_LINKS object, so it cannot be copied.
  */
-class RN_LINKS
+class RN_LINKS : public boost::noncopyable
 {
 public:
-    // Helper typedefs
-    typedef boost::unordered_set<RN_NODE_PTR, RN_NODE_HASH, RN_NODE_COMPARE> RN_NODE_SET;
-    typedef std::list<RN_EDGE_PTR> RN_EDGE_LIST;
+    RN_LINKS() : m_nodeCount( 0 ), m_connectionCount( 0 )
+    {}
 
     /**
      * Function AddNode()
@@ -195,11 +218,12 @@ public:
      * @param aY is the y coordinate of a node.
      * @return Pointer to the node with given coordinates.
      */
-    const RN_NODE_PTR& AddNode( int aX, int aY );
+    RN_NODE_PTR AddNode( int aX, int aY );
 
     /**
      * Function RemoveNode()
-     * Removes a node described by a given node pointer.
+     * Removes a node described by a given node pointer. Its slot is reused by the next node
+     * added, so the pointer must not be used anymore if the node was removed.
      * @param aNode is a pointer to node to be removed.
      * @return True if node was removed, false if there were other references, so it was kept.
      */
@@ -207,53 +231,118 @@ public:
 
     /**
      * Function GetNodes()
-     * Returns the set of currently used nodes.
-     * @return The set of currently used nodes.
+     * Adds the currently used nodes to a vector.
+     * @param aNodes is the vector that will have nodes added.
+     */
+    void GetNodes( std::vector<RN_NODE_PTR>& aNodes ) const;
+
+    /**
+     * Function GetNodeCount()
+     * Returns the number of currently used nodes.
+     */
+    unsigned int GetNodeCount() const
+    {
+        return m_nodeCount;
+    }
+
+    /**
+     * Function GetNodeSlotCount()
+     * Returns the number of node slots, used or free. Node indices are lower than this number.
+     */
+    unsigned int GetNodeSlotCount() const
+    {
+        return m_nodes.size();
+    }
+
+    /**
+     * Function IsNodeUsed()
+     * Returns true if a node slot holds a node, false if it is free.
+     * @param aIndex is the slot index.
+     */
+    bool IsNodeUsed( unsigned int aIndex ) const
+    {
+        return m_usedNodes[aIndex];
+    }
+
+    /**
+     * Function GetNode()
+     * Returns the node stored in a slot.
+     * @param aIndex is the slot index.
      */
-    const RN_NODE_SET& GetNodes() const
+    RN_NODE_PTR GetNode( unsigned int aIndex ) const
     {
-        return m_nodes;
+        return RN_NODE_PTR( const_cast<hed::NODE_POOL*>( &m_nodes ), aIndex );
     }
 
     /**
      * Function AddConnection()
-     * Adds a connection between two nodes and of given distance. Edges with distance equal 0 are
-     * considered to be existing connections. Distance different than 0 means that the connection
-     * is missing.
+     * Adds an existing connection between two nodes.
      * @param aNode1 is the origin node of a new connection.
      * @param aNode2 is the end node of a new connection.
-     * @param aDistance is the distance of the connection (0 means that nodes are actually
-     * connected, >0 means a missing connection).
+     * @return Index of the connection, to be given to RemoveConnection().
      */
-    RN_EDGE_MST_PTR AddConnection( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2,
-                                    unsigned int aDistance = 0 );
+    int AddConnection( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2 );
 
     /**
      * Function RemoveConnection()
-     * Removes a connection described by a given edge pointer.
-     * @param aEdge is a pointer to edge to be removed.
+     * Removes a connection. Its slot is reused by the next connection added.
+     * @param aIndex is the index of the connection, returned by AddConnection().
      */
-    void RemoveConnection( const RN_EDGE_PTR& aEdge )
+    void RemoveConnection( int aIndex );
+
+    /**
+     * Function GetConnection()
+     * Returns a connection.
+     * @param aIndex is the index of the connection, returned by AddConnection().
+     */
+    const RN_CONNECTION& GetConnection( int aIndex ) const
     {
-        m_edges.remove( aEdge );
+        return m_connections[aIndex];
     }
 
     /**
      * Function GetConnections()
-     * Returns the list of edges that currently connect nodes.
-     * @return the list of edges that currently connect nodes.
+     * Returns the connection slots. Free slots are not RN_CONNECTION::IsUsed().
+     * @return the connection slots.
      */
-    const RN_EDGE_LIST& GetConnections() const
+    const std::vector<RN_CONNECTION>& GetConnections() const
     {
-        return m_edges;
+        return m_connections;
+    }
+
+    /**
+     * Function GetConnectionCount()
+     * Returns the number of currently used connections.
+     */
+    unsigned int GetConnectionCount() const
+    {
+        return m_connectionCount;
     }
 
 protected:
-    ///> Set of nodes that are expected to be connected together (vias, tracks, pads).
-    RN_NODE_SET m_nodes;
+    ///> Nodes that are expected to be connected together (vias, tracks, pads).
+    hed::NODE_POOL m_nodes;
+
+    ///> Flags telling which node slots hold a node.
+    std::vector<bool> m_usedNodes;
+
+    ///> Free node slots.
+    std::vector<unsigned int> m_freeNodes;
+
+    ///> Number of used node slots.
+    unsigned int m_nodeCount;
+
+    ///> Node slots by position, as there is a single node at a given position.
+    boost::unordered_map<uint64_t, unsigned int> m_nodeIndex;
 
-    ///> List of edges that currently connect nodes.
-    RN_EDGE_LIST m_edges;
+    ///> Edges that currently connect nodes.
+    std::vector<RN_CONNECTION> m_connections;
+
+    ///> Free connection slots.
+    std::vector<int> m_freeConnections;
+
+    ///> Number of used connection slots.
+    unsigned int m_connectionCount;
 };
 
 
@@ -369,8 +458,18 @@ public:
     /**
      * Function Update()
      * Recomputes ratsnest for a net.
+     * @param aThreadCount is the number of threads that can be used for a large net.
      */
-    void Update();
+    void Update( int aThreadCount = 1 );
+
+    /**
+     * Function GetNodeCount()
+     * Returns the number of nodes of the net, i.e. the size of the ratsnest problem.
+     */
+    unsigned int GetNodeCount() const
+    {
+        return m_links.GetNodeCount();
+    }
 
     /**
      * Function AddItem()
@@ -543,14 +642,18 @@ protected:
     ///> to make sure that they are not ones with the flag set.
     void validateEdge( RN_EDGE_MST_PTR& aEdge );
 
-    ///> Removes all ratsnest edges for a given node.
+    ///> Removes all ratsnest edges and simple mode data for a node removed from m_links.
     void clearNode( const RN_NODE_PTR& aNode );
 
     ///> Adds appropriate edges for nodes that are connected by zones.
     void processZones();
 
     ///> Recomputes ratsnset from scratch.
-    void compute();
+    void compute( int aThreadCount = 1 );
+
+    ///> Recomputes ratsnest by splitting the net in aStripCount parts processed concurrently.
+    ///> Returns false if the result could be worse than with a single triangulation.
+    bool computeSplit( int aStripCount, int aThreadCount );
 
     ////> Stores information about connections for a given net.
     RN_LINKS m_links;
@@ -572,14 +675,14 @@ protected:
         ///> Subpolygons belonging to a zone
         std::deque<RN_POLY> m_Polygons;
 
-        ///> Connections to other nodes
-        std::deque<RN_EDGE_MST_PTR> m_Edges;
+        ///> Connections to other nodes (indices in m_links)
+        std::vector<int> m_Edges;
     } RN_ZONE_DATA;
 
     ///> Helper typedefs
     typedef boost::unordered_map<const D_PAD*, RN_NODE_PTR> PAD_NODE_MAP;
     typedef boost::unordered_map<const VIA*, RN_NODE_PTR> VIA_NODE_MAP;
-    typedef boost::unordered_map<const TRACK*, RN_EDGE_MST_PTR> TRACK_EDGE_MAP;
+    typedef boost::unordered_map<const TRACK*, int> TRACK_EDGE_MAP;
     typedef boost::unordered_map<const ZONE_CONTAINER*, RN_ZONE_DATA> ZONE_DATA_MAP;
 
     ///> Map that associates nodes in the ratsnest model to respective nodes.
@@ -588,7 +691,8 @@ protected:
     ///> Map that associates nodes in the ratsnest model to respective vias.
     VIA_NODE_MAP m_vias;
 
-    ///> Map that associates edges in the ratsnest model to respective tracks.
+    ///> Map that associates connections in the ratsnest model (indices in m_links) to respective
+    ///> tracks.
     TRACK_EDGE_MAP m_tracks;
 
     ///> Map that associates groups of subpolygons in the ratsnest model to respective zones.
@@ -611,7 +715,7 @@ public:
      * Default constructor
      * @param aBoard is the board to be processed in order to look for unconnected items.
      */
-    RN_DATA( const BOARD* aBoard ) : m_board( aBoard ) {}
+    RN_DATA( const BOARD* aBoard );
 
     /**
      * Function Add()
@@ -674,6 +778,23 @@ public:
      */
     void Recalculate( int aNet = -1 );
 
+    /**
+     * Function SetThreadCount()
+     * Sets the number of threads used to compute the ratsnest.
+     * @param aCount is the number of threads. If it is not positive, one thread
+     * per processor is used (the default).
+     */
+    void SetThreadCount( int aCount );
+
+    /**
+     * Function GetThreadCount()
+     * Returns the number of threads used to compute the ratsnest.
+     */
+    int GetThreadCount() const
+    {
+        return m_threadCount;
+    }
+
     /**
      * Function GetNetCount()
      * Returns the number of nets handled by the ratsnest.
@@ -732,14 +853,19 @@ protected:
      * Function updateNet()
      * Recomputes ratsnest for a single net.
      * @param aNetCode is the net number to be recomputed.
+     * @param aThreadCount is the number of threads that can be used for a large net.
      */
-    void updateNet( int aNetCode );
+    void updateNet( int aNetCode, int aThreadCount = 1 );
 
     ///> Board to be processed.
     const BOARD* m_board;
 
-    ///> Stores information about ratsnest grouped by net numbers.
-    std::vector<RN_NET> m_nets;
+    ///> Stores information about ratsnest grouped by net numbers. Nets are not copyable,
+    ///> as their nodes are referred to by their address.
+    boost::ptr_vector<RN_NET> m_nets;
+
+    ///> Number of threads used to recompute the nets.
+    int m_threadCount;
 };
 
 #endif /* RATSNEST_DATA_H */
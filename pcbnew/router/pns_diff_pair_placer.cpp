@@ -306,6 +306,7 @@ bool PNS_DIFF_PAIR_PLACER::route( const VECTOR2I& aP )
         case RM_Walkaround:
             return rhWalkOnly ( aP );
         case RM_Shove:
+        case RM_Smart:  // no smart mode for differential pairs yet
             return rhShoveOnly ( aP );
         default:
             break;
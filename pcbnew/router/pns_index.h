@@ -27,7 +27,7 @@
 #include <boost/foreach.hpp>
 #include <boost/range/adaptor/map.hpp>
 
-#include <list>
+#include <vector>
 #include <geometry/shape_index.h>
 
 #include "pns_item.h"
@@ -42,7 +42,7 @@
 class PNS_INDEX
 {
 public:
-    typedef std::list<PNS_ITEM*>            NET_ITEMS_LIST;
+    typedef std::vector<PNS_ITEM*>          NET_ITEMS_LIST;
     typedef SHAPE_INDEX<PNS_ITEM*>          ITEM_SHAPE_INDEX;
     typedef boost::unordered_set<PNS_ITEM*> ITEM_SET;
 
@@ -112,7 +112,7 @@ public:
     /**
      * Function GetItemsForNet()
      *
-     * Returns list of all items in a given net.
+     * Returns list of all items in a given net, in no particular order.
      */
     NET_ITEMS_LIST* GetItemsForNet( int aNet );
 
@@ -223,8 +223,27 @@ void PNS_INDEX::Remove( PNS_ITEM* aItem )
 
     int net = aItem->Net();
 
-    if( net >= 0 && m_netMap.find( net ) != m_netMap.end() )
-        m_netMap[net].remove( aItem );
+    if( net < 0 )
+        return;
+
+    std::map<int, NET_ITEMS_LIST>::iterator i = m_netMap.find( net );
+
+    if( i == m_netMap.end() )
+        return;
+
+    // the order of the items does not matter: fill the hole with the last item
+    NET_ITEMS_LIST& items = i->second;
+
+    for( unsigned j = 0; j < items.size(); )
+    {
+        if( items[j] == aItem )
+        {
+            items[j] = items.back();
+            items.pop_back();
+        }
+        else
+            j++;
+    }
 }
 
 void PNS_INDEX::Replace( PNS_ITEM* aOldItem, PNS_ITEM* aNewItem )
@@ -306,10 +325,12 @@ PNS_INDEX::~PNS_INDEX()
 
 PNS_INDEX::NET_ITEMS_LIST* PNS_INDEX::GetItemsForNet( int aNet )
 {
-    if( m_netMap.find( aNet ) == m_netMap.end() )
+    std::map<int, NET_ITEMS_LIST>::iterator i = m_netMap.find( aNet );
+
+    if( i == m_netMap.end() )
         return NULL;
 
-    return &m_netMap[aNet];
+    return &i->second;
 }
 
 #endif
@@ -0,0 +1,204 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <stdint.h>
+
+#include "pns_joint_map.h"
+
+PNS_JOINT_MAP::PNS_JOINT_MAP() :
+    m_count( 0 ),
+    m_removed( 0 )
+{
+}
+
+
+void PNS_JOINT_MAP::Clear()
+{
+    m_joints.clear();
+    m_free.clear();
+    m_slots.clear();
+    m_count = 0;
+    m_removed = 0;
+}
+
+
+int PNS_JOINT_MAP::firstSlot( const PNS_JOINT::HASH_TAG& aTag ) const
+{
+    uint32_t h = hash_value( aTag );
+
+    // coordinates are often multiples of large powers of two: mix the bits before masking
+    h ^= h >> 16;
+    h *= 0x45d9f3b;
+    h ^= h >> 16;
+
+    return h & ( m_slots.size() - 1 );
+}
+
+
+bool PNS_JOINT_MAP::Contains( const PNS_JOINT::HASH_TAG& aTag ) const
+{
+    if( m_count == 0 )
+        return false;
+
+    for( int s = firstSlot( aTag ); m_slots[s] != EMPTY; s = nextSlot( s ) )
+    {
+        if( m_slots[s] != REMOVED && m_joints[m_slots[s]].Tag() == aTag )
+            return true;
+    }
+
+    return false;
+}
+
+
+PNS_JOINT* PNS_JOINT_MAP::Find( const PNS_JOINT::HASH_TAG& aTag, const PNS_LAYERSET& aLayers )
+{
+    if( m_count == 0 )
+        return NULL;
+
+    for( int s = firstSlot( aTag ); m_slots[s] != EMPTY; s = nextSlot( s ) )
+    {
+        if( m_slots[s] == REMOVED )
+            continue;
+
+        PNS_JOINT& jt = m_joints[m_slots[s]];
+
+        if( jt.Tag() == aTag && jt.Layers().Overlaps( aLayers ) )
+            return &jt;
+    }
+
+    return NULL;
+}
+
+
+PNS_JOINT& PNS_JOINT_MAP::Insert( const PNS_JOINT& aJoint )
+{
+    reserveSlot();
+
+    int index;
+
+    if( m_free.empty() )
+    {
+        index = m_joints.size();
+        m_joints.push_back( aJoint );
+    }
+    else
+    {
+        index = m_free.back();
+        m_free.pop_back();
+        m_joints[index] = aJoint;
+    }
+
+    place( index );
+    m_count++;
+
+    return m_joints[index];
+}
+
+
+void PNS_JOINT_MAP::Insert( const PNS_JOINT_MAP& aOther, const PNS_JOINT::HASH_TAG& aTag )
+{
+    if( aOther.m_count == 0 )
+        return;
+
+    for( int s = aOther.firstSlot( aTag ); aOther.m_slots[s] != EMPTY; s = aOther.nextSlot( s ) )
+    {
+        int index = aOther.m_slots[s];
+
+        if( index != REMOVED && aOther.m_joints[index].Tag() == aTag )
+            Insert( aOther.m_joints[index] );
+    }
+}
+
+
+void PNS_JOINT_MAP::Erase( PNS_JOINT* aJoint )
+{
+    assert( m_count > 0 );
+
+    for( int s = firstSlot( aJoint->Tag() ); m_slots[s] != EMPTY; s = nextSlot( s ) )
+    {
+        int index = m_slots[s];
+
+        if( index != REMOVED && &m_joints[index] == aJoint )
+        {
+            // the tombstone keeps the probe sequences going through this slot unbroken
+            m_slots[s] = REMOVED;
+            m_removed++;
+            m_count--;
+
+            // release the links now, the joint may not be reused soon
+            m_joints[index] = PNS_JOINT();
+            m_free.push_back( index );
+            return;
+        }
+    }
+
+    assert( false );
+}
+
+
+void PNS_JOINT_MAP::place( int aIndex )
+{
+    int s = firstSlot( m_joints[aIndex].Tag() );
+
+    while( m_slots[s] >= 0 )
+        s = nextSlot( s );
+
+    if( m_slots[s] == REMOVED )
+        m_removed--;
+
+    m_slots[s] = aIndex;
+}
+
+
+void PNS_JOINT_MAP::reserveSlot()
+{
+    int size = m_slots.size();
+
+    // keep at least a quarter of the slots empty, so the probe sequences stay short
+    if( ( m_count + m_removed + 1 ) * 4 <= size * 3 )
+        return;
+
+    if( size == 0 )
+        size = MIN_SLOTS;
+    else if( ( m_count + 1 ) * 2 > size )
+        size *= 2;
+
+    // otherwise the table is mostly tombstones: rebuild it at the same size
+    rehash( size );
+}
+
+
+void PNS_JOINT_MAP::rehash( int aSlotCount )
+{
+    m_slots.assign( aSlotCount, EMPTY );
+    m_removed = 0;
+
+    std::vector<bool> unused( m_joints.size(), false );
+
+    for( unsigned i = 0; i < m_free.size(); i++ )
+        unused[m_free[i]] = true;
+
+    for( unsigned i = 0; i < m_joints.size(); i++ )
+    {
+        if( !unused[i] )
+            place( i );
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_JOINT_MAP_H
+#define __PNS_JOINT_MAP_H
+
+#include <vector>
+#include <deque>
+
+#include "pns_joint.h"
+#include "pns_layerset.h"
+
+/**
+ * Class PNS_JOINT_MAP
+ *
+ * Hash table of the joints of a PNS_NODE, keyed by their HASH_TAG. Several joints
+ * can share a tag, if their layers do not overlap.
+ *
+ * The joints are stored in a deque, so their addresses are stable, and the slots of
+ * removed joints are recycled. The table itself is a flat array of joint indices, probed
+ * linearly. Adding and removing joints does not allocate memory once the node has
+ * reached its working size, and copying the map (when a node is branched) is a copy
+ * of two arrays instead of a rebuild of the buckets.
+ **/
+class PNS_JOINT_MAP
+{
+public:
+    PNS_JOINT_MAP();
+
+    ///> Returns the number of joints
+    int Size() const
+    {
+        return m_count;
+    }
+
+    ///> Removes all the joints
+    void Clear();
+
+    ///> Returns true if there is at least one joint with tag aTag
+    bool Contains( const PNS_JOINT::HASH_TAG& aTag ) const;
+
+    ///> Returns a joint with tag aTag on layers overlapping aLayers, or NULL
+    PNS_JOINT* Find( const PNS_JOINT::HASH_TAG& aTag, const PNS_LAYERSET& aLayers );
+
+    ///> Adds a copy of aJoint and returns it
+    PNS_JOINT& Insert( const PNS_JOINT& aJoint );
+
+    ///> Adds copies of all the joints of aOther with tag aTag
+    void Insert( const PNS_JOINT_MAP& aOther, const PNS_JOINT::HASH_TAG& aTag );
+
+    ///> Removes aJoint, which must be stored in this map
+    void Erase( PNS_JOINT* aJoint );
+
+private:
+    ///> special values of the slots
+    enum SLOT_STATE
+    {
+        EMPTY = -1,
+        REMOVED = -2
+    };
+
+    static const int MIN_SLOTS = 16;
+
+    ///> Returns the first slot to probe for aTag
+    int firstSlot( const PNS_JOINT::HASH_TAG& aTag ) const;
+
+    int nextSlot( int aSlot ) const
+    {
+        return ( aSlot + 1 ) & ( m_slots.size() - 1 );
+    }
+
+    ///> Puts joint aIndex in the first free slot of its probe sequence
+    void place( int aIndex );
+
+    ///> Makes room for one more joint, growing or cleaning the table if needed
+    void reserveSlot();
+
+    void rehash( int aSlotCount );
+
+    ///> joint storage, including recycled joints
+    std::deque<PNS_JOINT> m_joints;
+
+    ///> indices of the recycled joints in m_joints
+    std::vector<int> m_free;
+
+    ///> open addressing table: indices in m_joints, EMPTY or REMOVED. Its size is
+    ///> a power of two.
+    std::vector<int> m_slots;
+
+    ///> number of joints
+    int m_count;
+
+    ///> number of REMOVED slots
+    int m_removed;
+};
+
+#endif    // __PNS_JOINT_MAP_H
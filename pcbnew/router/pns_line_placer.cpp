@@ -22,6 +22,7 @@
 #include <boost/optional.hpp>
 
 #include <colors.h>
+#include <task_queue.h>
 
 #include "trace.h"
 
@@ -357,7 +358,7 @@ bool PNS_LINE_PLACER::mergeHead()
 }
 
 
-bool PNS_LINE_PLACER::handleViaPlacement( PNS_LINE& aHead )
+bool PNS_LINE_PLACER::handleViaPlacement( PNS_LINE& aHead, PNS_NODE* aNode, bool aSolidsOnly )
 {
     if( !m_placingVia )
         return true;
@@ -369,9 +370,7 @@ bool PNS_LINE_PLACER::handleViaPlacement( PNS_LINE& aHead )
     VECTOR2I force;
     VECTOR2I lead = aHead.CPoint( -1 ) - aHead.CPoint( 0 );
 
-    bool solidsOnly = ( m_currentMode != RM_Walkaround );
-
-    if( v.PushoutForce( m_currentNode, lead, force, solidsOnly, 40 ) )
+    if( v.PushoutForce( aNode, lead, force, aSolidsOnly, 40 ) )
     {
         SHAPE_LINE_CHAIN line = m_direction.BuildInitialTrace(
                 aHead.CPoint( 0 ),
@@ -388,18 +387,50 @@ bool PNS_LINE_PLACER::handleViaPlacement( PNS_LINE& aHead )
 
 bool PNS_LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, PNS_LINE& aNewHead )
 {
-    SHAPE_LINE_CHAIN line = buildInitialLine( aP );
-    PNS_LINE initTrack( m_head, line ), walkFull;
-    int effort = 0;
-    bool viaOk = handleViaPlacement( initTrack );
-    bool rv = true;
+    PNS_LINE walkFull;
 
-    PNS_WALKAROUND walkaround( m_currentNode, Router() );
+    walkHead( aP, m_currentNode, walkFull );
+
+    m_head = walkFull;
+    aNewHead = walkFull;
+
+    return true;
+}
+
+
+PNS_WALKAROUND::WALKAROUND_STATUS PNS_LINE_PLACER::walkHead( const VECTOR2I& aP,
+                                                             PNS_NODE* aNode,
+                                                             PNS_LINE& aWalkFull )
+{
+    PNS_LINE initTrack;
+    PNS_WALKAROUND walkaround( aNode, Router() );
+    bool viaOk = startWalk( aP, aNode, walkaround, initTrack );
+
+    PNS_WALKAROUND::WALKAROUND_STATUS wf = walkaround.Route( initTrack, aWalkFull, false );
+
+    return finishWalk( aNode, viaOk, wf, aWalkFull );
+}
+
+
+bool PNS_LINE_PLACER::startWalk( const VECTOR2I& aP, PNS_NODE* aNode,
+                                 PNS_WALKAROUND& aWalkaround, PNS_LINE& aInitTrack )
+{
+    aInitTrack = PNS_LINE( m_head, buildInitialLine( aP ) );
+
+    bool viaOk = handleViaPlacement( aInitTrack, aNode, false );
 
-    walkaround.SetSolidsOnly( false );
-    walkaround.SetIterationLimit( Settings().WalkaroundIterationLimit() );
+    aWalkaround.SetSolidsOnly( false );
+    aWalkaround.SetIterationLimit( Settings().WalkaroundIterationLimit() );
 
-    PNS_WALKAROUND::WALKAROUND_STATUS wf = walkaround.Route( initTrack, walkFull, false );
+    return viaOk;
+}
+
+
+PNS_WALKAROUND::WALKAROUND_STATUS PNS_LINE_PLACER::finishWalk( PNS_NODE* aNode, bool aViaOk,
+        PNS_WALKAROUND::WALKAROUND_STATUS aStatus, PNS_LINE& aWalkFull )
+{
+    PNS_WALKAROUND::WALKAROUND_STATUS wf = aStatus;
+    int effort = 0;
 
     switch( Settings().OptimizerEffort() )
     {
@@ -418,25 +449,21 @@ bool PNS_LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, PNS_LINE& aNewHead )
 
     if( wf == PNS_WALKAROUND::STUCK )
     {
-        walkFull = walkFull.ClipToNearestObstacle( m_currentNode );
-        rv = true;
+        aWalkFull = aWalkFull.ClipToNearestObstacle( aNode );
     }
-    else if( m_placingVia && viaOk )
+    else if( m_placingVia && aViaOk )
     {
-        walkFull.AppendVia( makeVia ( walkFull.CPoint( -1 ) ) );
+        aWalkFull.AppendVia( makeVia ( aWalkFull.CPoint( -1 ) ) );
     }
 
-    PNS_OPTIMIZER::Optimize( &walkFull, effort, m_currentNode );
+    PNS_OPTIMIZER::Optimize( &aWalkFull, effort, aNode );
 
-    if( m_currentNode->CheckColliding( &walkFull ) )
+    if( aNode->CheckColliding( &aWalkFull ) )
     {
         TRACEn(0, "strange, walk line colliding\n");
     }
 
-    m_head = walkFull;
-    aNewHead = walkFull;
-
-    return rv;
+    return wf;
 }
 
 
@@ -461,7 +488,7 @@ bool PNS_LINE_PLACER::rhShoveOnly ( const VECTOR2I& aP, PNS_LINE& aNewHead )
     PNS_LINE initTrack( m_head, line );
     PNS_LINE walkSolids, l2;
 
-    handleViaPlacement( initTrack );
+    handleViaPlacement( initTrack, m_currentNode, true );
 
     m_currentNode = m_shove->CurrentNode();
     PNS_OPTIMIZER optimizer( m_currentNode );
@@ -535,6 +562,120 @@ bool PNS_LINE_PLACER::rhShoveOnly ( const VECTOR2I& aP, PNS_LINE& aNewHead )
 }
 
 
+///> The smart mode prefers walking around obstacles, which leaves the other tracks
+///> untouched, unless the walkaround head is this many times longer than the shoved one.
+static const double SMART_MAX_DETOUR = 1.5;
+
+
+/// Computes the candidate heads for PNS_LINE_PLACER::rhSmart(): the shoved head,
+/// and the walkaround head in both winding directions.
+struct PNS_LINE_PLACER::SMART_TASK
+{
+    enum CANDIDATE
+    {
+        SHOVE = 0,
+        WALK_CW,
+        WALK_CCW,
+        CANDIDATE_COUNT
+    };
+
+    SMART_TASK( PNS_LINE_PLACER* aPlacer, const VECTOR2I& aP ) :
+        m_placer( aPlacer ),
+        m_p( aP ),
+        m_shoveOk( false ),
+        m_walkaround( aPlacer->m_world, aPlacer->Router() )
+    {
+        // The walkaround only reads the placer world, the common ancestor of the
+        // shove branches.  It is prepared before the shove changes the current node.
+        m_viaOk = m_placer->startWalk( m_p, m_placer->m_world, m_walkaround, m_initTrack );
+        m_walkaround.Start( m_initTrack );
+    }
+
+    void operator()( int aCandidate )
+    {
+        // The shove changes the placer current node and its own branches
+        if( aCandidate == SHOVE )
+            m_shoveOk = m_placer->rhShoveOnly( m_p, m_shoveHead );
+        else
+            m_walkaround.RouteWinding( aCandidate == WALK_CW );
+    }
+
+    ///> Returns the walkaround head, once both directions are walked
+    PNS_WALKAROUND::WALKAROUND_STATUS FinishWalk()
+    {
+        PNS_WALKAROUND::WALKAROUND_STATUS status = m_walkaround.Finish( m_walkHead, false );
+
+        return m_placer->finishWalk( m_placer->m_world, m_viaOk, status, m_walkHead );
+    }
+
+    PNS_LINE_PLACER*    m_placer;
+    VECTOR2I            m_p;
+
+    PNS_LINE            m_shoveHead;
+    bool                m_shoveOk;
+
+    PNS_WALKAROUND      m_walkaround;
+    PNS_LINE            m_initTrack;
+    bool                m_viaOk;
+    PNS_LINE            m_walkHead;
+};
+
+
+bool PNS_LINE_PLACER::rhSmart( const VECTOR2I& aP, PNS_LINE& aNewHead )
+{
+    SMART_TASK task( this, aP );
+    TASK_QUEUE<SMART_TASK> queue( task, SMART_TASK::CANDIDATE_COUNT );
+
+    // The shove is the longest task, it is started first.  The router threads are
+    // kept from one step to the next.
+    queue.Run( Router()->ThreadPool() );
+
+    PNS_WALKAROUND::WALKAROUND_STATUS walkStatus = task.FinishWalk();
+
+    bool useWalk;
+
+    if( walkStatus == PNS_WALKAROUND::DONE )
+    {
+        useWalk = !task.m_shoveOk ||
+                  task.m_walkHead.CLine().Length() <=
+                  SMART_MAX_DETOUR * task.m_shoveHead.CLine().Length();
+    }
+    else if( task.m_shoveOk )
+    {
+        useWalk = false;
+    }
+    else
+    {
+        // Both are stuck: keep the head which goes the closest to the cursor
+        VECTOR2I::extended_type walkDist = 0, shoveDist = 0;
+
+        if( task.m_walkHead.PointCount() )
+            walkDist = ( task.m_walkHead.CPoint( -1 ) - aP ).SquaredEuclideanNorm();
+
+        if( task.m_shoveHead.PointCount() )
+            shoveDist = ( task.m_shoveHead.CPoint( -1 ) - aP ).SquaredEuclideanNorm();
+
+        useWalk = task.m_walkHead.PointCount() &&
+                  ( !task.m_shoveHead.PointCount() || walkDist <= shoveDist );
+    }
+
+    if( useWalk )
+    {
+        // The shoved branches are left to the shove algorithm springback
+        m_currentNode = m_world;
+        m_head = task.m_walkHead;
+        aNewHead = task.m_walkHead;
+
+        return true;
+    }
+
+    // rhShoveOnly() has already set the current node to the shoved branch
+    aNewHead = task.m_shoveHead;
+
+    return task.m_shoveOk;
+}
+
+
 bool PNS_LINE_PLACER::routeHead( const VECTOR2I& aP, PNS_LINE& aNewHead )
 {
     switch( m_currentMode )
@@ -545,6 +686,8 @@ bool PNS_LINE_PLACER::routeHead( const VECTOR2I& aP, PNS_LINE& aNewHead )
             return rhWalkOnly( aP, aNewHead );
         case RM_Shove:
             return rhShoveOnly( aP, aNewHead );
+        case RM_Smart:
+            return rhSmart( aP, aNewHead );
         default:
             break;
     }
@@ -30,6 +30,7 @@
 #include "pns_node.h"
 #include "pns_via.h"
 #include "pns_line.h"
+#include "pns_walkaround.h"
 #include "pns_placement_algo.h"
 
 class PNS_ROUTER;
@@ -256,9 +257,10 @@ private:
     /**
      * Function handleViaPlacement()
      *
-     * Attempts to find a spot to place the via at the end of line aHead.
+     * Attempts to find a spot to place the via at the end of line aHead, in aNode.
+     * @param aSolidsOnly: true to push the via out of solids only.
      */
-    bool handleViaPlacement( PNS_LINE& aHead );
+    bool handleViaPlacement( PNS_LINE& aHead, PNS_NODE* aNode, bool aSolidsOnly );
 
     /**
      * Function checkObtusity()
@@ -342,6 +344,30 @@ private:
     ///> route step, shove mode
     bool rhShoveOnly( const VECTOR2I& aP, PNS_LINE& aNewHead);
 
+    struct SMART_TASK;
+
+    ///> route step, smart mode: the shove head and the walkaround head in both
+    ///> directions are computed concurrently, and the best head is kept
+    bool rhSmart( const VECTOR2I& aP, PNS_LINE& aNewHead );
+
+    /**
+     * Function walkHead()
+     *
+     * Computes the head walking around the obstacles of aNode.  It changes no member.
+     * @return the walkaround status.
+     */
+    PNS_WALKAROUND::WALKAROUND_STATUS walkHead( const VECTOR2I& aP, PNS_NODE* aNode, PNS_LINE& aWalkFull );
+
+    ///> First part of walkHead(): builds the initial head and sets up aWalkaround.
+    ///> Returns true if the via can be placed.
+    bool startWalk( const VECTOR2I& aP, PNS_NODE* aNode, PNS_WALKAROUND& aWalkaround,
+                    PNS_LINE& aInitTrack );
+
+    ///> Last part of walkHead(): clips or optimizes the walkaround head aWalkFull.
+    PNS_WALKAROUND::WALKAROUND_STATUS finishWalk( PNS_NODE* aNode, bool aViaOk,
+                                                  PNS_WALKAROUND::WALKAROUND_STATUS aStatus,
+                                                  PNS_LINE& aWalkFull );
+
     ///> route step, mark obstacles mode
     bool rhMarkObstacles( const VECTOR2I& aP, PNS_LINE& aNewHead );
 
@@ -18,6 +18,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include "pns_logger.h"
 #include "pns_item.h"
 #include "pns_via.h"
@@ -45,6 +47,7 @@ void PNS_LOGGER::Clear()
 {
     m_theLog.str( std::string() );
     m_groupOpened = false;
+    m_durations.clear();
 }
 
 
@@ -135,6 +138,57 @@ void PNS_LOGGER::Log( const VECTOR2I& aStart, const VECTOR2I& aEnd,
 }
 
 
+void PNS_LOGGER::LogEvent( const std::string& aName, const VECTOR2I& aP, const PNS_ITEM* aItem,
+                           int aArg, uint64_t aDuration )
+{
+    m_theLog << "event " << aName << " " << aP.x << " " << aP.y << " " << aArg << " ";
+
+    if( aItem )
+        m_theLog << aItem->Kind() << " " << aItem->Net() << " " << aItem->Layers().Start() <<
+                    " " << aItem->Layers().End();
+    else
+        m_theLog << "0 -1 -1 -1";
+
+    m_theLog << " " << aDuration << std::endl;
+
+    m_durations[aName].push_back( aDuration );
+}
+
+
+const std::string PNS_LOGGER::LatencyReport( const std::string& aName ) const
+{
+    std::stringstream report;
+    std::map<std::string, std::vector<uint64_t> >::const_iterator i = m_durations.find( aName );
+
+    report << aName << ": ";
+
+    if( i == m_durations.end() || i->second.empty() )
+    {
+        report << "no events";
+        return report.str();
+    }
+
+    std::vector<uint64_t> sorted( i->second );
+    std::sort( sorted.begin(), sorted.end() );
+
+    const int percentiles[] = { 50, 90, 99 };
+    int n = sorted.size();
+
+    report << n << " events, times (ms):";
+
+    for( unsigned j = 0; j < sizeof( percentiles ) / sizeof( int ); j++ )
+    {
+        // nearest rank
+        int rank = std::max( 1, ( percentiles[j] * n + 99 ) / 100 );
+        report << " p" << percentiles[j] << " " << sorted[rank - 1] / 1000.0;
+    }
+
+    report << " max " << sorted.back() / 1000.0;
+
+    return report.str();
+}
+
+
 void PNS_LOGGER::dumpShape( const SHAPE* aSh )
 {
     switch( aSh->Type() )
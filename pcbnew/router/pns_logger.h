@@ -25,6 +25,8 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <map>
+#include <stdint.h>
 
 #include <math/vector2d.h>
 
@@ -49,11 +51,38 @@ public:
     void Log( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aKind = 0,
               const std::string aName = std::string() );
 
+    /**
+     * Function LogEvent()
+     *
+     * Records a router event (start, move, fix...), so a routing session can be replayed
+     * and timed. Events are written as lines of the form:
+     * event name x y arg item_kind item_net item_layer_start item_layer_end duration
+     *
+     * @param aName name of the event
+     * @param aP cursor position
+     * @param aItem item the event applies to (start or end item), or NULL
+     * @param aArg event parameter (e.g. the layer)
+     * @param aDuration time taken to process the event, in microseconds
+     */
+    void LogEvent( const std::string& aName, const VECTOR2I& aP, const PNS_ITEM* aItem = NULL,
+                   int aArg = 0, uint64_t aDuration = 0 );
+
+    /**
+     * Function LatencyReport()
+     *
+     * Returns the number of events named aName logged since the last Clear() and the
+     * percentiles of their durations, as a single line of text.
+     */
+    const std::string LatencyReport( const std::string& aName ) const;
+
 private:
     void dumpShape( const SHAPE* aSh );
 
     bool m_groupOpened;
     std::stringstream m_theLog;
+
+    ///> durations of the logged events, by event name
+    std::map<std::string, std::vector<uint64_t> > m_durations;
 };
 
 #endif
@@ -28,6 +28,8 @@
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_index.h>
 
+#include <ki_mutex.h>
+
 #include "trace.h"
 #include "pns_item.h"
 #include "pns_line.h"
@@ -43,6 +45,9 @@ using boost::unordered_map;
 
 #ifdef DEBUG
 static boost::unordered_set<PNS_NODE*> allocNodes;
+
+// The smart routing mode creates and queries nodes from several threads
+static MUTEX allocNodesLock;
 #endif
 
 PNS_NODE::PNS_NODE()
@@ -55,8 +60,10 @@ PNS_NODE::PNS_NODE()
     m_clearanceFunctor = NULL;
     m_index = new PNS_INDEX;
     m_collisionFilter = NULL;
+    m_stats = NULL;
 
 #ifdef DEBUG
+    MUTLOCK lock( allocNodesLock );
     allocNodes.insert( this );
 #endif
 }
@@ -73,13 +80,17 @@ PNS_NODE::~PNS_NODE()
     }
 
 #ifdef DEBUG
-    if( allocNodes.find( this ) == allocNodes.end() )
     {
-        TRACEn( 0, "attempting to free an already-free'd node.\n" );
-        assert( false );
-    }
+        MUTLOCK lock( allocNodesLock );
+
+        if( allocNodes.find( this ) == allocNodes.end() )
+        {
+            TRACEn( 0, "attempting to free an already-free'd node.\n" );
+            assert( false );
+        }
 
-    allocNodes.erase( this );
+        allocNodes.erase( this );
+    }
 #endif
 
     for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
@@ -113,13 +124,16 @@ PNS_NODE* PNS_NODE::Branch()
     child->m_root = isRoot() ? this : m_root;
     child->m_collisionFilter = m_collisionFilter;
 
+    PNS_NODE_STATS* stats = child->m_root->m_stats;
+
+    if( stats )
+        stats->AddNode( child->m_depth );
+
     // immmediate offspring of the root branch needs not copy anything.
     // For the rest, deep-copy joints, overridden item map and pointers
     // to stored items.
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
         for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
             child->m_index->Add( *i );
 
@@ -128,7 +142,7 @@ PNS_NODE* PNS_NODE::Branch()
     }
 
     TRACE( 2, "%d items, %d joints, %d overrides",
-            child->m_index->Size() % child->m_joints.size() % child->m_override.size() );
+            child->m_index->Size() % child->m_joints.Size() % child->m_override.size() );
 
     return child;
 }
@@ -247,9 +261,17 @@ int PNS_NODE::QueryColliding( const PNS_ITEM* aItem,
     OBSTACLE_VISITOR visitor( aObstacles, aItem, aKindMask );
 
 #ifdef DEBUG
-    assert( allocNodes.find( this ) != allocNodes.end() );
+    {
+        MUTLOCK lock( allocNodesLock );
+        assert( allocNodes.find( this ) != allocNodes.end() );
+    }
 #endif
 
+    PNS_NODE_STATS* stats = isRoot() ? m_stats : m_root->m_stats;
+
+    if( stats )
+        stats->AddQuery();
+
     visitor.SetCountLimit( aLimitCount );
     visitor.SetWorld( this, NULL );
 
@@ -664,27 +686,9 @@ void PNS_NODE::removeVia( PNS_VIA* aVia )
     tag.net = net;
     tag.pos = p;
 
-    bool split;
-    do
-    {
-        split = false;
-        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = m_joints.equal_range( tag );
-
-        if( range.first == m_joints.end() )
-            break;
-
-        // find and remove all joints containing the via to be removed
-
-        for( JOINT_MAP::iterator f = range.first; f != range.second; ++f )
-        {
-            if( aVia->LayersOverlap ( &f->second ) )
-            {
-                m_joints.erase( f );
-                split = true;
-                break;
-            }
-        }
-    } while( split );
+    // find and remove all joints containing the via to be removed
+    while( PNS_JOINT* f = m_joints.Find( tag, vLayers ) )
+        m_joints.Erase( f );
 
     // and re-link them, using the former via's link list
     BOOST_FOREACH(PNS_ITEM* item, links)
@@ -913,26 +917,11 @@ PNS_JOINT* PNS_NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    // joints of the root not touched by this node are not copied here
+    if( !isRoot() && !m_joints.Contains( tag ) )
+        return m_root->m_joints.Find( tag, PNS_LAYERSET( aLayer ) );
 
-    if( f == end && !isRoot() )
-    {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
-    }
-
-    if( f == end )
-        return NULL;
-
-    while( f != end )
-    {
-        if( f->second.Layers().Overlaps( aLayer ) )
-            return &f->second;
-
-        ++f;
-    }
-
-    return NULL;
+    return m_joints.Find( tag, PNS_LAYERSET( aLayer ) );
 }
 
 
@@ -943,47 +932,20 @@ PNS_JOINT& PNS_NODE::touchJoint( const VECTOR2I& aPos, const PNS_LAYERSET& aLaye
     tag.pos = aPos;
     tag.net = aNet;
 
-    // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
-
-    std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
-
-    // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
-    {
-        range = m_root->m_joints.equal_range( tag );
-
-        for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
-    }
+    // not found in this node and we are not root? find in the root and copy results here.
+    if( !isRoot() && !m_joints.Contains( tag ) )
+        m_joints.Insert( m_root->m_joints, tag );
 
     // now insert and combine overlapping joints
     PNS_JOINT jt( aPos, aLayers, aNet );
 
-    bool merged;
-
-    do
+    while( PNS_JOINT* f = m_joints.Find( tag, aLayers ) )
     {
-        merged  = false;
-        range   = m_joints.equal_range( tag );
-
-        if( range.first == m_joints.end() )
-            break;
-
-        for( f = range.first; f != range.second; ++f )
-        {
-            if( aLayers.Overlaps( f->second.Layers() ) )
-            {
-                jt.Merge( f->second );
-                m_joints.erase( f );
-                merged = true;
-                break;
-            }
-        }
+        jt.Merge( *f );
+        m_joints.Erase( f );
     }
-    while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return m_joints.Insert( jt );
 }
 
 
@@ -22,6 +22,8 @@
 #define __PNS_NODE_H
 
 #include <vector>
+#include <algorithm>
+#include <cassert>
 #include <list>
 
 #include <boost/unordered_set.hpp>
@@ -32,8 +34,11 @@
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_index.h>
 
+#include <ki_mutex.h>
+
 #include "pns_item.h"
 #include "pns_joint.h"
+#include "pns_joint_map.h"
 #include "pns_itemset.h"
 
 class PNS_SEGMENT;
@@ -116,6 +121,64 @@ struct PNS_COLLISION_FILTER {
     virtual bool operator()( const PNS_ITEM *aItemA, const PNS_ITEM *aItemB ) const = 0;
 };
 
+/**
+ * Class PNS_NODE_STATS
+ *
+ * Counts the collision searches and the depth of the nodes of a node hierarchy, when it
+ * is attached to its root node (used to benchmark the router). The branches of a root node
+ * can be processed by several threads at the same time, so the counters are protected by
+ * a mutex.
+ **/
+class PNS_NODE_STATS
+{
+public:
+    PNS_NODE_STATS()
+    {
+        Reset();
+    }
+
+    void Reset()
+    {
+        MUTLOCK lock( m_lock );
+
+        m_queries = 0;
+        m_peakDepth = 0;
+    }
+
+    ///> Counts a collision search
+    void AddQuery()
+    {
+        MUTLOCK lock( m_lock );
+
+        m_queries++;
+    }
+
+    ///> Counts a node branched at depth aDepth
+    void AddNode( int aDepth )
+    {
+        MUTLOCK lock( m_lock );
+
+        m_peakDepth = std::max( m_peakDepth, aDepth );
+    }
+
+    ///> Returns the number of collision searches since the last Reset()
+    int Queries() const
+    {
+        return m_queries;
+    }
+
+    ///> Returns the depth of the deepest node branched since the last Reset()
+    int PeakDepth() const
+    {
+        return m_peakDepth;
+    }
+
+private:
+    MUTEX m_lock;
+    int m_queries;
+    int m_peakDepth;
+};
+
 /**
  * Class PNS_NODE
  *
@@ -162,7 +225,7 @@ public:
     ///> Returns the number of joints
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints.Size();
     }
 
     ///> Returns the number of nodes in the inheritance chain (wrs to the root node)
@@ -171,6 +234,14 @@ public:
         return m_depth;
     }
 
+    ///> Attaches a statistics counter to a root node, or detaches it if aStats is NULL.
+    ///> It counts the collision searches in the node and all its branches.
+    void SetStats( PNS_NODE_STATS* aStats )
+    {
+        assert( isRoot() );
+        m_stats = aStats;
+    }
+
     /**
      * Function QueryColliding()
      *
@@ -375,8 +446,6 @@ public:
 
 private:
     struct OBSTACLE_VISITOR;
-    typedef boost::unordered_multimap<PNS_JOINT::HASH_TAG, PNS_JOINT> JOINT_MAP;
-    typedef JOINT_MAP::value_type TagJointPair;
 
     /// nodes are not copyable
     PNS_NODE( const PNS_NODE& aB );
@@ -433,8 +502,8 @@ private:
                      bool&           aGuardHit );
 
     ///> hash table with the joints, linking the items. Joints are hashed by
-    ///> their position, layer set and net.
-    JOINT_MAP m_joints;
+    ///> their position and net.
+    PNS_JOINT_MAP m_joints;
 
     ///> node this node was branched from
     PNS_NODE* m_parent;
@@ -462,6 +531,9 @@ private:
 
     ///> optional collision filtering object
     PNS_COLLISION_FILTER *m_collisionFilter;
+
+    ///> optional statistics counter (root node only)
+    PNS_NODE_STATS* m_stats;
 };
 
 #endif
@@ -23,6 +23,9 @@
 
 #include <boost/foreach.hpp>
 
+#include <profile.h>
+#include <task_queue.h>
+
 #include <view/view.h>
 #include <view/view_item.h>
 #include <view/view_group.h>
@@ -52,6 +55,7 @@
 
 #include <router/router_preview_item.h>
 
+#include <macros.h>
 #include <class_board.h>
 #include <class_board_connected_item.h>
 #include <class_module.h>
@@ -336,6 +340,9 @@ void PNS_ROUTER::SyncWorld()
     m_clearanceFunc = new PNS_PCBNEW_CLEARANCE_FUNC( this );
     m_world->SetClearanceFunctor( m_clearanceFunc );
     m_world->SetMaxClearance( 4 * worstClearance );
+
+    // recorded events apply to this state of the board
+    m_eventLog.Clear();
 }
 
 
@@ -356,6 +363,7 @@ PNS_ROUTER::PNS_ROUTER()
     // Initialize all other variables:
     m_lastNode = NULL;
     m_shove = NULL;
+    m_threadPool = NULL;
     m_iterLimit = 0;
     m_showInterSteps = false;
     m_snapshotIter = 0;
@@ -364,6 +372,12 @@ PNS_ROUTER::PNS_ROUTER()
     m_snappingEnabled  = false;
     m_violation = false;
 
+#ifdef DEBUG
+    // the events can be saved with DumpLog()
+    m_logEvents = true;
+#else
+    m_logEvents = false;
+#endif
 }
 
 
@@ -396,6 +410,17 @@ PNS_ROUTER::~PNS_ROUTER()
 
     if( m_previewItems )
         delete m_previewItems;
+
+    delete m_threadPool;
+}
+
+
+THREAD_POOL& PNS_ROUTER::ThreadPool()
+{
+    if( !m_threadPool )
+        m_threadPool = new THREAD_POOL;
+
+    return *m_threadPool;
 }
 
 
@@ -498,6 +523,8 @@ bool PNS_ROUTER::StartDragging( const VECTOR2I& aP, PNS_ITEM* aStartItem )
     if( !aStartItem || aStartItem->OfKind( PNS_ITEM::SOLID ) )
         return false;
 
+    logEvent( "drag", aP, aStartItem );
+
     m_dragger = new PNS_DRAGGER( this );
     m_dragger->SetWorld( m_world );
 
@@ -515,6 +542,11 @@ bool PNS_ROUTER::StartDragging( const VECTOR2I& aP, PNS_ITEM* aStartItem )
 
 bool PNS_ROUTER::StartRouting( const VECTOR2I& aP, PNS_ITEM* aStartItem, int aLayer )
 {
+    logEvent( "mode", VECTOR2I( m_mode, m_settings.Mode() ) );
+    logEvent( "sizes", VECTOR2I( m_sizes.TrackWidth(), m_sizes.ViaDiameter() ),
+              NULL, m_sizes.ViaDrill() );
+    logEvent( "route", aP, aStartItem, aLayer );
+
     switch( m_mode )
     {
         case PNS_MODE_ROUTE_SINGLE:
@@ -577,6 +609,9 @@ void PNS_ROUTER::eraseView()
 
 void PNS_ROUTER::DisplayItem( const PNS_ITEM* aItem, int aColor, int aClearance )
 {
+    if( !m_previewItems )   // no view (e.g. replaying a log)
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( aItem, m_previewItems );
 
     if( aColor >= 0 )
@@ -601,6 +636,9 @@ void PNS_ROUTER::DisplayItems( const PNS_ITEMSET& aItems )
 
 void PNS_ROUTER::DisplayDebugLine( const SHAPE_LINE_CHAIN& aLine, int aType, int aWidth )
 {
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_previewItems );
 
     pitem->Line( aLine, aWidth, aType );
@@ -612,6 +650,9 @@ void PNS_ROUTER::DisplayDebugLine( const SHAPE_LINE_CHAIN& aLine, int aType, int
 
 void PNS_ROUTER::DisplayDebugPoint( const VECTOR2I aPos, int aType )
 {
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_previewItems );
 
     pitem->Point( aPos, aType );
@@ -626,6 +667,9 @@ void PNS_ROUTER::Move( const VECTOR2I& aP, PNS_ITEM* endItem )
     m_currentEnd = aP;
     m_currentEndItem = endItem;
 
+    prof_counter cnt;
+    prof_start( &cnt );
+
     switch( m_state )
     {
         case ROUTE_TRACK:
@@ -637,8 +681,12 @@ void PNS_ROUTER::Move( const VECTOR2I& aP, PNS_ITEM* endItem )
             break;
 
         default:
-            break;
+            return;
     }
+
+    prof_end( &cnt );
+
+    logEvent( "move", aP, endItem, 0, cnt.usecs() );
 }
 
 
@@ -726,6 +774,8 @@ void PNS_ROUTER::UpdateSizes ( const PNS_SIZES_SETTINGS& aSizes )
     // Change track/via size settings
     if( m_state == ROUTE_TRACK)
     {
+        logEvent( "sizes", VECTOR2I( m_sizes.TrackWidth(), m_sizes.ViaDiameter() ),
+                  NULL, m_sizes.ViaDrill() );
         m_placer->UpdateSizes( m_sizes );
         movePlacing( m_currentEnd, m_currentEndItem );
     }
@@ -769,7 +819,9 @@ void PNS_ROUTER::CommitRouting( PNS_NODE* aNode )
 
         if( parent )
         {
-            m_view->Remove( parent );
+            if( m_view )
+                m_view->Remove( parent );
+
             m_board->Remove( parent );
             m_undoBuffer.PushItem( ITEM_PICKER( parent, UR_DELETED ) );
         }
@@ -819,7 +871,10 @@ void PNS_ROUTER::CommitRouting( PNS_NODE* aNode )
         {
             item->SetParent( newBI );
             newBI->ClearFlags();
-            m_view->Add( newBI );
+
+            if( m_view )
+                m_view->Add( newBI );
+
             m_board->Add( newBI );
             m_undoBuffer.PushItem( ITEM_PICKER( newBI, UR_NEW ) );
             newBI->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
@@ -834,6 +889,9 @@ bool PNS_ROUTER::FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem )
 {
     bool rv = false;
 
+    prof_counter cnt;
+    prof_start( &cnt );
+
     switch( m_state )
     {
         case ROUTE_TRACK:
@@ -848,6 +906,10 @@ bool PNS_ROUTER::FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem )
             break;
     }
 
+    prof_end( &cnt );
+
+    logEvent( "fix", aP, aEndItem, rv ? 1 : 0, cnt.usecs() );
+
     if( rv )
        StopRouting();
 
@@ -874,6 +936,8 @@ void PNS_ROUTER::StopRouting()
     if( !RoutingInProgress() )
         return;
 
+    logEvent( "stop", m_currentEnd );
+
     if( m_placer )
         delete m_placer;
 
@@ -895,6 +959,7 @@ void PNS_ROUTER::FlipPosture()
 {
     if( m_state == ROUTE_TRACK )
     {
+        logEvent( "posture", m_currentEnd );
         m_placer->FlipPosture();
         movePlacing ( m_currentEnd, m_currentEndItem );
     }
@@ -906,6 +971,7 @@ void PNS_ROUTER::SwitchLayer( int aLayer )
     switch( m_state )
     {
         case ROUTE_TRACK:
+            logEvent( "layer", m_currentEnd, NULL, aLayer );
             m_placer->SetLayer( aLayer );
             break;
         default:
@@ -919,6 +985,8 @@ void PNS_ROUTER::ToggleViaPlacement()
     if( m_state == ROUTE_TRACK )
     {
         bool toggle = !m_placer->IsPlacingVia();
+
+        logEvent( "via", m_currentEnd, NULL, toggle ? 1 : 0 );
         m_placer->ToggleVia( toggle );
     }
 }
@@ -956,6 +1024,31 @@ void PNS_ROUTER::DumpLog()
 
     if( logger )
         logger->Save( "/tmp/shove.log" );
+
+    if( m_logEvents )
+    {
+        m_eventLog.Save( "/tmp/router_events.log" );
+        wxString report = FROM_UTF8( m_eventLog.LatencyReport( "move" ).c_str() );
+
+        wxLogDebug( wxT( "router events: %s" ), GetChars( report ) );
+    }
+}
+
+
+void PNS_ROUTER::SetEventLogging( bool aEnable )
+{
+    m_logEvents = aEnable;
+
+    if( !aEnable )
+        m_eventLog.Clear();
+}
+
+
+void PNS_ROUTER::logEvent( const char* aName, const VECTOR2I& aP, const PNS_ITEM* aItem,
+                           int aArg, uint64_t aDuration )
+{
+    if( m_logEvents )
+        m_eventLog.LogEvent( aName, aP, aItem, aArg, aDuration );
 }
 
 
@@ -34,6 +34,7 @@
 #include "pns_item.h"
 #include "pns_itemset.h"
 #include "pns_node.h"
+#include "pns_logger.h"
 
 class BOARD;
 class BOARD_ITEM;
@@ -53,6 +54,7 @@ class PNS_VIA;
 class PNS_CLEARANCE_FUNC;
 class PNS_SHOVE;
 class PNS_DRAGGER;
+class THREAD_POOL;
 
 namespace KIGFX
 {
@@ -133,6 +135,23 @@ public:
 
     void DumpLog();
 
+    /**
+     * Enables or disables the recording of the router events (see EventLog()).
+     * They are recorded by default only in debug builds, where DumpLog() saves them.
+     * Disabling the recording clears the log.
+     */
+    void SetEventLogging( bool aEnable );
+
+    /**
+     * Returns the log of the router events (start, move, fix, layer switch...) since the
+     * last SyncWorld(), with the time taken by each of them. It is empty unless the events
+     * are recorded (see SetEventLogging()).
+     */
+    const PNS_LOGGER& EventLog() const
+    {
+        return m_eventLog;
+    }
+
     PNS_CLEARANCE_FUNC* GetClearanceFunc() const
     {
         return m_clearanceFunc;
@@ -216,6 +235,13 @@ public:
 
     PNS_PLACEMENT_ALGO *Placer() { return m_placer; }
 
+    /**
+     * Function ThreadPool()
+     * returns the threads computing the candidate heads of the smart mode.  They are
+     * started at the first call and kept for the next routing steps.
+     */
+    THREAD_POOL& ThreadPool();
+
 private:
     void movePlacing( const VECTOR2I& aP, PNS_ITEM* aItem );
     void moveDragging( const VECTOR2I& aP, PNS_ITEM* aItem );
@@ -242,6 +268,10 @@ private:
 
     void markViolations( PNS_NODE* aNode, PNS_ITEMSET& aCurrent, PNS_NODE::ITEM_VECTOR& aRemoved );
 
+    ///> records an event in m_eventLog, if the events are recorded
+    void logEvent( const char* aName, const VECTOR2I& aP, const PNS_ITEM* aItem = NULL,
+                   int aArg = 0, uint64_t aDuration = 0 );
+
     VECTOR2I m_currentEnd;
     RouterState m_state;
 
@@ -251,6 +281,7 @@ private:
     PNS_PLACEMENT_ALGO * m_placer;
     PNS_DRAGGER* m_dragger;
     PNS_SHOVE* m_shove;
+    THREAD_POOL* m_threadPool;
     int m_iterLimit;
     bool m_showInterSteps;
     int m_snapshotIter;
@@ -277,6 +308,10 @@ private:
 
     wxString m_toolStatusbarName;
     wxString m_failureReason;
+
+    ///> recorded router events, to replay and time routing sessions
+    PNS_LOGGER m_eventLog;
+    bool m_logEvents;
 };
 
 #endif
@@ -33,7 +33,7 @@ enum PNS_MODE
     RM_MarkObstacles = 0,   ///> Ignore collisions, mark obstacles
     RM_Shove,               ///> Only shove
     RM_Walkaround,          ///> Only walkaround
-    RM_Smart                ///> Guess what's better, try to make least mess on the PCB
+    RM_Smart                ///> Try shoving and walking around concurrently, keep the least mess
 };
 
 ///> Optimization effort
@@ -18,6 +18,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include <boost/foreach.hpp>
 #include <boost/optional.hpp>
 
@@ -43,7 +45,8 @@ PNS_NODE::OPT_OBSTACLE PNS_WALKAROUND::nearestObstacle( const PNS_LINE& aPath )
 
 
 PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
-                                                              bool aWindingDirection )
+                                                              bool aWindingDirection,
+                                                              int& aRecursiveBlockageCount )
 {
     optional<PNS_OBSTACLE>& current_obs =
         aWindingDirection ? m_currentObstacle[0] : m_currentObstacle[1];
@@ -59,9 +62,9 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
 
     if( ( current_obs->m_hull ).PointInside( last ) || ( current_obs->m_hull ).PointOnEdge( last ) )
     {
-        m_recursiveBlockageCount++;
+        aRecursiveBlockageCount++;
 
-        if( m_recursiveBlockageCount < 3 )
+        if( aRecursiveBlockageCount < 3 )
             aPath.Line().Append( current_obs->m_hull.NearestPoint( last ) );
         else
         {
@@ -76,12 +79,16 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
                       path_post[1], !aWindingDirection );
 
 #ifdef DEBUG
-    m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
-    m_logger.Log( &path_walk[0], 0, "path-walk" );
-    m_logger.Log( &path_pre[0], 1, "path-pre" );
-    m_logger.Log( &path_post[0], 4, "path-post" );
-    m_logger.Log( &current_obs->m_hull, 2, "hull" );
-    m_logger.Log( current_obs->m_item, 3, "item" );
+    // the logger is not thread safe
+    if( !m_parallel )
+    {
+        m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
+        m_logger.Log( &path_walk[0], 0, "path-walk" );
+        m_logger.Log( &path_pre[0], 1, "path-pre" );
+        m_logger.Log( &path_post[0], 4, "path-post" );
+        m_logger.Log( &current_obs->m_hull, 2, "hull" );
+        m_logger.Log( current_obs->m_item, 3, "item" );
+    }
 #endif
 
     int len_pre = path_walk[0].Length();
@@ -132,6 +139,92 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
 }
 
 
+void PNS_WALKAROUND::Start( const PNS_LINE& aInitialPath )
+{
+    start( aInitialPath );
+
+    m_parallel = true;
+    m_forceSingleDirection = false;
+    m_initialPath = aInitialPath;
+    m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
+    m_recursiveCollision[0] = m_recursiveCollision[1] = false;
+
+    for( int i = 0; i < 2; i++ )
+    {
+        m_path[i] = aInitialPath;
+        m_status[i] = IN_PROGRESS;
+        m_steps[i] = 0;
+        m_doneIteration[i] = m_iterationLimit;
+    }
+}
+
+
+void PNS_WALKAROUND::RouteWinding( bool aCw )
+{
+    // PNS_WALKAROUND::singleStep() only uses the obstacle and recursion flag of its
+    // direction.  Unlike Route(), each direction counts its own recursive blockages.
+    int dir = aCw ? 0 : 1;
+    int other = 1 - dir;
+    int recursiveBlockageCount = 0;
+
+    // Route() steps both directions once per iteration, and stops after the iteration
+    // where one of them is done: a direction stops once the other one is done at an
+    // earlier iteration.
+    for( int i = 0; i < m_iterationLimit; i++ )
+    {
+        if( !m_forceLongerPath )
+        {
+            MUTLOCK lock( m_doneLock );
+
+            if( m_doneIteration[other] < i )
+                break;
+        }
+
+        m_status[dir] = singleStep( m_path[dir], aCw, recursiveBlockageCount );
+        m_steps[dir] = i + 1;
+
+        if( m_status[dir] == DONE )
+        {
+            MUTLOCK lock( m_doneLock );
+            m_doneIteration[dir] = i;
+        }
+
+        if( m_status[dir] != IN_PROGRESS )
+            break;
+    }
+}
+
+
+PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Finish( PNS_LINE& aWalkPath, bool aOptimize )
+{
+    m_parallel = false;
+    m_iteration = std::max( m_steps[0], m_steps[1] );
+
+    // The path done first wins, as in Route()
+    if( m_doneIteration[0] < m_doneIteration[1] && !m_forceLongerPath )
+        aWalkPath = m_path[0];
+    else if( m_doneIteration[1] < m_doneIteration[0] && !m_forceLongerPath )
+        aWalkPath = m_path[1];
+    else
+        aWalkPath = choosePath( m_path[0], m_path[1] );
+
+    return finish( m_initialPath, aWalkPath, m_status[0], m_status[1], aOptimize );
+}
+
+
+const PNS_LINE& PNS_WALKAROUND::choosePath( const PNS_LINE& aPathCw,
+                                            const PNS_LINE& aPathCcw ) const
+{
+    int len_cw  = aPathCw.CLine().Length();
+    int len_ccw = aPathCcw.CLine().Length();
+
+    if( m_forceLongerPath )
+        return ( len_cw > len_ccw ? aPathCw : aPathCcw );
+    else
+        return ( len_cw < len_ccw ? aPathCw : aPathCcw );
+}
+
+
 PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitialPath,
         PNS_LINE& aWalkPath, bool aOptimize )
 {
@@ -158,21 +251,14 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitia
     while( m_iteration < m_iterationLimit )
     {
         if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
+            s_cw = singleStep( path_cw, true, m_recursiveBlockageCount );
 
         if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
+            s_ccw = singleStep( path_ccw, false, m_recursiveBlockageCount );
 
         if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
         {
-            int len_cw  = path_cw.CLine().Length();
-            int len_ccw = path_ccw.CLine().Length();
-
-            if( m_forceLongerPath )
-                aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-            else
-                aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
-
+            aWalkPath = choosePath( path_cw, path_ccw );
             break;
         }
         else if( s_cw == DONE && !m_forceLongerPath )
@@ -190,16 +276,18 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitia
     }
 
     if( m_iteration == m_iterationLimit )
-    {
-        int len_cw  = path_cw.CLine().Length();
-        int len_ccw = path_ccw.CLine().Length();
+        aWalkPath = choosePath( path_cw, path_ccw );
+
+    return finish( aInitialPath, aWalkPath, s_cw, s_ccw, aOptimize );
+}
 
-        if( m_forceLongerPath )
-            aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-        else
-            aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
-    }
 
+PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::finish( const PNS_LINE& aInitialPath,
+                                                          PNS_LINE& aWalkPath,
+                                                          WALKAROUND_STATUS aStatusCw,
+                                                          WALKAROUND_STATUS aStatusCcw,
+                                                          bool aOptimize )
+{
     if( m_cursorApproachMode )
     {
         // int len_cw = path_cw.GetCLine().Length();
@@ -243,7 +331,7 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitia
     if( aWalkPath.CPoint( 0 ) != aInitialPath.CPoint( 0 ) )
         return STUCK;
 
-    WALKAROUND_STATUS st = s_ccw == DONE || s_cw == DONE ? DONE : STUCK;
+    WALKAROUND_STATUS st = aStatusCcw == DONE || aStatusCw == DONE ? DONE : STUCK;
 
     if( st == DONE )
     {
@@ -21,6 +21,8 @@
 #ifndef __PNS_WALKAROUND_H
 #define __PNS_WALKAROUND_H
 
+#include <ki_mutex.h>
+
 #include "pns_line.h"
 #include "pns_node.h"
 #include "pns_router.h"
@@ -48,6 +50,10 @@ public:
         m_recursiveCollision[0] = m_recursiveCollision[1] = false;
         m_iteration = 0;
         m_forceCw = false;
+        m_parallel = false;
+        m_status[0] = m_status[1] = STUCK;
+        m_steps[0] = m_steps[1] = 0;
+        m_doneIteration[0] = m_doneIteration[1] = 0;
     }
 
     ~PNS_WALKAROUND() {};
@@ -108,6 +114,29 @@ public:
     WALKAROUND_STATUS Route( const PNS_LINE& aInitialPath, PNS_LINE& aWalkPath,
             bool aOptimize = true );
 
+    /**
+     * Function Start()
+     * prepares the walkaround of aInitialPath in both winding directions, for the callers
+     * running each direction on its own thread: RouteWinding() is then called once for
+     * each direction, possibly concurrently, and Finish() returns the path.  The result
+     * is the one of Route().
+     */
+    void Start( const PNS_LINE& aInitialPath );
+
+    /**
+     * Function RouteWinding()
+     * walks around in one winding direction, after Start().  It only changes the state
+     * of its direction, so both directions can run at the same time.
+     * @param aCw: true for the clockwise direction.
+     */
+    void RouteWinding( bool aCw );
+
+    /**
+     * Function Finish()
+     * chooses the path once both directions are walked, like Route() does.
+     */
+    WALKAROUND_STATUS Finish( PNS_LINE& aWalkPath, bool aOptimize = true );
+
     virtual PNS_LOGGER* Logger()
     {
         return &m_logger;
@@ -116,7 +145,16 @@ public:
 private:
     void start( const PNS_LINE& aInitialPath );
 
-    WALKAROUND_STATUS singleStep( PNS_LINE& aPath, bool aWindingDirection );
+    WALKAROUND_STATUS singleStep( PNS_LINE& aPath, bool aWindingDirection,
+                                  int& aRecursiveBlockageCount );
+
+    ///> Returns the final walkaround status, after the path is chosen.
+    WALKAROUND_STATUS finish( const PNS_LINE& aInitialPath, PNS_LINE& aWalkPath,
+                              WALKAROUND_STATUS aStatusCw, WALKAROUND_STATUS aStatusCcw,
+                              bool aOptimize );
+
+    ///> Returns the best of two walkaround paths.
+    const PNS_LINE& choosePath( const PNS_LINE& aPathCw, const PNS_LINE& aPathCcw ) const;
     PNS_NODE::OPT_OBSTACLE nearestObstacle( const PNS_LINE& aPath );
 
     PNS_NODE* m_world;
@@ -132,6 +170,18 @@ private:
     VECTOR2I m_cursorPos;
     PNS_NODE::OPT_OBSTACLE m_currentObstacle[2];
     bool m_recursiveCollision[2];
+
+    ///> Walk started by Start(): true while the directions run concurrently
+    bool m_parallel;
+    PNS_LINE m_initialPath;
+    PNS_LINE m_path[2];                     ///< clockwise and counterclockwise paths
+    WALKAROUND_STATUS m_status[2];
+    int m_steps[2];                         ///< steps done in each direction
+
+    ///> Iteration where each direction was done, m_iterationLimit if not done.
+    ///> Protected by m_doneLock.
+    int m_doneIteration[2];
+    MUTEX m_doneLock;
     PNS_LOGGER m_logger;
 };
 
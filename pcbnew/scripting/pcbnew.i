@@ -153,6 +153,14 @@
 
 %include <pcbnew_scripting_helpers.h>
 
+// functions used by the qa tests and benchmarks, only built in the python module
+#ifdef KICAD_QA
+%{
+#include <qa_hooks.h>
+%}
+%include <qa_hooks.h>
+#endif
+
 
 // ignore RELEASER as nested classes are still unsupported by swig
 %ignore IO_MGR::RELEASER;
@@ -1658,12 +1658,12 @@ void SPECCTRA_DB::FromBOARD( BOARD* aBoard )
             int ndx = 0;  // used in 2 for() loops below
             for( ; ndx<count; ++ndx )
             {
-                wxPoint   point( item->Outline()->m_CornersList[ndx].x,
-                                 item->Outline()->m_CornersList[ndx].y );
+                wxPoint   point( item->Outline()->GetX( ndx ),
+                                 item->Outline()->GetY( ndx ) );
                 mainPolygon->AppendPoint( mapPt(point) );
 
                 // this was the end of the main polygon
-                if( item->Outline()->m_CornersList[ndx].end_contour )
+                if( item->Outline()->IsEndContour( ndx ) )
                     break;
             }
 
@@ -1673,7 +1673,7 @@ void SPECCTRA_DB::FromBOARD( BOARD* aBoard )
             // handle the cutouts
             for( ++ndx; ndx<count; ++ndx )
             {
-                if( item->Outline()->m_CornersList[ndx-1].end_contour )
+                if( item->Outline()->IsEndContour( ndx-1 ) )
                 {
                     window = new WINDOW( plane );
 
@@ -1689,8 +1689,8 @@ void SPECCTRA_DB::FromBOARD( BOARD* aBoard )
                 wxASSERT( window );
                 wxASSERT( cutout );
 
-                wxPoint point(item->Outline()->m_CornersList[ndx].x,
-                              item->Outline()->m_CornersList[ndx].y );
+                wxPoint point(item->Outline()->GetX( ndx ),
+                              item->Outline()->GetY( ndx ) );
                 cutout->AppendPoint( mapPt(point) );
             }
         }
@@ -1735,12 +1735,12 @@ void SPECCTRA_DB::FromBOARD( BOARD* aBoard )
             int ndx = 0;  // used in 2 for() loops below
             for( ; ndx<count; ++ndx )
             {
-                wxPoint   point( item->Outline()->m_CornersList[ndx].x,
-                                 item->Outline()->m_CornersList[ndx].y );
+                wxPoint   point( item->Outline()->GetX( ndx ),
+                                 item->Outline()->GetY( ndx ) );
                 mainPolygon->AppendPoint( mapPt(point) );
 
                 // this was the end of the main polygon
-                if( item->Outline()->m_CornersList[ndx].end_contour )
+                if( item->Outline()->IsEndContour( ndx ) )
                     break;
             }
 
@@ -1750,7 +1750,7 @@ void SPECCTRA_DB::FromBOARD( BOARD* aBoard )
             // handle the cutouts
             for( ++ndx; ndx<count; ++ndx )
             {
-                if( item->Outline()->m_CornersList[ndx-1].end_contour )
+                if( item->Outline()->IsEndContour( ndx-1 ) )
                 {
                     window = new WINDOW( keepout );
                     keepout->AddWindow( window );
@@ -1764,8 +1764,8 @@ void SPECCTRA_DB::FromBOARD( BOARD* aBoard )
                 wxASSERT( window );
                 wxASSERT( cutout );
 
-                wxPoint point(item->Outline()->m_CornersList[ndx].x,
-                              item->Outline()->m_CornersList[ndx].y );
+                wxPoint point(item->Outline()->GetX( ndx ),
+                              item->Outline()->GetY( ndx ) );
                 cutout->AppendPoint( mapPt(point) );
             }
         }
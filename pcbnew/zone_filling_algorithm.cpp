@@ -28,11 +28,16 @@
 
 
 #include <algorithm> // sort
+#include <boost/functional/hash.hpp>
 
 #include <fctsys.h>
 #include <trigo.h>
 #include <wxPcbStruct.h>
 
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
 #include <class_zone.h>
 
 #include <pcbnew.h>
@@ -54,7 +59,8 @@
  * to add holes for pads and tracks and other items not in net.
  */
 
-bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, CPOLYGONS_LIST* aOutlineBuffer )
+bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, CPOLYGONS_LIST* aOutlineBuffer,
+                                                    const CPOLYGONS_LIST* aFeatures )
 {
     /* convert outlines + holes to outlines without holes (adding extra segments if necessary)
      * m_Poly data is expected normalized, i.e. NormalizeAreaOutlines was used after building
@@ -64,22 +70,58 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, CPOLYGONS_LIST*
     if( GetNumCorners() <= 2 )  // malformed zone. polygon calculations do not like it ...
         return 0;
 
+    // Only the outline is needed: build it without modifying this zone, because
+    // the outlines of other zones are read when zones are filled concurrently
+    if( aOutlineBuffer )
+    {
+        CPolyLine* smoothedPoly = buildSmoothedPoly();
+        aOutlineBuffer->Append( smoothedPoly->m_CornersList );
+        delete smoothedPoly;
+        return true;
+    }
+
     // Make a smoothed polygon out of the user-drawn polygon if required
-    if( m_smoothedPoly )
+    delete m_smoothedPoly;
+    m_smoothedPoly = buildSmoothedPoly();
+
+    /* For copper layers, we now must add holes in the Polygon list.
+     * holes are pads and tracks with their clearance area
+     * for non copper layers just recalculate the m_FilledPolysList
+     * with m_ZoneMinThickness taken in account
+     */
+    m_FilledPolysList.RemoveAllContours();
+
+    if( IsOnCopperLayer() )
+    {
+        if(g_UseOldZoneFillingAlgo)
+            AddClearanceAreasPolygonsToPolysList( aPcb, aFeatures );
+        else
+            AddClearanceAreasPolygonsToPolysList_NG( aPcb, aFeatures );
+    }
+    else
     {
-        delete m_smoothedPoly;
-        m_smoothedPoly = NULL;
+        int margin = m_ZoneMinThickness / 2;
+        m_smoothedPoly->m_CornersList.InflateOutline(m_FilledPolysList, -margin, true );
     }
 
+    if( m_FillMode )   // if fill mode uses segments, create them:
+        FillZoneAreasWithSegments();
+
+    m_IsFilled = true;
+
+    return true;
+}
+
+
+CPolyLine* ZONE_CONTAINER::buildSmoothedPoly() const
+{
     switch( m_cornerSmoothingType )
     {
     case ZONE_SETTINGS::SMOOTHING_CHAMFER:
-        m_smoothedPoly = m_Poly->Chamfer( m_cornerRadius );
-        break;
+        return m_Poly->Chamfer( m_cornerRadius );
 
     case ZONE_SETTINGS::SMOOTHING_FILLET:
-        m_smoothedPoly = m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
-        break;
+        return m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
 
     default:
         // Acute angles between adjacent edges can create issues in calculations,
@@ -87,42 +129,94 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, CPOLYGONS_LIST*
         // We can avoid issues by creating a very small chamfer which remove acute angles,
         // or left it without chamfer and use only CPOLYGONS_LIST::InflateOutline to create
         // clearance areas
-        m_smoothedPoly = m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
-        break;
+        return m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
     }
+}
 
-    if( aOutlineBuffer )
-        aOutlineBuffer->Append( m_smoothedPoly->m_CornersList );
 
-    /* For copper layers, we now must add holes in the Polygon list.
-     * holes are pads and tracks with their clearance area
-     * for non copper layers just recalculate the m_FilledPolysList
-     * with m_ZoneMinThickness taken in account
-     */
-    else
+// Add the corners of a polygon list to a fingerprint
+static void hashCorners( size_t& aSeed, const CPOLYGONS_LIST& aList )
+{
+    for( unsigned ii = 0; ii < aList.GetCornersCount(); ii++ )
+    {
+        boost::hash_combine( aSeed, aList.GetX( ii ) );
+        boost::hash_combine( aSeed, aList.GetY( ii ) );
+        boost::hash_combine( aSeed, aList.IsEndContour( ii ) );
+    }
+}
+
+
+size_t ZONE_CONTAINER::BuildFillFingerprint( BOARD* aPcb, CPOLYGONS_LIST* aFeatures )
+{
+    size_t seed = 0;
+
+    // Zone settings used when filling
+    boost::hash_combine( seed, (int) GetLayer() );
+    boost::hash_combine( seed, GetNetCode() );
+    boost::hash_combine( seed, GetClearance() );
+    boost::hash_combine( seed, m_ZoneClearance );
+    boost::hash_combine( seed, m_ZoneMinThickness );
+    boost::hash_combine( seed, m_FillMode );
+    boost::hash_combine( seed, m_ArcToSegmentsCount );
+    boost::hash_combine( seed, (int) m_PadConnection );
+    boost::hash_combine( seed, m_ThermalReliefGap );
+    boost::hash_combine( seed, m_ThermalReliefCopperBridge );
+    boost::hash_combine( seed, m_cornerSmoothingType );
+    boost::hash_combine( seed, m_cornerRadius );
+    boost::hash_combine( seed, m_priority );
+    boost::hash_combine( seed, g_UseOldZoneFillingAlgo );
+
+    // Zone outline
+    hashCorners( seed, m_Poly->m_CornersList );
+
+    if( IsOnCopperLayer() )
     {
-        m_FilledPolysList.RemoveAllContours();
+        // Obstacles: pads, tracks, graphic items and zones of higher priority,
+        // with their clearance, and thermal reliefs
+        CPOLYGONS_LIST  localFeatures;
+        CPOLYGONS_LIST& features = aFeatures ? *aFeatures : localFeatures;
+
+        features.RemoveAllContours();
+        buildFeatureHoleList( aPcb, features );
+        hashCorners( seed, features );
+
+        // Pads and tracks of the zone net are not obstacles, but filled areas which
+        // do not contain one of them are removed (insulated copper islands)
+        EDA_RECT bbox = GetBoundingBox();
 
-        if( IsOnCopperLayer() )
+        for( MODULE* module = aPcb->m_Modules; module; module = module->Next() )
         {
-            if(g_UseOldZoneFillingAlgo)
-                AddClearanceAreasPolygonsToPolysList( aPcb );
-            else
-                AddClearanceAreasPolygonsToPolysList_NG( aPcb );
+            for( D_PAD* pad = module->Pads(); pad != NULL; pad = pad->Next() )
+            {
+                if( !pad->IsOnLayer( GetLayer() ) || pad->GetNetCode() != GetNetCode() )
+                    continue;
+
+                if( !bbox.Contains( pad->GetPosition() ) )
+                    continue;
+
+                boost::hash_combine( seed, pad->GetPosition().x );
+                boost::hash_combine( seed, pad->GetPosition().y );
+            }
         }
-        else
+
+        for( TRACK* track = aPcb->m_Track; track; track = track->Next() )
         {
-            int margin = m_ZoneMinThickness / 2;
-            m_smoothedPoly->m_CornersList.InflateOutline(m_FilledPolysList, -margin, true );
-        }
+            if( !track->IsOnLayer( GetLayer() ) || track->GetNetCode() != GetNetCode() )
+                continue;
 
-        if( m_FillMode )   // if fill mode uses segments, create them:
-            FillZoneAreasWithSegments();
+            if( !track->GetBoundingBox().Intersects( bbox ) )
+                continue;
 
-        m_IsFilled = true;
+            boost::hash_combine( seed, (int) track->Type() );
+            boost::hash_combine( seed, track->GetStart().x );
+            boost::hash_combine( seed, track->GetStart().y );
+            boost::hash_combine( seed, track->GetEnd().x );
+            boost::hash_combine( seed, track->GetEnd().y );
+        }
     }
 
-    return true;
+    // 0 means "unknown fingerprint"
+    return seed ? seed : 1;
 }
 
 
@@ -153,7 +247,7 @@ int ZONE_CONTAINER::FillZoneAreasWithSegments()
 
     for( int ic = 0; ic <= end_list; ic++ )
     {
-        CPolyPt* corner = &m_FilledPolysList[ic];
+        const CPolyPt* corner = &m_FilledPolysList.GetCorner( ic );
         if ( corner->end_contour || ( ic == end_list ) )
         {
             iend = ic;
@@ -167,13 +261,13 @@ int ZONE_CONTAINER::FillZoneAreasWithSegments()
 
                 for( ics = istart, ice = iend; ics <= iend; ice = ics, ics++ )
                 {
-                    if( m_FilledPolysList[ice].m_flags )
+                    if( m_FilledPolysList.GetUtility( ice ) )
                         continue;
 
-                    int seg_startX = m_FilledPolysList[ics].x;
-                    int seg_startY = m_FilledPolysList[ics].y;
-                    int seg_endX   = m_FilledPolysList[ice].x;
-                    int seg_endY   = m_FilledPolysList[ice].y;
+                    int seg_startX = m_FilledPolysList.GetX( ics );
+                    int seg_startY = m_FilledPolysList.GetY( ics );
+                    int seg_endX   = m_FilledPolysList.GetX( ice );
+                    int seg_endY   = m_FilledPolysList.GetY( ice );
 
 
                     /* Trivial cases: skip if ref above or below the segment to test */
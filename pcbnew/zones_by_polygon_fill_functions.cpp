@@ -40,10 +40,53 @@
 
 #include <pcbnew.h>
 #include <zones.h>
+#include <task_queue.h>
 
 #define FORMAT_STRING _( "Filling zone %d out of %d (net %s)..." )
 
 
+/**
+ * Struct ZONE_FILL_TASK
+ * fills the zones of a block starting at index aFirst of aZones, for TASK_QUEUE.
+ * A zone is not refilled (and is flagged in aSkipped) when its fill fingerprint shows
+ * nothing it depends on was modified since its last filling.
+ */
+struct ZONE_FILL_TASK
+{
+    ZONE_FILL_TASK( BOARD* aBoard, const std::vector<ZONE_CONTAINER*>& aZones, int aFirst,
+                    std::vector<char>& aSkipped ) :
+        m_board( aBoard ), m_zones( aZones ), m_first( aFirst ), m_skipped( aSkipped )
+    {}
+
+    void operator()( int aTask )
+    {
+        int             index = m_first + aTask;
+        ZONE_CONTAINER* zone = m_zones[index];
+
+        // The obstacles are built once, for the fingerprint and the filling
+        CPOLYGONS_LIST  features;
+        size_t fingerprint = zone->BuildFillFingerprint( m_board, &features );
+
+        // Nothing this zone depends on was changed since it was filled
+        if( zone->IsFilled() && zone->GetFillFingerprint() == fingerprint )
+        {
+            m_skipped[index] = true;
+            return;
+        }
+
+        zone->ClearFilledPolysList();
+        zone->UnFill();
+        zone->BuildFilledSolidAreasPolygons( m_board, NULL, &features );
+        zone->SetFillFingerprint( fingerprint );
+    }
+
+    BOARD*                                  m_board;
+    const std::vector<ZONE_CONTAINER*>&     m_zones;
+    int                                     m_first;
+    std::vector<char>&                      m_skipped;
+};
+
+
 /**
  * Function Delete_OldZone_Fill (obsolete)
  * Used for compatibility with old boards
@@ -112,7 +155,11 @@ int PCB_EDIT_FRAME::Fill_Zone( ZONE_CONTAINER* aZone )
 
     wxBusyCursor dummy;     // Shows an hourglass cursor (removed by its destructor)
 
-    aZone->BuildFilledSolidAreasPolygons( GetBoard() );
+    CPOLYGONS_LIST  features;
+    size_t          fingerprint = aZone->BuildFillFingerprint( GetBoard(), &features );
+
+    aZone->BuildFilledSolidAreasPolygons( GetBoard(), NULL, &features );
+    aZone->SetFillFingerprint( fingerprint );
 
     OnModify();
 
@@ -120,9 +167,11 @@ int PCB_EDIT_FRAME::Fill_Zone( ZONE_CONTAINER* aZone )
 }
 
 
-int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
+int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose,
+                                    int* aSkippedCount )
 {
     int errorLevel = 0;
+    int skippedCount = 0;
     int areaCount = GetBoard()->GetAreaCount();
     wxBusyCursor dummyCursor;
     wxString msg;
@@ -142,30 +191,61 @@ int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
     // Remove segment zones
     GetBoard()->m_Zone.DeleteAll();
 
-    int ii;
+    // Collect the zones to fill (keepout zones cannot be filled)
+    BOARD* board = GetBoard();
+    std::vector<ZONE_CONTAINER*> zones;
+
+    for( int ii = 0; ii < areaCount; ii++ )
+    {
+        ZONE_CONTAINER* zoneContainer = board->GetArea( ii );
+
+        if( !zoneContainer->GetIsKeepout() )
+            zones.push_back( zoneContainer );
+    }
+
+    // Filling a zone only reads the board (outlines of other zones are built without
+    // modifying them) and writes its own filled areas, so zones can be filled
+    // concurrently.  They are filled by blocks of one zone per thread, to update the
+    // progress bar and to test for user abort between blocks.
+    int zoneCount = zones.size();
+    int blockSize = DefaultThreadCount();
+
+    // The zones dump file cannot be shared by several threads
+    if( g_DumpZonesWhenFilling )
+        blockSize = 1;
 
-    for( ii = 0; ii < areaCount; ii++ )
+    std::vector<char> skipped( zoneCount, false );
+    int first;
+
+    for( first = 0; first < zoneCount; first += blockSize )
     {
-        ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
-        if( zoneContainer->GetIsKeepout() )
-            continue;
+        int last = std::min( first + blockSize, zoneCount );
 
-        msg.Printf( FORMAT_STRING, ii + 1, areaCount, GetChars( zoneContainer->GetNetname() ) );
+        msg.Printf( FORMAT_STRING, first + 1, zoneCount,
+                    GetChars( zones[first]->GetNetname() ) );
 
         if( progressDialog )
         {
-            if( !progressDialog->Update( ii+1, msg ) )
+            if( !progressDialog->Update( first + 1, msg ) )
                 break;  // Aborted by user
         }
 
-        errorLevel = Fill_Zone( zoneContainer );
-
-        if( errorLevel && !aVerbose )
-            break;
+        ZONE_FILL_TASK task( board, zones, first, skipped );
+        TASK_QUEUE<ZONE_FILL_TASK> queue( task, last - first );
+        queue.Run( blockSize );
     }
 
+    skippedCount = std::count( skipped.begin(), skipped.end(), true );
+
+    if( std::min( first, zoneCount ) > skippedCount )
+        OnModify();
+
+    if( aSkippedCount )
+        *aSkippedCount = skippedCount;
+
     if( progressDialog )
-        progressDialog->Update( ii+2, _( "Updating ratsnest..." ) );
+        progressDialog->Update( std::min( first, zoneCount ) + 2, _( "Updating ratsnest..." ) );
+
     TestConnections();
 
     // Recalculate the active ratsnest, i.e. the unconnected links
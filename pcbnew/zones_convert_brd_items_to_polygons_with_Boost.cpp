@@ -476,7 +476,8 @@ static const SHAPE_POLY_SET convertBoostToPolySet ( const KI_POLYGON_SET& aSet )
  *     Remove new insulated copper islands
  */
 
-void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
+void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb,
+                                                              const CPOLYGONS_LIST* aFeatures )
 {
     int segsPerCircle;
     double correctionFactor;
@@ -510,7 +511,12 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
 
 
     tmp.RemoveAllContours();
-    buildFeatureHoleList( aPcb, tmp );
+
+    if( aFeatures )
+        tmp.Append( *aFeatures );
+    else
+        buildFeatureHoleList( aPcb, tmp );
+
     SHAPE_POLY_SET holes = convertPolyListToPolySet( tmp );
 
     if(g_DumpZonesWhenFilling)
@@ -585,7 +591,8 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
         dumper->EndGroup();
 }
 
-void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb )
+void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb,
+                                                           const CPOLYGONS_LIST* aFeatures )
 {
     int segsPerCircle;
     double correctionFactor;
@@ -637,7 +644,10 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb )
  if (g_DumpZonesWhenFilling)
         dumper->Write ( convertBoostToPolySet( polyset_zone_solid_areas ), "solid-areas" );
 
-    buildFeatureHoleList( aPcb, cornerBufferPolysToSubstract );
+    if( aFeatures )
+        cornerBufferPolysToSubstract.Append( *aFeatures );
+    else
+        buildFeatureHoleList( aPcb, cornerBufferPolysToSubstract );
 
     // cornerBufferPolysToSubstract contains polygons to substract.
     // polyset_zone_solid_areas contains the main filled area
@@ -37,6 +37,14 @@
 #include <zones.h>
 #include <polygon_test_point_inside.h>
 
+#include <algorithm>
+
+
+static bool sortPointsByX( const wxPoint& aFirst, const wxPoint& aSecond )
+{
+    return aFirst.x < aSecond.x;
+}
+
 
 void ZONE_CONTAINER::TestForCopperIslandAndRemoveInsulatedIslands( BOARD* aPcb )
 {
@@ -75,29 +83,52 @@ void ZONE_CONTAINER::TestForCopperIslandAndRemoveInsulatedIslands( BOARD* aPcb )
             listPointsCandidates.push_back( track->GetEnd() );
     }
 
+    // Sort the points by X coordinate, to find quickly the ones inside a sub-area bounding box
+    std::sort( listPointsCandidates.begin(), listPointsCandidates.end(), sortPointsByX );
+
+    std::vector <wxPoint> bboxCandidates;
+
     // test if a point is inside
     unsigned indexstart = 0, indexend;
     bool     connected  = false;
 
     for( indexend = 0; indexend < m_FilledPolysList.GetCornersCount(); indexend++ )
     {
-        if( m_FilledPolysList[indexend].end_contour )    // end of a filled sub-area found
+        if( m_FilledPolysList.IsEndContour( indexend ) )    // end of a filled sub-area found
         {
             EDA_RECT bbox = CalculateSubAreaBoundaryBox( indexstart, indexend );
 
-            for( unsigned ic = 0; ic < listPointsCandidates.size(); ic++ )
+            // Collect the points inside the bounding box
+            bboxCandidates.clear();
+
+            std::vector <wxPoint>::const_iterator it;
+            it = std::lower_bound( listPointsCandidates.begin(), listPointsCandidates.end(),
+                                   bbox.GetOrigin(), sortPointsByX );
+
+            for( ; it != listPointsCandidates.end() && it->x <= bbox.GetRight(); ++it )
             {
-                // test if this area is connected to a board item:
-                wxPoint pos = listPointsCandidates[ic];
+                if( bbox.Contains( *it ) )
+                    bboxCandidates.push_back( *it );
+            }
 
-                if( !bbox.Contains( pos ) )
-                    continue;
+            // test if this area is connected to a board item:
+            if( bboxCandidates.size() == 1 )
+            {
+                connected = TestPointInsidePolygon( m_FilledPolysList, indexstart, indexend,
+                                                    bboxCandidates[0].x, bboxCandidates[0].y );
+            }
+            else if( bboxCandidates.size() > 1 )
+            {
+                // Many points to test: only test the edges near each point
+                POLYGON_EDGE_INDEX polygon( m_FilledPolysList, indexstart, indexend );
 
-                if( TestPointInsidePolygon( m_FilledPolysList, indexstart, indexend,
-                                            pos.x, pos.y ) )
+                for( unsigned ic = 0; ic < bboxCandidates.size(); ic++ )
                 {
-                    connected = true;
-                    break;
+                    if( polygon.TestPointInside( bboxCandidates[ic].x, bboxCandidates[ic].y ) )
+                    {
+                        connected = true;
+                        break;
+                    }
                 }
             }
 
@@ -122,12 +153,12 @@ EDA_RECT ZONE_CONTAINER::CalculateSubAreaBoundaryBox( int aIndexStart, int aInde
     CPolyPt  start_point, end_point;
     EDA_RECT bbox;
 
-    start_point = m_FilledPolysList[aIndexStart];
+    start_point = m_FilledPolysList.GetCorner( aIndexStart );
     end_point   = start_point;
 
     for( int ii = aIndexStart; ii <= aIndexEnd; ii++ )
     {
-        CPolyPt ptst = m_FilledPolysList[ii];
+        const CPolyPt& ptst = m_FilledPolysList.GetCorner( ii );
 
         if( start_point.x > ptst.x )
             start_point.x = ptst.x;
@@ -551,7 +551,7 @@ bool DRC::doEdgeZoneDrc( ZONE_CONTAINER* aArea, int aCornerIndex )
     wxPoint  end;
 
     // Search the end point of the edge starting at aCornerIndex
-    if( aArea->Outline()->m_CornersList[aCornerIndex].end_contour == false
+    if( aArea->Outline()->IsEndContour( aCornerIndex ) == false
        && aCornerIndex < (aArea->GetNumCorners() - 1) )
     {
         end = aArea->GetCornerPosition( aCornerIndex + 1 );
@@ -564,7 +564,7 @@ bool DRC::doEdgeZoneDrc( ZONE_CONTAINER* aArea, int aCornerIndex )
 
         while( ii >= 0 )
         {
-            if( aArea->Outline()->m_CornersList[ii].end_contour )
+            if( aArea->Outline()->IsEndContour( ii ) )
                 break;
 
             end = aArea->GetCornerPosition( ii );
@@ -82,21 +82,20 @@ CPolyLine::~CPolyLine()
     for( unsigned icnt = 1; icnt < m_CornersList.GetCornersCount(); icnt ++ )
     {
         unsigned last = icnt-1;
-        if( m_CornersList[icnt].end_contour )
+        if( m_CornersList.IsEndContour( icnt ) )
         {
             last = startcountour;
             startcountour = icnt+1;
         }
 
-        if( ( m_CornersList[last].x == m_CornersList[icnt].x ) &&
-            ( m_CornersList[last].y == m_CornersList[icnt].y ) )
+        if( m_CornersList.GetPos( last ) == m_CornersList.GetPos( icnt ) )
         {
             DeleteCorner( icnt );
             icnt--;
             removed ++;
         }
 
-        if( m_CornersList[icnt].end_contour )
+        if( m_CornersList.IsEndContour( icnt ) )
         {
             startcountour = icnt+1;
             icnt++;
@@ -133,7 +132,7 @@ int CPolyLine::NormalizeAreaOutlines( std::vector<CPolyLine*>* aNewPolygonList )
     unsigned ic    = 0;
     while( ic < corners_count )
     {
-        const CPolyPt& corner = m_CornersList[ic++];
+        const CPolyPt& corner = m_CornersList.GetCorner( ic++ );
         raw_polygon.push_back( ClipperLib::IntPoint( corner.x, corner.y ) );
 
         if( corner.end_contour )
@@ -164,7 +163,7 @@ int CPolyLine::NormalizeAreaOutlines( std::vector<CPolyLine*>* aNewPolygonList )
         // Normalize current hole and add it to hole list
         while( ic < corners_count )
         {
-            const CPolyPt& corner = m_CornersList[ic++];
+            const CPolyPt& corner = m_CornersList.GetCorner( ic++ );
             raw_polygon.push_back( ClipperLib::IntPoint( corner.x, corner.y ) );
 
             if( corner.end_contour )
@@ -274,8 +273,8 @@ void CPolyLine::AppendCorner( int x, int y )
 void CPolyLine::MoveCorner( int ic, int x, int y )
 {
     UnHatch();
-    m_CornersList[ic].x = x;
-    m_CornersList[ic].y = y;
+    m_CornersList.SetX( ic, x );
+    m_CornersList.SetY( ic, y );
     Hatch();
 }
 
@@ -300,7 +299,7 @@ void CPolyLine::DeleteCorner( int ic )
         m_CornersList.DeleteCorner( ic );
 
         if( ic == iend )
-            m_CornersList[ic - 1].end_contour = true;
+            m_CornersList.SetEndContour( ic - 1, true );
     }
 
     if( closed && GetContourSize( icont ) < 3 )
@@ -345,7 +344,7 @@ void CPolyLine::RemoveContour( int icont )
 }
 
 
-CPolyLine* CPolyLine::Chamfer( unsigned int aDistance )
+CPolyLine* CPolyLine::Chamfer( unsigned int aDistance ) const
 {
     CPolyLine* newPoly = new CPolyLine;
 
@@ -423,7 +422,7 @@ CPolyLine* CPolyLine::Chamfer( unsigned int aDistance )
 }
 
 
-CPolyLine* CPolyLine::Fillet( unsigned int aRadius, unsigned int aSegments )
+CPolyLine* CPolyLine::Fillet( unsigned int aRadius, unsigned int aSegments ) const
 {
     CPolyLine* newPoly = new CPolyLine;
 
@@ -589,8 +588,8 @@ void CPolyLine::InsertCorner( int ic, int x, int y )
     {
         if( m_CornersList[ic].end_contour )
         {
-            m_CornersList[ic + 1].end_contour   = true;
-            m_CornersList[ic].end_contour       = false;
+            m_CornersList.SetEndContour( ic + 1, true );
+            m_CornersList.SetEndContour( ic, false );
         }
     }
 
@@ -605,7 +604,7 @@ void CPolyLine::UnHatch()
 }
 
 
-const EDA_RECT CPolyLine::GetBoundingBox()
+const EDA_RECT CPolyLine::GetBoundingBox() const
 {
     int xmin    = INT_MAX;
     int ymin    = INT_MAX;
@@ -628,7 +627,7 @@ const EDA_RECT CPolyLine::GetBoundingBox()
 }
 
 
-const EDA_RECT CPolyLine::GetBoundingBox( int icont )
+const EDA_RECT CPolyLine::GetBoundingBox( int icont ) const
 {
     int xmin    = INT_MAX;
     int ymin    = INT_MAX;
@@ -662,26 +661,28 @@ int CPolyLine::GetContoursCount() const
 
 int CPOLYGONS_LIST::GetContoursCount() const
 {
-    if( !m_cornersList.size() )
+    const CORNERS& cornersList = *m_cornersList;
+
+    if( !cornersList.size() )
         return 0;
 
     // count the number of corners flagged end_contour
     int ncont = 0;
 
-    for( unsigned ic = 0; ic < m_cornersList.size(); ic++ )
-        if( m_cornersList[ic].end_contour )
+    for( unsigned ic = 0; ic < cornersList.size(); ic++ )
+        if( cornersList[ic].end_contour )
             ncont++;
 
     // The last corner can be not yet flagged end_contour.
     // It was not counted, but the polygon exists, so count it
-    if( !m_cornersList[m_cornersList.size() - 1].end_contour )
+    if( !cornersList[cornersList.size() - 1].end_contour )
         ncont++;
 
     return ncont;
 }
 
 
-int CPolyLine::GetContour( int ic )
+int CPolyLine::GetContour( int ic ) const
 {
     int ncont = 0;
 
@@ -695,7 +696,7 @@ int CPolyLine::GetContour( int ic )
 }
 
 
-int CPolyLine::GetContourStart( int icont )
+int CPolyLine::GetContourStart( int icont ) const
 {
     if( icont == 0 )
         return 0;
@@ -718,7 +719,7 @@ int CPolyLine::GetContourStart( int icont )
 }
 
 
-int CPolyLine::GetContourEnd( int icont )
+int CPolyLine::GetContourEnd( int icont ) const
 {
     if( icont < 0 )
         return 0;
@@ -744,13 +745,13 @@ int CPolyLine::GetContourEnd( int icont )
 }
 
 
-int CPolyLine::GetContourSize( int icont )
+int CPolyLine::GetContourSize( int icont ) const
 {
     return GetContourEnd( icont ) - GetContourStart( icont ) + 1;
 }
 
 
-bool CPolyLine::GetClosed()
+bool CPolyLine::GetClosed() const
 {
     if( m_CornersList.GetCornersCount() == 0 )
         return false;
@@ -778,25 +779,28 @@ void CPolyLine::Hatch()
     if( !GetClosed() ) // If not closed, the poly is beeing created and not finalised. Not not hatch
         return;
 
+    // Read corners through a const reference: they can be shared with undo copies
+    const CPOLYGONS_LIST& cornersList = m_CornersList;
+
     // define range for hatch lines
-    int min_x   = m_CornersList[0].x;
-    int max_x   = m_CornersList[0].x;
-    int min_y   = m_CornersList[0].y;
-    int max_y   = m_CornersList[0].y;
+    int min_x   = cornersList[0].x;
+    int max_x   = cornersList[0].x;
+    int min_y   = cornersList[0].y;
+    int max_y   = cornersList[0].y;
 
-    for( unsigned ic = 1; ic < m_CornersList.GetCornersCount(); ic++ )
+    for( unsigned ic = 1; ic < cornersList.GetCornersCount(); ic++ )
     {
-        if( m_CornersList[ic].x < min_x )
-            min_x = m_CornersList[ic].x;
+        if( cornersList[ic].x < min_x )
+            min_x = cornersList[ic].x;
 
-        if( m_CornersList[ic].x > max_x )
-            max_x = m_CornersList[ic].x;
+        if( cornersList[ic].x > max_x )
+            max_x = cornersList[ic].x;
 
-        if( m_CornersList[ic].y < min_y )
-            min_y = m_CornersList[ic].y;
+        if( cornersList[ic].y < min_y )
+            min_y = cornersList[ic].y;
 
-        if( m_CornersList[ic].y > max_y )
-            max_y = m_CornersList[ic].y;
+        if( cornersList[ic].y > max_y )
+            max_y = cornersList[ic].y;
     }
 
     // Calculate spacing between 2 hatch lines
@@ -835,7 +839,7 @@ void CPolyLine::Hatch()
     min_a += offset;
 
     // now calculate and draw hatch lines
-    int nc = m_CornersList.GetCornersCount();
+    int nc = cornersList.GetCornersCount();
 
     // loop through hatch lines
     #define MAXPTS 200      // Usually we store only few values per one hatch line
@@ -861,21 +865,21 @@ void CPolyLine::Hatch()
             double  x, y, x2, y2;
             int     ok;
 
-            if( m_CornersList[ic].end_contour ||
-                ( ic == (int) (m_CornersList.GetCornersCount() - 1) ) )
+            if( cornersList[ic].end_contour ||
+                ( ic == (int) (cornersList.GetCornersCount() - 1) ) )
             {
                 ok = FindLineSegmentIntersection( a, slope,
-                                                  m_CornersList[ic].x, m_CornersList[ic].y,
-                                                  m_CornersList[i_start_contour].x,
-                                                  m_CornersList[i_start_contour].y,
+                                                  cornersList[ic].x, cornersList[ic].y,
+                                                  cornersList[i_start_contour].x,
+                                                  cornersList[i_start_contour].y,
                                                   &x, &y, &x2, &y2 );
                 i_start_contour = ic + 1;
             }
             else
             {
                 ok = FindLineSegmentIntersection( a, slope,
-                                                  m_CornersList[ic].x, m_CornersList[ic].y,
-                                                  m_CornersList[ic + 1].x, m_CornersList[ic + 1].y,
+                                                  cornersList[ic].x, cornersList[ic].y,
+                                                  cornersList[ic + 1].x, cornersList[ic + 1].y,
                                                   &x, &y, &x2, &y2 );
             }
 
@@ -953,7 +957,7 @@ void CPolyLine::Hatch()
 
 // test to see if a point is inside polyline
 //
-bool CPolyLine::TestPointInside( int px, int py )
+bool CPolyLine::TestPointInside( int px, int py ) const
 {
     if( !GetClosed() )
     {
@@ -999,7 +1003,7 @@ void CPolyLine::Copy( const CPolyLine* src )
  * return true if the corner aCornerIdx is on a hole inside the main outline
  * and false if it is on the main outline
  */
-bool CPolyLine::IsCutoutContour( int aCornerIdx )
+bool CPolyLine::IsCutoutContour( int aCornerIdx ) const
 {
     int ncont = GetContour( aCornerIdx );
 
@@ -1083,7 +1087,7 @@ void CPolyLine::AppendBezier( int x1, int y1, int x2, int y2, int x3, int y3, in
  * return distance between the segment and outline.
  *               0 if segment intersects or is inside
  */
-int CPolyLine::Distance( wxPoint aStart, wxPoint aEnd, int aWidth )
+int CPolyLine::Distance( wxPoint aStart, wxPoint aEnd, int aWidth ) const
 {
     // We calculate the min dist between the segment and each outline segment
     // However, if the segment to test is inside the outline, and does not cross
@@ -1143,7 +1147,7 @@ int CPolyLine::Distance( wxPoint aStart, wxPoint aEnd, int aWidth )
  * return distance between the point and outline.
  *               0 if the point is inside
  */
-int CPolyLine::Distance( const wxPoint& aPoint )
+int CPolyLine::Distance( const wxPoint& aPoint ) const
 {
     // We calculate the dist between the point and each outline segment
     // If the point is inside the outline, the dist is 0.
@@ -1266,7 +1270,7 @@ int CPolyLine::HitTestForCorner( const wxPoint& aPos, int aDistMax ) const
  */
 void CPOLYGONS_LIST::ExportTo( KI_POLYGON_WITH_HOLES& aPolygoneWithHole ) const
 {
-    unsigned    corners_count = m_cornersList.size();
+    unsigned    corners_count = m_cornersList->size();
 
     std::vector<KI_POLY_POINT> cornerslist;
     KI_POLYGON  poly;
@@ -1461,7 +1465,8 @@ void CPOLYGONS_LIST::ImportFrom( ClipperLib::Paths& aPolygons )
  */
 #include <convert_basic_shapes_to_polygon.h>
 
-void CPOLYGONS_LIST::InflateOutline( CPOLYGONS_LIST& aResult, int aInflateValue, bool aLinkHoles )
+void CPOLYGONS_LIST::InflateOutline( CPOLYGONS_LIST& aResult, int aInflateValue,
+                                     bool aLinkHoles ) const
 {
     KI_POLYGON_SET polyset_outline;
     ExportTo( polyset_outline );
@@ -1640,7 +1645,7 @@ void ConvertPolysListWithHolesToOnePolygon( const CPOLYGONS_LIST& aPolysListWith
  * When a CPolyLine is self intersectic, it need to be normalized.
  * (converted to non intersecting polygons)
  */
-bool CPolyLine::IsPolygonSelfIntersecting()
+bool CPolyLine::IsPolygonSelfIntersecting() const
 {
     // first, check for sides intersecting other sides
     int n_cont  = GetContoursCount();
@@ -49,6 +49,7 @@
 #define POLYLINE_H
 
 #include <vector>
+#include <boost/shared_ptr.hpp>
 
 #include <wx/gdicmn.h>                          // for wxPoint definition
 #include <layers_id_colors_and_visibility.h>    // for LAYER_NUM definition
@@ -108,83 +109,137 @@ public:
  * CPOLYGONS_LIST handle a list of contours (polygons corners).
  * Each corner is a CPolyPt item.
  * The last cornet of each contour has its end_contour member = true
+ * The corners are shared by the copies of a list until one of them is modified
+ * (copy on write), so copying a list (e.g. to save a zone in undo list) is cheap.
  */
 class CPOLYGONS_LIST
 {
 private:
-    std::vector <CPolyPt> m_cornersList;    // array of points for corners
+    typedef std::vector <CPolyPt> CORNERS;
+
+    boost::shared_ptr<CORNERS> m_cornersList;    // array of points for corners
+
+    // Returns the corners to modify them, after making a private copy if they are shared.
+    // The returned reference is only used inside this class: a mutable reference kept by a
+    // caller would change the other copies if the list was copied after it was handed out.
+    CORNERS& corners()
+    {
+        if( !m_cornersList.unique() )
+            m_cornersList.reset( new CORNERS( *m_cornersList ) );
+
+        return *m_cornersList;
+    }
+
 public:
-    CPOLYGONS_LIST() {};
+    CPOLYGONS_LIST() : m_cornersList( new CORNERS ) {};
 
-    CPolyPt& operator [](int aIdx) {return m_cornersList[aIdx]; }
+    // Corners are read only: use SetX(), SetY(), SetFlag() and SetEndContour() to change them
+    const CPolyPt& operator [](int aIdx) const {return (*m_cornersList)[aIdx]; }
 
     // Accessor:
-    const std::vector <CPolyPt>& GetList() const {return m_cornersList;}
-    int        GetX( int ic ) const { return m_cornersList[ic].x; }
-    void       SetX( int ic, int aValue ) { m_cornersList[ic].x = aValue; }
-    int        GetY( int ic ) const { return m_cornersList[ic].y; }
-    void       SetY( int ic, int aValue ) { m_cornersList[ic].y = aValue; }
-    int        GetUtility( int ic ) const { return m_cornersList[ic].m_flags; }
+    const std::vector <CPolyPt>& GetList() const {return *m_cornersList;}
+    int        GetX( int ic ) const { return (*m_cornersList)[ic].x; }
+    void       SetX( int ic, int aValue ) { corners()[ic].x = aValue; }
+    int        GetY( int ic ) const { return (*m_cornersList)[ic].y; }
+    void       SetY( int ic, int aValue ) { corners()[ic].y = aValue; }
+    int        GetUtility( int ic ) const { return (*m_cornersList)[ic].m_flags; }
     void       SetFlag( int ic, int aFlag )
     {
-        m_cornersList[ic].m_flags = aFlag;
+        corners()[ic].m_flags = aFlag;
     }
 
     bool       IsEndContour( int ic ) const
     {
-        return m_cornersList[ic].end_contour;
+        return (*m_cornersList)[ic].end_contour;
     }
 
     void        SetEndContour( int ic, bool end_contour )
     {
-        m_cornersList[ic].end_contour = end_contour;
+        corners()[ic].end_contour = end_contour;
     }
 
-    const wxPoint&  GetPos( int ic ) const { return m_cornersList[ic]; }
-    const CPolyPt&  GetCorner( int ic ) const { return m_cornersList[ic]; }
+    const wxPoint&  GetPos( int ic ) const { return (*m_cornersList)[ic]; }
+    const CPolyPt&  GetCorner( int ic ) const { return (*m_cornersList)[ic]; }
+
+    /**
+     * Function IsShared
+     * @return true if the corners are shared with other copies of this list.
+     */
+    bool IsShared() const { return !m_cornersList.unique(); }
+
+    /**
+     * Function ShareCount
+     * @return the number of copies of this list sharing its corners, 1 if not shared.
+     */
+    long ShareCount() const { return m_cornersList.use_count(); }
+
+    /**
+     * Function GetMemorySize
+     * @return the size in bytes of the corners buffer, shared or not.
+     */
+    size_t GetMemorySize() const { return m_cornersList->capacity() * sizeof( CPolyPt ); }
 
     // vector <> methods
-    void reserve( int aSize ) { m_cornersList.reserve( aSize ); }
+    void reserve( int aSize ) { corners().reserve( aSize ); }
+
 
+    void RemoveAllContours( void )
+    {
+        // Do not copy corners which would be removed
+        if( m_cornersList.unique() )
+            m_cornersList->clear();
+        else
+            m_cornersList.reset( new CORNERS );
+    }
 
-    void RemoveAllContours( void ) { m_cornersList.clear(); }
-    CPolyPt& GetLastCorner() { return m_cornersList.back(); }
+    const CPolyPt& GetLastCorner() const { return m_cornersList->back(); }
 
-    unsigned GetCornersCount() const { return m_cornersList.size(); }
+    unsigned GetCornersCount() const { return m_cornersList->size(); }
 
     void DeleteCorner( int aIdx )
     {
-        m_cornersList.erase( m_cornersList.begin() + aIdx );
+        CORNERS& cornersList = corners();
+        cornersList.erase( cornersList.begin() + aIdx );
     }
 
     void DeleteCorners( int aIdFirstCorner, int aIdLastCorner )
     {
-        m_cornersList.erase( m_cornersList.begin() + aIdFirstCorner,
-                             m_cornersList.begin() + aIdLastCorner + 1 );
+        CORNERS& cornersList = corners();
+        cornersList.erase( cornersList.begin() + aIdFirstCorner,
+                           cornersList.begin() + aIdLastCorner + 1 );
     }
 
     void Append( const CPOLYGONS_LIST& aList )
     {
-        m_cornersList.insert( m_cornersList.end(),
-                              aList.m_cornersList.begin(),
-                              aList.m_cornersList.end() );
+        // Appending to an empty list is a copy: share the corners
+        if( m_cornersList->empty() )
+        {
+            m_cornersList = aList.m_cornersList;
+            return;
+        }
+
+        CORNERS& cornersList = corners();
+        cornersList.insert( cornersList.end(),
+                            aList.m_cornersList->begin(),
+                            aList.m_cornersList->end() );
     }
 
     void Append( const CPolyPt& aItem )
     {
-        m_cornersList.push_back( aItem );
+        corners().push_back( aItem );
     }
 
     void Append( const wxPoint& aItem )
     {
         CPolyPt item( aItem );
 
-        m_cornersList.push_back( aItem );
+        corners().push_back( aItem );
     }
 
     void InsertCorner( int aPosition, const CPolyPt& aItem )
     {
-        m_cornersList.insert( m_cornersList.begin() + aPosition + 1, aItem );
+        CORNERS& cornersList = corners();
+        cornersList.insert( cornersList.begin() + aPosition + 1, aItem );
     }
 
     /**
@@ -193,7 +248,7 @@ public:
      */
     void    AddCorner( const CPolyPt& aCorner )
     {
-        m_cornersList.push_back( aCorner );
+        corners().push_back( aCorner );
     }
 
     /**
@@ -202,8 +257,8 @@ public:
      */
     void    CloseLastContour()
     {
-        if( m_cornersList.size() > 0 )
-            m_cornersList.back().end_contour = true;
+        if( m_cornersList->size() > 0 )
+            corners().back().end_contour = true;
     }
 
     /**
@@ -261,7 +316,7 @@ public:
      * @param aLinkHoles = if true, aResult contains only one polygon,
      * with holes linked by overlapping segments
      */
-    void InflateOutline( CPOLYGONS_LIST& aResult, int aInflateValue, bool aLinkHoles );
+    void InflateOutline( CPOLYGONS_LIST& aResult, int aInflateValue, bool aLinkHoles ) const;
 };
 
 class CPolyLine
@@ -322,7 +377,7 @@ public:
      * When a CPolyLine is self intersectic, it need to be normalized.
      * (converted to non intersecting polygons)
      */
-    bool        IsPolygonSelfIntersecting();
+    bool        IsPolygonSelfIntersecting() const;
 
     /**
      * Function Chamfer
@@ -330,7 +385,7 @@ public:
      * @param aDistance is the chamfering distance.
      * @return CPolyLine* - Pointer to new polygon.
      */
-    CPolyLine*  Chamfer( unsigned int aDistance );
+    CPolyLine*  Chamfer( unsigned int aDistance ) const;
 
     /**
      * Function Fillet
@@ -339,7 +394,7 @@ public:
      * @param aSegments is the number of segments / fillet.
      * @return CPolyLine* - Pointer to new polygon.
      */
-    CPolyLine*  Fillet( unsigned int aRadius, unsigned int aSegments );
+    CPolyLine*  Fillet( unsigned int aRadius, unsigned int aSegments ) const;
 
     /**
      * Function RemoveNullSegments
@@ -362,23 +417,23 @@ public:
     /**
      * @return the full bounding box of polygons
      */
-    const EDA_RECT GetBoundingBox();
+    const EDA_RECT GetBoundingBox() const;
 
     /**
      * @return the bounding box of a given polygon
      * @param icont = the index of the polygon contour
      * (0 = main contour, 1 ... n = other contours, usually holes)
      */
-    const EDA_RECT GetBoundingBox( int icont );
+    const EDA_RECT GetBoundingBox( int icont ) const;
 
     void        Copy( const CPolyLine* src );
-    bool        TestPointInside( int x, int y );
+    bool        TestPointInside( int x, int y ) const;
 
     /**
      * @return true if the corner aCornerIdx is on a hole inside the main outline
      * and false if it is on the main outline
      */
-    bool        IsCutoutContour( int aCornerIdx );
+    bool        IsCutoutContour( int aCornerIdx ) const;
 
     /**
      * Function AppendArc.
@@ -398,7 +453,7 @@ public:
     /**
      * @return true if the last corner in corners list is flagged end_contour
      */
-    bool        GetClosed();
+    bool        GetClosed() const;
 
     /**
      * Function GetContoursCount.
@@ -412,28 +467,28 @@ public:
      * @return the contour number containing the corner ic
      * @param ic = the index of the corner in the corner list
      */
-    int         GetContour( int ic );
+    int         GetContour( int ic ) const;
 
     /**
      * Function GetContourStart.
      * @return the index of the first corner (in corners list) of a contour
      * @param icont = the index of the contour
      */
-    int         GetContourStart( int icont );
+    int         GetContourStart( int icont ) const;
 
     /**
      * Function GetContourEnd.
      * @return the index of the last corner (in corners list) of a contour
      * @param icont = the index of the contour
      */
-    int         GetContourEnd( int icont );
+    int         GetContourEnd( int icont ) const;
 
     /**
      * Function GetContourSize.
      * @return the corners count of a contour
      * @param icont = the index of the contour
      */
-    int         GetContourSize( int icont );
+    int         GetContourSize( int icont ) const;
 
     int        GetX( int ic ) const { return m_CornersList.GetX( ic ); }
     int        GetY( int ic ) const { return m_CornersList.GetY( ic ); }
@@ -506,7 +561,7 @@ public:
      * @return int = distance between the point and outline.
      *               0 if the point is inside
      */
-    int     Distance( const wxPoint& aPoint );
+    int     Distance( const wxPoint& aPoint ) const;
 
     /**
      * Function Distance
@@ -517,7 +572,7 @@ public:
      * @return int = distance between the segment and outline.
      *               0 if segment intersects or is inside
      */
-    int     Distance( wxPoint aStart, wxPoint aEnd, int aWidth );
+    int     Distance( wxPoint aStart, wxPoint aEnd, int aWidth ) const;
 
     /**
      * Function HitTestForEdge
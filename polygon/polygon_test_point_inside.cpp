@@ -28,7 +28,9 @@
 
 #include <cmath>
 #include <vector>
+#include <algorithm>
 #include <PolyLine.h>
+#include <polygon_test_point_inside.h>
 
 /* this algo uses the the Jordan curve theorem to find if a point is inside or outside a polygon:
  * It run a semi-infinite line horizontally (increasing x, fixed y)
@@ -50,6 +52,49 @@
 #define OUTSIDE false
 #define INSIDE true
 
+/* Returns true if the segment from (seg_startX, seg_startY) to (seg_endX, seg_endY) is crossed
+ * by the semi-infinite horizontal line from (aRefx, aRefy) to increasing x, following the rules
+ * above about the segment ends.
+ */
+static inline bool crossesRay( int seg_startX, int seg_startY, int seg_endX, int seg_endY,
+                               int aRefx, int aRefy )
+{
+    /* Trivial cases: skip if ref above or below the segment to test */
+    if( ( seg_startY > aRefy ) && (seg_endY > aRefy ) )
+        return false;
+
+    // segment below ref point, or one of its ends has the same Y pos as the ref point: skip
+    // So we eliminate one end point of 2 consecutive segments.
+    // Note: also we skip horizontal segments if ref point is on this horizontal line
+    // So reference points on horizontal segments outlines always are seen as outside the polygon
+    if( ( seg_startY <= aRefy ) && (seg_endY <= aRefy ) )
+        return false;
+
+    /* refy is between seg_startY and seg_endY.
+     * note: here: horizontal segments (seg_startY == seg_endY) are skipped,
+     * either by the first test or by the second test
+     * see if an horizontal semi infinite line from refx is intersecting the segment
+     */
+
+    // calculate the x position of the intersection of this segment and the semi infinite line
+    // this is more easier if we move the X,Y axis origin to the segment start point:
+    seg_endX -= seg_startX;
+    seg_endY -= seg_startY;
+    double newrefx = (double) (aRefx - seg_startX);
+    double newrefy = (double) (aRefy - seg_startY);
+
+    // Now calculate the x intersection coordinate of the line from (0,0) to (seg_endX,seg_endY)
+    // with the horizontal line at the new refy position
+    // the line slope  = seg_endY/seg_endX;
+    // and the x pos relative to the new origin is intersec_x = refy/slope
+    // Note: because horizontal segments are skipped, 1/slope exists (seg_endY never == O)
+    double intersec_x = (newrefy * seg_endX) / seg_endY;
+
+    // Intersection found with the semi-infinite line from refx to infinite
+    return newrefx < intersec_x;
+}
+
+
 bool TestPointInsidePolygon( const CPOLYGONS_LIST& aPolysList,
                              int             aIdxstart,
                              int             aIdxend,
@@ -74,42 +119,8 @@ bool TestPointInsidePolygon( const CPOLYGONS_LIST& aPolysList,
     // find all intersection points of line with polyline sides
     for( ics = aIdxstart, ice = aIdxend; ics <= aIdxend; ice = ics++ )
     {
-        int seg_startX = aPolysList.GetX( ics );
-        int seg_startY = aPolysList.GetY( ics );
-        int seg_endX   = aPolysList.GetX( ice );
-        int seg_endY   = aPolysList.GetY( ice );
-
-        /* Trivial cases: skip if ref above or below the segment to test */
-        if( ( seg_startY > aRefy ) && (seg_endY > aRefy ) )
-            continue;
-
-        // segment below ref point, or one of its ends has the same Y pos as the ref point: skip
-        // So we eliminate one end point of 2 consecutive segments.
-        // Note: also we skip horizontal segments if ref point is on this horizontal line
-        // So reference points on horizontal segments outlines always are seen as outside the polygon
-        if( ( seg_startY <= aRefy ) && (seg_endY <= aRefy ) )
-            continue;
-
-        /* refy is between seg_startY and seg_endY.
-         * note: here: horizontal segments (seg_startY == seg_endY) are skipped,
-         * either by the first test or by the second test
-         * see if an horizontal semi infinite line from refx is intersecting the segment
-         */
-
-        // calculate the x position of the intersection of this segment and the semi infinite line
-        // this is more easier if we move the X,Y axis origin to the segment start point:
-        seg_endX -= seg_startX;
-        seg_endY -= seg_startY;
-        double newrefx = (double) (aRefx - seg_startX);
-        double newrefy = (double) (aRefy - seg_startY);
-
-        // Now calculate the x intersection coordinate of the line from (0,0) to (seg_endX,seg_endY)
-        // with the horizontal line at the new refy position
-        // the line slope  = seg_endY/seg_endX;
-        // and the x pos relative to the new origin is intersec_x = refy/slope
-        // Note: because horizontal segments are skipped, 1/slope exists (seg_endY never == O)
-        double intersec_x = (newrefy * seg_endX) / seg_endY;
-        if( newrefx < intersec_x )  // Intersection found with the semi-infinite line from refx to infinite
+        if( crossesRay( aPolysList.GetX( ics ), aPolysList.GetY( ics ),
+                        aPolysList.GetX( ice ), aPolysList.GetY( ice ), aRefx, aRefy ) )
             count++;
     }
 
@@ -128,44 +139,132 @@ bool TestPointInsidePolygon( const wxPoint *aPolysList, int aCount, const wxPoin
     // find all intersection points of line with polyline sides
     for( ics = 0, ice = aCount-1; ics < aCount; ice = ics++ )
     {
-        int seg_startX = aPolysList[ics].x;
-        int seg_startY = aPolysList[ics].y;
-        int seg_endX   = aPolysList[ice].x;
-        int seg_endY   = aPolysList[ice].y;
+        if( crossesRay( aPolysList[ics].x, aPolysList[ics].y,
+                        aPolysList[ice].x, aPolysList[ice].y, aRefPoint.x, aRefPoint.y ) )
+            count++;
+    }
 
-        /* Trivial cases: skip if ref above or below the segment to test */
-        if( ( seg_startY > aRefPoint.y ) && (seg_endY > aRefPoint.y ) )
+    return count & 1 ? INSIDE : OUTSIDE;
+}
+
+
+POLYGON_EDGE_INDEX::POLYGON_EDGE_INDEX( const CPOLYGONS_LIST& aPolysList,
+                                        int aIdxstart, int aIdxend ) :
+    m_polysList( aPolysList ), m_idxstart( aIdxstart ), m_idxend( aIdxend )
+{
+    m_ymin = m_ymax = aPolysList.GetY( aIdxstart );
+
+    for( int ii = aIdxstart; ii <= aIdxend; ii++ )
+    {
+        m_ymin = std::min( m_ymin, aPolysList.GetY( ii ) );
+        m_ymax = std::max( m_ymax, aPolysList.GetY( ii ) );
+    }
+
+    int edgeCount = aIdxend - aIdxstart + 1;
+    m_slabCount = std::min( edgeCount / EDGES_PER_SLAB + 1, MAX_SLAB_COUNT );
+
+    // Each edge is stored in all the slabs between its ends: first count the edges of each
+    // slab, then store them.  The edges spanning more than MAX_SLABS_PER_EDGE slabs are kept
+    // apart and tested for every point, so the index holds at most MAX_SLABS_PER_EDGE
+    // entries per edge
+    m_slabStart.assign( m_slabCount + 1, 0 );
+
+    for( int ics = aIdxstart, ice = aIdxend; ics <= aIdxend; ice = ics++ )
+    {
+        int first, last;
+        edgeSlabs( ics, ice, first, last );
+
+        if( last - first >= MAX_SLABS_PER_EDGE )
+        {
+            m_longEdges.push_back( ics );
             continue;
+        }
+
+        for( int slab = first; slab <= last; slab++ )
+            m_slabStart[slab + 1]++;
+    }
+
+    // When most edges are long, the slabs would not skip much: test all the edges
+    if( (int) m_longEdges.size() * 2 > edgeCount )
+    {
+        m_slabCount = 1;
+        m_slabStart.assign( 2, 0 );
+        m_longEdges.clear();
+
+        for( int ics = aIdxstart; ics <= aIdxend; ics++ )
+            m_longEdges.push_back( ics );
 
-        // segment below ref point, or one of its ends has the same Y pos as the ref point: skip
-        // So we eliminate one end point of 2 consecutive segments.
-        // Note: also we skip horizontal segments if ref point is on this horizontal line
-        // So reference points on horizontal segments outlines always are seen as outside the polygon
-        if( ( seg_startY <= aRefPoint.y ) && (seg_endY <= aRefPoint.y ) )
+        return;
+    }
+
+    for( int slab = 0; slab < m_slabCount; slab++ )
+        m_slabStart[slab + 1] += m_slabStart[slab];
+
+    m_edges.resize( m_slabStart[m_slabCount] );
+
+    std::vector<int> fill( m_slabStart.begin(), m_slabStart.end() - 1 );
+
+    for( int ics = aIdxstart, ice = aIdxend; ics <= aIdxend; ice = ics++ )
+    {
+        int first, last;
+        edgeSlabs( ics, ice, first, last );
+
+        if( last - first >= MAX_SLABS_PER_EDGE )
             continue;
 
-        /* refy is between seg_startY and seg_endY.
-         * note: here: horizontal segments (seg_startY == seg_endY) are skipped,
-         * either by the first test or by the second test
-         * see if an horizontal semi infinite line from refx is intersecting the segment
-         */
-
-        // calculate the x position of the intersection of this segment and the semi infinite line
-        // this is more easier if we move the X,Y axis origin to the segment start point:
-        seg_endX -= seg_startX;
-        seg_endY -= seg_startY;
-        double newrefx = (double) (aRefPoint.x - seg_startX);
-        double newrefy = (double) (aRefPoint.y - seg_startY);
-
-        // Now calculate the x intersection coordinate of the line from (0,0) to (seg_endX,seg_endY)
-        // with the horizontal line at the new refy position
-        // the line slope  = seg_endY/seg_endX;
-        // and the x pos relative to the new origin is intersec_x = refy/slope
-        // Note: because horizontal segments are skipped, 1/slope exists (seg_endY never == O)
-        double intersec_x = (newrefy * seg_endX) / seg_endY;
-        if( newrefx < intersec_x )  // Intersection found with the semi-infinite line from refx to infinite
+        for( int slab = first; slab <= last; slab++ )
+            m_edges[fill[slab]++] = ics;
+    }
+}
+
+
+int POLYGON_EDGE_INDEX::slab( int aY ) const
+{
+    return (int) ( (long long) ( aY - m_ymin ) * m_slabCount / ( (long long) m_ymax - m_ymin + 1 ) );
+}
+
+
+void POLYGON_EDGE_INDEX::edgeSlabs( int aIcs, int aIce, int& aFirst, int& aLast ) const
+{
+    int ys = m_polysList.GetY( aIcs );
+    int ye = m_polysList.GetY( aIce );
+
+    aFirst = slab( std::min( ys, ye ) );
+    aLast  = slab( std::max( ys, ye ) );
+}
+
+
+bool POLYGON_EDGE_INDEX::TestPointInside( int aRefx, int aRefy ) const
+{
+    // Only the edges with an end above the point and the other one below or at the same
+    // height can be crossed, so there is nothing to cross outside of [m_ymin, m_ymax[
+    if( aRefy < m_ymin || aRefy >= m_ymax )
+        return OUTSIDE;
+
+    int s = slab( aRefy );
+    int count = 0;
+
+    // The slab holds every short edge whose Y range includes aRefy
+    for( int ii = m_slabStart[s]; ii < m_slabStart[s + 1]; ii++ )
+    {
+        if( crossesEdge( m_edges[ii], aRefx, aRefy ) )
+            count++;
+    }
+
+    for( unsigned ii = 0; ii < m_longEdges.size(); ii++ )
+    {
+        if( crossesEdge( m_longEdges[ii], aRefx, aRefy ) )
             count++;
     }
 
     return count & 1 ? INSIDE : OUTSIDE;
 }
+
+
+bool POLYGON_EDGE_INDEX::crossesEdge( int aIcs, int aRefx, int aRefy ) const
+{
+    int ice = ( aIcs == m_idxstart ) ? m_idxend : aIcs - 1;
+
+    return crossesRay( m_polysList.GetX( aIcs ), m_polysList.GetY( aIcs ),
+                       m_polysList.GetX( ice ), m_polysList.GetY( ice ), aRefx, aRefy );
+}
@@ -22,6 +22,11 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#ifndef POLYGON_TEST_POINT_INSIDE_H
+#define POLYGON_TEST_POINT_INSIDE_H
+
+#include <vector>
+
 #ifndef __WXWINDOWS__
 // define here wxPoint if we want to compile outside wxWidgets
 class wxPoint
@@ -57,3 +62,63 @@ bool TestPointInsidePolygon( const CPOLYGONS_LIST& aPolysList,
 bool TestPointInsidePolygon( const wxPoint* aPolysList,
                              int      aCount,
                              const wxPoint  &aRefPoint );
+
+/**
+ * Class POLYGON_EDGE_INDEX
+ * sorts the edges of a polygon of a CPOLYGONS_LIST into horizontal slabs, to test many points
+ * against the same polygon. Only the edges of the slab of a point are tested, instead of all
+ * the edges of the polygon. The results are the same as TestPointInsidePolygon() ones.
+ * The edges spanning many slabs are tested for every point instead of being stored in each
+ * slab, and all the edges are tested when most of them are long.
+ * The polygon must not be modified while the index is used.
+ */
+class POLYGON_EDGE_INDEX
+{
+public:
+    /**
+     * Constructor
+     * @param aPolysList: the list of polygons
+     * @param aIdxstart: the starting point of the polygon in aPolysList.
+     * @param aIdxend: the ending point of the polygon in aPolysList.
+     */
+    POLYGON_EDGE_INDEX( const CPOLYGONS_LIST& aPolysList, int aIdxstart, int aIdxend );
+
+    /**
+     * Function TestPointInside
+     * test if a point is inside or outside the polygon.
+     * @param aRefx, aRefy: the point coordinate to test
+     * @return true if the point is inside, false for outside
+     */
+    bool TestPointInside( int aRefx, int aRefy ) const;
+
+private:
+    ///> Average number of edges per slab
+    static const int EDGES_PER_SLAB = 4;
+
+    ///> Maximal number of slabs
+    static const int MAX_SLAB_COUNT = 4096;
+
+    ///> Maximal number of slabs an edge is stored in: longer edges go in m_longEdges
+    static const int MAX_SLABS_PER_EDGE = 16;
+
+    ///> Returns the slab of a Y coordinate between m_ymin and m_ymax
+    int slab( int aY ) const;
+
+    ///> Returns the first and last slabs of the edge from corner aIce to corner aIcs
+    void edgeSlabs( int aIcs, int aIce, int& aFirst, int& aLast ) const;
+
+    ///> Returns true if the edge ending at corner aIcs crosses the ray from aRefx, aRefy
+    bool crossesEdge( int aIcs, int aRefx, int aRefy ) const;
+
+    const CPOLYGONS_LIST&   m_polysList;
+    int                     m_idxstart;
+    int                     m_idxend;
+    int                     m_ymin;             ///< Y range of the polygon
+    int                     m_ymax;
+    int                     m_slabCount;
+    std::vector<int>        m_slabStart;        ///< First edge of each slab in m_edges
+    std::vector<int>        m_edges;            ///< Start corner of the edges, slab by slab
+    std::vector<int>        m_longEdges;        ///< Start corner of the edges tested for all points
+};
+
+#endif      // POLYGON_TEST_POINT_INSIDE_H
@@ -0,0 +1,72 @@
+#!/usr/bin/env python
+#
+# Times BOARD::GetViaByPosition() on synthetic boards of increasing size, to check
+# the BOARD locate functions do not walk the whole item lists.
+#
+# usage: python board_lookup_benchmark.py [item count...]
+#
+
+import random
+import sys
+import time
+
+import pcbnew
+
+# number of lookups timed on each board
+LOOKUPS = 10000
+
+# BOARD::Add() flag appending the item instead of searching where to insert it
+ADD_APPEND = 1
+
+
+def grid_board( items ):
+    """A board with a grid of vias, half of them joined by a track."""
+    board = pcbnew.BOARD()
+    pitch = pcbnew.FromMM( 1.0 )
+    side = int( items ** 0.5 )
+    positions = []
+
+    for i in range( items ):
+        pos = pcbnew.wxPoint( ( i % side ) * pitch, ( i // side ) * pitch )
+
+        if i % 2:
+            track = pcbnew.TRACK( board )
+            track.SetStart( pos )
+            track.SetEnd( pcbnew.wxPoint( pos.x + pitch // 2, pos.y ) )
+            board.Add( track, ADD_APPEND )
+        else:
+            via = pcbnew.VIA( board )
+            via.SetPosition( pos )
+            board.Add( via, ADD_APPEND )
+            positions.append( pos )
+
+    return board, positions
+
+
+def time_lookups( board, positions ):
+    random.seed( 1 )
+    points = [ random.choice( positions ) for i in range( LOOKUPS ) ]
+
+    start = time.time()
+
+    for pos in points:
+        if board.GetViaByPosition( pos ) is None:
+            raise AssertionError( "via not found" )
+
+    return ( time.time() - start ) * 1e6 / LOOKUPS
+
+
+def main( sizes ):
+    if not sizes:
+        sizes = [ 12500, 50000, 200000 ]
+
+    print( "%10s %16s" % ( "items", "via lookup" ) )
+
+    for items in sizes:
+        board, positions = grid_board( items )
+
+        print( "%10d %13.1f us" % ( items, time_lookups( board, positions ) ) )
+
+
+if __name__ == '__main__':
+    main( [ int( arg ) for arg in sys.argv[1:] ] )
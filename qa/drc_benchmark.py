@@ -0,0 +1,116 @@
+#!/usr/bin/env python
+#
+# Times the DRC track clearance tests with the full sweep (each segment tested against
+# all the following segments and all the pads) and with DRC_ITEM_INDEX (each segment
+# tested against the items near it only), on the demo boards and on a synthetic board.
+# Both must find the same markers.
+#
+# usage: python drc_benchmark.py [board files...]
+#        python drc_benchmark.py --bus [segment count]
+#
+# --bus times a synthetic board only: rows of tracks of alternating nets, a few of
+# them too close to the next one, with a via at the end of each row.
+#
+
+import glob
+import os
+import sys
+import time
+
+import pcbnew
+
+# default size of the synthetic board
+BUS_SEGMENTS = 10000
+
+# segments per row of the synthetic board
+ROW_SEGMENTS = 50
+
+DEMOS_DIR = os.path.join( os.path.dirname( os.path.abspath( __file__ ) ), '..', 'demos' )
+
+
+def bus_board( segments ):
+    board = pcbnew.BOARD()
+    nets = []
+
+    for name in [ "BUS_A", "BUS_B" ]:
+        net = pcbnew.NETINFO_ITEM( board, name )
+        board.AppendNet( net )
+        nets.append( net.GetNet() )
+
+    board.SynchronizeNetsAndNetClasses()
+
+    length = pcbnew.FromMM( 2.0 )
+    y = 0
+
+    for row in range( ( segments + ROW_SEGMENTS - 1 ) // ROW_SEGMENTS ):
+        # rows are 0.25 mm apart, every 20th one only 0.1 mm
+        y += pcbnew.FromMM( 0.35 if row % 20 == 19 else 0.5 )
+        net = nets[row % 2]
+
+        for i in range( ROW_SEGMENTS ):
+            track = pcbnew.TRACK( board )
+            track.SetStart( pcbnew.wxPoint( i * length, y ) )
+            track.SetEnd( pcbnew.wxPoint( ( i + 1 ) * length, y ) )
+            track.SetWidth( pcbnew.FromMM( 0.25 ) )
+            track.SetNetCode( net )
+            board.Add( track )
+
+        via = pcbnew.VIA( board )
+        via.SetPosition( pcbnew.wxPoint( ROW_SEGMENTS * length, y ) )
+        via.SetWidth( pcbnew.FromMM( 0.6 ) )
+        via.SetNetCode( net )
+        board.Add( via )
+
+    return board
+
+
+def time_tests( board, use_index ):
+    start = time.time()
+    report = pcbnew.TestTrackClearances( board, use_index )
+
+    return time.time() - start, report
+
+
+def benchmark( name, board ):
+    """Prints the speed of both paths, returns False if their markers differ."""
+    segments = max( board.GetNumSegmTrack() - 1, 0 )
+
+    sweep_time, sweep_report = time_tests( board, False )
+    index_time, index_report = time_tests( board, True )
+    markers = board.GetMARKERCount()
+
+    print( "%-40s %8d %8d %12.0f/s %12.0f/s" % ( name, segments, markers,
+            segments / max( sweep_time, 1e-6 ), segments / max( index_time, 1e-6 ) ) )
+
+    return sweep_report == index_report
+
+
+def main( boards ):
+    print( "%-40s %8s %8s %14s %14s" % ( "board", "segments", "markers", "sweep", "index" ) )
+
+    failed = []
+
+    for name, board in boards:
+        if not benchmark( name, board ):
+            failed.append( name )
+
+    if failed:
+        print( "the sweep and the index give different markers on: %s" % ", ".join( failed ) )
+        sys.exit( 1 )
+
+
+def demo_boards( files ):
+    if not files:
+        files = sorted( glob.glob( os.path.join( DEMOS_DIR, '*', '*.kicad_pcb' ) ) )
+
+    for name in files:
+        yield os.path.basename( name ), pcbnew.LoadBoard( name )
+
+
+if __name__ == '__main__':
+    if len( sys.argv ) > 1 and sys.argv[1] == '--bus':
+        segments = int( sys.argv[2] ) if len( sys.argv ) > 2 else BUS_SEGMENTS
+        main( [ ( "bus (synthetic)", bus_board( segments ) ) ] )
+    else:
+        main( list( demo_boards( sys.argv[1:] ) ) +
+              [ ( "bus (synthetic)", bus_board( BUS_SEGMENTS ) ) ] )
@@ -0,0 +1,282 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file netlist_connect_test.cpp
+ * @brief Compares the netlists built with the connection grid, with the sheet cache,
+ * and with the old connection pass (each item tested against all the next items of
+ * its sheet), on a generated multi-sheet schematic.
+ *
+ * The hierarchy has a root sheet and three sheets, two of them sharing the same
+ * screen.  Each screen is filled with random wires, buses, junctions, no connects,
+ * local, global, hierarchical and bus labels on a coarse grid, so many items touch.
+ * The sheets have pins matching the hierarchical labels.
+ * There are no components: their pins need the component libraries.
+ *
+ * The netlist of each build is written as text, one line per item with its sheet,
+ * type, position, net code, bus net code, connection type and net name, i.e. all the
+ * data the netlist exporters use.  The texts must be identical.  The cache is also
+ * checked after a sheet is modified.
+ *
+ * usage: netlist_connect_test [items per screen]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include <wx/init.h>
+
+#include <fctsys.h>
+#include <general.h>
+#include <class_sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+#include <sch_line.h>
+#include <sch_junction.h>
+#include <sch_no_connect.h>
+#include <sch_text.h>
+#include <class_netlist_object.h>
+
+// Default number of items per screen
+#define ITEM_COUNT      3000
+
+// Side of the area where the items are placed, in grid steps
+#define AREA_SIZE       60
+
+#define GRID_STEP       50
+
+#define HIERLABEL_COUNT 4
+
+
+static wxPoint randomPoint()
+{
+    return wxPoint( ( rand() % AREA_SIZE ) * GRID_STEP, ( rand() % AREA_SIZE ) * GRID_STEP );
+}
+
+
+static SCH_LINE* randomLine( int aLayer )
+{
+    SCH_LINE* line   = new SCH_LINE( randomPoint(), aLayer );
+    wxPoint   end    = line->GetStartPoint();
+    int       length = ( 1 + rand() % 8 ) * GRID_STEP;
+
+    if( rand() % 2 )
+        end.x += length;
+    else
+        end.y += length;
+
+    line->SetEndPoint( end );
+
+    return line;
+}
+
+
+/// Fills aScreen with aCount random items, and hierarchical labels if aHierLabels is true
+static void fillScreen( SCH_SCREEN* aScreen, int aCount, bool aHierLabels )
+{
+    for( int ii = 0; ii < aCount; ii++ )
+    {
+        int         kind = rand() % 100;
+        wxString    name;
+
+        if( kind < 50 )
+            aScreen->Append( randomLine( LAYER_WIRE ) );
+        else if( kind < 60 )
+            aScreen->Append( randomLine( LAYER_BUS ) );
+        else if( kind < 75 )
+            aScreen->Append( new SCH_JUNCTION( randomPoint() ) );
+        else if( kind < 80 )
+            aScreen->Append( new SCH_NO_CONNECT( randomPoint() ) );
+        else if( kind < 90 )
+        {
+            name.Printf( wxT( "L%d" ), rand() % 40 );
+            aScreen->Append( new SCH_LABEL( randomPoint(), name ) );
+        }
+        else if( kind < 95 )
+        {
+            name.Printf( wxT( "G%d" ), rand() % 10 );
+            aScreen->Append( new SCH_GLOBALLABEL( randomPoint(), name ) );
+        }
+        else
+        {
+            name.Printf( wxT( "D%d[0..3]" ), rand() % 4 );
+            aScreen->Append( new SCH_LABEL( randomPoint(), name ) );
+        }
+    }
+
+    if( !aHierLabels )
+        return;
+
+    for( int ii = 0; ii < HIERLABEL_COUNT; ii++ )
+    {
+        wxString name;
+
+        name.Printf( wxT( "H%d" ), ii );
+        aScreen->Append( new SCH_HIERLABEL( randomPoint(), name ) );
+    }
+}
+
+
+/// Adds a sheet using aScreen to the root screen, with a pin for each hierarchical label
+static SCH_SHEET* addSheet( SCH_SCREEN* aScreen, const wxString& aName, int aTimeStamp )
+{
+    SCH_SHEET* sheet = new SCH_SHEET( randomPoint() );
+
+    sheet->SetName( aName );
+    sheet->SetFileName( aName + wxT( ".sch" ) );
+    sheet->SetTimeStamp( aTimeStamp );
+    sheet->SetScreen( aScreen );
+
+    for( int ii = 0; ii < HIERLABEL_COUNT; ii++ )
+    {
+        wxString name;
+
+        name.Printf( wxT( "H%d" ), ii );
+        sheet->AddPin( new SCH_SHEET_PIN( sheet, randomPoint(), name ) );
+    }
+
+    g_RootSheet->GetScreen()->Append( sheet );
+
+    return sheet;
+}
+
+
+/// Formats the items of aList, in list order, with their connections
+static std::string formatNetlist( const NETLIST_OBJECT_LIST& aList )
+{
+    std::string text;
+
+    for( unsigned ii = 0; ii < aList.size(); ii++ )
+    {
+        const NETLIST_OBJECT* item = aList.GetItem( ii );
+        char                  line[256];
+
+        snprintf( line, sizeof( line ), " %d (%d %d) (%d %d) net %d bus %d member %d conn %d ",
+                  (int) item->m_Type, item->m_Start.x, item->m_Start.y,
+                  item->m_End.x, item->m_End.y,
+                  item->GetNet(), item->m_BusNetCode, item->m_Member,
+                  (int) item->m_ConnectionType );
+
+        text += TO_UTF8( item->m_SheetPath.PathHumanReadable() );
+        text += line;
+        text += TO_UTF8( item->m_Label );
+        text += " ";
+        text += TO_UTF8( item->GetNetName() );
+        text += "\n";
+    }
+
+    return text;
+}
+
+
+static std::string buildNetlist( NETLIST_SHEET_CACHE* aCache, bool aUseGrid )
+{
+    SCH_SHEET_LIST      sheets;
+    NETLIST_OBJECT_LIST list;
+
+    list.BuildNetListInfo( sheets, aCache, aUseGrid );
+
+    return formatNetlist( list );
+}
+
+
+/// Compares aNetlist with the reference, prints the first difference
+static bool compare( const char* aName, const std::string& aNetlist,
+                     const std::string& aReference )
+{
+    if( aNetlist == aReference )
+    {
+        printf( "%-28s identical (%u bytes)\n", aName, (unsigned) aNetlist.size() );
+        return true;
+    }
+
+    size_t diff = 0;
+
+    while( diff < aNetlist.size() && diff < aReference.size()
+           && aNetlist[diff] == aReference[diff] )
+        diff++;
+
+    size_t lineStart = aReference.rfind( '\n', diff );
+    lineStart = ( lineStart == std::string::npos ) ? 0 : lineStart + 1;
+
+    printf( "%-28s differs at offset %u:\n  got:      %s\n  expected: %s\n", aName,
+            (unsigned) diff,
+            aNetlist.substr( lineStart, aNetlist.find( '\n', diff ) - lineStart ).c_str(),
+            aReference.substr( lineStart, aReference.find( '\n', diff ) - lineStart ).c_str() );
+
+    return false;
+}
+
+
+int main( int argc, char** argv )
+{
+    wxInitializer initializer;
+
+    int itemCount = argc > 1 ? atoi( argv[1] ) : ITEM_COUNT;
+
+    srand( 1 );
+
+    g_RootSheet = new SCH_SHEET;
+    g_RootSheet->SetScreen( new SCH_SCREEN( NULL ) );
+
+    SCH_SCREEN* shared = new SCH_SCREEN( NULL );
+    SCH_SCREEN* single = new SCH_SCREEN( NULL );
+
+    fillScreen( g_RootSheet->GetScreen(), itemCount, false );
+    fillScreen( shared, itemCount, true );
+    fillScreen( single, itemCount, true );
+
+    // Two instances of the same screen, and one of another screen
+    addSheet( shared, wxT( "shared_a" ), 3 );
+    addSheet( shared, wxT( "shared_b" ), 1 );
+    addSheet( single, wxT( "single" ), 2 );
+
+    int errors = 0;
+
+    std::string reference = buildNetlist( NULL, false );
+
+    if( !compare( "connection grid", buildNetlist( NULL, true ), reference ) )
+        errors++;
+
+    NETLIST_SHEET_CACHE cache;
+
+    if( !compare( "sheet cache, empty", buildNetlist( &cache, true ), reference ) )
+        errors++;
+
+    if( !compare( "sheet cache, all cached", buildNetlist( &cache, true ), reference ) )
+        errors++;
+
+    // Modify one sheet: the other sheets are taken from the cache
+    fillScreen( single, itemCount / 10, false );
+    single->SetModify();
+
+    reference = buildNetlist( NULL, false );
+
+    if( !compare( "sheet cache, one modified", buildNetlist( &cache, true ), reference ) )
+        errors++;
+
+    delete g_RootSheet;
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,262 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+
+#include <class_board.h>
+#include <layers_id_colors_and_visibility.h>
+
+#include <router/pns_router.h>
+#include <router/pns_node.h>
+#include <router/pns_sizes_settings.h>
+
+#include "pns_log_player.h"
+
+PNS_LOG_PLAYER::PNS_LOG_PLAYER() :
+    m_trackWidth( 0 ),
+    m_viaDiameter( 0 ),
+    m_viaDrill( 0 ),
+    m_missingItems( 0 ),
+    m_routes( 0 ),
+    m_fixedRoutes( 0 )
+{
+}
+
+
+PNS_LOG_PLAYER::~PNS_LOG_PLAYER()
+{
+}
+
+
+bool PNS_LOG_PLAYER::Load( const std::string& aFilename )
+{
+    std::ifstream f( aFilename.c_str() );
+    std::string line;
+
+    if( !f )
+        return false;
+
+    m_events.clear();
+
+    while( std::getline( f, line ) )
+    {
+        std::istringstream s( line );
+        std::string type;
+        EVENT ev;
+
+        // item dumps and groups are not replayed
+        if( !( s >> type ) || type != "event" )
+            continue;
+
+        s >> ev.name >> ev.pos.x >> ev.pos.y >> ev.arg >> ev.itemKind >> ev.itemNet
+          >> ev.itemLayerStart >> ev.itemLayerEnd;
+
+        if( s.fail() )
+            continue;
+
+        m_events.push_back( ev );
+    }
+
+    return !m_events.empty();
+}
+
+
+void PNS_LOG_PLAYER::Replay( BOARD* aBoard )
+{
+    PNS_ROUTER router;
+    PNS_NODE_STATS stats;
+
+    m_steps.clear();
+    m_missingItems = 0;
+    m_routes = 0;
+    m_fixedRoutes = 0;
+
+    router.SetBoard( aBoard );
+    router.SetEventLogging( true );
+    router.SyncWorld();
+    router.GetWorld()->SetStats( &stats );
+
+    BOOST_FOREACH( const EVENT& ev, m_events )
+    {
+        if( ev.name != "move" )
+        {
+            replayEvent( router, aBoard, ev );
+            continue;
+        }
+
+        if( !router.RoutingInProgress() )
+            continue;
+
+        PNS_ITEM* endItem = findItem( router, ev );
+
+        stats.Reset();
+        router.Move( ev.pos, endItem );
+
+        STEP step;
+        step.queries = stats.Queries();
+        step.depth = stats.PeakDepth();
+        m_steps.push_back( step );
+    }
+
+    router.StopRouting();
+    router.GetWorld()->SetStats( NULL );
+
+    // the router log has the time taken by each move
+    m_moveTimes = router.EventLog().LatencyReport( "move" );
+}
+
+
+void PNS_LOG_PLAYER::replayEvent( PNS_ROUTER& aRouter, BOARD* aBoard, const EVENT& aEvent )
+{
+    if( aEvent.name == "mode" )
+    {
+        aRouter.SetMode( (PNS_ROUTER_MODE) aEvent.pos.x );
+        aRouter.Settings().SetMode( (PNS_MODE) aEvent.pos.y );
+    }
+    else if( aEvent.name == "sizes" )
+    {
+        m_trackWidth = aEvent.pos.x;
+        m_viaDiameter = aEvent.pos.y;
+        m_viaDrill = aEvent.arg;
+
+        if( aRouter.RoutingInProgress() )
+        {
+            PNS_SIZES_SETTINGS sizes( aRouter.Sizes() );
+
+            sizes.SetTrackWidth( m_trackWidth );
+            sizes.SetViaDiameter( m_viaDiameter );
+            sizes.SetViaDrill( m_viaDrill );
+            aRouter.UpdateSizes( sizes );
+        }
+    }
+    else if( aEvent.name == "route" )
+    {
+        PNS_ITEM* startItem = findItem( aRouter, aEvent );
+        PNS_SIZES_SETTINGS sizes( aRouter.Sizes() );
+
+        // as done by the router tool, then with the recorded sizes
+        sizes.Init( aBoard, startItem );
+        sizes.AddLayerPair( F_Cu, B_Cu );
+
+        if( m_trackWidth > 0 )
+        {
+            sizes.SetTrackWidth( m_trackWidth );
+            sizes.SetViaDiameter( m_viaDiameter );
+            sizes.SetViaDrill( m_viaDrill );
+        }
+
+        aRouter.UpdateSizes( sizes );
+
+        if( aRouter.StartRouting( aEvent.pos, startItem, aEvent.arg ) )
+            m_routes++;
+    }
+    else if( aEvent.name == "drag" )
+    {
+        if( aRouter.StartDragging( aEvent.pos, findItem( aRouter, aEvent ) ) )
+            m_routes++;
+    }
+    else if( aEvent.name == "fix" )
+    {
+        if( aRouter.RoutingInProgress() && aRouter.FixRoute( aEvent.pos, findItem( aRouter, aEvent ) ) )
+            m_fixedRoutes++;
+    }
+    else if( aEvent.name == "layer" )
+    {
+        aRouter.SwitchLayer( aEvent.arg );
+    }
+    else if( aEvent.name == "via" )
+    {
+        if( aRouter.IsPlacingVia() != ( aEvent.arg != 0 ) )
+            aRouter.ToggleViaPlacement();
+    }
+    else if( aEvent.name == "posture" )
+    {
+        aRouter.FlipPosture();
+    }
+    else if( aEvent.name == "stop" )
+    {
+        aRouter.StopRouting();
+    }
+}
+
+
+PNS_ITEM* PNS_LOG_PLAYER::findItem( PNS_ROUTER& aRouter, const EVENT& aEvent )
+{
+    if( aEvent.itemKind == 0 )
+        return NULL;
+
+    const PNS_ITEMSET candidates = aRouter.QueryHoverItems( aEvent.pos );
+    PNS_ITEM* found = NULL;
+
+    BOOST_FOREACH( PNS_ITEM* item, candidates.CItems() )
+    {
+        if( item->Kind() != aEvent.itemKind || item->Net() != aEvent.itemNet )
+            continue;
+
+        // no recorded layers: any layer matches
+        if( aEvent.itemLayerStart < 0 )
+            return item;
+
+        const PNS_LAYERSET& layers = item->Layers();
+
+        if( layers.Start() == aEvent.itemLayerStart && layers.End() == aEvent.itemLayerEnd )
+            return item;
+
+        if( !found && layers.Overlaps( PNS_LAYERSET( aEvent.itemLayerStart, aEvent.itemLayerEnd ) ) )
+            found = item;
+    }
+
+    if( !found )
+        m_missingItems++;
+
+    return found;
+}
+
+
+const std::string PNS_LOG_PLAYER::Report() const
+{
+    std::stringstream report;
+    int maxQueries = 0, maxDepth = 0;
+    double totalQueries = 0;
+
+    BOOST_FOREACH( const STEP& step, m_steps )
+    {
+        totalQueries += step.queries;
+        maxQueries = std::max( maxQueries, step.queries );
+        maxDepth = std::max( maxDepth, step.depth );
+    }
+
+    report << m_moveTimes << std::endl;
+
+    report << "collision searches per move: average " <<
+              ( m_steps.empty() ? 0.0 : totalQueries / m_steps.size() ) <<
+              ", max " << maxQueries << std::endl;
+
+    report << "peak node depth: " << maxDepth << std::endl;
+
+    report << "routes: " << m_routes << " started, " << m_fixedRoutes << " fixed, " <<
+              m_missingItems << " recorded items not found" << std::endl;
+
+    return report.str();
+}
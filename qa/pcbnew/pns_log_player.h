@@ -0,0 +1,112 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_LOG_PLAYER_H
+#define __PNS_LOG_PLAYER_H
+
+#include <vector>
+#include <string>
+
+#include <math/vector2d.h>
+
+class BOARD;
+class PNS_ITEM;
+class PNS_ROUTER;
+
+/**
+ * Class PNS_LOG_PLAYER
+ *
+ * Replays the router events recorded by PNS_ROUTER (see PNS_ROUTER::EventLog()) on a
+ * board, without a view or an edit frame, and measures the time taken by each Move(),
+ * the number of collision searches it ran and the depth of the node tree it built.
+ * Used to benchmark the router (shove, walkaround, optimizer) on real boards.
+ *
+ * The board must be in the state it was when the events were recorded (i.e. when the
+ * router synchronized its world). Fixed routes are committed to the board.
+ **/
+class PNS_LOG_PLAYER
+{
+public:
+    PNS_LOG_PLAYER();
+    ~PNS_LOG_PLAYER();
+
+    /**
+     * Function Load()
+     *
+     * Reads the events from a log saved by PNS_LOGGER::Save().
+     * @return false if the file could not be read or contains no event.
+     */
+    bool Load( const std::string& aFilename );
+
+    /**
+     * Function Replay()
+     *
+     * Replays the loaded events on aBoard.
+     */
+    void Replay( BOARD* aBoard );
+
+    /**
+     * Function Report()
+     *
+     * Returns the statistics of the last replay, as a few lines of text.
+     */
+    const std::string Report() const;
+
+private:
+    struct EVENT
+    {
+        std::string name;
+        VECTOR2I    pos;
+        int         arg;
+        int         itemKind;
+        int         itemNet;
+        int         itemLayerStart;
+        int         itemLayerEnd;
+    };
+
+    ///> Statistics of a Move()
+    struct STEP
+    {
+        int         queries;
+        int         depth;
+    };
+
+    void replayEvent( PNS_ROUTER& aRouter, BOARD* aBoard, const EVENT& aEvent );
+
+    ///> Finds the item an event was applied to, or returns NULL if there was none
+    PNS_ITEM* findItem( PNS_ROUTER& aRouter, const EVENT& aEvent );
+
+    std::vector<EVENT> m_events;
+    std::vector<STEP> m_steps;
+
+    ///> Percentiles of the time taken by the moves (see PNS_LOGGER::LatencyReport())
+    std::string m_moveTimes;
+
+    ///> Track width, via diameter and via drill of the next routed track
+    int m_trackWidth, m_viaDiameter, m_viaDrill;
+
+    ///> Number of events whose item was not found on the board
+    int m_missingItems;
+
+    ///> Number of routes started and committed
+    int m_routes, m_fixedRoutes;
+};
+
+#endif    // __PNS_LOG_PLAYER_H
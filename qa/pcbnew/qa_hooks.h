@@ -0,0 +1,83 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file qa_hooks.h
+ * @brief Functions used by the qa tests and benchmarks.
+ *
+ * They are only built in the pcbnew python module (see KICAD_SCRIPTING_MODULES),
+ * not in pcbnew itself, and are available as pcbnew.<function_name> from python.
+ */
+
+#ifndef __QA_HOOKS_H
+#define __QA_HOOKS_H
+
+#include <wx/string.h>
+
+class BOARD;
+
+/**
+ * Function ProcessRatsnest
+ * rebuilds from scratch the ratsnest data of aBoard, as done after loading a board,
+ * and returns the time it took in milliseconds (used to benchmark the ratsnest).
+ * @param aBoard is the board to process.
+ * @param aThreadCount is the number of threads to use (0 means one per processor).
+ */
+double  ProcessRatsnest( BOARD* aBoard, int aThreadCount = 0 );
+
+/**
+ * Function TestTrackClearances
+ * deletes the markers of aBoard and runs the DRC track and via clearance tests on it,
+ * without an edit frame (used to check and benchmark the DRC, see
+ * DRC::TestTrackClearances()).
+ * @param aBoard is the board to test. The markers found are added to it.
+ * @param aUseIndex false to test each segment against all the following segments and
+ *  all the pads, instead of the items found near it by a DRC_ITEM_INDEX.
+ * @return the reports of the markers found, in the order they were added.
+ */
+wxString TestTrackClearances( BOARD* aBoard, bool aUseIndex = true );
+
+/**
+ * Function ReplayRouterLog
+ * replays on aBoard the router events saved in aLogFile (see PNS_ROUTER::DumpLog()),
+ * without an edit frame, and returns the statistics of the replay: time taken by the
+ * moves, collision searches per move and peak node depth (used to benchmark the router).
+ * @param aBoard is the board the events were recorded on. Fixed routes are added to it.
+ * @param aLogFile is the event log.
+ * @return the statistics, or an empty string if aLogFile could not be read.
+ */
+wxString ReplayRouterLog( BOARD* aBoard, wxString& aLogFile );
+
+/**
+ * Function BenchmarkSegmentCollisions
+ * tests random line chains, made of horizontal, vertical and diagonal segments as the router
+ * makes them, against random segments, circles and line chains, with the batched collision
+ * tests (see SEG_BATCH) and with the scalar tests they replace, and returns the time taken
+ * by both and the number of tests whose results differ (used to benchmark SEG_BATCH).
+ * @param aChainCount is the number of line chains.
+ * @param aSeed initializes the random generator.
+ * @return the timings and the number of mismatches, as a few lines of text.
+ */
+wxString BenchmarkSegmentCollisions( int aChainCount, int aSeed = 1 );
+
+#endif
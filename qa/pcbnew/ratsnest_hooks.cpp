@@ -0,0 +1,49 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file ratsnest_hooks.cpp
+ * @brief Ratsnest functions used by the qa benchmarks.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <ratsnest_data.h>
+#include <profile.h>
+
+#include "qa_hooks.h"
+
+
+double ProcessRatsnest( BOARD* aBoard, int aThreadCount )
+{
+    RN_DATA* ratsnest = aBoard->GetRatsnest();
+    prof_counter time;
+
+    ratsnest->SetThreadCount( aThreadCount );
+
+    prof_start( &time );
+    ratsnest->ProcessBoard();
+    prof_end( &time );
+
+    return time.msecs();
+}
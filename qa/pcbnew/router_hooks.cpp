@@ -0,0 +1,47 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file router_hooks.cpp
+ * @brief Router functions used by the qa benchmarks.
+ */
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <macros.h>
+
+#include "pns_log_player.h"
+#include "qa_hooks.h"
+
+
+wxString ReplayRouterLog( BOARD* aBoard, wxString& aLogFile )
+{
+    PNS_LOG_PLAYER player;
+
+    if( !player.Load( std::string( aLogFile.fn_str() ) ) )
+        return wxEmptyString;
+
+    player.Replay( aBoard );
+
+    return FROM_UTF8( player.Report().c_str() );
+}
@@ -0,0 +1,218 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file segment_collision_benchmark.cpp
+ * @brief Compares the batched collision tests of line chains (SEG_BATCH) with the
+ * scalar tests they replace.
+ */
+
+#include <stdlib.h>
+#include <sstream>
+#include <algorithm>
+
+#include <fctsys.h>
+#include <geometry/seg_batch.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_circle.h>
+#include <profile.h>
+#include <convert_to_biu.h>
+#include <macros.h>
+
+#include "qa_hooks.h"
+
+
+// The scalar collision tests, as SHAPE_LINE_CHAIN and CollideShapes() did them before
+// SEG_BATCH: the reference of BenchmarkSegmentCollisions().
+static bool scalarCollide( const SHAPE_LINE_CHAIN& aChain, const SEG& aSeg, int aClearance )
+{
+    BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
+    BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
+
+    for( int i = 0; i < aChain.SegmentCount(); i++ )
+    {
+        const SEG& s = aChain.CSegment( i );
+        BOX2I box_b( s.A, s.B - s.A );
+
+        if( box_a.SquaredDistance( box_b ) < dist_sq && s.Collide( aSeg, aClearance ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+static bool scalarCollide( const SHAPE_CIRCLE& aCircle, const SHAPE_LINE_CHAIN& aChain,
+                           int aClearance )
+{
+    for( int i = 0; i < aChain.SegmentCount(); i++ )
+    {
+        if( aCircle.Collide( aChain.CSegment( i ), aClearance ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+static bool scalarCollide( const SHAPE_LINE_CHAIN& aA, const SHAPE_LINE_CHAIN& aB,
+                           int aClearance )
+{
+    for( int i = 0; i < aB.SegmentCount(); i++ )
+    {
+        if( scalarCollide( aA, aB.CSegment( i ), aClearance ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+///> A random horizontal, vertical or diagonal vector, sometimes off by one unit
+static VECTOR2I randomDirection( int aMaxLength )
+{
+    static const int dirs[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 },
+                                    { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+    int len = 1 + rand() % aMaxLength;
+    int dir = rand() % 8;
+    VECTOR2I d( dirs[dir][0] * len, dirs[dir][1] * len );
+
+    if( rand() % 8 == 0 )
+        d.x += 1;
+
+    return d;
+}
+
+
+wxString BenchmarkSegmentCollisions( int aChainCount, int aSeed )
+{
+    const int area = Millimeter2iu( 100 );
+    const int maxLength = Millimeter2iu( 5 );
+    const int clearance = Millimeter2iu( 0.2 );
+    const int queries = 50;
+
+    std::vector<SHAPE_LINE_CHAIN> chains( aChainCount );
+    std::vector<SEG> segs;
+    std::vector<SHAPE_CIRCLE> circles;
+
+    srand( aSeed );
+
+    for( int i = 0; i < aChainCount; i++ )
+    {
+        VECTOR2I p( rand() % area, rand() % area );
+        int n = 2 + rand() % 64;
+
+        chains[i].Append( p );
+
+        for( int j = 0; j < n; j++ )
+        {
+            p += randomDirection( maxLength );
+            chains[i].Append( p );
+        }
+    }
+
+    for( int i = 0; i < queries; i++ )
+    {
+        VECTOR2I p( rand() % area, rand() % area );
+
+        segs.push_back( SEG( p, p + randomDirection( maxLength ) ) );
+        circles.push_back( SHAPE_CIRCLE( p, 1 + rand() % maxLength ) );
+    }
+
+    // every chain against every query, for each kind of test. The results are summed,
+    // so both paths must do all the work.
+    int mismatches = 0, hits = 0;
+    prof_counter segScalar, segBatch, circleScalar, circleBatch, chainScalar, chainBatch;
+    std::vector<char> ref( aChainCount * queries );
+    VECTOR2I mtv;
+
+    prof_start( &segScalar );
+
+    for( int i = 0; i < aChainCount; i++ )
+        for( int j = 0; j < queries; j++ )
+            ref[i * queries + j] = scalarCollide( chains[i], segs[j], clearance );
+
+    prof_end( &segScalar );
+    prof_start( &segBatch );
+
+    for( int i = 0; i < aChainCount; i++ )
+        for( int j = 0; j < queries; j++ )
+            mismatches += chains[i].Collide( segs[j], clearance ) != (bool) ref[i * queries + j];
+
+    prof_end( &segBatch );
+    hits += std::count( ref.begin(), ref.end(), 1 );
+
+    prof_start( &circleScalar );
+
+    for( int i = 0; i < aChainCount; i++ )
+        for( int j = 0; j < queries; j++ )
+            ref[i * queries + j] = scalarCollide( circles[j], chains[i], clearance );
+
+    prof_end( &circleScalar );
+    prof_start( &circleBatch );
+
+    for( int i = 0; i < aChainCount; i++ )
+        for( int j = 0; j < queries; j++ )
+            mismatches += CollideShapes( &circles[j], &chains[i], clearance, false, mtv ) !=
+                          (bool) ref[i * queries + j];
+
+    prof_end( &circleBatch );
+    hits += std::count( ref.begin(), ref.end(), 1 );
+
+    // each chain against the next ones
+    int pairs = std::min( aChainCount - 1, queries );
+
+    std::fill( ref.begin(), ref.end(), 0 );
+
+    prof_start( &chainScalar );
+
+    for( int i = 0; i < aChainCount; i++ )
+        for( int j = 1; j <= pairs; j++ )
+            ref[i * queries + j - 1] = scalarCollide( chains[i], chains[( i + j ) % aChainCount],
+                                                      clearance );
+
+    prof_end( &chainScalar );
+    prof_start( &chainBatch );
+
+    for( int i = 0; i < aChainCount; i++ )
+        for( int j = 1; j <= pairs; j++ )
+            mismatches += CollideShapes( &chains[i], &chains[( i + j ) % aChainCount], clearance,
+                                         false, mtv ) != (bool) ref[i * queries + j - 1];
+
+    prof_end( &chainBatch );
+    hits += std::count( ref.begin(), ref.end(), 1 );
+
+    std::stringstream report;
+
+    report << "kernel: " << SEG_BATCH::KernelName() << std::endl;
+    report << "segment vs chain: " << aChainCount * queries << " tests, scalar " <<
+              segScalar.msecs() << " ms, batched " << segBatch.msecs() << " ms" << std::endl;
+    report << "circle vs chain: " << aChainCount * queries << " tests, scalar " <<
+              circleScalar.msecs() << " ms, batched " << circleBatch.msecs() << " ms" << std::endl;
+    report << "chain vs chain: " << aChainCount * pairs << " tests, scalar " <<
+              chainScalar.msecs() << " ms, batched " << chainBatch.msecs() << " ms" << std::endl;
+    report << "collisions: " << hits << std::endl;
+    report << "mismatches: " << mismatches << std::endl;
+
+    return FROM_UTF8( report.str().c_str() );
+}
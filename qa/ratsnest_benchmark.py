@@ -0,0 +1,104 @@
+#!/usr/bin/env python
+#
+# Times the ratsnest computation (RN_DATA::ProcessBoard()) of the demo boards,
+# with a single thread and with one thread per processor.
+#
+# usage: python ratsnest_benchmark.py [board files...]
+#        python ratsnest_benchmark.py --grid [connection points]
+#
+# --grid times a synthetic board: a single net made of tracks joining the points
+# of a square grid, with every fourth track missing (i.e. many ratsnest lines).
+# It has GRID_POINTS connection points by default. The memory used by the ratsnest
+# is reported too: the peak during the rebuild, and the memory kept afterwards.
+#
+
+import glob
+import math
+import os
+import resource
+import sys
+
+import pcbnew
+
+# each board is processed several times, the best time is kept
+RUNS = 5
+
+# default size of the synthetic board
+GRID_POINTS = 100000
+
+DEMOS_DIR = os.path.join( os.path.dirname( os.path.abspath( __file__ ) ), '..', 'demos' )
+
+
+def best_time( board, threads ):
+    return min( pcbnew.ProcessRatsnest( board, threads ) for i in range( RUNS ) )
+
+
+def resident_kb():
+    # current resident memory (Linux only), ru_maxrss only gives the peak
+    try:
+        with open( '/proc/self/statm' ) as statm:
+            return int( statm.read().split()[1] ) * resource.getpagesize() // 1024
+    except IOError:
+        return 0
+
+
+def grid_board( points ):
+    board = pcbnew.BOARD()
+    net = pcbnew.NETINFO_ITEM( board, "GRID" )
+    board.AppendNet( net )
+
+    side = int( math.sqrt( points ) )
+    pitch = pcbnew.FromMM( 1.0 )
+
+    for i in range( points ):
+        if i % 4 == 3:
+            continue
+
+        x = ( i % side ) * pitch
+        y = ( i // side ) * pitch
+
+        track = pcbnew.TRACK( board )
+        track.SetStart( pcbnew.wxPoint( x, y ) )
+        track.SetEnd( pcbnew.wxPoint( x + pitch, y ) )
+        track.SetNetCode( net.GetNet() )
+        board.Add( track )
+
+    return board
+
+
+def main_grid( points ):
+    board = grid_board( points )
+
+    before = resource.getrusage( resource.RUSAGE_SELF ).ru_maxrss
+    resident = resident_kb()
+    single = best_time( board, 1 )
+    after = resource.getrusage( resource.RUSAGE_SELF ).ru_maxrss
+    kept = resident_kb() - resident
+    multi = best_time( board, 0 )
+
+    print( "%d connection points: rebuild %.1f ms (1 thread), %.1f ms (all threads)"
+           % ( points, single, multi ) )
+    print( "ratsnest memory: peak +%d kB, kept +%d kB" % ( after - before, kept ) )
+
+
+def main( files ):
+    if not files:
+        files = sorted( glob.glob( os.path.join( DEMOS_DIR, '*', '*.kicad_pcb' ) ) )
+
+    print( "%-40s %8s %12s %12s" % ( "board", "nets", "1 thread", "all threads" ) )
+
+    for name in files:
+        board = pcbnew.LoadBoard( name )
+
+        single = best_time( board, 1 )
+        multi = best_time( board, 0 )
+
+        print( "%-40s %8d %9.1f ms %9.1f ms" % ( os.path.basename( name ),
+                board.GetNetCount(), single, multi ) )
+
+
+if __name__ == '__main__':
+    if len( sys.argv ) > 1 and sys.argv[1] == '--grid':
+        main_grid( int( sys.argv[2] ) if len( sys.argv ) > 2 else GRID_POINTS )
+    else:
+        main( sys.argv[1:] )
@@ -0,0 +1,131 @@
+#!/usr/bin/env python
+#
+# Replays router events on a board, without the editor, and prints the time taken by
+# the moves, the collision searches per move and the peak node depth, for each
+# routing mode (shove, walkaround, smart).
+#
+# usage: python router_replay_benchmark.py [board event_log]
+#
+# The event log is saved by the router (/tmp/router_events.log, 'S' key while routing
+# in a debug build), and must be replayed on the board as it was when routing started.
+# Without arguments, a synthetic session is generated on data/complex_hierarchy.kicad_pcb:
+# tracks are routed between pads of the same net, across the existing tracks.
+#
+
+import os
+import sys
+import tempfile
+
+import pcbnew
+
+QA_DIR = os.path.dirname( os.path.abspath( __file__ ) )
+
+DEFAULT_BOARD = os.path.join( QA_DIR, 'data', 'complex_hierarchy.kicad_pcb' )
+
+# routing modes of PNS_ROUTING_SETTINGS (PNS_MODE)
+MODES = [ ( 1, 'shove' ), ( 2, 'walkaround' ), ( 3, 'smart' ) ]
+
+# PNS_ROUTER_MODE of single track routing, and PNS_ITEM kind of pads
+ROUTE_SINGLE = 1
+SOLID = 1
+
+# number of synthetic routes, and of moves for each of them
+ROUTES = 20
+MOVES = 50
+
+
+def event( name, pos, arg = 0, kind = 0, net = -1 ):
+    # the item layers are not recorded: any layer matches
+    return "event %s %d %d %d %d %d -1 -1 0\n" % ( name, pos[0], pos[1], arg, kind, net )
+
+
+def synthetic_log( board_file, log_file ):
+    board = pcbnew.LoadBoard( board_file )
+    pads = {}
+
+    for module in board.GetModules():
+        for pad in module.Pads():
+            if pad.GetNetCode() > 0 and pad.IsOnLayer( pcbnew.F_Cu ):
+                pads.setdefault( pad.GetNetCode(), [] ).append( pad )
+
+    # the most distant pads of each net give the longest routes
+    pairs = []
+
+    for net, net_pads in sorted( pads.items() ):
+        if len( net_pads ) < 2:
+            continue
+
+        pos = [ ( p.GetPosition().x, p.GetPosition().y ) for p in net_pads ]
+        a = min( pos )
+        b = max( pos )
+        pairs.append( ( net, a, b ) )
+
+    pairs = pairs[:ROUTES]
+
+    with open( log_file, 'w' ) as log:
+        log.write( event( 'mode', ( ROUTE_SINGLE, MODES[0][0] ) ) )
+
+        for net, a, b in pairs:
+            log.write( event( 'route', a, pcbnew.F_Cu, SOLID, net ) )
+
+            # an L shaped path, the cursor wobbling a bit around it
+            for i in range( 1, MOVES + 1 ):
+                t = float( i ) / MOVES
+                wobble = ( i % 3 - 1 ) * pcbnew.FromMM( 0.1 )
+
+                if t < 0.5:
+                    p = ( a[0] + ( b[0] - a[0] ) * 2 * t, a[1] + wobble )
+                else:
+                    p = ( b[0] + wobble, a[1] + ( b[1] - a[1] ) * ( 2 * t - 1 ) )
+
+                log.write( event( 'move', p ) )
+
+            log.write( event( 'move', b, 0, SOLID, net ) )
+            log.write( event( 'fix', b, 0, SOLID, net ) )
+            log.write( event( 'stop', b ) )
+
+    return len( pairs )
+
+
+def replay( board_file, log_file ):
+    for mode, name in MODES:
+        # each mode starts from the original board
+        board = pcbnew.LoadBoard( board_file )
+
+        mode_log = log_file + '.' + name
+
+        with open( log_file ) as src:
+            with open( mode_log, 'w' ) as dst:
+                for line in src:
+                    # the recorded routing mode is replaced, fields are:
+                    # event mode <router mode> <routing mode> ...
+                    if line.startswith( 'event mode ' ):
+                        fields = line.split()
+                        fields[3] = str( mode )
+                        line = ' '.join( fields ) + '\n'
+
+                    dst.write( line )
+
+        print( "%s:" % name )
+        print( pcbnew.ReplayRouterLog( board, mode_log ) )
+
+        os.remove( mode_log )
+
+
+def main( args ):
+    if len( args ) == 2:
+        replay( args[0], args[1] )
+        return
+
+    log_file = os.path.join( tempfile.gettempdir(), 'router_replay_benchmark.log' )
+    routes = synthetic_log( DEFAULT_BOARD, log_file )
+
+    print( "%s, %d synthetic routes of %d moves\n" %
+           ( os.path.basename( DEFAULT_BOARD ), routes, MOVES + 1 ) )
+
+    replay( DEFAULT_BOARD, log_file )
+    os.remove( log_file )
+
+
+if __name__ == '__main__':
+    main( sys.argv[1:] )
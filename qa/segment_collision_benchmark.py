@@ -0,0 +1,40 @@
+#!/usr/bin/env python
+#
+# Compares the batched collision tests of line chains (SEG_BATCH, vectorised when the
+# compiler targets SSE2 or AVX) with the scalar tests: both must give the same results.
+# Prints the time taken by both paths.
+#
+# usage: python segment_collision_benchmark.py [chain count]
+#
+
+import sys
+
+import pcbnew
+
+DEFAULT_CHAINS = 2000
+
+# a few seeds, so the line chains differ between the runs
+SEEDS = [ 1, 2, 3 ]
+
+
+def main( args ):
+    chains = int( args[0] ) if args else DEFAULT_CHAINS
+    failed = False
+
+    for seed in SEEDS:
+        report = pcbnew.BenchmarkSegmentCollisions( chains, seed )
+
+        print( "seed %d:" % seed )
+        print( report )
+
+        for line in report.splitlines():
+            if line.startswith( 'mismatches:' ) and int( line.split()[1] ) != 0:
+                failed = True
+
+    if failed:
+        print( "the batched and scalar collision tests differ" )
+        sys.exit( 1 )
+
+
+if __name__ == '__main__':
+    main( sys.argv[1:] )
@@ -0,0 +1,64 @@
+import unittest
+import pcbnew
+
+from pcbnew import *
+
+
+class TestDrcTrackIndex(unittest.TestCase):
+    """The track clearance tests using DRC_ITEM_INDEX must find the same markers
+    as the full sweep, in the same order."""
+
+    def assertSameMarkers(self, pcb):
+        sweep = TestTrackClearances(pcb, False)
+        sweep_count = pcb.GetMARKERCount()
+
+        index = TestTrackClearances(pcb, True)
+
+        self.assertEqual(pcb.GetMARKERCount(), sweep_count)
+        self.assertEqual(index, sweep)
+
+        return sweep_count
+
+    def test_demo_board(self):
+        pcb = LoadBoard("data/complex_hierarchy.kicad_pcb")
+        self.assertSameMarkers(pcb)
+
+    def test_clearance_violations(self):
+        pcb = BOARD()
+        nets = []
+
+        for name in ["NET_A", "NET_B"]:
+            net = NETINFO_ITEM(pcb, name)
+            pcb.AppendNet(net)
+            nets.append(net.GetNet())
+
+        pcb.SynchronizeNetsAndNetClasses()
+
+        # rows of tracks of alternating nets, every third one too close to the
+        # previous one, and vias of the other net on some of them
+        y = 0
+
+        for row in range(30):
+            y += FromMM(0.3 if row % 3 == 2 else 0.6)
+            net = nets[row % 2]
+
+            for i in range(10):
+                track = TRACK(pcb)
+                track.SetStart(wxPoint(FromMM(i * 2.0), y))
+                track.SetEnd(wxPoint(FromMM((i + 1) * 2.0), y))
+                track.SetWidth(FromMM(0.25))
+                track.SetNetCode(net)
+                pcb.Add(track)
+
+            if row % 4 == 0:
+                via = VIA(pcb)
+                via.SetPosition(wxPoint(FromMM(5.0 + row), y))
+                via.SetWidth(FromMM(0.6))
+                via.SetNetCode(nets[(row + 1) % 2])
+                pcb.Add(via)
+
+        self.assertTrue(self.assertSameMarkers(pcb) > 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,246 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file cached_container_test.cpp
+ * @brief Churns items in a cached vertex container, as editing a big board does,
+ * and reports the time spent allocating and freeing them.
+ *
+ * Items of random sizes are added in several steps (an item grows while it is
+ * drawn) and deleted in random order, CHURN_COUNT times, with MAX_ITEMS / 2 to
+ * MAX_ITEMS items stored. Every CLEANUP_PERIOD churns, most of the items are
+ * deleted at once, so the container shrinks too.
+ *
+ * Defragmentation happens inside the allocations and deletions which need it, so
+ * it shows up as the slowest operations: they are reported with the totals.
+ * Only the VERTEX_MANAGER API is used, so the test builds against any version of
+ * CACHED_CONTAINER.
+ *
+ * The vertices of each item are checked after the churns, since the container
+ * moves items when it is defragmented.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+
+#include <common.h>
+#include <gal/opengl/vertex_manager.h>
+#include <gal/opengl/vertex_item.h>
+
+using namespace KIGFX;
+
+#define CHURN_COUNT     1000000
+#define MAX_ITEMS       50000
+#define CLEANUP_PERIOD  200000
+#define MAX_ITEM_SIZE   200         // vertices
+#define SLOW_OPERATION  1000        // usecs
+
+
+/**
+ * Struct TIMES
+ * accumulates the durations of one kind of operation.
+ */
+struct TIMES
+{
+    TIMES() : m_count( 0 ), m_total( 0 ), m_max( 0 ), m_slow( 0 ) {}
+
+    void Add( unsigned aStart, unsigned aStop )
+    {
+        unsigned duration = aStop - aStart;
+
+        m_count++;
+        m_total += duration;
+
+        if( duration > m_max )
+            m_max = duration;
+
+        if( duration >= SLOW_OPERATION )
+            m_slow++;
+    }
+
+    void Show( const char* aName ) const
+    {
+        printf( "%-10s %8u ops  total: %8.1f ms  slowest: %7.2f ms  slower than %d ms: %u\n",
+                aName, m_count, m_total / 1000.0, m_max / 1000.0,
+                SLOW_OPERATION / 1000, m_slow );
+    }
+
+    unsigned            m_count;
+    unsigned long long  m_total;
+    unsigned            m_max;
+    unsigned            m_slow;
+};
+
+
+/**
+ * Class TEST_ITEM
+ * is a VERTEX_ITEM remembering its id, which is stored in all its vertices.
+ */
+class TEST_ITEM : public VERTEX_ITEM
+{
+public:
+    TEST_ITEM( const VERTEX_MANAGER& aManager, unsigned aId ) :
+        VERTEX_ITEM( aManager ), m_id( aId )
+    {}
+
+    unsigned    m_id;
+};
+
+
+static std::vector<VERTEX>  vertexBuffer;
+
+
+/// Adds an item of aSize vertices, in a few steps as the painters do
+static TEST_ITEM* addItem( VERTEX_MANAGER& aManager, unsigned aId, unsigned aSize )
+{
+    TEST_ITEM* item = new TEST_ITEM( aManager, aId );
+
+    for( unsigned ii = 0; ii < aSize; ii++ )
+    {
+        vertexBuffer[ii].x = aId;
+        vertexBuffer[ii].y = ii;
+        vertexBuffer[ii].z = 0;
+    }
+
+    unsigned added = 0;
+
+    while( added < aSize )
+    {
+        unsigned step = std::min( aSize - added, 3 + (unsigned) rand() % 120 );
+
+        aManager.CopyVertices( &vertexBuffer[added], step );
+        added += step;
+    }
+
+    aManager.FinishItem();
+
+    return item;
+}
+
+
+/// Checks that the vertices of aItem were not lost when the item was moved
+static bool checkItem( const TEST_ITEM* aItem, unsigned aSize )
+{
+    if( aItem->GetSize() != aSize )
+        return false;
+
+    const VERTEX* vertices = aItem->GetVertices();
+
+    for( unsigned ii = 0; ii < aSize; ii++ )
+    {
+        if( vertices[ii].x != aItem->m_id || vertices[ii].y != ii )
+            return false;
+    }
+
+    return true;
+}
+
+
+int main( int argc, char** argv )
+{
+    VERTEX_MANAGER          manager( true );
+    std::vector<TEST_ITEM*> items;
+    std::vector<unsigned>   sizes;
+    TIMES                   allocTimes;
+    TIMES                   freeTimes;
+    TIMES                   cleanupTimes;
+    unsigned                nextId = 0;
+
+    srand( 1 );
+    vertexBuffer.resize( MAX_ITEM_SIZE );
+
+    unsigned start = GetRunningMicroSecs();
+
+    for( int churn = 0; churn < CHURN_COUNT; churn++ )
+    {
+        if( churn % CLEANUP_PERIOD == CLEANUP_PERIOD - 1 )
+        {
+            // Most of the board is redrawn: drop 3/4 of the items
+            unsigned opStart = GetRunningMicroSecs();
+
+            while( items.size() > MAX_ITEMS / 8 )
+            {
+                delete items.back();
+                items.pop_back();
+                sizes.pop_back();
+            }
+
+            cleanupTimes.Add( opStart, GetRunningMicroSecs() );
+        }
+
+        // The item count stays between MAX_ITEMS / 2 and MAX_ITEMS, once refilled
+        bool add = items.size() < MAX_ITEMS / 2 || ( items.size() < MAX_ITEMS && rand() % 2 );
+
+        if( add )
+        {
+            unsigned size = 1 + rand() % MAX_ITEM_SIZE;
+            unsigned opStart = GetRunningMicroSecs();
+
+            items.push_back( addItem( manager, nextId++, size ) );
+
+            allocTimes.Add( opStart, GetRunningMicroSecs() );
+            sizes.push_back( size );
+        }
+        else
+        {
+            unsigned idx = rand() % items.size();
+            unsigned opStart = GetRunningMicroSecs();
+
+            delete items[idx];
+
+            freeTimes.Add( opStart, GetRunningMicroSecs() );
+
+            items[idx] = items.back();
+            items.pop_back();
+            sizes[idx] = sizes.back();
+            sizes.pop_back();
+        }
+    }
+
+    unsigned stop = GetRunningMicroSecs();
+
+    int errors = 0;
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
+    {
+        if( !checkItem( items[ii], sizes[ii] ) )
+        {
+            printf( "item %u: wrong vertices\n", items[ii]->m_id );
+            errors++;
+        }
+    }
+
+    printf( "%d churns, %zu items left, container size: %u vertices\n",
+            CHURN_COUNT, items.size(), manager.GetSize() );
+    allocTimes.Show( "allocate" );
+    freeTimes.Show( "free" );
+    cleanupTimes.Show( "cleanup" );
+    printf( "total: %u ms, %d errors\n", ( stop - start ) / 1000, errors );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
+        delete items[ii];
+
+    return errors ? 1 : 0;
+}
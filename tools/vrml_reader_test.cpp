@@ -0,0 +1,154 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file vrml_reader_test.cpp
+ * @brief Checks that VRML_READER::ReadFloat() reads the VRML numbers like strtof() does
+ * in the C locale, when the current locale uses a comma as decimal point.
+ *
+ * The 3D models are read by a background thread, which must not switch the process
+ * locale to "C": ReadFloat() must give the same values whatever the current locale is.
+ * The values are chosen to take both paths of ReadFloat(): the direct conversion of
+ * short decimal values, and the strtof() fallback for long mantissas, large exponents,
+ * infinities and hexadecimal values.
+ *
+ * The locale is given on the command line, or the first comma-decimal locale found in
+ * a short list of usual ones is used.  The test is skipped if there is none.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <clocale>
+#include <vector>
+
+#include <wx/filename.h>
+
+#include <vrml_aux.h>
+
+
+/// Values written to the file, expected to be read as strtof() reads them in the C locale
+static const char* s_values[] =
+{
+    "1.5",                          // direct conversion
+    "-0.25",
+    "1.5e-3",
+    "12345678901234567890.5",       // more than 19 digits: strtof() fallback
+    "1e30",                         // exponent too large for the direct conversion
+    "-1.5e-30",
+    "inf",
+    "0x1.8p1",
+    "1.00000006",                   // nearly a midpoint between two floats
+    NULL
+};
+
+
+static const char* s_commaLocales[] =
+{
+    "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8", "fr_FR",
+    "German", "French", NULL
+};
+
+
+/// Sets the numeric locale to aName, or to a usual comma-decimal locale if aName is NULL
+static bool setCommaLocale( const char* aName )
+{
+    if( aName )
+        return setlocale( LC_NUMERIC, aName ) && localeconv()->decimal_point[0] == ',';
+
+    for( int ii = 0; s_commaLocales[ii]; ii++ )
+    {
+        if( setlocale( LC_NUMERIC, s_commaLocales[ii] )
+            && localeconv()->decimal_point[0] == ',' )
+            return true;
+    }
+
+    return false;
+}
+
+
+int main( int argc, char** argv )
+{
+    std::vector<float> expected;
+
+    setlocale( LC_NUMERIC, "C" );
+
+    for( int ii = 0; s_values[ii]; ii++ )
+        expected.push_back( strtof( s_values[ii], NULL ) );
+
+    if( !setCommaLocale( argc > 1 ? argv[1] : NULL ) )
+    {
+        printf( "no locale with a comma as decimal point, test skipped\n" );
+        return 0;
+    }
+
+    printf( "locale: %s\n", setlocale( LC_NUMERIC, NULL ) );
+
+    // The values are separated by commas, as in the coordinate lists of a VRML file
+    wxString    filename = wxFileName::CreateTempFileName( wxT( "vrml" ) );
+    FILE*       file = wxFopen( filename, wxT( "wb" ) );
+
+    if( !file )
+    {
+        printf( "cannot write %s\n", TO_UTF8( filename ) );
+        return 1;
+    }
+
+    for( int ii = 0; s_values[ii]; ii++ )
+        fprintf( file, "%s, ", s_values[ii] );
+
+    fclose( file );
+
+    VRML_READER reader;
+    int         errors = 0;
+
+    if( !reader.Open( filename ) )
+    {
+        printf( "cannot read %s\n", TO_UTF8( filename ) );
+        wxRemoveFile( filename );
+        return 1;
+    }
+
+    for( int ii = 0; s_values[ii]; ii++ )
+    {
+        float value = 0;
+
+        if( !reader.ReadFloat( &value ) || !reader.SkipChar( ',' ) )
+        {
+            printf( "%s: not read\n", s_values[ii] );
+            errors++;
+        }
+        else if( memcmp( &value, &expected[ii], sizeof( float ) ) != 0 )
+        {
+            printf( "%s: read %g instead of %g\n", s_values[ii], value, expected[ii] );
+            errors++;
+        }
+    }
+
+    reader.Close();
+    wxRemoveFile( filename );
+
+    printf( "%d values, %d errors\n", (int) expected.size(), errors );
+
+    return errors ? 1 : 0;
+}
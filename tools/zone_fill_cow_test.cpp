@@ -0,0 +1,221 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file zone_fill_cow_test.cpp
+ * @brief Reads zone outlines on several threads, as the zone filling does,
+ * while undo copies of the outlines are alive.
+ *
+ * The corners of a CPolyLine are shared with its copies until one of them is
+ * modified. Filling a zone smoothes its own outline and inflates the outlines of
+ * the other zones, and Fill_All_Zones() fills the zones concurrently. These reads
+ * must not detach the shared corners: two threads detaching the same list is a
+ * data race, and each detach is a useless copy of the outline.
+ * The test fails if a list is no longer shared after the concurrent reads, or if
+ * the results differ from the ones computed on a single thread.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include <common.h>
+#include <task_queue.h>
+#include <PolyLine.h>
+
+#define ZONE_COUNT      64
+#define PASS_COUNT      20
+
+
+/// Builds a zone outline: a jagged main outline with a few square holes
+static CPolyLine* buildOutline( int aSeed )
+{
+    CPolyLine*  poly = new CPolyLine;
+    int         org  = aSeed * 3000000;
+    int         n    = 40 + aSeed % 17;
+
+    for( int ii = 0; ii < n; ii++ )
+    {
+        double  angle  = 2 * M_PI * ii / n;
+        int     radius = 2000000 + ( ( ii * 7 + aSeed ) % 5 ) * 200000;
+        int     x      = org + KiROUND( radius * cos( angle ) );
+        int     y      = KiROUND( radius * sin( angle ) );
+
+        if( ii == 0 )
+            poly->Start( F_Cu, x, y, CPolyLine::DIAGONAL_EDGE );
+        else
+            poly->AppendCorner( x, y );
+    }
+
+    poly->CloseLastContour();
+
+    for( int hole = 0; hole < 3; hole++ )
+    {
+        int x = org - 800000 + hole * 600000;
+        int y = -200000;
+
+        poly->AppendCorner( x, y );
+        poly->AppendCorner( x + 400000, y );
+        poly->AppendCorner( x + 400000, y + 400000 );
+        poly->AppendCorner( x, y + 400000 );
+        poly->CloseLastContour();
+    }
+
+    return poly;
+}
+
+
+/// Sums the corners of a list, to compare the results of the threads
+static long long checksum( const CPOLYGONS_LIST& aList )
+{
+    long long sum = aList.GetCornersCount();
+
+    for( unsigned ii = 0; ii < aList.GetCornersCount(); ii++ )
+        sum = sum * 31 + aList.GetX( ii ) * 7 + aList.GetY( ii ) + aList.IsEndContour( ii );
+
+    return sum;
+}
+
+
+/**
+ * Class FILL_TASK
+ * does the outline reads of the filling of one zone: it smoothes the zone outline
+ * and builds the clearance areas of the outlines of all the other zones.
+ */
+class FILL_TASK
+{
+public:
+    FILL_TASK( boost::ptr_vector<CPolyLine>& aZones, std::vector<long long>& aResults ) :
+        m_zones( aZones ), m_results( aResults )
+    {}
+
+    void operator()( int aZone )
+    {
+        long long   sum = 0;
+        CPolyLine*  smoothed;
+
+        // A zone outline is read through a non const pointer, as the filling code does
+        CPolyLine*  outline = &m_zones[aZone];
+
+        smoothed = outline->Chamfer( 100000 );
+        sum += checksum( smoothed->m_CornersList );
+        delete smoothed;
+
+        smoothed = outline->Fillet( 100000, 16 );
+        sum += checksum( smoothed->m_CornersList );
+        delete smoothed;
+
+        for( unsigned other = 0; other < m_zones.size(); other++ )
+        {
+            CPolyLine*  otherOutline = &m_zones[other];
+
+            for( int icont = 0; icont < otherOutline->GetContoursCount(); icont++ )
+                sum += otherOutline->GetContourSize( icont );
+
+            sum += otherOutline->GetBoundingBox().GetWidth();
+            sum += otherOutline->TestPointInside( 0, 0 );
+
+            CPOLYGONS_LIST clearance;
+            otherOutline->m_CornersList.InflateOutline( clearance, 50000, true );
+            sum += checksum( clearance );
+        }
+
+        m_results[aZone] = sum;
+    }
+
+private:
+    boost::ptr_vector<CPolyLine>&   m_zones;
+    std::vector<long long>&         m_results;
+};
+
+
+int main( int argc, char** argv )
+{
+    boost::ptr_vector<CPolyLine> zones;
+    boost::ptr_vector<CPolyLine> undoCopies;
+
+    for( int ii = 0; ii < ZONE_COUNT; ii++ )
+    {
+        zones.push_back( buildOutline( ii ) );
+
+        // The undo copy shares the corners of the zone
+        undoCopies.push_back( new CPolyLine( zones.back() ) );
+    }
+
+    for( int ii = 0; ii < ZONE_COUNT; ii++ )
+    {
+        if( !zones[ii].m_CornersList.IsShared() )
+        {
+            printf( "zone %d: the undo copy does not share the outline\n", ii );
+            return 1;
+        }
+    }
+
+    std::vector<long long>  expected( ZONE_COUNT );
+    FILL_TASK               serial( zones, expected );
+
+    for( int ii = 0; ii < ZONE_COUNT; ii++ )
+        serial( ii );
+
+    int errors = 0;
+    int threads = std::max( 2, DefaultThreadCount() );
+
+    unsigned start = GetRunningMicroSecs();
+
+    for( int pass = 0; pass < PASS_COUNT; pass++ )
+    {
+        std::vector<long long>  results( ZONE_COUNT );
+        FILL_TASK               task( zones, results );
+        TASK_QUEUE<FILL_TASK>   queue( task, ZONE_COUNT );
+
+        queue.Run( threads );
+
+        for( int ii = 0; ii < ZONE_COUNT; ii++ )
+        {
+            if( results[ii] != expected[ii] )
+            {
+                printf( "pass %d, zone %d: result differs from the single thread one\n",
+                        pass, ii );
+                errors++;
+            }
+        }
+    }
+
+    unsigned stop = GetRunningMicroSecs();
+
+    for( int ii = 0; ii < ZONE_COUNT; ii++ )
+    {
+        if( &zones[ii].m_CornersList.GetList() != &undoCopies[ii].m_CornersList.GetList() )
+        {
+            printf( "zone %d: the outline was copied by a read\n", ii );
+            errors++;
+        }
+    }
+
+    printf( "%d zones, %d passes on %d threads: %u ms, %d errors\n",
+            ZONE_COUNT, PASS_COUNT, threads, ( stop - start ) / 1000, errors );
+
+    return errors ? 1 : 0;
+}